@@ -0,0 +1,219 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "test_xMobileSyncTransfer.h"
+#include "xMobileSyncTransfer.h"
+
+#include <QTemporaryDir>
+#include <QFile>
+
+#include <filesystem>
+#include <chrono>
+
+// Size of the source files. Not a multiple of the resume alignment.
+constexpr auto test_xMobileSyncTransfer_FileSize = 3*1024*1024+123;
+// Size of the source file during the interrupted transfer.
+constexpr auto test_xMobileSyncTransfer_PartialSize = 5*512*1024;
+
+/**
+ * Return the content of a file.
+ *
+ * @param path the path to the file.
+ * @return the content as raw bytes, empty if the file cannot be read.
+ */
+static QByteArray test_xMobileSyncTransfer_read(const std::filesystem::path& path) {
+    QFile file(QString::fromStdString(path.string()));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    return file.readAll();
+}
+
+/**
+ * Write the content of a file.
+ *
+ * @param path the path to the file.
+ * @param content the content as raw bytes.
+ */
+static void test_xMobileSyncTransfer_write(const std::filesystem::path& path, const QByteArray& content) {
+    QFile file(QString::fromStdString(path.string()));
+    QVERIFY(file.open(QIODevice::WriteOnly|QIODevice::Truncate));
+    QCOMPARE(file.write(content), static_cast<qint64>(content.size()));
+}
+
+/**
+ * Return the content of a source file.
+ *
+ * @param seed the value used to vary the content.
+ * @return the content as raw bytes.
+ */
+static QByteArray test_xMobileSyncTransfer_content(int seed) {
+    QByteArray content(test_xMobileSyncTransfer_FileSize, '\0');
+    for (auto i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>((i*31+seed) % 251);
+    }
+    return content;
+}
+
+/**
+ * Interrupt the transfer of a single file.
+ *
+ * The source is truncated after it was added to the transfer. The copy stops at
+ * the end of the truncated source and leaves a partial file. The source content
+ * and modification time are restored afterwards.
+ *
+ * @param source the path to the source file.
+ * @param base the path to the mobile library.
+ * @param destination the path of the destination file relative to the mobile library.
+ */
+static void test_xMobileSyncTransfer_interrupt(const std::filesystem::path& source, const std::filesystem::path& base,
+                                               const std::filesystem::path& destination) {
+    auto content = test_xMobileSyncTransfer_read(source);
+    auto modified = std::filesystem::last_write_time(source);
+    xMobileSyncTransfer transfer(base);
+    transfer.addFile(source, destination);
+    std::filesystem::resize_file(source, test_xMobileSyncTransfer_PartialSize);
+    QVERIFY(!transfer.run());
+    QVERIFY(!std::filesystem::exists(base / destination));
+    test_xMobileSyncTransfer_write(source, content);
+    std::filesystem::last_write_time(source, modified);
+}
+
+
+void test_xMobileSyncTransfer::testCopy() {
+    QTemporaryDir sourceDir;
+    QTemporaryDir baseDir;
+    std::filesystem::path sourcePath(sourceDir.path().toStdString());
+    std::filesystem::path basePath(baseDir.path().toStdString());
+    std::filesystem::create_directories(sourcePath / "Album");
+    test_xMobileSyncTransfer_write(sourcePath / "Album" / "01 Track.flac", test_xMobileSyncTransfer_content(1));
+    test_xMobileSyncTransfer_write(sourcePath / "Album" / "02 Track.flac", test_xMobileSyncTransfer_content(2));
+    xMobileSyncTransfer transfer(basePath);
+    transfer.addDirectory(sourcePath / "Album", "Artist/Album");
+    QCOMPARE(transfer.getTotalBytes(), static_cast<std::uintmax_t>(2*test_xMobileSyncTransfer_FileSize));
+    QVERIFY(transfer.run());
+    QCOMPARE(test_xMobileSyncTransfer_read(basePath / "Artist/Album/01 Track.flac"), test_xMobileSyncTransfer_content(1));
+    QCOMPARE(test_xMobileSyncTransfer_read(basePath / "Artist/Album/02 Track.flac"), test_xMobileSyncTransfer_content(2));
+    // Neither partial files nor the journal are left after a complete transfer.
+    QVERIFY(!std::filesystem::exists(basePath / "Artist/Album/01 Track.flac.xPlaySyncPartial"));
+    QVERIFY(!std::filesystem::exists(basePath / ".xPlaySyncJournal"));
+}
+
+void test_xMobileSyncTransfer::testResume() {
+    QTemporaryDir sourceDir;
+    QTemporaryDir baseDir;
+    std::filesystem::path sourcePath(sourceDir.path().toStdString());
+    std::filesystem::path basePath(baseDir.path().toStdString());
+    auto source = sourcePath / "01 Track.flac";
+    auto partial = basePath / "Album/01 Track.flac.xPlaySyncPartial";
+    test_xMobileSyncTransfer_write(source, test_xMobileSyncTransfer_content(1));
+    test_xMobileSyncTransfer_interrupt(source, basePath, "Album/01 Track.flac");
+    QCOMPARE(std::filesystem::file_size(partial), static_cast<std::uintmax_t>(test_xMobileSyncTransfer_PartialSize));
+    QVERIFY(std::filesystem::exists(basePath / ".xPlaySyncJournal"));
+    // Mark the start of the partial file. The mark is only kept if the copy is continued.
+    auto content = test_xMobileSyncTransfer_read(partial);
+    content[0] = static_cast<char>(~content[0]);
+    test_xMobileSyncTransfer_write(partial, content);
+    xMobileSyncTransfer transfer(basePath);
+    transfer.addFile(source, "Album/01 Track.flac");
+    QVERIFY(transfer.run());
+    auto expected = test_xMobileSyncTransfer_content(1);
+    expected[0] = static_cast<char>(~expected[0]);
+    QCOMPARE(test_xMobileSyncTransfer_read(basePath / "Album/01 Track.flac"), expected);
+    QVERIFY(!std::filesystem::exists(partial));
+    QVERIFY(!std::filesystem::exists(basePath / ".xPlaySyncJournal"));
+}
+
+void test_xMobileSyncTransfer::testResumeChangedSource() {
+    QTemporaryDir sourceDir;
+    QTemporaryDir baseDir;
+    std::filesystem::path sourcePath(sourceDir.path().toStdString());
+    std::filesystem::path basePath(baseDir.path().toStdString());
+    auto source = sourcePath / "01 Track.flac";
+    auto partial = basePath / "Album/01 Track.flac.xPlaySyncPartial";
+    test_xMobileSyncTransfer_write(source, test_xMobileSyncTransfer_content(1));
+    test_xMobileSyncTransfer_interrupt(source, basePath, "Album/01 Track.flac");
+    QVERIFY(std::filesystem::exists(partial));
+    // Replace the source with a file of the same size and a different modification time.
+    test_xMobileSyncTransfer_write(source, test_xMobileSyncTransfer_content(2));
+    std::filesystem::last_write_time(source, std::filesystem::last_write_time(source)+std::chrono::seconds(10));
+    xMobileSyncTransfer transfer(basePath);
+    transfer.addFile(source, "Album/01 Track.flac");
+    QVERIFY(transfer.run());
+    // The partial file is discarded. No bytes of the previous source are kept.
+    QCOMPARE(test_xMobileSyncTransfer_read(basePath / "Album/01 Track.flac"), test_xMobileSyncTransfer_content(2));
+    QVERIFY(!std::filesystem::exists(partial));
+}
+
+void test_xMobileSyncTransfer::testPlanSkip() {
+    QTemporaryDir sourceDir;
+    QTemporaryDir baseDir;
+    std::filesystem::path sourcePath(sourceDir.path().toStdString());
+    std::filesystem::path basePath(baseDir.path().toStdString());
+    std::filesystem::create_directories(basePath / "Album");
+    test_xMobileSyncTransfer_write(sourcePath / "01 Track.flac", test_xMobileSyncTransfer_content(1));
+    test_xMobileSyncTransfer_write(basePath / "Album/01 Track.flac", test_xMobileSyncTransfer_content(1));
+    xMobileSyncTransfer transfer(basePath);
+    transfer.addFile(sourcePath / "01 Track.flac", "Album/01 Track.flac");
+    transfer.plan({});
+    QCOMPARE(transfer.transferFiles.front().action, xMobileSyncTransferSkip);
+    // Files in the removed paths are copied even if identical.
+    transfer.transferFiles.front().action = xMobileSyncTransferCopy;
+    transfer.plan({ basePath / "Album" });
+    QCOMPARE(transfer.transferFiles.front().action, xMobileSyncTransferCopy);
+}
+
+void test_xMobileSyncTransfer::testPlanRename() {
+    QTemporaryDir sourceDir;
+    QTemporaryDir baseDir;
+    std::filesystem::path sourcePath(sourceDir.path().toStdString());
+    std::filesystem::path basePath(baseDir.path().toStdString());
+    std::filesystem::create_directories(basePath / "Old Album");
+    test_xMobileSyncTransfer_write(sourcePath / "01 Track.flac", test_xMobileSyncTransfer_content(1));
+    test_xMobileSyncTransfer_write(sourcePath / "02 Track.flac", test_xMobileSyncTransfer_content(2));
+    test_xMobileSyncTransfer_write(basePath / "Old Album/01 Track.flac", test_xMobileSyncTransfer_content(1));
+    test_xMobileSyncTransfer_write(basePath / "Old Album/02 Track.flac", test_xMobileSyncTransfer_content(3));
+    xMobileSyncTransfer transfer(basePath);
+    transfer.addFile(sourcePath / "01 Track.flac", "Album/01 Track.flac");
+    transfer.addFile(sourcePath / "02 Track.flac", "Album/02 Track.flac");
+    transfer.plan({ basePath / "Old Album" });
+    // Only the identical file is renamed. The other file has the same size but a different content.
+    QCOMPARE(transfer.transferFiles[0].action, xMobileSyncTransferRename);
+    QVERIFY(transfer.transferFiles[0].existing == basePath / "Old Album/01 Track.flac");
+    QCOMPARE(transfer.transferFiles[1].action, xMobileSyncTransferCopy);
+    transfer.renameFiles();
+    QVERIFY(!std::filesystem::exists(basePath / "Old Album/01 Track.flac"));
+    QVERIFY(transfer.run());
+    QCOMPARE(test_xMobileSyncTransfer_read(basePath / "Album/01 Track.flac"), test_xMobileSyncTransfer_content(1));
+    QCOMPARE(test_xMobileSyncTransfer_read(basePath / "Album/02 Track.flac"), test_xMobileSyncTransfer_content(2));
+}
+
+void test_xMobileSyncTransfer::testPlanChanged() {
+    QTemporaryDir sourceDir;
+    QTemporaryDir baseDir;
+    std::filesystem::path sourcePath(sourceDir.path().toStdString());
+    std::filesystem::path basePath(baseDir.path().toStdString());
+    std::filesystem::create_directories(basePath / "Album");
+    // Same size, the beginning, the middle and the end are unchanged.
+    auto changed = test_xMobileSyncTransfer_content(1);
+    changed[changed.size()/4] = static_cast<char>(~changed[changed.size()/4]);
+    test_xMobileSyncTransfer_write(sourcePath / "01 Track.flac", test_xMobileSyncTransfer_content(1));
+    test_xMobileSyncTransfer_write(basePath / "Album/01 Track.flac", changed);
+    xMobileSyncTransfer transfer(basePath);
+    transfer.addFile(sourcePath / "01 Track.flac", "Album/01 Track.flac");
+    transfer.plan({});
+    QCOMPARE(transfer.transferFiles.front().action, xMobileSyncTransferCopy);
+    QVERIFY(transfer.run());
+    QCOMPARE(test_xMobileSyncTransfer_read(basePath / "Album/01 Track.flac"), test_xMobileSyncTransfer_content(1));
+}
@@ -0,0 +1,29 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <QtTest>
+#include <QtTestWidgets>
+
+
+class test_xMobileSyncTransfer:public QObject {
+    Q_OBJECT
+
+private slots:
+    void testCopy();
+    void testResume();
+    void testResumeChangedSource();
+    void testPlanSkip();
+    void testPlanRename();
+    void testPlanChanged();
+};
@@ -14,8 +14,10 @@
 
 #include "test_xMovieLibrary.h"
 #include "xPlayerConfiguration.h"
+#include "xMovieFile.h"
 
 #include <QtTest/QSignalSpy>
+#include <QScopeGuard>
 #include <QMetaType>
 
 #include <vector>
@@ -167,3 +169,103 @@ void test_xMovieLibrary::testScannedMovies() {
     movies.sort();
     QVERIFY(movies == expectedMovies);
 }
+
+void test_xMovieLibrary::testScanDepth() {
+    QStringList expectedMovies {
+            "lilyhammer - s01 e01 - reality check.mkv",
+            "lilyhammer - s01 e02 - the flamingo.mkv",
+            "season 2/lilyhammer - s02 e01 - trouble.mkv",
+    };
+    // Restore the scan depth even if a verification fails.
+    auto scanDepth = xPlayerConfiguration::configuration()->getMovieLibraryScanDepth();
+    auto restoreScanDepth = qScopeGuard([scanDepth]() {
+        xPlayerConfiguration::configuration()->setMovieLibraryScanDepth(scanDepth);
+    });
+    xPlayerConfiguration::configuration()->setMovieLibraryScanDepth(3);
+    QSignalSpy spyTags(movieLibrary, &xMovieLibrary::scannedTags);
+    movieLibrary->setBaseDirectories(baseDirectories);
+    spyTags.wait();
+    QVERIFY(spyTags.count() == 1);
+    QSignalSpy spy(movieLibrary, &xMovieLibrary::scannedMovies);
+    movieLibrary->scanForTagAndDirectory("shows", "lilyhammer");
+    spy.wait();
+    QVERIFY(spy.count() == 1);
+    auto moviesPaths = qvariant_cast<std::vector<xMovieLibraryEntry*>>(spy.at(0).at(0));
+    QStringList movies;
+    for (const auto& moviePath : moviesPaths) {
+        movies.push_back(moviePath->getMovieName());
+    }
+    movies.sort();
+    QVERIFY(movies == expectedMovies);
+}
+
+void test_xMovieLibrary::testUnknownEntries() {
+    std::list<std::tuple<QString,QString,QString>> entries {
+            { "movies", "stallone", "rocky.mkv" },
+            { "movies", "stallone", "rambo.mkv" },
+            { "documentation", ".", "sicko.mkv" },
+            { "shows", "knight rider", "s01 e01 e02 - knight of the phoenix.mkv" },
+            { "shows", "unknown", "s01 e01.mkv" },
+            { "unknown", ".", "sicko.mkv" },
+    };
+    std::list<std::tuple<QString,QString,QString>> expectedUnknownEntries {
+            { "movies", "stallone", "rambo.mkv" },
+            { "shows", "unknown", "s01 e01.mkv" },
+            { "unknown", ".", "sicko.mkv" },
+    };
+    QVERIFY(movieLibrary->findMovie("movies", "stallone", "rocky.mkv") != nullptr);
+    QVERIFY(movieLibrary->findMovie("movies", "stallone", "rambo.mkv") == nullptr);
+    // Querying unknown directories must not modify the library.
+    QSignalSpy spy(movieLibrary, &xMovieLibrary::scannedMovies);
+    movieLibrary->scanForTagAndDirectory("shows", "unknown");
+    QVERIFY(spy.count() == 0);
+    QSignalSpy spyDirectories(movieLibrary, &xMovieLibrary::scannedDirectories);
+    movieLibrary->scanForTag("shows");
+    QVERIFY(spyDirectories.count() == 1);
+    QVERIFY(!qvariant_cast<QStringList>(spyDirectories.at(0).at(0)).contains("unknown"));
+    auto unknownEntries = movieLibrary->findUnknownEntries(entries);
+    QVERIFY(unknownEntries == expectedUnknownEntries);
+}
+
+void test_xMovieLibrary::testSnapshot() {
+    auto previousSnapshot = movieLibrary->snapshot();
+    QVERIFY(previousSnapshot != nullptr);
+    auto previousEntry = movieLibrary->findMovie("movies", "stallone", "rocky.mkv");
+    QVERIFY(previousEntry != nullptr);
+    auto showEntry = movieLibrary->findMovie("shows", "boston legal", "s01 e01 - head cases.mkv");
+    QVERIFY(showEntry != nullptr);
+    // Rescan without the shows.
+    std::list<std::pair<QString, std::filesystem::path>> moviesDirectories {
+            {"movies", "../tests/input/movielibrary/movies/" },
+    };
+    QSignalSpy spy(movieLibrary, &xMovieLibrary::scannedTags);
+    movieLibrary->setBaseDirectories(moviesDirectories);
+    spy.wait();
+    QVERIFY(spy.count() == 1);
+    QVERIFY(qvariant_cast<QStringList>(spy.at(0).at(0)) == QStringList{ "movies" });
+    // The previous snapshot is not modified by the scan.
+    auto currentSnapshot = movieLibrary->snapshot();
+    QVERIFY(currentSnapshot != previousSnapshot);
+    QVERIFY(previousSnapshot->files.find("shows") != previousSnapshot->files.end());
+    QVERIFY(currentSnapshot->files.find("shows") == currentSnapshot->files.end());
+    // Entries of unchanged movies are reused.
+    QVERIFY(movieLibrary->findMovie("movies", "stallone", "rocky.mkv") == previousEntry);
+    // Entries found remain valid after their snapshot is released.
+    QVERIFY(movieLibrary->findMovie("shows", "boston legal", "s01 e01 - head cases.mkv") == nullptr);
+    previousSnapshot.reset();
+    QCOMPARE(showEntry->getMovieName(), QString("s01 e01 - head cases.mkv"));
+    // Restore the library for other tests.
+    movieLibrary->setBaseDirectories(baseDirectories);
+    spy.wait();
+}
+
+void test_xMovieLibrary::testKeyFrames() {
+    // Matroska file with a key frame every second. The cues are stored after the clusters.
+    xMovieFileInfo info;
+    QVERIFY(xMovieFile::readInfo("../tests/input/test_file.mkv", info, false));
+    QCOMPARE(info.length, static_cast<qint64>(10000));
+    QVERIFY(info.keyFramesValid);
+    QCOMPARE(info.keyFrames, QVector<qint64>({ 0, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000 }));
+    // The movies in the movie library are empty files.
+    QVERIFY(!xMovieFile::readInfo("../tests/input/movielibrary/movies/xxx.mkv", info, false));
+}
@@ -28,6 +28,10 @@ private slots:
     void testScannedDirectories();
     void testScannedMovies_data();
     void testScannedMovies();
+    void testScanDepth();
+    void testUnknownEntries();
+    void testSnapshot();
+    void testKeyFrames();
 
 private:
     xMovieLibrary* movieLibrary;
@@ -19,12 +19,58 @@
 #include "xMusicLibraryTrackEntry.h"
 
 #include <QtTest/QSignalSpy>
+#include <QTemporaryDir>
 #include <QMetaType>
+#include <QFile>
+#include <QDir>
 
 #include <vector>
 #include <list>
 #include <tuple>
 
+/**
+ * Create a music library with the given track files.
+ *
+ * @param base the path to the music library.
+ * @param tracks a list of tuples of the path of the track relative to the library and the file size.
+ */
+static void test_xMusicLibrary_create(const QString& base, const QList<std::pair<QString,int>>& tracks) {
+    for (const auto& [track, size] : tracks) {
+        auto trackPath = QDir(base).filePath(track);
+        QVERIFY(QDir().mkpath(QFileInfo(trackPath).path()));
+        QFile trackFile(trackPath);
+        QVERIFY(trackFile.open(QIODevice::WriteOnly));
+        trackFile.write(QByteArray(size, 'x'));
+    }
+}
+
+/**
+ * Scan the given music library and wait until the scanning is finished.
+ *
+ * @param library the music library.
+ * @param base the path to the music library.
+ */
+static void test_xMusicLibrary_scan(xMusicLibrary* library, const QString& base) {
+    QSignalSpy spyFinished(library, &xMusicLibrary::scanningFinished);
+    library->setUrl(QUrl::fromLocalFile(base));
+    QVERIFY(spyFinished.wait());
+}
+
+/**
+ * Return the sorted names of the given tracks.
+ *
+ * @param tracks the vector of tracks.
+ * @return the list of track names.
+ */
+static QStringList test_xMusicLibrary_trackNames(const std::vector<xMusicLibraryTrackEntry*>& tracks) {
+    QStringList trackNames;
+    for (auto track : tracks) {
+        trackNames.push_back(track->getTrackName());
+    }
+    trackNames.sort();
+    return trackNames;
+}
+
 
 void test_xMusicLibrary::initTestCase() {
     musicLibrary = new xMusicLibrary();
@@ -754,3 +800,94 @@ void test_xMusicLibrary::testScannedTracks() {
     trackNames.sort();
     QVERIFY(trackNames == expectedTrackNames);
 }
+
+void test_xMusicLibrary::testCompare() {
+    QTemporaryDir musicDir;
+    QTemporaryDir mobileDir;
+    test_xMusicLibrary_create(musicDir.path(), {
+            { "dio/holy diver/01 stand up and shout.flac", 100 },
+            { "dio/holy diver/02 holy diver.flac", 100 },
+            { "dio/magica/01 discovery.flac", 100 },
+            { "opeth/damnation/01 windowpane.flac", 100 },
+            { "rainbow/rising/01 tarot woman.flac", 100 },
+    });
+    test_xMusicLibrary_create(mobileDir.path(), {
+            { "dio/holy diver/01 stand up and shout.flac", 100 },
+            { "dio/holy diver/03 gypsy.flac", 100 },
+            { "dio/lock up the wolves/01 wild one.flac", 100 },
+            { "rainbow/rising/01 tarot woman.flac", 200 },
+            { "zz top/eliminator/01 gimme all your lovin.flac", 100 },
+    });
+    xMusicLibrary music;
+    xMusicLibrary mobile;
+    test_xMusicLibrary_scan(&music, musicDir.path());
+    test_xMusicLibrary_scan(&mobile, mobileDir.path());
+    // Compare in both directions. Missing and additional entries are swapped.
+    for (auto reverse : { false, true }) {
+        auto first = (reverse) ? &mobile : &music;
+        auto second = (reverse) ? &music : &mobile;
+        xMusicLibraryDifference missing, additional;
+        auto append = [](xMusicLibraryDifference& difference, const xMusicLibraryDifference& batch) {
+            difference.artists.insert(difference.artists.end(), batch.artists.begin(), batch.artists.end());
+            difference.albums.insert(difference.albums.end(), batch.albums.begin(), batch.albums.end());
+            difference.tracks.insert(difference.tracks.end(), batch.tracks.begin(), batch.tracks.end());
+            difference.differentTracks.insert(difference.differentTracks.end(),
+                                              batch.differentTracks.begin(), batch.differentTracks.end());
+        };
+        first->compare(second, [&](const xMusicLibraryDifference& missingBatch, const xMusicLibraryDifference& additionalBatch) {
+            append(missing, missingBatch);
+            append(additional, additionalBatch);
+        });
+        auto& musicOnly = (reverse) ? additional : missing;
+        auto& mobileOnly = (reverse) ? missing : additional;
+        QCOMPARE(musicOnly.artists.size(), static_cast<size_t>(1));
+        QCOMPARE(musicOnly.artists.front()->getArtistName(), QString("opeth"));
+        QCOMPARE(musicOnly.albums.size(), static_cast<size_t>(1));
+        QCOMPARE(musicOnly.albums.front()->getAlbumName(), QString("magica"));
+        QCOMPARE(test_xMusicLibrary_trackNames(musicOnly.tracks), QStringList{ "02 holy diver.flac" });
+        QCOMPARE(mobileOnly.artists.size(), static_cast<size_t>(1));
+        QCOMPARE(mobileOnly.artists.front()->getArtistName(), QString("zz top"));
+        QCOMPARE(mobileOnly.albums.size(), static_cast<size_t>(1));
+        QCOMPARE(mobileOnly.albums.front()->getAlbumName(), QString("lock up the wolves"));
+        QCOMPARE(test_xMusicLibrary_trackNames(mobileOnly.tracks), QStringList{ "03 gypsy.flac" });
+        // Tracks with different sizes are reported for both libraries.
+        QCOMPARE(test_xMusicLibrary_trackNames(musicOnly.differentTracks), QStringList{ "01 tarot woman.flac" });
+        QCOMPARE(test_xMusicLibrary_trackNames(mobileOnly.differentTracks), QStringList{ "01 tarot woman.flac" });
+        QVERIFY(musicOnly.differentTracks.front()->getFileSize() != mobileOnly.differentTracks.front()->getFileSize());
+    }
+}
+
+void test_xMusicLibrary::testCompareTranscoded() {
+    QTemporaryDir musicDir;
+    QTemporaryDir mobileDir;
+    test_xMusicLibrary_create(musicDir.path(), {
+            { "dio/holy diver/01 stand up and shout.flac", 1000 },
+            { "dio/holy diver/02 holy diver.flac", 1000 },
+            { "dio/holy diver/03 gypsy.mp3", 100 },
+    });
+    // The flac files are transcoded to mp3 files of a different size.
+    test_xMusicLibrary_create(mobileDir.path(), {
+            { "dio/holy diver/01 stand up and shout.mp3", 100 },
+            { "dio/holy diver/03 gypsy.mp3", 100 },
+            { "dio/holy diver/04 caught in the middle.mp3", 100 },
+    });
+    xMusicLibrary music;
+    xMusicLibrary mobile;
+    test_xMusicLibrary_scan(&music, musicDir.path());
+    test_xMusicLibrary_scan(&mobile, mobileDir.path());
+    auto transcodedName = [](const QString& name) {
+        return (name.endsWith(".flac")) ? name.chopped(5)+".mp3" : name;
+    };
+    std::vector<xMusicLibraryTrackEntry*> missingTracks, additionalTracks, differentTracks;
+    music.compare(&mobile, [&](const xMusicLibraryDifference& missing, const xMusicLibraryDifference& additional) {
+        QVERIFY(missing.artists.empty() && missing.albums.empty());
+        QVERIFY(additional.artists.empty() && additional.albums.empty());
+        missingTracks.insert(missingTracks.end(), missing.tracks.begin(), missing.tracks.end());
+        additionalTracks.insert(additionalTracks.end(), additional.tracks.begin(), additional.tracks.end());
+        differentTracks.insert(differentTracks.end(), missing.differentTracks.begin(), missing.differentTracks.end());
+    }, transcodedName);
+    // Transcoded tracks are matched by their transcoded name and not compared by size.
+    QCOMPARE(test_xMusicLibrary_trackNames(missingTracks), QStringList{ "02 holy diver.flac" });
+    QCOMPARE(test_xMusicLibrary_trackNames(additionalTracks), QStringList{ "04 caught in the middle.mp3" });
+    QVERIFY(differentTracks.empty());
+}
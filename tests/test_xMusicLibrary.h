@@ -41,6 +41,8 @@ private slots:
     void testScannedListArtistsAllAlbumTracksFilter();
     void testScannedTracks_data();
     void testScannedTracks();
+    void testCompare();
+    void testCompareTranscoded();
 
 private:
     xMusicLibrary* musicLibrary;
@@ -0,0 +1,191 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "test_xMusicPlayerShuffle.h"
+#include "xMusicPlayerShuffle.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+constexpr auto test_xMusicPlayerShuffle_Seed = 4711;
+constexpr auto test_xMusicPlayerShuffle_BenchmarkElements = 100000;
+
+/**
+ * Verify that the shuffle contains a permutation with a consistent inverse.
+ */
+bool isValidPermutation(const xMusicPlayerShuffle& shuffle, int elements) {
+    if (shuffle.count() != elements) {
+        return false;
+    }
+    std::vector<int> sorted(shuffle.permutation());
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<int> expected(elements);
+    std::iota(expected.begin(), expected.end(), 0);
+    if (sorted != expected) {
+        return false;
+    }
+    for (auto i = 0; i < elements; ++i) {
+        if (shuffle.position(shuffle.index(i)) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_xMusicPlayerShuffle::testCompute_data() {
+    QTest::addColumn<int>("elements");
+    QTest::addColumn<int>("startIndex");
+
+    QTest::newRow("empty") << 0 << -1;
+    QTest::newRow("single") << 1 << 0;
+    QTest::newRow("no start index") << 100 << -1;
+    QTest::newRow("start index") << 100 << 42;
+    QTest::newRow("invalid start index") << 100 << 100;
+}
+
+void test_xMusicPlayerShuffle::testCompute() {
+    QFETCH(int, elements);
+    QFETCH(int, startIndex);
+
+    xMusicPlayerShuffle shuffle(test_xMusicPlayerShuffle_Seed);
+    shuffle.compute(elements, startIndex);
+    QVERIFY(isValidPermutation(shuffle, elements));
+    if ((startIndex >= 0) && (startIndex < elements)) {
+        QVERIFY(shuffle.index(0) == startIndex);
+    }
+    QVERIFY(shuffle.index(elements) == -1);
+    QVERIFY(shuffle.position(-1) == -1);
+}
+
+void test_xMusicPlayerShuffle::testDeterministicSeed() {
+    xMusicPlayerShuffle shuffle1(test_xMusicPlayerShuffle_Seed);
+    xMusicPlayerShuffle shuffle2(test_xMusicPlayerShuffle_Seed);
+    shuffle1.compute(1000, 10);
+    shuffle2.compute(1000, 10);
+    QVERIFY(shuffle1.permutation() == shuffle2.permutation());
+    shuffle1.extend(1500, 100);
+    shuffle2.extend(1500, 100);
+    QVERIFY(shuffle1.permutation() == shuffle2.permutation());
+}
+
+void test_xMusicPlayerShuffle::testExtend() {
+    xMusicPlayerShuffle shuffle(test_xMusicPlayerShuffle_Seed);
+    shuffle.compute(100, 5);
+    std::vector<int> kept(shuffle.permutation().begin(), shuffle.permutation().begin()+21);
+    shuffle.extend(200, 20);
+    QVERIFY(isValidPermutation(shuffle, 200));
+    // The permutation up to the extend position must not change.
+    QVERIFY(std::equal(kept.begin(), kept.end(), shuffle.permutation().begin()));
+    // A smaller number of elements results in a new permutation.
+    shuffle.extend(50, 20);
+    QVERIFY(isValidPermutation(shuffle, 50));
+}
+
+void test_xMusicPlayerShuffle::testRemove() {
+    xMusicPlayerShuffle shuffle(test_xMusicPlayerShuffle_Seed);
+    shuffle.compute(100, -1);
+    auto removePosition = shuffle.position(42);
+    auto nextIndex = shuffle.index(removePosition+1);
+    shuffle.remove(42);
+    QVERIFY(isValidPermutation(shuffle, 99));
+    // The following entry moves up and is shifted if necessary.
+    QVERIFY(shuffle.index(removePosition) == ((nextIndex > 42) ? nextIndex-1 : nextIndex));
+    // Removing an invalid index does not change anything.
+    shuffle.remove(99);
+    QVERIFY(isValidPermutation(shuffle, 99));
+}
+
+void test_xMusicPlayerShuffle::testWeighted() {
+    const int elements = 1000;
+    // The first half is heavily favored.
+    std::vector<double> weights(elements, 0.01);
+    std::fill(weights.begin(), weights.begin()+elements/2, 1.0);
+    xMusicPlayerShuffle shuffle(test_xMusicPlayerShuffle_Seed);
+    shuffle.setWeights(weights, {}, 0);
+    shuffle.compute(elements, -1);
+    QVERIFY(shuffle.isWeighted());
+    QVERIFY(isValidPermutation(shuffle, elements));
+    auto favored = 0;
+    for (auto i = 0; i < 100; ++i) {
+        favored += (shuffle.index(i) < elements/2) ? 1 : 0;
+    }
+    QVERIFY(favored >= 90);
+    // Weights that do not match the number of elements result in a uniform shuffle.
+    shuffle.extend(elements+10, 100);
+    QVERIFY(!shuffle.isWeighted());
+    QVERIFY(isValidPermutation(shuffle, elements+10));
+    shuffle.clearWeights();
+    QVERIFY(!shuffle.isWeighted());
+}
+
+void test_xMusicPlayerShuffle::testWeightedGroupRun() {
+    const int elements = 1000;
+    // Groups of 10 consecutive indices, e.g. an album of an artist.
+    std::vector<double> weights(elements, 1.0);
+    std::vector<int> groups(elements);
+    for (auto i = 0; i < elements; ++i) {
+        groups[i] = i / 10;
+    }
+    xMusicPlayerShuffle shuffle(test_xMusicPlayerShuffle_Seed);
+    shuffle.setWeights(weights, groups, 1);
+    shuffle.compute(elements, 0);
+    QVERIFY(isValidPermutation(shuffle, elements));
+    QVERIFY(shuffle.index(0) == 0);
+    auto groupRuns = 0;
+    for (auto i = 1; i < elements; ++i) {
+        groupRuns += (groups[shuffle.index(i)] == groups[shuffle.index(i-1)]) ? 1 : 0;
+    }
+    QVERIFY(groupRuns <= 1);
+    // Removing an index keeps the weights consistent.
+    shuffle.remove(500);
+    QVERIFY(shuffle.isWeighted());
+    QVERIFY(isValidPermutation(shuffle, elements-1));
+}
+
+void test_xMusicPlayerShuffle::benchmarkCompute() {
+    xMusicPlayerShuffle shuffle(test_xMusicPlayerShuffle_Seed);
+    QBENCHMARK {
+        shuffle.compute(test_xMusicPlayerShuffle_BenchmarkElements, 0);
+    }
+    QVERIFY(isValidPermutation(shuffle, test_xMusicPlayerShuffle_BenchmarkElements));
+}
+
+void test_xMusicPlayerShuffle::benchmarkExtend() {
+    xMusicPlayerShuffle shuffle(test_xMusicPlayerShuffle_Seed);
+    QBENCHMARK {
+        // Simulate queueing an album at a time in the middle of playback.
+        shuffle.compute(test_xMusicPlayerShuffle_BenchmarkElements, -1);
+        for (auto i = 0; i < 100; ++i) {
+            shuffle.extend(test_xMusicPlayerShuffle_BenchmarkElements+(i+1)*10,
+                           test_xMusicPlayerShuffle_BenchmarkElements/2);
+        }
+    }
+    QVERIFY(isValidPermutation(shuffle, test_xMusicPlayerShuffle_BenchmarkElements+1000));
+}
+
+void test_xMusicPlayerShuffle::benchmarkWeighted() {
+    std::vector<double> weights(test_xMusicPlayerShuffle_BenchmarkElements);
+    std::vector<int> groups(test_xMusicPlayerShuffle_BenchmarkElements);
+    for (auto i = 0; i < test_xMusicPlayerShuffle_BenchmarkElements; ++i) {
+        weights[i] = 1.0 / (1 + (i % 7));
+        groups[i] = i % 500;
+    }
+    xMusicPlayerShuffle shuffle(test_xMusicPlayerShuffle_Seed);
+    shuffle.setWeights(weights, groups, 2);
+    QBENCHMARK {
+        shuffle.compute(test_xMusicPlayerShuffle_BenchmarkElements, 0);
+    }
+    QVERIFY(isValidPermutation(shuffle, test_xMusicPlayerShuffle_BenchmarkElements));
+}
@@ -17,6 +17,9 @@
 #include "test_xMusicLibrary.h"
 #include "test_xMovieLibrary.h"
 #include "test_xPlayerRotelControls.h"
+#include "test_xMusicPlayerShuffle.h"
+#include "test_xPlayerBluOSClient.h"
+#include "test_xMobileSyncTransfer.h"
 
 #include "xMusicLibraryArtistEntry.h"
 #include "xMusicLibraryAlbumEntry.h"
@@ -40,6 +43,7 @@ int main(int argc, char** argv) {
     qRegisterMetaType<std::vector<std::pair<QString,QString>>>();
     qRegisterMetaType<xMovieLibraryEntry>();
     qRegisterMetaType<std::vector<xMovieLibraryEntry*>>();
+    qRegisterMetaType<xMovieSnapshot_t>();
     qRegisterMetaType<std::vector<xMusicLibraryAlbumEntry*>>();
 
     test_xMusicLibraryTrackEntry musicLibraryTrackEntry;
@@ -47,10 +51,16 @@ int main(int argc, char** argv) {
     test_xMusicLibrary musicLibrary;
     test_xMovieLibrary movieLibrary;
     test_xPlayerRotelControls rotelControls;
+    test_xMusicPlayerShuffle musicPlayerShuffle;
+    test_xPlayerBluOSClient bluOSClient;
+    test_xMobileSyncTransfer mobileSyncTransfer;
 
     return QTest::qExec(&musicLibraryTrackEntry, argc, argv) |
            QTest::qExec(&musicLibraryEntry, argc, argv) |
            QTest::qExec(&musicLibrary, argc, argv) |
            QTest::qExec(&movieLibrary, argc, argv) |
-           QTest::qExec(&rotelControls, argc, argv);
+           QTest::qExec(&rotelControls, argc, argv) |
+           QTest::qExec(&musicPlayerShuffle, argc, argv) |
+           QTest::qExec(&bluOSClient, argc, argv) |
+           QTest::qExec(&mobileSyncTransfer, argc, argv);
 }
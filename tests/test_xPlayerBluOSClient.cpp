@@ -0,0 +1,537 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "test_xPlayerBluOSClient.h"
+#include "xPlayerBluOSClient.h"
+#include "xPlayerBluOSControl.h"
+#include "xPlayerBluOSStatusTracker.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMutexLocker>
+#include <QSignalSpy>
+#include <QPointer>
+
+#include <vector>
+
+// Number of requests issued by the callback and latency tests.
+constexpr auto test_xPlayerBluOSClient_Requests = 200;
+// Number of songs in the responses used by the parsing benchmarks.
+constexpr auto test_xPlayerBluOSClient_BenchmarkSongs = 5000;
+
+/**
+ * Return a folder response in the format recorded from a BluOS player.
+ *
+ * @param songs the number of songs in the folder.
+ * @return the response as raw bytes.
+ */
+static QByteArray test_xPlayerBluOSClient_folderResponse(int songs) {
+    QByteArray response(R"(<?xml version="1.0" encoding="UTF-8"?>)""\n"
+                        R"(<folders service="LocalMusic" path="Music/Simon &amp; Garfunkel/Bookends"><songs>)");
+    for (auto i = 0; i < songs; ++i) {
+        response += QString(R"(<song><title>Track %1</title><art>Simon &amp; Garfunkel</art><alb>Bookends</alb>)"
+                            R"(<fn>Music/Simon &amp; Garfunkel/Bookends/%1 Track %1.flac</fn><time>%2</time></song>)")
+                .arg(i).arg(100+i%200).toUtf8();
+    }
+    response += "</songs></folders>";
+    return response;
+}
+
+/**
+ * Return a playlist response in the format recorded from a BluOS player.
+ *
+ * @param songs the number of songs in the playlist.
+ * @return the response as raw bytes.
+ */
+static QByteArray test_xPlayerBluOSClient_playlistResponse(int songs) {
+    QByteArray response(QString(R"(<playlist name="Queue" modified="1" length="%1" id="7">)").arg(songs).toUtf8());
+    for (auto i = 0; i < songs; ++i) {
+        response += QString(R"(<song id="%1" songid="%2"><title>Track %1</title><art>Bj&#246;rk</art><alb>Post</alb>)"
+                            R"(<fn>Music/Bj&#246;rk/Post/%1 Track %1.flac</fn><quality>cd</quality></song>)")
+                .arg(i).arg(1000+i).toUtf8();
+    }
+    response += "</playlist>";
+    return response;
+}
+
+/**
+ * Minimal HTTP server that mimics the XML API of the BluOS player.
+ *
+ * The server runs in its own thread. Connections are kept alive and multiple
+ * requests on a connection are answered in order. Status requests with the
+ * current etag are held until the status changes (long-polling). The library
+ * consists of the artists A and B with the album X with a single track each.
+ */
+class test_xPlayerBluOSServer {
+public:
+    test_xPlayerBluOSServer():
+            serverPort(0),
+            serverConnections(0),
+            serverEtag(1),
+            serverTrack("01 track.flac"),
+            serverSong(0) {
+        serverThread.start();
+        server = new QTcpServer();
+        server->moveToThread(&serverThread);
+        QMetaObject::invokeMethod(server, [this]() { listen(); }, Qt::BlockingQueuedConnection);
+    }
+    ~test_xPlayerBluOSServer() {
+        serverThread.quit();
+        serverThread.wait();
+        // The sockets are children of the server.
+        delete server;
+    }
+    [[nodiscard]] QString url() const {
+        return QString("http://127.0.0.1:%1").arg(serverPort);
+    }
+    [[nodiscard]] int connections() const {
+        return serverConnections.load();
+    }
+    [[nodiscard]] QStringList paths() {
+        QMutexLocker lock(&serverMutex);
+        return serverPaths;
+    }
+    void setPlaylist(const QStringList& playlist) {
+        QMutexLocker lock(&serverMutex);
+        serverPlaylist = playlist;
+    }
+    void setFailures(const QString& path, int failures) {
+        QMutexLocker lock(&serverMutex);
+        serverFailurePath = path;
+        serverFailures = failures;
+    }
+    void setTrack(const QString& track, int song) {
+        QMetaObject::invokeMethod(server, [=]() {
+            {
+                QMutexLocker lock(&serverMutex);
+                serverTrack = track;
+                serverSong = song;
+                ++serverEtag;
+            }
+            // Answer the held status requests.
+            for (const auto& socket : serverHeld) {
+                if (socket) {
+                    write(socket, status());
+                }
+            }
+            serverHeld.clear();
+        }, Qt::BlockingQueuedConnection);
+    }
+
+private:
+    void listen() {
+        server->listen(QHostAddress::LocalHost);
+        serverPort = server->serverPort();
+        QObject::connect(server, &QTcpServer::newConnection, server, [this]() {
+            while (server->hasPendingConnections()) {
+                auto socket = server->nextPendingConnection();
+                ++serverConnections;
+                QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+                    respond(socket);
+                });
+            }
+        });
+    }
+    void respond(QTcpSocket* socket) {
+        auto& buffer = serverBuffers[socket];
+        buffer.append(socket->readAll());
+        qsizetype end;
+        while ((end = buffer.indexOf("\r\n\r\n")) >= 0) {
+            // Request line: GET <path> HTTP/1.1
+            auto path = QString::fromUtf8(buffer.left(end).split(' ').value(1));
+            buffer.remove(0, end+4);
+            if (hold(path)) {
+                serverHeld.push_back(socket);
+                continue;
+            }
+            if (fail(path)) {
+                write(socket, "<error>Internal Server Error</error>", "500 Internal Server Error");
+                continue;
+            }
+            write(socket, reply(path));
+        }
+    }
+    static void write(QTcpSocket* socket, const QByteArray& body, const QString& status="200 OK") {
+        socket->write(QString("HTTP/1.1 %1\r\nContent-Type: text/xml\r\nContent-Length: %2\r\n\r\n").arg(status).arg(body.size()).toUtf8());
+        socket->write(body);
+    }
+    bool fail(const QString& path) {
+        QMutexLocker lock(&serverMutex);
+        if ((serverFailures > 0) && (path.contains(serverFailurePath))) {
+            serverPaths.push_back(path);
+            --serverFailures;
+            return true;
+        }
+        return false;
+    }
+    bool hold(const QString& path) {
+        QMutexLocker lock(&serverMutex);
+        if ((path.startsWith("/Status")) && (path.contains(QString("etag=%1").arg(serverEtag)))) {
+            serverPaths.push_back(path);
+            return true;
+        }
+        return false;
+    }
+    QByteArray status() {
+        QMutexLocker lock(&serverMutex);
+        return QString("<status etag=\"%1\"><state>play</state><volume>42</volume><mute>0</mute><shuffle>0</shuffle>"
+                       "<fn>Music/artist/album/%2</fn><song>%3</song><secs>10</secs>"
+                       "<quality>cd</quality><canSeek>1</canSeek></status>").arg(serverEtag).arg(serverTrack).arg(serverSong).toUtf8();
+    }
+    QByteArray reply(const QString& path) {
+        if (path.startsWith("/Status")) {
+            {
+                QMutexLocker lock(&serverMutex);
+                serverPaths.push_back(path);
+            }
+            return status();
+        }
+        QMutexLocker lock(&serverMutex);
+        serverPaths.push_back(path);
+        if (path.startsWith("/Volume")) {
+            return "<volume>42</volume>";
+        }
+        if (path.startsWith("/Add")) {
+            return "<addsong length=\"1\"/>";
+        }
+        if (path.startsWith("/Folders")) {
+            // Base path, artists, albums or tracks depending on the depth of the path.
+            auto folder = QUrl::fromPercentEncoding(path.section("path=", 1).toUtf8());
+            switch ((folder.isEmpty()) ? 0 : folder.count('/')+1) {
+                case 0: return "<folders><subfolders><folder>Music</folder></subfolders></folders>";
+                case 1: return "<folders><subfolders><folder>A</folder><folder>B</folder></subfolders></folders>";
+                case 2: return "<folders><subfolders><folder>X</folder></subfolders></folders>";
+                default: return QString("<folders><songs><song><fn>%1/1 Track.flac</fn><time>100</time></song></songs></folders>").
+                        arg(folder).toUtf8();
+            }
+        }
+        if (path.startsWith("/Playlist")) {
+            QByteArray playlist(QString(R"(<playlist name="Queue" length="%1">)").arg(serverPlaylist.size()).toUtf8());
+            for (auto i = 0; i < serverPlaylist.size(); ++i) {
+                playlist += QString(R"(<song id="%1" songid="%2"><fn>%3</fn></song>)").arg(i).arg(1000+i).arg(serverPlaylist[i]).toUtf8();
+            }
+            return playlist + "</playlist>";
+        }
+        if (path.startsWith("/Info")) {
+            // The track info is a small HTML page.
+            return "<tr><td>Sample rate</td><td>96000</td></tr>\n<tr><td>Sample size</td><td>24</td></tr>";
+        }
+        return "<ok/>";
+    }
+
+    QThread serverThread;
+    QTcpServer* server;
+    quint16 serverPort;
+    std::atomic<int> serverConnections;
+    QMutex serverMutex;
+    QStringList serverPaths;
+    QStringList serverPlaylist;
+    QString serverFailurePath;
+    int serverFailures = 0;
+    int serverEtag;
+    QString serverTrack;
+    int serverSong;
+    // Only accessed within the server thread.
+    QHash<QTcpSocket*,QByteArray> serverBuffers;
+    std::vector<QPointer<QTcpSocket>> serverHeld;
+};
+
+
+void test_xPlayerBluOSClient::testRequestFuture() {
+    test_xPlayerBluOSServer server;
+    xPlayerBluOSClient client;
+    auto volume = client.request(QUrl(server.url()+"/Volume")).get();
+    QCOMPARE(volume, QByteArray("<volume>42</volume>"));
+    auto status = client.request(QUrl(server.url()+"/Status")).get();
+    QVERIFY(status.startsWith("<status"));
+    QCOMPARE(client.getCompletedRequests(), static_cast<qint64>(2));
+    // Unreachable player results in an empty result.
+    QVERIFY(client.request(QUrl("http://127.0.0.1:1/Status")).get().isEmpty());
+    // Error replies result in an empty result.
+    server.setFailures("/Volume", 1);
+    QVERIFY(client.request(QUrl(server.url()+"/Volume")).get().isEmpty());
+    QCOMPARE(client.request(QUrl(server.url()+"/Volume")).get(), QByteArray("<volume>42</volume>"));
+}
+
+void test_xPlayerBluOSClient::testRequestCallback() {
+    test_xPlayerBluOSServer server;
+    xPlayerBluOSClient client;
+    auto received = 0;
+    for (auto i = 0; i < test_xPlayerBluOSClient_Requests; ++i) {
+        client.request(QUrl(server.url()+"/Volume"), this, [&received](const QByteArray& result) {
+            QCOMPARE(result, QByteArray("<volume>42</volume>"));
+            ++received;
+        });
+    }
+    // The callbacks are called within the event loop of the test.
+    QCOMPARE(received, 0);
+    QTRY_COMPARE(received, test_xPlayerBluOSClient_Requests);
+    // The connections are kept alive and reused.
+    QVERIFY(server.connections() <= 4);
+}
+
+void test_xPlayerBluOSClient::testOrderedRequests() {
+    test_xPlayerBluOSServer server;
+    xPlayerBluOSClient client;
+    std::vector<int> completed;
+    QStringList expectedPaths;
+    for (auto i = 0; i < 50; ++i) {
+        expectedPaths.push_back(QString("/Add?file=track%1").arg(i));
+        client.request(QUrl(server.url()+expectedPaths.back()), this, [&completed, i](const QByteArray&) {
+            completed.push_back(i);
+        }, true);
+    }
+    QTRY_COMPARE(completed.size(), static_cast<size_t>(50));
+    // The player received the requests in the order they were issued.
+    QCOMPARE(server.paths(), expectedPaths);
+    for (auto i = 0; i < 50; ++i) {
+        QCOMPARE(completed[i], i);
+    }
+}
+
+void test_xPlayerBluOSClient::testLatency() {
+    test_xPlayerBluOSServer server;
+    // Sequential requests measure the round-trip latency on a kept alive connection.
+    xPlayerBluOSClient sequentialClient;
+    QElapsedTimer timer;
+    timer.start();
+    for (auto i = 0; i < test_xPlayerBluOSClient_Requests; ++i) {
+        QVERIFY(!sequentialClient.request(QUrl(server.url()+"/Status")).get().isEmpty());
+    }
+    auto sequentialTime = timer.nsecsElapsed()/1000;
+    // Concurrent requests are spread over multiple connections.
+    xPlayerBluOSClient concurrentClient;
+    std::vector<std::future<QByteArray>> results;
+    timer.restart();
+    for (auto i = 0; i < test_xPlayerBluOSClient_Requests; ++i) {
+        results.emplace_back(concurrentClient.request(QUrl(server.url()+"/Status")));
+    }
+    for (auto& result : results) {
+        QVERIFY(!result.get().isEmpty());
+    }
+    auto concurrentTime = timer.nsecsElapsed()/1000;
+    qInfo() << "BluOS round-trip latency (sequential):" << sequentialClient.getAverageLatency() << "us, total:" << sequentialTime << "us";
+    qInfo() << "BluOS round-trip latency (concurrent):" << concurrentClient.getAverageLatency() << "us, total:" << concurrentTime << "us";
+    QCOMPARE(sequentialClient.getCompletedRequests(), static_cast<qint64>(test_xPlayerBluOSClient_Requests));
+    QCOMPARE(concurrentClient.getCompletedRequests(), static_cast<qint64>(test_xPlayerBluOSClient_Requests));
+    QVERIFY(sequentialClient.getAverageLatency() > 0);
+}
+
+void test_xPlayerBluOSClient::testSyncQueue() {
+    test_xPlayerBluOSServer server;
+    auto controls = xPlayerBluOSControls::controls();
+    controls->connect(QUrl(server.url()));
+    // Wait for the initial queue query.
+    QTRY_VERIFY(server.paths().contains("/Playlist"));
+    auto queueCommands = [&server]() {
+        QStringList commands;
+        for (const auto& path : server.paths()) {
+            if ((path.startsWith("/Add")) || (path.startsWith("/Delete")) || (path.startsWith("/Move"))) {
+                commands.push_back(path);
+            }
+        }
+        return commands;
+    };
+    // Appending tracks only requires adds.
+    controls->syncQueue({ "a", "b", "c" });
+    QCOMPARE(controls->queue(), QStringList({ "a", "b", "c" }));
+    QTRY_COMPARE(queueCommands(), QStringList({ "/Add?file=a", "/Add?file=b", "/Add?file=c" }));
+    // Removing and adding a track.
+    controls->syncQueue({ "a", "c", "d" });
+    QCOMPARE(controls->queue(), QStringList({ "a", "c", "d" }));
+    QTRY_COMPARE(queueCommands().mid(3), QStringList({ "/Delete?id=1", "/Add?file=d" }));
+    // Reordering requires a single move.
+    controls->syncQueue({ "c", "a", "d" });
+    QCOMPARE(controls->queue(), QStringList({ "c", "a", "d" }));
+    QTRY_COMPARE(queueCommands().mid(5), QStringList({ "/Move?new=1&old=0" }));
+    // An unchanged playlist does not issue any command.
+    controls->syncQueue({ "c", "a", "d" });
+    QTest::qWait(100);
+    QCOMPARE(queueCommands().size(), 6);
+    // Moving a track over a long distance requires a single move.
+    QStringList playlist;
+    for (auto index = 0; index < 300; ++index) {
+        playlist.push_back(QString("t%1").arg(index));
+    }
+    controls->syncQueue(playlist);
+    QCOMPARE(controls->queue(), playlist);
+    QTRY_COMPARE(queueCommands().size(), 309);
+    playlist.move(0, 299);
+    controls->syncQueue(playlist);
+    QCOMPARE(controls->queue(), playlist);
+    QTRY_COMPARE(queueCommands().mid(309), QStringList({ "/Move?new=299&old=0" }));
+    playlist.move(299, 0);
+    controls->syncQueue(playlist);
+    QCOMPARE(controls->queue(), playlist);
+    QTRY_COMPARE(queueCommands().mid(310), QStringList({ "/Move?new=0&old=299" }));
+    // Each displaced track is moved once.
+    playlist.move(10, 200);
+    playlist.move(250, 3);
+    controls->syncQueue(playlist);
+    QCOMPARE(controls->queue(), playlist);
+    QTRY_COMPARE(queueCommands().size(), 313);
+    controls->disconnect();
+}
+
+void test_xPlayerBluOSClient::testTrackInfo() {
+    test_xPlayerBluOSServer server;
+    server.setPlaylist({ "a.flac", "b.flac" });
+    auto controls = xPlayerBluOSControls::controls();
+    controls->connect(QUrl(server.url()));
+    QTRY_COMPARE(controls->queue(), QStringList({ "a.flac", "b.flac" }));
+    auto requests = [&server](const QString& command) {
+        QStringList paths;
+        for (const auto& path : server.paths()) {
+            if (path.startsWith(command)) {
+                paths.push_back(path);
+            }
+        }
+        return paths;
+    };
+    std::vector<std::tuple<int,int>> trackInfos;
+    auto trackInfo = [&trackInfos](int sampleRate, int bitsPerSample) {
+        trackInfos.emplace_back(sampleRate, bitsPerSample);
+    };
+    // The song id is looked up in the playlist first. The caller does not wait.
+    controls->getTrackInfo("b.flac", trackInfo);
+    QVERIFY(trackInfos.empty());
+    QTRY_COMPARE(trackInfos.size(), static_cast<size_t>(1));
+    QCOMPARE(trackInfos[0], std::make_tuple(96000, 24));
+    QCOMPARE(requests("/Playlist").size(), 2);
+    QCOMPARE(requests("/Info"), QStringList({ "/Info?service=LocalMusic&category=technical&songid=1001&service=library" }));
+    // The song ids are cached. Only the track info is requested.
+    controls->getTrackInfo("a.flac", trackInfo);
+    QTRY_COMPARE(trackInfos.size(), static_cast<size_t>(2));
+    QCOMPARE(requests("/Playlist").size(), 2);
+    QCOMPARE(requests("/Info").size(), 2);
+    // Tracks not in the playlist are reported as unknown.
+    controls->getTrackInfo("c.flac", trackInfo);
+    QTRY_COMPARE(trackInfos.size(), static_cast<size_t>(3));
+    QCOMPARE(trackInfos[2], std::make_tuple(-1, -1));
+    controls->disconnect();
+}
+
+void test_xPlayerBluOSClient::testCrawlLibrary() {
+    test_xPlayerBluOSServer server;
+    auto controls = xPlayerBluOSControls::controls();
+    controls->connect(QUrl(server.url()));
+    auto notInterrupted = []() { return false; };
+    // Failed requests are retried.
+    server.setFailures("path=Music/A/X", 2);
+    auto library = controls->crawlLibrary(notInterrupted);
+    QCOMPARE(library.size(), static_cast<size_t>(2));
+    for (const auto& artist : library) {
+        QCOMPARE(artist.albums.size(), static_cast<size_t>(1));
+        QCOMPARE(artist.albums[0].tracks.size(), static_cast<size_t>(1));
+        QCOMPARE(std::get<1>(artist.albums[0].tracks[0]), QString("Music/%1/X/1 Track.flac").arg(std::get<2>(artist.artist)));
+    }
+    // Repeatedly failing requests abort the crawl. The partial library is not returned.
+    server.setFailures("path=Music/B", 100);
+    QVERIFY(controls->crawlLibrary(notInterrupted).empty());
+    server.setFailures("path=Music", 100);
+    QVERIFY(controls->crawlLibrary(notInterrupted).empty());
+    server.setFailures(QString(), 0);
+    controls->disconnect();
+}
+
+void test_xPlayerBluOSClient::testStatusTracker() {
+    test_xPlayerBluOSServer server;
+    xPlayerBluOSClient client;
+    xPlayerBluOSStatusTracker tracker(&client);
+    QSignalSpy trackSpy(&tracker, &xPlayerBluOSStatusTracker::trackChanged);
+    QSignalSpy volumeSpy(&tracker, &xPlayerBluOSStatusTracker::volumeChanged);
+    tracker.start(server.url());
+    // The first reply reports all fields.
+    QTRY_COMPARE(trackSpy.count(), 1);
+    QCOMPARE(trackSpy.last().at(0).toString(), QString("Music/artist/album/01 track.flac"));
+    QCOMPARE(volumeSpy.count(), 1);
+    // Wait for the status request to be held by the player.
+    QTRY_VERIFY(server.paths().contains("/Status?timeout=60&etag=1"));
+    QElapsedTimer timer;
+    timer.start();
+    server.setTrack("02 track.flac", 1);
+    QTRY_COMPARE(trackSpy.count(), 2);
+    auto latency = timer.elapsed();
+    qInfo() << "BluOS track change latency:" << latency << "ms";
+    QCOMPARE(trackSpy.last().at(0).toString(), QString("Music/artist/album/02 track.flac"));
+    QCOMPARE(trackSpy.last().at(1).toInt(), 1);
+    // Unchanged fields are not reported again.
+    QCOMPARE(volumeSpy.count(), 1);
+    // The player is not polled while nothing changes. The next status request is held.
+    QTRY_VERIFY(server.paths().contains("/Status?timeout=60&etag=2"));
+    QStringList statusPaths;
+    for (const auto& path : server.paths()) {
+        if (path.startsWith("/Status")) {
+            statusPaths.push_back(path);
+        }
+    }
+    QCOMPARE(statusPaths, QStringList({ "/Status", "/Status?timeout=60&etag=1", "/Status?timeout=60&etag=2" }));
+    tracker.stop();
+}
+
+void test_xPlayerBluOSClient::testParseResponses() {
+    auto controls = xPlayerBluOSControls::controls();
+    std::vector<std::tuple<QString,QString,qint64>> tracks;
+    QVERIFY(controls->parseTracks(test_xPlayerBluOSClient_folderResponse(3), tracks));
+    QCOMPARE(tracks.size(), static_cast<size_t>(3));
+    // Escapes are resolved.
+    QCOMPARE(std::get<0>(tracks[1]), QString("Music/Simon & Garfunkel/Bookends/1 Track 1.flac"));
+    QCOMPARE(std::get<1>(tracks[1]), QString("1 Track 1.flac"));
+    QCOMPARE(std::get<2>(tracks[1]), static_cast<qint64>(101000));
+    auto queue = controls->parsePlaylist(test_xPlayerBluOSClient_playlistResponse(2));
+    QCOMPARE(queue, QStringList({ QString::fromUtf8("Music/Bj\xc3\xb6rk/Post/0 Track 0.flac"),
+                                  QString::fromUtf8("Music/Bj\xc3\xb6rk/Post/1 Track 1.flac") }));
+    auto trackIds = controls->parsePlaylistTrackIds(test_xPlayerBluOSClient_playlistResponse(2));
+    QCOMPARE(trackIds.value(QString::fromUtf8("Music/Bj\xc3\xb6rk/Post/1 Track 1.flac")), 1001);
+    std::vector<QString> folders;
+    QVERIFY(controls->parseFolders("<folders><subfolders><folder>A</folder><folder>B &amp; C</folder></subfolders></folders>", folders));
+    QCOMPARE(folders, std::vector<QString>({ "A", "B & C" }));
+    // A folder without subfolders or songs is not an error.
+    QVERIFY(controls->parseFolders("<folders path=\"Music/A\"/>", folders));
+    QVERIFY(folders.empty());
+    QVERIFY(controls->parseTracks("<folders path=\"Music/A/X\"/>", tracks));
+    QVERIFY(tracks.empty());
+    QCOMPARE(controls->parseVolume("<volume db=\"-20.5\" mute=\"0\">42</volume>"), 42);
+    QCOMPARE(controls->parseState("<status etag=\"1\"><state>pause</state></status>"), QString("pause"));
+    // Empty or broken responses result in empty results. Folder queries report them as failure.
+    QVERIFY(controls->parsePlaylist(QByteArray()).isEmpty());
+    QVERIFY(!controls->parseTracks("<folders><songs>", tracks));
+    QVERIFY(!controls->parseTracks(QByteArray(), tracks));
+    QVERIFY(!controls->parseFolders("<error>Internal Server Error</error>", folders));
+    QCOMPARE(controls->parseVolume(QByteArray()), -1);
+}
+
+void test_xPlayerBluOSClient::benchmarkParseTracks() {
+    auto recorded = test_xPlayerBluOSClient_folderResponse(test_xPlayerBluOSClient_BenchmarkSongs);
+    auto controls = xPlayerBluOSControls::controls();
+    std::vector<std::tuple<QString,QString,qint64>> tracks;
+    QBENCHMARK {
+        // Each received response is an unshared buffer.
+        controls->parseTracks(QByteArray(recorded.constData(), recorded.size()), tracks);
+    }
+    QCOMPARE(tracks.size(), static_cast<size_t>(test_xPlayerBluOSClient_BenchmarkSongs));
+}
+
+void test_xPlayerBluOSClient::benchmarkParsePlaylist() {
+    auto recorded = test_xPlayerBluOSClient_playlistResponse(test_xPlayerBluOSClient_BenchmarkSongs);
+    auto controls = xPlayerBluOSControls::controls();
+    QStringList queue;
+    QBENCHMARK {
+        // Each received response is an unshared buffer.
+        queue = controls->parsePlaylist(QByteArray(recorded.constData(), recorded.size()));
+    }
+    QCOMPARE(queue.size(), static_cast<qsizetype>(test_xPlayerBluOSClient_BenchmarkSongs));
+}
@@ -26,6 +26,7 @@
 #include "xPlayerConfiguration.h"
 #include "xPlayerConfigurationDialog.h"
 #include "xPlayerDatabase.h"
+#include "xPlayerDurationService.h"
 #include "xPlayerConfig.h"
 #include "xPlayerPulseAudioControls.h"
 #include "xPlayerBluOSControl.h"
@@ -53,6 +54,7 @@ xApplication::xApplication(QWidget* parent, Qt::WindowFlags flags):
     qRegisterMetaType<std::vector<xMusicLibraryArtistEntry*>>();
     qRegisterMetaType<xMovieLibraryEntry>();
     qRegisterMetaType<xMovieLibraryEntry*>();
+    qRegisterMetaType<xMovieSnapshot_t>();
     qRegisterMetaType<std::filesystem::path>();
     // Setup music and movie library.
     musicLibrary = new xMusicLibrary(this);
@@ -104,6 +106,9 @@ xApplication::xApplication(QWidget* parent, Qt::WindowFlags flags):
     connect(musicLibrary, &xMusicLibrary::scannedListArtistsAllAlbumTracks, mainMusicWidget, &xMainMusicWidget::scannedListArtistsAllAlbumTracks);
     // Connect music or movie library for application.
     connect(musicLibrary, &xMusicLibrary::scannedUnknownEntries, this, &xApplication::unknownTracks);
+    // Files may have been replaced. Do not use the lengths cached before a rescan.
+    connect(musicLibrary, &xMusicLibrary::scanningFinished, this, &xPlayerDurationService::invalidateCache);
+    connect(movieLibrary, &xMovieLibrary::scannedTags, this, &xPlayerDurationService::invalidateCache);
     connect(movieLibrary, &xMovieLibrary::scannedUnknownEntries, this, &xApplication::unknownMovies);
     // Connect movie library with main movie widget
     connect(mainMovieWidget, &xMainMovieWidget::scanForTag, movieLibrary, &xMovieLibrary::scanForTag);
@@ -134,6 +139,8 @@ xApplication::xApplication(QWidget* parent, Qt::WindowFlags flags):
     });
     connect(xPlayerConfiguration::configuration(), &xPlayerConfiguration::updatedMovieLibraryTagsAndDirectories,
             this, &xApplication::setMovieLibraryTagsAndDirectories);
+    connect(xPlayerConfiguration::configuration(), &xPlayerConfiguration::updatedMovieLibraryScanDepth,
+            this, &xApplication::setMovieLibraryTagsAndDirectories);
     connect(xPlayerConfiguration::configuration(), &xPlayerConfiguration::updatedRotelNetworkAddress,
             this, &xApplication::setRotelNetworkAddress);
     // Connect database.
@@ -546,6 +553,18 @@ void xApplication::createMusicOptionsMenus() {
     musicOptionsVisualizationSmall->setChecked(true);
     auto musicOptionsVisualizationCentral = new QAction("Central Window", musicOptionsVisualizationMode);
     musicOptionsVisualizationCentral->setCheckable(true);
+    // Action group for shuffle mode
+    auto musicOptionsShuffleMode = new QActionGroup(this);
+    musicOptionsShuffleMode->setExclusive(true);
+    auto musicOptionsShuffleUniform = new QAction("Uniform", musicOptionsShuffleMode);
+    musicOptionsShuffleUniform->setCheckable(true);
+    auto musicOptionsShuffleRarelyPlayed = new QAction("Favor Rarely Played", musicOptionsShuffleMode);
+    musicOptionsShuffleRarelyPlayed->setCheckable(true);
+    auto musicOptionsShuffleNotRecentlyPlayed = new QAction("Avoid Recently Played", musicOptionsShuffleMode);
+    musicOptionsShuffleNotRecentlyPlayed->setCheckable(true);
+    auto musicOptionsShuffleLimitArtist = new QAction("Limit Artist Runs", this);
+    musicOptionsShuffleLimitArtist->setCheckable(true);
+    musicOptionsShuffleLimitArtist->setChecked(xPlayerConfiguration::configuration()->getMusicShuffleLimitArtist());
 
     // Create music options menu.
     musicOptionsMenu->addAction(musicOptionsRescanMusicLibrary);
@@ -567,6 +586,24 @@ void xApplication::createMusicOptionsMenus() {
         musicOptionsVisualizationCentral->setChecked(true);
     }
     musicOptionsVisualizationMenu->setDisabled(xPlayerConfiguration::configuration()->getMusicViewVisualization());
+    auto musicOptionsShuffleMenu = musicOptionsMenu->addMenu("Shuffle Mode");
+    musicOptionsShuffleMenu->addAction(musicOptionsShuffleUniform);
+    musicOptionsShuffleMenu->addAction(musicOptionsShuffleRarelyPlayed);
+    musicOptionsShuffleMenu->addAction(musicOptionsShuffleNotRecentlyPlayed);
+    musicOptionsShuffleMenu->addSeparator();
+    musicOptionsShuffleMenu->addAction(musicOptionsShuffleLimitArtist);
+    // Select the proper shuffle mode.
+    switch (xPlayerConfiguration::configuration()->getMusicShuffleMode()) {
+        case xMusicPlayer::RarelyPlayedShuffle: {
+            musicOptionsShuffleRarelyPlayed->setChecked(true);
+        } break;
+        case xMusicPlayer::NotRecentlyPlayedShuffle: {
+            musicOptionsShuffleNotRecentlyPlayed->setChecked(true);
+        } break;
+        default: {
+            musicOptionsShuffleUniform->setChecked(true);
+        } break;
+    }
 
     // Create connections.
     connect(musicOptionsRescanMusicLibrary, &QAction::triggered, [=]() {
@@ -600,6 +637,19 @@ void xApplication::createMusicOptionsMenus() {
             xPlayerConfiguration::configuration()->setMusicViewVisualizationMode(1);
         }
     });
+    // Connect shuffle mode signals.
+    connect(musicOptionsShuffleMode, &QActionGroup::triggered, [=](QAction* action) {
+        if (action == musicOptionsShuffleRarelyPlayed) {
+            xPlayerConfiguration::configuration()->setMusicShuffleMode(xMusicPlayer::RarelyPlayedShuffle);
+        } else if (action == musicOptionsShuffleNotRecentlyPlayed) {
+            xPlayerConfiguration::configuration()->setMusicShuffleMode(xMusicPlayer::NotRecentlyPlayedShuffle);
+        } else {
+            xPlayerConfiguration::configuration()->setMusicShuffleMode(xMusicPlayer::UniformShuffle);
+        }
+    });
+    connect(musicOptionsShuffleLimitArtist, &QAction::triggered, [=](bool checked) {
+        xPlayerConfiguration::configuration()->setMusicShuffleLimitArtist(checked);
+    });
     // Toggle the visualization view.
     connect(mainMusicWidget, &xMainMusicWidget::visualizationToggle, [=]() {
         auto toggleChecked = !musicOptionsVisualization->isChecked();
@@ -16,6 +16,7 @@
 #include "xPlayerUI.h"
 #include "xMusicLibraryTrackEntry.h"
 #include "xPlayerConfiguration.h"
+#include "xMobileSyncTransfer.h"
 
 #include <QApplication>
 #include <QMenu>
@@ -27,20 +28,16 @@
 #include <QCheckBox>
 #include <QDebug>
 
-#include <sys/stat.h>
-#include <sys/sysmacros.h>
-#include <fcntl.h>
 
-
-const QString pathToDeviceSectorSize { "/sys/dev/block/%1:%2/queue/hw_sector_size" }; // NO_LINT
-const QString pathToDeviceStat { "/sys/dev/block/%1:%2/stat" }; // NO_LINT
+// Range of the sync progress bar.
+constexpr auto xMainMobileSyncWidget_ProgressRange = 1000;
 
 xMainMobileSyncWidget::xMainMobileSyncWidget(xMusicLibrary* library, QWidget* parent, Qt::WindowFlags flags):
         QWidget(parent, flags),
         musicLibrary(library),
         musicLibraryExisting(),
+        musicLibraryCompareThread(nullptr),
         mobileLibrarySpaceInfo(),
-        mobileLibraryIOThread(nullptr),
         actionThread(nullptr) {
     // Library tree sections.
     auto layout = new xPlayerLayout(this);
@@ -84,6 +81,7 @@ xMainMobileSyncWidget::xMainMobileSyncWidget(xMusicLibrary* library, QWidget* pa
     mobileLibraryDirectoryButton = new QPushButton(tr("Open..."), this);
     mobileLibraryDirectoryWidget = new QLineEdit(this);
     mobileLibraryScanClearButton = new QPushButton(tr("Clear"), this);
+    mobileLibraryMonitor = new xPlayerDeviceMonitor(this);
 
     auto musicLibraryExistingMenu = new QMenu(this);
     musicLibraryExistingMenu->addAction(tr("Save Mobile Library to Existing"), this,
@@ -120,6 +118,20 @@ xMainMobileSyncWidget::xMainMobileSyncWidget(xMusicLibrary* library, QWidget* pa
     actionStorageBar = new QProgressBar(this);
     actionApplyButton = new QPushButton(tr("Apply"), this);
     actionApplyButton->setEnabled(false);
+    // Transcoding of lossless files.
+    actionTranscodeWidget = new QComboBox(this);
+    actionTranscodeWidget->addItem(tr("No Transcoding"), QString());
+    for (const auto& format : xMobileSyncTranscoder::formats()) {
+        actionTranscodeWidget->addItem(format, format);
+    }
+    actionTranscodeWidget->setCurrentIndex(std::max(actionTranscodeWidget->findData(
+            xPlayerConfiguration::configuration()->getMobileSyncTranscodeFormat()), 0));
+    actionTranscodeBitrateWidget = new QSpinBox(this);
+    actionTranscodeBitrateWidget->setRange(32, 512);
+    actionTranscodeBitrateWidget->setSingleStep(32);
+    actionTranscodeBitrateWidget->setSuffix(tr(" kbit/s"));
+    actionTranscodeBitrateWidget->setValue(xPlayerConfiguration::configuration()->getMobileSyncTranscodeBitrate());
+    actionTranscodeBitrateWidget->setEnabled(actionTranscodeWidget->currentIndex() > 0);
     // Action bar is only visible if action is applied.
     actionBarLabel = new QLabel(tr("Syncing"), this);
     actionBarLabel->setAlignment(Qt::AlignCenter);
@@ -142,6 +154,8 @@ xMainMobileSyncWidget::xMainMobileSyncWidget(xMusicLibrary* library, QWidget* pa
     layout->addWidget(actionStorageBar, 15, 11, 1, 8);
     layout->addWidget(actionBarLabel, 16, 11, 1, 2);
     layout->addWidget(actionBar, 16, 13, 1, 6);
+    layout->addWidget(actionTranscodeWidget, 17, 11, 1, 3);
+    layout->addWidget(actionTranscodeBitrateWidget, 17, 14, 1, 2);
     layout->addWidget(actionApplyButton, 17, 17, 1, 2);
     layout->addColumnSpacer(19, xPlayerLayout::SmallSpace);
     // Mobile library layout
@@ -157,7 +171,7 @@ xMainMobileSyncWidget::xMainMobileSyncWidget(xMusicLibrary* library, QWidget* pa
     layout->addWidget(mobileLibraryScanClearButton, 17, 28, 1, 2);
     this->setLayout(layout);
     // Connect signals.
-    connect(this, &xMainMobileSyncWidget::mobileLibraryIO, this, &xMainMobileSyncWidget::mobileLibraryUpdateIO);
+    connect(mobileLibraryMonitor, &xPlayerDeviceMonitor::throughput, this, &xMainMobileSyncWidget::mobileLibraryUpdateIO);
     connect(mobileLibraryDirectoryButton, &QPushButton::pressed, this, &xMainMobileSyncWidget::mobileLibraryOpenDirectory);
     connect(mobileLibraryScanClearButton, &QPushButton::pressed, this, &xMainMobileSyncWidget::mobileLibraryScanClear);
     connect(mobileLibraryWidget, &xPlayerMusicLibraryWidget::treeItemCtrlClicked, this, &xMainMobileSyncWidget::musicLibraryFindItem);
@@ -173,8 +187,17 @@ xMainMobileSyncWidget::xMainMobileSyncWidget(xMusicLibrary* library, QWidget* pa
     connect(actionAddToWidget, &QListWidget::customContextMenuRequested, this, &xMainMobileSyncWidget::actionAddToDelete);
     connect(actionRemoveFromWidget, &QListWidget::customContextMenuRequested, this, &xMainMobileSyncWidget::actionRemoveFromDelete);
     connect(actionApplyButton, &QPushButton::pressed, this, &xMainMobileSyncWidget::actionApply);
+    connect(actionTranscodeWidget, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int index) {
+        xPlayerConfiguration::configuration()->setMobileSyncTranscodeFormat(actionTranscodeWidget->itemData(index).toString());
+        actionTranscodeBitrateWidget->setEnabled(index > 0);
+    });
+    connect(actionTranscodeBitrateWidget, QOverload<int>::of(&QSpinBox::valueChanged), [=](int bitrate) {
+        xPlayerConfiguration::configuration()->setMobileSyncTranscodeBitrate(bitrate);
+    });
     connect(xPlayerConfiguration::configuration(), &xPlayerConfiguration::updatedUseMusicLibraryBluOS,
             this, &xMainMobileSyncWidget::useMusicLibraryBluOS);
+    connect(xPlayerConfiguration::configuration(), &xPlayerConfiguration::updatedMobileSyncTranscode,
+            this, &xMainMobileSyncWidget::updateTranscode);
     // Update text on scan button based on the content of the mobile library directory entry.
     connect(mobileLibraryDirectoryWidget, &QLineEdit::textChanged, [=](const QString& text) {
         if (text.isEmpty()) {
@@ -296,8 +319,48 @@ void xMainMobileSyncWidget::actionRemoveFromDelete(const QPoint& point) {
 }
 
 void xMainMobileSyncWidget::actionApplyThread(const std::list<xPlayerMusicLibraryWidgetItem*>& actionAddToExpandedItems) {
-    // Remove files.
-    int actionCount = 0;
+    // Determine the files to be copied.
+    xMobileSyncTransfer transfer(mobileLibrary->getUrl().toLocalFile().toStdString());
+    transfer.setMonitor(mobileLibraryMonitor);
+    for (auto addToItem : actionAddToExpandedItems) {
+        // Determine source and destination path relative to the mobile library.
+        if (addToItem->trackEntry()) {
+            std::filesystem::path sourcePath = addToItem->trackEntry()->getUrl().toLocalFile().toStdString();
+            transfer.addFile(sourcePath, std::filesystem::path(addToItem->artist()->entryName().toStdString()) /
+                                         addToItem->album()->entryName().toStdString() / sourcePath.filename());
+        } else {
+            std::filesystem::path sourcePath = addToItem->entryUrl().toLocalFile().toStdString();
+            if (addToItem->artist()) {
+                transfer.addDirectory(sourcePath, std::filesystem::path(addToItem->artist()->entryName().toStdString()) /
+                                                  addToItem->entryName().toStdString());
+            } else {
+                transfer.addDirectory(sourcePath, addToItem->entryName().toStdString());
+            }
+        }
+    }
+    // Transcode lossless files. The transcoded files are copied instead.
+    xMobileSyncTranscoder transcoder(xPlayerConfiguration::configuration()->getMobileSyncTranscodeFormat(),
+                                     xPlayerConfiguration::configuration()->getMobileSyncTranscodeBitrate(),
+                                     xPlayerConfiguration::configuration()->getMobileSyncEncoder());
+    if (transcoder.isEnabled()) {
+        connect(&transfer, &xMobileSyncTransfer::transcodeProgress, this,
+                &xMainMobileSyncWidget::actionApplyTranscodeProgress, Qt::DirectConnection);
+        if (!transfer.transcodeFiles(transcoder)) {
+            return;
+        }
+    }
+    // Skip identical files and rename moved files instead of copying them.
+    std::vector<std::filesystem::path> removals;
+    for (auto removeFromItem : actionRemoveFromItems) {
+        if (removeFromItem->trackEntry()) {
+            removals.emplace_back(removeFromItem->trackEntry()->getUrl().toLocalFile().toStdString());
+        } else {
+            removals.emplace_back(removeFromItem->entryUrl().toLocalFile().toStdString());
+        }
+    }
+    transfer.plan(removals);
+    transfer.renameFiles();
+    // Remove files. Files that are renamed were moved out of the removed paths.
     for (auto removeFromItem : actionRemoveFromItems) {
         // Allow interruptions of remove operations.
         if (QThread::currentThread()->isInterruptionRequested()) {
@@ -312,54 +375,23 @@ void xMainMobileSyncWidget::actionApplyThread(const std::list<xPlayerMusicLibrar
         } catch (const std::filesystem::filesystem_error& error) {
             qCritical() << "Unable to remove item: " << removeFromItem->description() << ", error: " << error.what();
         }
-        // Update action progress.
-        emit actionApplyProgress(++actionCount);
-    }
-    // Copy files.
-    for (auto addToItem : actionAddToExpandedItems) {
-        // Allow interruption of copy operations.
-        if (QThread::currentThread()->isInterruptionRequested()) {
-            return;
-        }
-        try {
-            std::filesystem::path sourcePath;
-            std::filesystem::path destinationPath;
-            std::error_code errorCode;
-            // Determine source and destination path.
-            destinationPath = mobileLibrary->getUrl().toLocalFile().toStdString();
-            if (addToItem->trackEntry()) {
-                sourcePath = addToItem->trackEntry()->getUrl().toLocalFile().toStdString();
-                destinationPath = destinationPath /
-                                  addToItem->artist()->entryName().toStdString() /
-                                  addToItem->album()->entryName().toStdString();
-            } else {
-                sourcePath = addToItem->entryUrl().toLocalFile().toStdString();
-                if (addToItem->artist()) {
-                    destinationPath = destinationPath /
-                                      addToItem->artist()->entryName().toStdString() /
-                                      addToItem->entryName().toStdString();
-                } else {
-                    destinationPath = destinationPath /
-                                      addToItem->entryName().toStdString();
-                }
-            }
-            // We do ignore any error while creating directories.
-            std::filesystem::create_directories(destinationPath, errorCode);
-            // Copy recursively
-            std::filesystem::copy(sourcePath, destinationPath, std::filesystem::copy_options::overwrite_existing |
-                                                               std::filesystem::copy_options::recursive);
-            // Update action progress.
-            emit actionApplyProgress(++actionCount);
-        } catch (const std::filesystem::filesystem_error& error) {
-            qCritical() << "Unable to copy item: " << addToItem->description() << ", error: " << error.what();
-        }
     }
+    // Copy files. The transfer is cancelled if the thread is interrupted.
+    connect(&transfer, &xMobileSyncTransfer::progress, this, &xMainMobileSyncWidget::actionApplyProgress,
+            Qt::DirectConnection);
+    transfer.run();
+    // Remove cached files of other formats and bitrates and limit the cache size.
+    transcoder.prune();
     // Sleep a few ms before finishing thread. Give emitted signals time.
     QThread::msleep(250);
 }
 
-void xMainMobileSyncWidget::actionApplyUpdate(int progress) {
-    actionBar->setValue(progress);
+void xMainMobileSyncWidget::actionApplyUpdate(quint64 copiedBytes, quint64 totalBytes) {
+    // Use a fixed range. The byte counts exceed the range of the progress bar.
+    actionBar->setRange(0, xMainMobileSyncWidget_ProgressRange);
+    actionBar->setValue((totalBytes > 0) ? static_cast<int>((copiedBytes*xMainMobileSyncWidget_ProgressRange)/totalBytes) : 0);
+    actionBar->setFormat(QString(tr("%1 GB of %2 GB")).arg(static_cast<double>(copiedBytes) / 1073741824.0, -1, 'f', 2)
+                                                      .arg(static_cast<double>(totalBytes) / 1073741824.0, -1, 'f', 2));
     // Determine available space and capacity.
     auto currentSpaceInfo = std::filesystem::space(mobileLibrary->getUrl().toLocalFile().toStdString());
     actionStorageBar->setRange(0, static_cast<int>(currentSpaceInfo.capacity / 1048576));
@@ -368,6 +400,13 @@ void xMainMobileSyncWidget::actionApplyUpdate(int progress) {
     actionStorageBar->setFormat(storageBarFormat(currentSpaceInfo.available, currentSpaceInfo.capacity));
 }
 
+void xMainMobileSyncWidget::actionApplyTranscodeUpdate(int transcodedTracks, int totalTracks, double tracksPerMinute) {
+    actionBar->setRange(0, std::max(totalTracks, 1));
+    actionBar->setValue(transcodedTracks);
+    actionBar->setFormat(QString(tr("%1 of %2 tracks transcoded (%3 tracks/min)")).arg(transcodedTracks).arg(totalTracks)
+                                                                                  .arg(tracksPerMinute, -1, 'f', 1));
+}
+
 void xMainMobileSyncWidget::actionApplyFinished() {
     qDebug() << "Sync of mobile library finished...";
     // Rescan the library.
@@ -392,17 +431,20 @@ void xMainMobileSyncWidget::actionApplyFinished() {
     actionAddToGroupBox->setEnabled(true);
     actionRemoveFromWidget->setEnabled(true);
     actionRemoveFromGroupBox->setEnabled(true);
+    actionTranscodeWidget->setEnabled(true);
+    actionTranscodeBitrateWidget->setEnabled(actionTranscodeWidget->currentIndex() > 0);
     disconnect(this, &xMainMobileSyncWidget::actionApplyProgress, this, &xMainMobileSyncWidget::actionApplyUpdate);
+    disconnect(this, &xMainMobileSyncWidget::actionApplyTranscodeProgress, this,
+               &xMainMobileSyncWidget::actionApplyTranscodeUpdate);
     actionApplyButton->setText("Apply");
     // Allow music library scanning again.
     emit enableMusicLibraryScanning(true);
 }
 
 xMainMobileSyncWidget::~xMainMobileSyncWidget() {
-   if (mobileLibraryIOThread) {
-       qDebug() << "Waiting for IO thread to finish.";
-       mobileLibraryIOThread->requestInterruption();
-       mobileLibraryIOThread->wait();
+   mobileLibraryMonitor->stop();
+   if (musicLibraryCompareThread) {
+       musicLibraryCompareThread->wait();
    }
 }
 
@@ -421,6 +463,8 @@ void xMainMobileSyncWidget::actionApply() {
         // Cleanup.
         actionApplyButton->setText(tr("Apply"));
         mobileLibraryScanClear();
+        // Completed files are skipped if the sync is applied again.
+        return;
     }
     // Expand AddTo artist items to multiple artist/album items.
     std::list<xPlayerMusicLibraryWidgetItem*> actionAddToExpandedItems;
@@ -452,12 +496,17 @@ void xMainMobileSyncWidget::actionApply() {
     actionAddToGroupBox->setEnabled(false);
     actionRemoveFromWidget->setEnabled(false);
     actionRemoveFromGroupBox->setEnabled(false);
+    actionTranscodeWidget->setEnabled(false);
+    actionTranscodeBitrateWidget->setEnabled(false);
     // Prepare action bar and make it visible.
     actionBar->setVisible(true);
-    actionBar->setRange(0, static_cast<int>(actionRemoveFromItems.size()+actionAddToExpandedItems.size()));
+    actionBar->setRange(0, xMainMobileSyncWidget_ProgressRange);
+    actionBar->setValue(0);
     actionBarLabel->setVisible(true);
 
     connect(this, &xMainMobileSyncWidget::actionApplyProgress, this, &xMainMobileSyncWidget::actionApplyUpdate);
+    connect(this, &xMainMobileSyncWidget::actionApplyTranscodeProgress, this,
+            &xMainMobileSyncWidget::actionApplyTranscodeUpdate);
     actionThread = QThread::create([=]() { actionApplyThread(actionAddToExpandedItems); });
     connect(actionThread, &QThread::finished, this, &xMainMobileSyncWidget::actionApplyFinished);
     // Disable music library scanning.
@@ -476,6 +525,16 @@ void xMainMobileSyncWidget::useMusicLibraryBluOS() {
     }
 }
 
+void xMainMobileSyncWidget::updateTranscode() {
+    // Do not write the configuration back.
+    QSignalBlocker transcodeBlocker(actionTranscodeWidget);
+    QSignalBlocker transcodeBitrateBlocker(actionTranscodeBitrateWidget);
+    actionTranscodeWidget->setCurrentIndex(std::max(actionTranscodeWidget->findData(
+            xPlayerConfiguration::configuration()->getMobileSyncTranscodeFormat()), 0));
+    actionTranscodeBitrateWidget->setValue(xPlayerConfiguration::configuration()->getMobileSyncTranscodeBitrate());
+    actionTranscodeBitrateWidget->setEnabled((actionTranscodeWidget->isEnabled()) && (actionTranscodeWidget->currentIndex() > 0));
+}
+
 void xMainMobileSyncWidget::mobileLibraryOpenDirectory() {
     QString mobileLibraryDirectoryPath =
             QFileDialog::getExistingDirectory(this, tr("Open Mobile Library"), mobileLibraryDirectoryWidget->text(),
@@ -511,15 +570,8 @@ void xMainMobileSyncWidget::mobileLibraryScanClear() {
                                                                 mobileLibrarySpaceInfo.capacity));
             // Update action section.
             updateActionStorage();
-            // Stop old IO thread and start new IO Thread.
-            if (mobileLibraryIOThread) {
-                mobileLibraryIOThread->requestInterruption();
-                mobileLibraryIOThread->wait();
-            }
-            mobileLibraryIOThread = QThread::create([=]() {
-                mobileLibraryReadIOThread(QString::fromStdString(mobileLibraryPath));
-            });
-            mobileLibraryIOThread->start();
+            // Monitor the device of the new mobile library.
+            mobileLibraryMonitor->start(mobileLibraryPath);
         } catch (const std::filesystem::filesystem_error& error) {
             qCritical() << "Unable to determine capacity for mobile library.";
         }
@@ -527,11 +579,7 @@ void xMainMobileSyncWidget::mobileLibraryScanClear() {
         musicLibraryExisting.erase(mobileLibraryPath);
         updateExistingList();
     } else {
-        if (mobileLibraryIOThread) {
-            mobileLibraryIOThread->requestInterruption();
-            mobileLibraryIOThread->wait();
-            mobileLibraryIOThread = nullptr;
-        }
+        mobileLibraryMonitor->stop();
         mobileLibraryWidget->clear();
         // Clear storage bars.
         mobileLibrarySpaceInfo = std::filesystem::space_info{};
@@ -612,66 +660,6 @@ void xMainMobileSyncWidget::mobileLibraryUpdateIO(quint64 readBytes, quint64 wri
     mobileLibraryIOWriteBar->setFormat(QString("%1 MB/sec").arg(writeKiloBytes/1024.0, -1, 'f', 2));
 }
 
-void xMainMobileSyncWidget::mobileLibraryReadIOThread(const QString &mobileLibraryPath) {
-    // Determine device from path.
-    struct stat pathStat{};
-    if (stat(mobileLibraryPath.toStdString().c_str(), &pathStat) < 0) {
-        qCritical() << "Unable to call stat for path: " << mobileLibraryPath;
-        return;
-    }
-    auto deviceMajor = major(pathStat.st_dev);
-    auto deviceMinor = minor(pathStat.st_dev);
-    // Determine the sector size
-    unsigned long deviceSectorSize = 512;
-    QFile deviceSectorSizeFile(pathToDeviceSectorSize.arg(deviceMajor).arg(deviceMinor));
-    if (deviceSectorSizeFile.open(QIODevice::ReadOnly|QIODevice::Text)) {
-        QTextStream deviceSectorSizeStream(&deviceSectorSizeFile);
-        deviceSectorSizeFile.close();
-    } else {
-        qWarning() << "Unable to read sector size for device. Defaulting to 512 Bytes";
-    }
-    // Open the device stat file.
-    QFile deviceStatFile(pathToDeviceStat.arg(deviceMajor).arg(deviceMinor));
-    if (!deviceStatFile.open(QIODevice::ReadOnly|QIODevice::Text)) {
-        qCritical() << "Unable to open device stat file: " << deviceStatFile.fileName();
-        return;
-    }
-    // Initialize sectors.
-    unsigned long currentSectorsRead = 0;
-    unsigned long currentSectorsWrite = 0;
-    unsigned long sectorsRead = 0;
-    unsigned long sectorsWrite = 0;
-    // Read sectors read/write initial values.
-    QTextStream deviceStatStream(&deviceStatFile);
-    QStringList deviceStat = deviceStatStream.readLine().split(' ', Qt::SkipEmptyParts);
-    if (deviceStat.size() > 6) {
-        currentSectorsRead = deviceStat[2].toULong();
-        currentSectorsWrite = deviceStat[6].toULong();
-    }
-    while (!deviceStatStream.atEnd()) {
-        if (QThread::currentThread()->isInterruptionRequested()) {
-            break;
-        }
-        // Reset stat file stream.
-        deviceStatStream.seek(0);
-        deviceStat = deviceStatStream.readLine().split(' ', Qt::SkipEmptyParts);
-        if (deviceStat.size() > 6) {
-            sectorsRead = deviceStat[2].toULong();
-            sectorsWrite = deviceStat[6].toULong();
-        }
-        auto bytesRead = (sectorsRead - currentSectorsRead) * deviceSectorSize;
-        auto bytesWrite = (sectorsWrite - currentSectorsWrite) * deviceSectorSize;
-        // Emit IO data.
-        emit mobileLibraryIO(bytesRead, bytesWrite);
-        currentSectorsRead = sectorsRead;
-        currentSectorsWrite = sectorsWrite;
-        // Read every second.
-        QThread::sleep(1);
-    }
-    // Close file.
-    deviceStatFile.close();
-}
-
 void xMainMobileSyncWidget::musicLibraryCompare() {
     // Sanity check.
     if ((!mobileLibraryWidget->isReady()) || (!musicLibraryWidget->isReady())) {
@@ -683,18 +671,39 @@ void xMainMobileSyncWidget::musicLibraryCompare() {
     actionAddToWidget->clear();
     actionAddToItems.clear();
     updateActionStorage();
-    // Perform compare.
-    QStringList missingArtists, additionalArtists;
-    std::map<QString, QStringList> missingAlbums, additionalAlbums;
-    std::list<xMusicLibraryTrackEntry*> missingTracks, additionalTracks;
-    std::pair<std::list<xMusicLibraryTrackEntry*>, std::list<xMusicLibraryTrackEntry*>> differentTracks;
-
-    musicLibrary->compare(mobileLibrary, missingArtists, additionalArtists,
-                          missingAlbums, additionalAlbums,
-                          missingTracks, additionalTracks, differentTracks);
-    // Mark music and mobile library.
-    musicLibraryWidget->markItems(missingArtists, missingAlbums, missingTracks, differentTracks.first);
-    mobileLibraryWidget->markItems(additionalArtists, additionalAlbums, additionalTracks, differentTracks.second);
+    musicLibraryWidget->clearItems();
+    mobileLibraryWidget->clearItems();
+    // The compared entries must not change. Disable scanning until the compare is finished.
+    musicLibraryCompareButton->setEnabled(false);
+    mobileLibraryScanClearButton->setEnabled(false);
+    emit enableMusicLibraryScanning(false);
+    // Transcoded tracks are stored in the mobile library with the extension of the target format.
+    xMobileSyncTranscoder transcoder(xPlayerConfiguration::configuration()->getMobileSyncTranscodeFormat(),
+                                     xPlayerConfiguration::configuration()->getMobileSyncTranscodeBitrate(),
+                                     xPlayerConfiguration::configuration()->getMobileSyncEncoder());
+    std::function<QString(const QString&)> trackNameMap;
+    if (transcoder.isEnabled()) {
+        trackNameMap = [transcoder](const QString& name) { return transcoder.trackName(name); };
+    }
+    // Perform compare in a thread. Mark music and mobile library for each batch of differences.
+    musicLibraryCompareThread = QThread::create([=]() {
+        musicLibrary->compare(mobileLibrary, [this](const xMusicLibraryDifference& missing,
+                                                    const xMusicLibraryDifference& additional) {
+            QMetaObject::invokeMethod(this, [this, missing, additional]() {
+                musicLibraryWidget->markItems(missing);
+                mobileLibraryWidget->markItems(additional);
+            }, Qt::QueuedConnection);
+        }, trackNameMap);
+    });
+    // The finished signal is delivered after all batches.
+    connect(musicLibraryCompareThread, &QThread::finished, this, [=]() {
+        musicLibraryCompareThread->deleteLater();
+        musicLibraryCompareThread = nullptr;
+        musicLibraryCompareButton->setEnabled(true);
+        mobileLibraryScanClearButton->setEnabled(true);
+        emit enableMusicLibraryScanning(true);
+    });
+    musicLibraryCompareThread->start();
 }
 
 void xMainMobileSyncWidget::musicLibraryFindItem(xPlayerMusicLibraryWidgetItem* item) {
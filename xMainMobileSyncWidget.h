@@ -16,6 +16,7 @@
 #define __XMAINMOBILESYNCWIDGET_H__
 
 #include "xPlayerMusicLibraryWidget.h"
+#include "xPlayerDeviceMonitor.h"
 
 #include <QThread>
 #include <QPushButton>
@@ -24,6 +25,8 @@
 #include <QListWidget>
 #include <QLineEdit>
 #include <QLabel>
+#include <QComboBox>
+#include <QSpinBox>
 
 #include <filesystem>
 
@@ -49,28 +52,34 @@ signals:
     /**
      * Internal signal used to update the mobile sync progress bar.
      *
-     * @param progress the progress in precent as integer.
+     * @param copiedBytes the number of bytes copied.
+     * @param totalBytes the total number of bytes to be copied.
      */
-    void actionApplyProgress(int progress);
+    void actionApplyProgress(quint64 copiedBytes, quint64 totalBytes);
     /**
-     * Signal emitted whenever we enable/disable the music library scanning.
+     * Internal signal used to update the mobile sync progress bar while transcoding.
      *
-     * @param enabled scanning of music library allowed if true, not allowed otherwise.
+     * @param transcodedTracks the number of tracks transcoded.
+     * @param totalTracks the total number of tracks to be transcoded.
+     * @param tracksPerMinute the number of tracks transcoded per minute.
      */
-    void enableMusicLibraryScanning(bool enabled);
+    void actionApplyTranscodeProgress(int transcodedTracks, int totalTracks, double tracksPerMinute);
     /**
-     * Signal emitted with read/write IO for mobile library.
+     * Signal emitted whenever we enable/disable the music library scanning.
      *
-     * @param readBytes no of bytes per second read.
-     * @param writeBytes no of bytes per second written.
+     * @param enabled scanning of music library allowed if true, not allowed otherwise.
      */
-    void mobileLibraryIO(quint64 readBytes, quint64 writeBytes);
+    void enableMusicLibraryScanning(bool enabled);
 
 private slots:
     /**
      * Disable mobile sync widget if BluOS player library is used.
      */
     void useMusicLibraryBluOS();
+    /**
+     * Update the transcoding controls if the configuration changed.
+     */
+    void updateTranscode();
     /**
      * Open a file dialog.
      *
@@ -107,10 +116,6 @@ private slots:
      * Update mobile library view after scan is finished.
      */
     void mobileLibraryReady();
-    /**
-     * Read IO stats for the mobile library access.
-     */
-    void mobileLibraryReadIOThread(const QString& mobileLibraryPath);
     /**
      * Update progess bars with read and write bytes per second.
      *
@@ -122,8 +127,8 @@ private slots:
      * Compare the music with the mobile directory.
      *
      * The comparison of music and mobile library is perfomed only if both
-     * libraries are ready. The missing and different items for each of the
-     * libraries are marked.
+     * libraries are ready. The comparison runs in a thread and the missing
+     * and different items for each of the libraries are marked in batches.
      */
     void musicLibraryCompare();
     /**
@@ -182,14 +187,27 @@ private slots:
     void actionApply();
     /**
      * The actual remove and copy operations which are executed in a thread.
+     *
+     * The files are copied by the sync transfer. Lossless files are transcoded
+     * before if configured. A cancelled sync resumes with the files not yet
+     * copied if it is applied again.
      */
     void actionApplyThread(const std::list<xPlayerMusicLibraryWidgetItem*>& actionAddToExpandedItems);
     /**
      * Update the action progress and storage bar.
      *
-     * @param progress the action progress as int.
+     * @param copiedBytes the number of bytes copied.
+     * @param totalBytes the total number of bytes to be copied.
+     */
+    void actionApplyUpdate(quint64 copiedBytes, quint64 totalBytes);
+    /**
+     * Update the action progress bar while transcoding.
+     *
+     * @param transcodedTracks the number of tracks transcoded.
+     * @param totalTracks the total number of tracks to be transcoded.
+     * @param tracksPerMinute the number of tracks transcoded per minute.
      */
-    void actionApplyUpdate(int progress);
+    void actionApplyTranscodeUpdate(int transcodedTracks, int totalTracks, double tracksPerMinute);
     /**
      * Perform rescan after the action is finished.
      */
@@ -219,6 +237,7 @@ private:
     QPushButton* musicLibraryExistingButton;
     QListWidget* musicLibraryExistingWidget;
     std::map<std::filesystem::path, std::map<QString, std::map<QString, std::list<xMusicLibraryTrackEntry*>>>> musicLibraryExisting;
+    QThread* musicLibraryCompareThread;
     xMusicLibrary* mobileLibrary;
     xPlayerMusicLibraryWidget* mobileLibraryWidget;
     QGroupBox* mobileLibraryFilter;
@@ -230,7 +249,7 @@ private:
     QProgressBar* mobileLibraryIOReadBar;
     QProgressBar* mobileLibraryIOWriteBar;
     std::filesystem::space_info mobileLibrarySpaceInfo;
-    QThread* mobileLibraryIOThread;
+    xPlayerDeviceMonitor* mobileLibraryMonitor;
     QListWidget* actionAddToWidget;
     QGroupBox* actionAddToGroupBox;
     QListWidget* actionRemoveFromWidget;
@@ -239,6 +258,8 @@ private:
     QLabel* actionBarLabel;
     QProgressBar* actionBar;
     QPushButton* actionApplyButton;
+    QComboBox* actionTranscodeWidget;
+    QSpinBox* actionTranscodeBitrateWidget;
     std::vector<xPlayerMusicLibraryWidgetItem*> actionAddToItems;
     std::vector<xPlayerMusicLibraryWidgetItem*> actionRemoveFromItems;
     QThread* actionThread;
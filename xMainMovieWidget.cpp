@@ -17,8 +17,10 @@
 #include "xPlayerConfiguration.h"
 #include "xPlayerDatabase.h"
 #include "xMovieLibrary.h"
+#include "xMovieFile.h"
 
 #include <QGroupBox>
+#include <QPixmap>
 #include <QApplication>
 #include <QDateTime>
 #include <QSplitter>
@@ -99,7 +101,19 @@ xMainMovieWidget::xMainMovieWidget(xMoviePlayer* player, QWidget* parent):
     moviePlayerWidget = new xPlayerMovieWidget(moviePlayer, moviePlayerStackedWidget);
     // Stacked widget setup for movie player.
     movieStack = new QStackedWidget(moviePlayerStackedWidget);
-    movieStack->addWidget(new QWidget(moviePlayerStackedWidget));
+    // Show the movie catalog info of the selected movie while no movie is played.
+    auto movieInfoWidget = new QWidget(moviePlayerStackedWidget);
+    movieInfoThumbnails = new QLabel(movieInfoWidget);
+    movieInfoThumbnails->setAlignment(Qt::AlignCenter);
+    movieInfoDetails = new QLabel(movieInfoWidget);
+    movieInfoDetails->setAlignment(Qt::AlignCenter);
+    movieInfoDetails->setWordWrap(true);
+    auto movieInfoLayout = new QVBoxLayout(movieInfoWidget);
+    movieInfoLayout->addStretch(1);
+    movieInfoLayout->addWidget(movieInfoThumbnails);
+    movieInfoLayout->addWidget(movieInfoDetails);
+    movieInfoLayout->addStretch(1);
+    movieStack->addWidget(movieInfoWidget);
     moviePlayer->setParent(moviePlayerStackedWidget);
     movieStack->addWidget(moviePlayer);
     movieStack->setCurrentIndex(0);
@@ -121,6 +135,7 @@ xMainMovieWidget::xMainMovieWidget(xMoviePlayer* player, QWidget* parent):
     connect(tagList, &xPlayerListWidget::currentListIndexChanged, this, &xMainMovieWidget::selectTag);
     connect(directoryList, &xPlayerListWidget::currentListIndexChanged, this, &xMainMovieWidget::selectDirectory);
     connect(movieList, &xPlayerListWidget::listItemDoubleClicked, this, &xMainMovieWidget::selectMovie);
+    connect(movieList, &xPlayerListWidget::currentListIndexChanged, this, &xMainMovieWidget::updateMovieInfo);
     connect(movieFilter, &QLineEdit::textChanged, movieList, &xPlayerListWidget::updateFilter);
     // Connect to movie player.
     connect(this, &xMainMovieWidget::setMovie, moviePlayer, &xMoviePlayer::setMovie);
@@ -218,11 +233,12 @@ void xMainMovieWidget::scannedDirectories(const QStringList& directories) {
 void xMainMovieWidget::scannedMovies(const std::vector<xMovieLibraryEntry*>& movies) {
     movieList->clearItems();
     currentMovies.clear();
+    movieList->addListItems(movies);
     for (const auto& movie : movies) {
-        movieList->addListItem(movie);
         currentMovies.push_back(movie);
     }
     updatePlayedMovies();
+    updateMovieInfo(movieList->currentListIndex());
     movieList->updateItems();
     qDebug() << "xMainMovieWidget: no of scanned movies: " << movies.size();
 }
@@ -272,6 +288,41 @@ void xMainMovieWidget::updateSelectedMovie(const std::filesystem::path& path, co
     }
 }
 
+void xMainMovieWidget::updateMovieInfo(int index) {
+    movieInfoThumbnails->clear();
+    movieInfoDetails->clear();
+    if ((index < 0) || (index >= currentMovies.size())) {
+        return;
+    }
+    auto movie = currentMovies[index];
+    auto file = QString::fromStdString(movie->getPath().string());
+    // Only use the catalog entry if the movie file has not been modified since it was indexed.
+    xMovieFileInfo fileInfo;
+    auto info = xPlayerDatabase::database()->getMovieCatalogEntry(file);
+    if ((!xMovieFile::readFileStatus(file, fileInfo)) ||
+        (info.size != fileInfo.size) || (info.modified != fileInfo.modified)) {
+        movieInfoDetails->setText(QString(tr("%1\nnot indexed yet")).arg(movie->getMovieName()));
+        return;
+    }
+    QPixmap thumbnails;
+    if (thumbnails.loadFromData(info.thumbnails, "JPG")) {
+        movieInfoThumbnails->setPixmap(thumbnails);
+    }
+    QStringList details { movie->getMovieName() };
+    if (info.length >= 0) {
+        details.push_back(QString(tr("Length: %1:%2:%3")).
+                arg(info.length/3600000).
+                arg((info.length/60000)%60, 2, 10, QChar('0')).
+                arg((info.length/1000)%60, 2, 10, QChar('0')));
+    }
+    details.push_back(QString(tr("Chapters: %1")).arg(info.chapterBegin.size()));
+    details.push_back(QString(tr("Audio: %1")).arg((info.audioLanguages.isEmpty()) ?
+            tr("none") : info.audioLanguages.join(", ")));
+    details.push_back(QString(tr("Subtitles: %1")).arg((info.subtitleLanguages.isEmpty()) ?
+            tr("none") : info.subtitleLanguages.join(", ")));
+    movieInfoDetails->setText(details.join("\n"));
+}
+
 void xMainMovieWidget::setAutoPlayNextMovie(bool mode) {
     autoPlayNextMovie = mode;
     updateMovieQueue(movieList->currentListIndex());
@@ -24,6 +24,7 @@
 #include <QListWidget>
 #include <QGroupBox>
 #include <QLineEdit>
+#include <QLabel>
 #include <QCheckBox>
 #include <QWidget>
 #include <vector>
@@ -160,6 +161,15 @@ private slots:
      * @param directory the directory for the movie played.
      */
     void updateSelectedMovie(const std::filesystem::path& path, const QString& name, const QString& tag, const QString& directory);
+    /**
+     * Show the movie catalog info for the selected entry in the movie list widget.
+     *
+     * Thumbnails, length, chapters and stream languages are shown if the catalog
+     * entry is still valid for the movie file.
+     *
+     * @param index the listIndex of the selected movie.
+     */
+    void updateMovieInfo(int index);
     /**
      * Set the autoplay next mode and update/clear the movie queue.
      *
@@ -235,6 +245,8 @@ private:
     xPlayerListWidget* movieList;
     QGroupBox* movieFilterBox;
     QLineEdit* movieFilter;
+    QLabel* movieInfoThumbnails;
+    QLabel* movieInfoDetails;
     QList<xMovieLibraryEntry*> currentMovies;
     QString currentMovieName;
     QString currentMovieTag;
@@ -172,8 +172,8 @@ xMainMusicWidget::xMainMusicWidget(xMusicPlayer* player, xMusicLibrary* library,
     queueBoxLayout = new xPlayerLayout(queueBox);
     queueList = new xPlayerListWidget(queueBox, true);
     queueList->setContextMenuPolicy(Qt::CustomContextMenu);
-    queueList->setDragDropMode(QTreeWidget::InternalMove);
-    queueList->setSelectionMode(QTreeWidget::SingleSelection);
+    queueList->setDragDropMode(QAbstractItemView::InternalMove);
+    queueList->setSelectionMode(QAbstractItemView::SingleSelection);
     queueList->setMinimumWidth(xPlayer::QueueListMinimumWidth);
     auto queueShuffleCheck = new QCheckBox(tr("Shuffle Mode"), queueBox);
     // Tags menu.
@@ -364,9 +364,7 @@ void xMainMusicWidget::updateScannedArtists(const std::vector<xMusicLibraryArtis
     clearTrackList();
     // Not very efficient to use a filtered and the unfiltered list, but easier to read.
     filteredArtists = filterArtists(artists);
-    for (auto artist : filteredArtists) {
-        artistList->addListItem(artist);
-    }
+    artistList->addListItems(filteredArtists);
     // Update database overlay for artists.
     updatePlayedArtists();
     // Enable the selector tab if any artists are in the list
@@ -381,9 +379,7 @@ void xMainMusicWidget::scannedAlbums(const std::vector<xMusicLibraryAlbumEntry*>
     // Clear album and track lists
     albumList->clearItems();
     clearTrackList();
-    for (auto album : sortedAlbums) {
-        albumList->addListItem(album);
-    }
+    albumList->addListItems(sortedAlbums);
     // Update database overlay for albums.
     updatePlayedAlbums();
 }
@@ -391,9 +387,7 @@ void xMainMusicWidget::scannedAlbums(const std::vector<xMusicLibraryAlbumEntry*>
 void xMainMusicWidget::scannedTracks(const std::vector<xMusicLibraryTrackEntry*>& tracks) {
     // Clear only track list and stop potential running update thread.
     clearTrackList();
-    for (auto track : tracks) {
-        trackList->addListItem(track);
-    }
+    trackList->addListItems(tracks);
     // Update database overlay for tracks. Run in separate thread.
     updatePlayedTracks();
     // Update track times.
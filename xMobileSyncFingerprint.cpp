@@ -0,0 +1,112 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xMobileSyncFingerprint.h"
+#include "xPlayerDatabase.h"
+
+#include <QCryptographicHash>
+#include <QThreadPool>
+#include <QThread>
+#include <QMutex>
+#include <QDebug>
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+
+// Size of the buffer used to read the file.
+constexpr std::uintmax_t xMobileSyncFingerprint_BufferSize = 1024*1024;
+// Number of fingerprints computed by a single task.
+constexpr size_t xMobileSyncFingerprint_BatchSize = 64;
+
+
+QString xMobileSyncFingerprint::fingerprint(const std::filesystem::path& path, std::uintmax_t size) {
+    auto fd = ::open(path.c_str(), O_RDONLY|O_CLOEXEC);
+    if (fd < 0) {
+        return {};
+    }
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    QByteArray buffer(static_cast<qsizetype>(xMobileSyncFingerprint_BufferSize), Qt::Uninitialized);
+    std::uintmax_t hashed = 0;
+    while (hashed < size) {
+        auto bytes = ::read(fd, buffer.data(), std::min(size-hashed, xMobileSyncFingerprint_BufferSize));
+        if (bytes <= 0) {
+            ::close(fd);
+            return {};
+        }
+        hash.addData(QByteArrayView(buffer.constData(), bytes));
+        hashed += bytes;
+    }
+    ::close(fd);
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QHash<QString,QString> xMobileSyncFingerprint::fingerprints(const std::vector<std::filesystem::path>& paths) {
+    QHash<QString,QString> fingerprints;
+    if (paths.empty()) {
+        return fingerprints;
+    }
+    QHash<QString,xFileFingerprint> cachedFingerprints;
+    for (const auto& cached : xPlayerDatabase::database()->getFileFingerprints()) {
+        cachedFingerprints.insert(cached.path, cached);
+    }
+    // Use the cached fingerprints if the file has not been modified.
+    std::vector<xFileFingerprint> missingFingerprints;
+    for (const auto& path : paths) {
+        struct stat pathStat{};
+        if (stat(path.c_str(), &pathStat) < 0) {
+            continue;
+        }
+        xFileFingerprint fingerprint;
+        fingerprint.path = QString::fromStdString(path.string());
+        fingerprint.size = static_cast<std::uintmax_t>(pathStat.st_size);
+        fingerprint.modified = static_cast<qint64>(pathStat.st_mtim.tv_sec)*1000000000+pathStat.st_mtim.tv_nsec;
+        auto cached = cachedFingerprints.find(fingerprint.path);
+        if ((cached != cachedFingerprints.end()) && (cached->size == fingerprint.size) &&
+            (cached->modified == fingerprint.modified)) {
+            fingerprints.insert(fingerprint.path, cached->fingerprint);
+        } else {
+            missingFingerprints.push_back(fingerprint);
+        }
+    }
+    // Compute the missing fingerprints in parallel.
+    QMutex computedMutex;
+    QList<xFileFingerprint> computedFingerprints;
+    QThreadPool fingerprintPool;
+    fingerprintPool.setMaxThreadCount(QThread::idealThreadCount());
+    for (size_t begin = 0; begin < missingFingerprints.size(); begin += xMobileSyncFingerprint_BatchSize) {
+        auto end = std::min(begin+xMobileSyncFingerprint_BatchSize, missingFingerprints.size());
+        fingerprintPool.start(QRunnable::create([&, begin, end]() {
+            QList<xFileFingerprint> computed;
+            for (auto i = begin; i < end; ++i) {
+                auto computedFingerprint = missingFingerprints[i];
+                computedFingerprint.fingerprint = fingerprint(computedFingerprint.path.toStdString(), computedFingerprint.size);
+                if (!computedFingerprint.fingerprint.isEmpty()) {
+                    computed.push_back(computedFingerprint);
+                }
+            }
+            QMutexLocker lock(&computedMutex);
+            computedFingerprints.append(computed);
+        }));
+    }
+    fingerprintPool.waitForDone();
+    qDebug() << "xMobileSyncFingerprint: cached: " << fingerprints.size() << ", computed: " << computedFingerprints.size();
+    for (const auto& computed : computedFingerprints) {
+        fingerprints.insert(computed.path, computed.fingerprint);
+    }
+    xPlayerDatabase::database()->updateFileFingerprints(computedFingerprints);
+    return fingerprints;
+}
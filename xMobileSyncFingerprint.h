@@ -0,0 +1,54 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XMOBILESYNCFINGERPRINT_H__
+#define __XMOBILESYNCFINGERPRINT_H__
+
+#include <QString>
+#include <QHash>
+
+#include <filesystem>
+#include <vector>
+
+/**
+ * Compute content fingerprints for the mobile sync.
+ *
+ * The fingerprint is a hash of the complete file. Files with equal fingerprints
+ * are treated as identical and are not copied again. Fingerprints are cached in
+ * the database by path, size and modification time. Unmodified files, in
+ * particular the files in the mobile library, are therefore only read once.
+ */
+class xMobileSyncFingerprint {
+public:
+    /**
+     * Compute the fingerprint of a single file without using the cache.
+     *
+     * @param path the path to the file.
+     * @param size the size of the file. The file is read up to this size.
+     * @return the fingerprint as string, empty on error.
+     */
+    [[nodiscard]] static QString fingerprint(const std::filesystem::path& path, std::uintmax_t size);
+    /**
+     * Determine the fingerprints for the given files.
+     *
+     * Cached fingerprints are used if size and modification time match. All
+     * other fingerprints are computed in parallel and added to the cache.
+     *
+     * @param paths the vector of paths.
+     * @return a map of path to fingerprint. Files that cannot be read are not included.
+     */
+    [[nodiscard]] static QHash<QString,QString> fingerprints(const std::vector<std::filesystem::path>& paths);
+};
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xMobileSyncTranscoder.h"
+
+#include <QStandardPaths>
+#include <QProcess>
+#include <QDebug>
+
+#include <vector>
+#include <tuple>
+#include <algorithm>
+
+#include <taglib/fileref.h>
+#include <taglib/tpropertymap.h>
+
+// Interval in ms to check for cancellation while the encoder is running.
+constexpr auto xMobileSyncTranscoder_CancelInterval = 250;
+// Subdirectory of the cache location for transcoded files.
+constexpr auto xMobileSyncTranscoder_CacheDirectory = "transcode";
+// Maximal size of the transcoded files in the cache.
+constexpr std::uintmax_t xMobileSyncTranscoder_CacheSize = 4ULL*1024*1024*1024;
+// Lossless source file extensions.
+const QStringList xMobileSyncTranscoder_LosslessExtensions { ".flac", ".wv", ".wav", ".ape", ".aiff" }; // NOLINT
+
+/**
+ * Target format with the corresponding encoder and file extension.
+ */
+struct xMobileSyncTranscoderFormat {
+    QString name;
+    QString codec;
+    QString extension;
+};
+
+const QList<xMobileSyncTranscoderFormat> xMobileSyncTranscoder_Formats { // NOLINT
+        { "opus", "libopus", ".opus" },
+        { "vorbis", "libvorbis", ".ogg" },
+        { "mp3", "libmp3lame", ".mp3" },
+        { "aac", "aac", ".m4a" },
+};
+
+
+xMobileSyncTranscoder::xMobileSyncTranscoder(const QString& format, int bitrate, const QString& encoder):
+        transcoderFormat(-1),
+        transcoderBitrate(bitrate),
+        transcoderEncoder(encoder) {
+    for (auto i = 0; i < xMobileSyncTranscoder_Formats.size(); ++i) {
+        if (xMobileSyncTranscoder_Formats[i].name == format) {
+            transcoderFormat = i;
+            break;
+        }
+    }
+    transcoderCache = QStandardPaths::writableLocation(QStandardPaths::CacheLocation).toStdString();
+    transcoderCache /= xMobileSyncTranscoder_CacheDirectory;
+}
+
+const QStringList& xMobileSyncTranscoder::formats() {
+    static QStringList formatNames;
+    if (formatNames.isEmpty()) {
+        for (const auto& format : xMobileSyncTranscoder_Formats) {
+            formatNames.push_back(format.name);
+        }
+    }
+    return formatNames;
+}
+
+bool xMobileSyncTranscoder::isEnabled() const {
+    return (transcoderFormat >= 0);
+}
+
+bool xMobileSyncTranscoder::accepts(const std::filesystem::path& source) const {
+    return (isEnabled()) &&
+           (xMobileSyncTranscoder_LosslessExtensions.contains(QString::fromStdString(source.extension().string()),
+                                                             Qt::CaseInsensitive));
+}
+
+std::filesystem::path xMobileSyncTranscoder::destination(const std::filesystem::path& destination) const {
+    if (!isEnabled()) {
+        return destination;
+    }
+    auto transcodedDestination = destination;
+    return transcodedDestination.replace_extension(xMobileSyncTranscoder_Formats[transcoderFormat].extension.toStdString());
+}
+
+QString xMobileSyncTranscoder::trackName(const QString& name) const {
+    auto path = std::filesystem::path(name.toStdString());
+    return (accepts(path)) ? QString::fromStdString(destination(path).string()) : name;
+}
+
+std::filesystem::path xMobileSyncTranscoder::transcode(const std::filesystem::path& source, const QString& fingerprint,
+                                                       const std::atomic<bool>& cancelled) const {
+    if ((!isEnabled()) || (fingerprint.isEmpty())) {
+        return {};
+    }
+    const auto& format = xMobileSyncTranscoder_Formats[transcoderFormat];
+    auto cacheName = QString("%1-%2-%3").arg(fingerprint, format.name).arg(transcoderBitrate);
+    auto cached = transcoderCache / (cacheName+format.extension).toStdString();
+    std::error_code errorCode;
+    if (std::filesystem::exists(cached, errorCode)) {
+        return cached;
+    }
+    std::filesystem::create_directories(transcoderCache, errorCode);
+    // The encoder determines the container by the extension of the partial file.
+    auto partial = transcoderCache / (cacheName+".partial"+format.extension).toStdString();
+    QProcess encoderProcess;
+    encoderProcess.setProcessChannelMode(QProcess::MergedChannels);
+    // Tags are copied with taglib. Cover art and other streams are dropped.
+    encoderProcess.start(transcoderEncoder, { "-nostdin", "-v", "error", "-y",
+                                              "-i", QString::fromStdString(source.string()),
+                                              "-map", "0:a", "-map_metadata", "-1", "-c:a", format.codec,
+                                              "-b:a", QString("%1k").arg(transcoderBitrate),
+                                              QString::fromStdString(partial.string()) });
+    if (!encoderProcess.waitForStarted()) {
+        qCritical() << "xMobileSyncTranscoder: unable to start encoder: " << transcoderEncoder;
+        return {};
+    }
+    while (!encoderProcess.waitForFinished(xMobileSyncTranscoder_CancelInterval)) {
+        if (cancelled) {
+            encoderProcess.kill();
+            encoderProcess.waitForFinished();
+            std::filesystem::remove(partial, errorCode);
+            return {};
+        }
+    }
+    if ((encoderProcess.exitStatus() != QProcess::NormalExit) || (encoderProcess.exitCode() != 0)) {
+        qCritical() << "xMobileSyncTranscoder: unable to transcode: " << QString::fromStdString(source.string())
+                    << ", error: " << encoderProcess.readAll().trimmed();
+        std::filesystem::remove(partial, errorCode);
+        return {};
+    }
+    if (!copyTags(source, partial)) {
+        qWarning() << "xMobileSyncTranscoder: unable to copy tags: " << QString::fromStdString(source.string());
+    }
+    std::filesystem::rename(partial, cached, errorCode);
+    if (errorCode) {
+        std::filesystem::remove(partial, errorCode);
+        return {};
+    }
+    return cached;
+}
+
+void xMobileSyncTranscoder::prune() const {
+    // Cached files of the current format and bitrate end with this suffix.
+    QString suffix;
+    if (isEnabled()) {
+        const auto& format = xMobileSyncTranscoder_Formats[transcoderFormat];
+        suffix = QString("-%1-%2%3").arg(format.name).arg(transcoderBitrate).arg(format.extension);
+    }
+    std::error_code errorCode;
+    std::vector<std::tuple<std::filesystem::file_time_type,std::uintmax_t,std::filesystem::path>> cachedFiles;
+    std::uintmax_t cacheSize = 0;
+    size_t removed = 0;
+    for (auto entry = std::filesystem::directory_iterator(transcoderCache, errorCode);
+         entry != std::filesystem::directory_iterator(); entry.increment(errorCode)) {
+        if (errorCode) {
+            break;
+        }
+        auto name = QString::fromStdString(entry->path().filename().string());
+        if ((suffix.isEmpty()) || (!name.endsWith(suffix))) {
+            removed += std::filesystem::remove(entry->path(), errorCode);
+            continue;
+        }
+        auto size = entry->file_size(errorCode);
+        cachedFiles.emplace_back(entry->last_write_time(errorCode), size, entry->path());
+        cacheSize += size;
+    }
+    // Remove the oldest files first.
+    std::sort(cachedFiles.begin(), cachedFiles.end());
+    for (auto cachedFile = cachedFiles.begin(); (cachedFile != cachedFiles.end()) &&
+                                                (cacheSize > xMobileSyncTranscoder_CacheSize); ++cachedFile) {
+        removed += std::filesystem::remove(std::get<2>(*cachedFile), errorCode);
+        cacheSize -= std::get<1>(*cachedFile);
+    }
+    qDebug() << "xMobileSyncTranscoder: cache size: " << cacheSize << ", removed files: " << removed;
+}
+
+bool xMobileSyncTranscoder::copyTags(const std::filesystem::path& source, const std::filesystem::path& target) {
+    TagLib::FileRef sourceFile(source.c_str(), false);
+    TagLib::FileRef targetFile(target.c_str(), false);
+    if ((sourceFile.isNull()) || (targetFile.isNull())) {
+        return false;
+    }
+    targetFile.file()->setProperties(sourceFile.file()->properties());
+    return targetFile.save();
+}
@@ -0,0 +1,111 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XMOBILESYNCTRANSCODER_H__
+#define __XMOBILESYNCTRANSCODER_H__
+
+#include <QString>
+#include <QStringList>
+
+#include <filesystem>
+#include <atomic>
+
+/**
+ * Transcode lossless music files for the mobile sync.
+ *
+ * Files are transcoded by an encoder binary (ffmpeg) into a cache directory.
+ * Cached files are identified by the source fingerprint, the target format
+ * and the bitrate. Repeated syncs thereby reuse previously transcoded files.
+ * The cache is pruned to files of the current format and bitrate and limited
+ * in size. The tags of the source file are copied using taglib.
+ */
+class xMobileSyncTranscoder {
+public:
+    /**
+     * Constructor.
+     *
+     * @param format the target format, empty if files are not transcoded.
+     * @param bitrate the target bitrate in kbit/s.
+     * @param encoder the path to the encoder binary.
+     */
+    xMobileSyncTranscoder(const QString& format, int bitrate, const QString& encoder);
+    ~xMobileSyncTranscoder() = default;
+    /**
+     * Return the list of supported target formats.
+     *
+     * @return the list of format names.
+     */
+    [[nodiscard]] static const QStringList& formats();
+    /**
+     * Determine if files are transcoded.
+     *
+     * @return true if a supported target format is configured, false otherwise.
+     */
+    [[nodiscard]] bool isEnabled() const;
+    /**
+     * Determine if the given file is transcoded. Only lossless files are transcoded.
+     *
+     * @param source the path to the source file.
+     * @return true if the file is transcoded, false if it is copied.
+     */
+    [[nodiscard]] bool accepts(const std::filesystem::path& source) const;
+    /**
+     * Return the destination path with the extension of the target format.
+     *
+     * @param destination the destination path of the source file.
+     * @return the destination path of the transcoded file.
+     */
+    [[nodiscard]] std::filesystem::path destination(const std::filesystem::path& destination) const;
+    /**
+     * Return the track name used in the mobile library for the given track name.
+     *
+     * @param name the name of the track in the music library.
+     * @return the name of the transcoded track if the track is transcoded, the given name otherwise.
+     */
+    [[nodiscard]] QString trackName(const QString& name) const;
+    /**
+     * Transcode a file unless it is already in the cache. Called in a worker thread.
+     *
+     * @param source the path to the source file.
+     * @param fingerprint the fingerprint of the source file.
+     * @param cancelled the encoder is stopped if set to true.
+     * @return the path to the transcoded file in the cache, empty on error.
+     */
+    [[nodiscard]] std::filesystem::path transcode(const std::filesystem::path& source, const QString& fingerprint,
+                                                  const std::atomic<bool>& cancelled) const;
+    /**
+     * Remove cached files that are not used by the current format and bitrate.
+     *
+     * The oldest cached files are removed if the remaining files exceed the cache size.
+     * Must not be called while files are transcoded.
+     */
+    void prune() const;
+
+private:
+    /**
+     * Copy the tags of the source to the target file.
+     *
+     * @param source the path to the source file.
+     * @param target the path to the target file.
+     * @return true if the tags were copied, false otherwise.
+     */
+    static bool copyTags(const std::filesystem::path& source, const std::filesystem::path& target);
+
+    int transcoderFormat;
+    int transcoderBitrate;
+    QString transcoderEncoder;
+    std::filesystem::path transcoderCache;
+};
+
+#endif
@@ -0,0 +1,522 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xMobileSyncTransfer.h"
+#include "xMobileSyncFingerprint.h"
+
+#include <QThreadPool>
+#include <QThread>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <map>
+#include <set>
+
+// Journal file for completed files stored in the mobile library.
+const QString xMobileSyncTransfer_Journal { ".xPlaySyncJournal" }; // NOLINT
+// Suffix for files not yet completely copied.
+constexpr auto xMobileSyncTransfer_PartialSuffix = ".xPlaySyncPartial";
+// Prefix of journal entries for started partial files.
+const QString xMobileSyncTransfer_JournalPartial { "partial " }; // NOLINT
+// Number of bytes copied in between checks for cancellation.
+constexpr off_t xMobileSyncTransfer_ChunkSize = 8*1024*1024;
+// Buffer size and alignment if copy_file_range is not supported.
+constexpr size_t xMobileSyncTransfer_BufferSize = 4*1024*1024;
+constexpr size_t xMobileSyncTransfer_BufferAlignment = 4096;
+// Partial files are continued at a multiple of the resume alignment.
+constexpr off_t xMobileSyncTransfer_ResumeAlignment = 1024*1024;
+// Interval for progress updates in ms.
+constexpr auto xMobileSyncTransfer_ProgressInterval = 250;
+// Upper limit of concurrent copies relative to the initial number if adapted by the device monitor.
+constexpr auto xMobileSyncTransfer_ConcurrencyAdaptFactor = 2;
+// Number of concurrent copies for rotational, SD card and other devices.
+constexpr auto xMobileSyncTransfer_ConcurrencyRotational = 1;
+constexpr auto xMobileSyncTransfer_ConcurrencySDCard = 2;
+constexpr auto xMobileSyncTransfer_ConcurrencyDefault = 4;
+const QString xMobileSyncTransfer_DeviceRotational { "/sys/dev/block/%1:%2/queue/rotational" }; // NOLINT
+const QString xMobileSyncTransfer_PartitionRotational { "/sys/dev/block/%1:%2/../queue/rotational" }; // NOLINT
+const QString xMobileSyncTransfer_Device { "/sys/dev/block/%1:%2" }; // NOLINT
+
+/**
+ * Read the first line of the given file.
+ */
+static QString xMobileSyncTransfer_readLine(const QString& fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly|QIODevice::Text)) {
+        return {};
+    }
+    return QString::fromUtf8(file.readLine()).trimmed();
+}
+
+
+xMobileSyncTransfer::xMobileSyncTransfer(const std::filesystem::path& base, QObject* parent):
+        QObject(parent),
+        transferBase(base),
+        transferMonitor(nullptr),
+        transferMonitorSamples(0),
+        transferFiles(),
+        transferTotalBytes(0),
+        transferCopiedBytes(0),
+        transferCancelled(false),
+        transferErrors(0),
+        transferJournal(),
+        transferJournalMutex(),
+        transferJournalFile(QString::fromStdString((base / xMobileSyncTransfer_Journal.toStdString()).string())) {
+}
+
+void xMobileSyncTransfer::addFile(const std::filesystem::path& source, const std::filesystem::path& destination) {
+    std::error_code errorCode;
+    auto size = std::filesystem::file_size(source, errorCode);
+    if (errorCode) {
+        qCritical() << "xMobileSyncTransfer: unable to add file: " << QString::fromStdString(source.string());
+        return;
+    }
+    auto modified = std::filesystem::last_write_time(source, errorCode).time_since_epoch().count();
+    transferFiles.push_back({ source, destination, size, static_cast<qint64>(modified) });
+    transferTotalBytes += size;
+}
+
+void xMobileSyncTransfer::addDirectory(const std::filesystem::path& source, const std::filesystem::path& destination) {
+    std::error_code errorCode;
+    for (auto entry = std::filesystem::recursive_directory_iterator(source, errorCode);
+         entry != std::filesystem::recursive_directory_iterator(); entry.increment(errorCode)) {
+        if (errorCode) {
+            qCritical() << "xMobileSyncTransfer: unable to read directory: " << QString::fromStdString(source.string());
+            break;
+        }
+        if (entry->is_regular_file(errorCode)) {
+            addFile(entry->path(), destination / std::filesystem::relative(entry->path(), source, errorCode));
+        }
+    }
+}
+
+std::uintmax_t xMobileSyncTransfer::getTotalBytes() const {
+    return transferTotalBytes;
+}
+
+void xMobileSyncTransfer::setMonitor(xPlayerDeviceMonitor* monitor) {
+    transferMonitor = monitor;
+}
+
+void xMobileSyncTransfer::plan(const std::vector<std::filesystem::path>& removals) {
+    std::error_code errorCode;
+    // Files in the removed paths are the candidates for renames. Index them by size.
+    std::map<std::uintmax_t,std::vector<std::filesystem::path>> removedFiles;
+    for (const auto& removal : removals) {
+        if (std::filesystem::is_regular_file(removal, errorCode)) {
+            removedFiles[std::filesystem::file_size(removal, errorCode)].push_back(removal);
+        } else if (std::filesystem::is_directory(removal, errorCode)) {
+            for (auto entry = std::filesystem::recursive_directory_iterator(removal, errorCode);
+                 entry != std::filesystem::recursive_directory_iterator(); entry.increment(errorCode)) {
+                if (errorCode) {
+                    break;
+                }
+                if (entry->is_regular_file(errorCode)) {
+                    removedFiles[entry->file_size(errorCode)].push_back(entry->path());
+                }
+            }
+        }
+    }
+    auto isRemoved = [&removals](const std::filesystem::path& path) {
+        for (const auto& removal : removals) {
+            auto relative = path.lexically_relative(removal);
+            if ((!relative.empty()) && (*relative.begin() != "..")) {
+                return true;
+            }
+        }
+        return false;
+    };
+    // Determine the files that need to be compared by their fingerprints.
+    std::vector<std::filesystem::path> fingerprintPaths;
+    for (const auto& file : transferFiles) {
+        auto destination = transferBase / file.destination;
+        if (std::filesystem::exists(destination, errorCode)) {
+            if ((std::filesystem::file_size(destination, errorCode) == file.size) && (!isRemoved(destination))) {
+                fingerprintPaths.push_back(file.source);
+                fingerprintPaths.push_back(destination);
+            }
+        } else if (!isRemoved(destination)) {
+            auto candidates = removedFiles.find(file.size);
+            if (candidates != removedFiles.end()) {
+                fingerprintPaths.push_back(file.source);
+                fingerprintPaths.insert(fingerprintPaths.end(), candidates->second.begin(), candidates->second.end());
+            }
+        }
+    }
+    std::sort(fingerprintPaths.begin(), fingerprintPaths.end());
+    fingerprintPaths.erase(std::unique(fingerprintPaths.begin(), fingerprintPaths.end()), fingerprintPaths.end());
+    auto fingerprints = xMobileSyncFingerprint::fingerprints(fingerprintPaths);
+    auto fingerprint = [&fingerprints](const std::filesystem::path& path) {
+        return fingerprints.value(QString::fromStdString(path.string()));
+    };
+    // Each removed file is renamed at most once.
+    std::set<std::filesystem::path> renamedFiles;
+    size_t skipped = 0, renamed = 0;
+    for (auto& file : transferFiles) {
+        auto sourceFingerprint = fingerprint(file.source);
+        if (sourceFingerprint.isEmpty()) {
+            continue;
+        }
+        auto destination = transferBase / file.destination;
+        if (std::filesystem::exists(destination, errorCode)) {
+            if ((!isRemoved(destination)) && (fingerprint(destination) == sourceFingerprint)) {
+                file.action = xMobileSyncTransferSkip;
+                ++skipped;
+            }
+            continue;
+        }
+        // Renamed files must not be removed afterwards.
+        auto candidates = removedFiles.find(file.size);
+        if ((candidates == removedFiles.end()) || (isRemoved(destination))) {
+            continue;
+        }
+        for (const auto& candidate : candidates->second) {
+            if ((renamedFiles.find(candidate) == renamedFiles.end()) && (fingerprint(candidate) == sourceFingerprint)) {
+                file.action = xMobileSyncTransferRename;
+                file.existing = candidate;
+                renamedFiles.insert(candidate);
+                ++renamed;
+                break;
+            }
+        }
+    }
+    qDebug() << "xMobileSyncTransfer: files: " << transferFiles.size() << ", skipped: " << skipped
+             << ", renamed: " << renamed;
+}
+
+bool xMobileSyncTransfer::transcodeFiles(const xMobileSyncTranscoder& transcoder) {
+    transferCancelled = false;
+    std::vector<std::filesystem::path> sources;
+    std::vector<size_t> transcodeFiles;
+    for (size_t i = 0; i < transferFiles.size(); ++i) {
+        if (transcoder.accepts(transferFiles[i].source)) {
+            sources.push_back(transferFiles[i].source);
+            transcodeFiles.push_back(i);
+        }
+    }
+    if (transcodeFiles.empty()) {
+        return true;
+    }
+    // The transcoded files are cached by the fingerprint of the source.
+    auto fingerprints = xMobileSyncFingerprint::fingerprints(sources);
+    std::atomic<int> transcodedFiles(0);
+    std::atomic<int> failedFiles(0);
+    QElapsedTimer transcodeTimer;
+    transcodeTimer.start();
+    // One encoder per core.
+    QThreadPool transcodePool;
+    transcodePool.setMaxThreadCount(QThread::idealThreadCount());
+    for (auto index : transcodeFiles) {
+        // Each job only modifies its own file entry.
+        auto& file = transferFiles[index];
+        auto fingerprint = fingerprints.value(QString::fromStdString(file.source.string()));
+        transcodePool.start(QRunnable::create([this, &file, &transcoder, &transcodedFiles, &failedFiles, fingerprint]() {
+            if (transferCancelled) {
+                return;
+            }
+            auto transcoded = transcoder.transcode(file.source, fingerprint, transferCancelled);
+            std::error_code errorCode;
+            auto size = std::filesystem::file_size(transcoded, errorCode);
+            if ((transcoded.empty()) || (errorCode)) {
+                // Copy the source file instead.
+                if (!transferCancelled) {
+                    ++failedFiles;
+                }
+                return;
+            }
+            file.source = transcoded;
+            file.destination = transcoder.destination(file.destination);
+            file.size = size;
+            file.modified = std::filesystem::last_write_time(transcoded, errorCode).time_since_epoch().count();
+            ++transcodedFiles;
+        }));
+    }
+    auto filesPerMinute = [&transcodedFiles, &transcodeTimer]() {
+        auto elapsed = transcodeTimer.elapsed();
+        return (elapsed > 0) ? (transcodedFiles*60000.0)/static_cast<double>(elapsed) : 0.0;
+    };
+    // Report the progress while waiting. Cancel on interruption of the calling thread.
+    while (!transcodePool.waitForDone(xMobileSyncTransfer_ProgressInterval)) {
+        if (QThread::currentThread()->isInterruptionRequested()) {
+            cancel();
+        }
+        emit transcodeProgress(transcodedFiles, static_cast<int>(transcodeFiles.size()), filesPerMinute());
+    }
+    emit transcodeProgress(transcodedFiles, static_cast<int>(transcodeFiles.size()), filesPerMinute());
+    qDebug() << "xMobileSyncTransfer: transcoded: " << transcodedFiles << ", failed: " << failedFiles
+             << ", tracks per minute: " << filesPerMinute();
+    // The transcoded files are usually smaller.
+    transferTotalBytes = 0;
+    for (const auto& file : transferFiles) {
+        transferTotalBytes += file.size;
+    }
+    return !transferCancelled;
+}
+
+void xMobileSyncTransfer::renameFiles() {
+    std::error_code errorCode;
+    for (auto& file : transferFiles) {
+        if (file.action != xMobileSyncTransferRename) {
+            continue;
+        }
+        auto destination = transferBase / file.destination;
+        // We do ignore any error while creating directories.
+        std::filesystem::create_directories(destination.parent_path(), errorCode);
+        std::filesystem::rename(file.existing, destination, errorCode);
+        if (errorCode) {
+            qWarning() << "xMobileSyncTransfer: unable to rename: " << QString::fromStdString(file.existing.string())
+                       << ", error: " << QString::fromStdString(errorCode.message());
+            file.action = xMobileSyncTransferCopy;
+        }
+    }
+}
+
+bool xMobileSyncTransfer::run() {
+    transferCancelled = false;
+    transferErrors = 0;
+    transferCopiedBytes = 0;
+    loadJournal();
+    auto threads = concurrency(transferBase);
+    qDebug() << "xMobileSyncTransfer: files: " << transferFiles.size() << ", bytes: " << transferTotalBytes
+             << ", concurrent copies: " << threads;
+    QThreadPool transferPool;
+    transferPool.setMaxThreadCount(threads);
+    for (const auto& file : transferFiles) {
+        // Skipped and renamed files are already in place.
+        if (file.action != xMobileSyncTransferCopy) {
+            transferCopiedBytes += file.size;
+            continue;
+        }
+        transferPool.start(QRunnable::create([this, &file]() {
+            if ((!transferCancelled) && (!copyFile(file))) {
+                ++transferErrors;
+            }
+        }));
+    }
+    // Report the progress while waiting. Cancel on interruption of the calling thread.
+    while (!transferPool.waitForDone(xMobileSyncTransfer_ProgressInterval)) {
+        if (QThread::currentThread()->isInterruptionRequested()) {
+            cancel();
+        }
+        adaptConcurrency(&transferPool, threads*xMobileSyncTransfer_ConcurrencyAdaptFactor);
+        emit progress(transferCopiedBytes, transferTotalBytes);
+    }
+    emit progress(transferCopiedBytes, transferTotalBytes);
+    transferJournalFile.close();
+    if ((transferCancelled) || (transferErrors > 0)) {
+        qWarning() << "xMobileSyncTransfer: incomplete transfer, cancelled: " << transferCancelled
+                   << ", errors: " << transferErrors;
+        return false;
+    }
+    // The transfer is complete. The journal is no longer required.
+    transferJournalFile.remove();
+    return true;
+}
+
+void xMobileSyncTransfer::cancel() {
+    transferCancelled = true;
+}
+
+int xMobileSyncTransfer::concurrency(const std::filesystem::path& path) {
+    struct stat pathStat{};
+    if (stat(path.c_str(), &pathStat) < 0) {
+        return xMobileSyncTransfer_ConcurrencyDefault;
+    }
+    auto deviceMajor = major(pathStat.st_dev);
+    auto deviceMinor = minor(pathStat.st_dev);
+    // Partitions do not have a queue. Use the queue of the parent device.
+    auto rotational = xMobileSyncTransfer_readLine(xMobileSyncTransfer_DeviceRotational.arg(deviceMajor).arg(deviceMinor));
+    if (rotational.isEmpty()) {
+        rotational = xMobileSyncTransfer_readLine(xMobileSyncTransfer_PartitionRotational.arg(deviceMajor).arg(deviceMinor));
+    }
+    if (rotational == "1") {
+        return xMobileSyncTransfer_ConcurrencyRotational;
+    }
+    auto device = QFileInfo(xMobileSyncTransfer_Device.arg(deviceMajor).arg(deviceMinor)).canonicalFilePath();
+    if (device.contains("/mmcblk")) {
+        return xMobileSyncTransfer_ConcurrencySDCard;
+    }
+    return xMobileSyncTransfer_ConcurrencyDefault;
+}
+
+bool xMobileSyncTransfer::copyFile(const xMobileSyncTransferFile& file) {
+    auto destination = transferBase / file.destination;
+    std::error_code errorCode;
+    // Skip files completed by a previous transfer.
+    if ((transferJournal.contains(journalKey(file))) &&
+        (std::filesystem::file_size(destination, errorCode) == file.size)) {
+        transferCopiedBytes += file.size;
+        return true;
+    }
+    // We do ignore any error while creating directories.
+    std::filesystem::create_directories(destination.parent_path(), errorCode);
+    auto partial = destination;
+    partial += xMobileSyncTransfer_PartialSuffix;
+    auto source = ::open(file.source.c_str(), O_RDONLY|O_CLOEXEC);
+    if (source < 0) {
+        qCritical() << "xMobileSyncTransfer: unable to open source: " << QString::fromStdString(file.source.string());
+        return false;
+    }
+    auto target = ::open(partial.c_str(), O_WRONLY|O_CREAT|O_CLOEXEC, 0644);
+    if (target < 0) {
+        qCritical() << "xMobileSyncTransfer: unable to open destination: " << QString::fromStdString(partial.string());
+        ::close(source);
+        return false;
+    }
+    ::posix_fadvise(source, 0, 0, POSIX_FADV_SEQUENTIAL);
+    // Continue a partial file of a cancelled transfer if it was started for the same
+    // source size and modification time. Start from the beginning otherwise.
+    auto size = static_cast<off_t>(file.size);
+    off_t offset = 0;
+    if (transferJournal.contains(xMobileSyncTransfer_JournalPartial+journalKey(file))) {
+        offset = ::lseek(target, 0, SEEK_END);
+        offset = (offset > size) ? 0 : (offset / xMobileSyncTransfer_ResumeAlignment) * xMobileSyncTransfer_ResumeAlignment;
+    } else {
+        recordJournal(xMobileSyncTransfer_JournalPartial+journalKey(file));
+    }
+    if (::ftruncate(target, offset) < 0) {
+        offset = 0;
+    }
+    transferCopiedBytes += offset;
+    auto copied = copyData(source, target, offset, size);
+    // Make the written data durable. Required for the journal and partial files.
+    ::fdatasync(target);
+    ::close(target);
+    ::close(source);
+    if (!copied) {
+        return transferCancelled;
+    }
+    std::filesystem::rename(partial, destination, errorCode);
+    if (errorCode) {
+        qCritical() << "xMobileSyncTransfer: unable to rename: " << QString::fromStdString(partial.string())
+                    << ", error: " << QString::fromStdString(errorCode.message());
+        return false;
+    }
+    recordJournal(journalKey(file));
+    return true;
+}
+
+bool xMobileSyncTransfer::copyData(int source, int destination, off_t offset, off_t size) {
+    auto sourceOffset = offset;
+    auto destinationOffset = offset;
+    // Zero-copy within the kernel if supported by both file systems.
+    auto useCopyFileRange = true;
+    std::unique_ptr<char, decltype(&std::free)> buffer(nullptr, &std::free);
+    while (sourceOffset < size) {
+        if (transferCancelled) {
+            return false;
+        }
+        auto chunk = std::min(size - sourceOffset, xMobileSyncTransfer_ChunkSize);
+        if (useCopyFileRange) {
+            auto written = ::copy_file_range(source, &sourceOffset, destination, &destinationOffset, chunk, 0);
+            if (written > 0) {
+                transferCopiedBytes += written;
+                continue;
+            }
+            if ((written < 0) && (errno != EXDEV) && (errno != ENOSYS) && (errno != EINVAL) && (errno != EOPNOTSUPP)) {
+                qCritical() << "xMobileSyncTransfer: copy error: " << strerror(errno);
+                return false;
+            }
+            if (written == 0) {
+                // Source file truncated.
+                return false;
+            }
+            // Fall back to read/write with a large aligned buffer.
+            useCopyFileRange = false;
+            buffer.reset(static_cast<char*>(std::aligned_alloc(xMobileSyncTransfer_BufferAlignment, xMobileSyncTransfer_BufferSize)));
+            if (!buffer) {
+                return false;
+            }
+        }
+        auto bytes = ::pread(source, buffer.get(), std::min(static_cast<size_t>(chunk), xMobileSyncTransfer_BufferSize), sourceOffset);
+        if (bytes <= 0) {
+            qCritical() << "xMobileSyncTransfer: read error: " << ((bytes < 0) ? strerror(errno) : "truncated");
+            return false;
+        }
+        for (ssize_t written = 0; written < bytes; ) {
+            auto result = ::pwrite(destination, buffer.get()+written, bytes-written, destinationOffset+written);
+            if (result < 0) {
+                qCritical() << "xMobileSyncTransfer: write error: " << strerror(errno);
+                return false;
+            }
+            written += result;
+        }
+        sourceOffset += bytes;
+        destinationOffset += bytes;
+        transferCopiedBytes += bytes;
+    }
+    return true;
+}
+
+void xMobileSyncTransfer::adaptConcurrency(QThreadPool* pool, int maxThreads) {
+    if (!transferMonitor) {
+        return;
+    }
+    auto statistics = transferMonitor->getStatistics();
+    // Adapt at most once for each sample of the device monitor.
+    if ((statistics.samples == transferMonitorSamples) || (statistics.queueDepth <= 0)) {
+        return;
+    }
+    transferMonitorSamples = statistics.samples;
+    auto threads = pool->maxThreadCount();
+    if ((statistics.inFlight >= statistics.queueDepth) && (threads > 1)) {
+        // The device queue is saturated. Additional copies only add latency.
+        pool->setMaxThreadCount(threads-1);
+    } else if ((statistics.inFlight < 1.0) && (threads < maxThreads)) {
+        // The device is idle in between the requests of the current copies.
+        pool->setMaxThreadCount(threads+1);
+    } else {
+        return;
+    }
+    qDebug() << "xMobileSyncTransfer: in flight: " << statistics.inFlight << ", queue depth: "
+             << statistics.queueDepth << ", concurrent copies: " << pool->maxThreadCount();
+}
+
+void xMobileSyncTransfer::loadJournal() {
+    transferJournal.clear();
+    if (transferJournalFile.open(QIODevice::ReadOnly|QIODevice::Text)) {
+        QTextStream journalStream(&transferJournalFile);
+        while (!journalStream.atEnd()) {
+            transferJournal.insert(journalStream.readLine());
+        }
+        transferJournalFile.close();
+        qDebug() << "xMobileSyncTransfer: resume transfer with completed files: " << transferJournal.size();
+    }
+    if (!transferJournalFile.open(QIODevice::WriteOnly|QIODevice::Append|QIODevice::Text)) {
+        qWarning() << "xMobileSyncTransfer: unable to open journal: " << transferJournalFile.fileName();
+    }
+}
+
+void xMobileSyncTransfer::recordJournal(const QString& entry) {
+    QMutexLocker lock(&transferJournalMutex);
+    if (transferJournalFile.isOpen()) {
+        transferJournalFile.write((entry+"\n").toUtf8());
+        transferJournalFile.flush();
+    }
+}
+
+QString xMobileSyncTransfer::journalKey(const xMobileSyncTransferFile& file) {
+    return QString("%1 %2 %3").arg(file.size).arg(file.modified).arg(QString::fromStdString(file.destination.string()));
+}
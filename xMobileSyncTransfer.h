@@ -0,0 +1,235 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XMOBILESYNCTRANSFER_H__
+#define __XMOBILESYNCTRANSFER_H__
+
+#include "xMobileSyncTranscoder.h"
+#include "xPlayerDeviceMonitor.h"
+
+#include <QObject>
+#include <QMutex>
+#include <QFile>
+#include <QSet>
+#include <QThreadPool>
+
+#include <filesystem>
+#include <vector>
+#include <atomic>
+
+/**
+ * Action of the mobile sync transfer for a single file.
+ */
+enum xMobileSyncTransferAction {
+    xMobileSyncTransferCopy,
+    xMobileSyncTransferSkip,
+    xMobileSyncTransferRename
+};
+
+/**
+ * File copied by the mobile sync transfer.
+ */
+struct xMobileSyncTransferFile {
+    std::filesystem::path source;
+    std::filesystem::path destination;
+    std::uintmax_t size;
+    qint64 modified;
+    xMobileSyncTransferAction action = xMobileSyncTransferCopy;
+    // Existing file in the mobile library renamed to the destination.
+    std::filesystem::path existing = {};
+};
+
+// Allow test class to access everything.
+class test_xMobileSyncTransfer;
+
+/**
+ * Copy files to the mobile library using multiple concurrent copies.
+ *
+ * The number of concurrent copies is determined by the destination device.
+ * If a device monitor is set, the number of concurrent copies is adapted to
+ * the number of requests in flight on the device during the transfer.
+ * Files are copied using copy_file_range if supported and large buffers
+ * otherwise. Each file is written to a partial file that is renamed once
+ * the file is complete. Started and completed files are recorded in a journal
+ * in the mobile library. A cancelled transfer therefore skips the completed
+ * files and continues partial files if it is run again. A partial file is only
+ * continued if size and modification time of its source are unchanged. The
+ * journal is removed after a transfer without errors.
+ *
+ * Before the transfer, files that are identical to existing files in the
+ * mobile library are determined by their content fingerprints. Files
+ * already in place are skipped and files that exist under a different path
+ * in the mobile library are renamed on the device instead of copied.
+ */
+class xMobileSyncTransfer:public QObject {
+    Q_OBJECT
+
+    friend class test_xMobileSyncTransfer;
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param base the path to the mobile library.
+     * @param parent the parent object.
+     */
+    explicit xMobileSyncTransfer(const std::filesystem::path& base, QObject* parent=nullptr);
+    ~xMobileSyncTransfer() override = default;
+    /**
+     * Add a single file to the transfer.
+     *
+     * @param source the absolute path of the source file.
+     * @param destination the path of the destination file relative to the mobile library.
+     */
+    void addFile(const std::filesystem::path& source, const std::filesystem::path& destination);
+    /**
+     * Add all files of a directory to the transfer.
+     *
+     * @param source the absolute path of the source directory.
+     * @param destination the path of the destination directory relative to the mobile library.
+     */
+    void addDirectory(const std::filesystem::path& source, const std::filesystem::path& destination);
+    /**
+     * Return the total number of bytes of all files in the transfer.
+     *
+     * @return the number of bytes.
+     */
+    [[nodiscard]] std::uintmax_t getTotalBytes() const;
+    /**
+     * Set the monitor of the destination device used to adapt the number of concurrent copies.
+     *
+     * @param monitor pointer to the device monitor, nullptr to use a fixed number of copies.
+     */
+    void setMonitor(xPlayerDeviceMonitor* monitor);
+    /**
+     * Determine the files to be skipped or renamed.
+     *
+     * Existing destination files identical to their source are skipped unless
+     * they are located in one of the removed paths. Missing destination files
+     * are renamed from identical files in the removed paths.
+     *
+     * @param removals the absolute paths of files and directories to be removed from the mobile library.
+     */
+    void plan(const std::vector<std::filesystem::path>& removals);
+    /**
+     * Transcode the files accepted by the transcoder. Blocks until all files are transcoded.
+     *
+     * The transcoded files replace the source files of the transfer. Files that
+     * cannot be transcoded are copied unchanged. Must be called before plan. An
+     * interruption request for the calling thread cancels the transcoding.
+     *
+     * @param transcoder the transcoder used.
+     * @return true if the transcoding was not cancelled, false otherwise.
+     */
+    bool transcodeFiles(const xMobileSyncTranscoder& transcoder);
+    /**
+     * Rename the existing files determined by plan. Must be called before the removal.
+     *
+     * Files that cannot be renamed are copied instead.
+     */
+    void renameFiles();
+    /**
+     * Run the transfer. Blocks until all files are copied or the transfer is cancelled.
+     *
+     * An interruption request for the calling thread cancels the transfer.
+     *
+     * @return true if all files were copied, false otherwise.
+     */
+    bool run();
+    /**
+     * Cancel the transfer. The files currently copied are kept as partial files.
+     */
+    void cancel();
+    /**
+     * Determine the number of concurrent copies for the device of the given path.
+     *
+     * @param path the path to the mobile library.
+     * @return the number of concurrent copies.
+     */
+    [[nodiscard]] static int concurrency(const std::filesystem::path& path);
+
+signals:
+    /**
+     * Signal the progress of the transfer. Emitted by the thread calling run.
+     *
+     * @param copiedBytes the number of bytes copied, including skipped files.
+     * @param totalBytes the total number of bytes of the transfer.
+     */
+    void progress(quint64 copiedBytes, quint64 totalBytes);
+    /**
+     * Signal the progress of the transcoding. Emitted by the thread calling transcodeFiles.
+     *
+     * @param transcodedFiles the number of files transcoded, including cached files.
+     * @param totalFiles the total number of files to be transcoded.
+     * @param filesPerMinute the throughput in files per minute.
+     */
+    void transcodeProgress(int transcodedFiles, int totalFiles, double filesPerMinute);
+
+private:
+    /**
+     * Copy a single file. Called in a worker thread.
+     *
+     * @param file the file to copy.
+     * @return true if the file was copied or skipped, false otherwise.
+     */
+    bool copyFile(const xMobileSyncTransferFile& file);
+    /**
+     * Copy the remaining bytes from the source to the destination file descriptor.
+     *
+     * @param source the source file descriptor.
+     * @param destination the destination file descriptor.
+     * @param offset the number of bytes already copied.
+     * @param size the size of the source file.
+     * @return true if the copy is complete, false on error or cancellation.
+     */
+    bool copyData(int source, int destination, off_t offset, off_t size);
+    /**
+     * Adapt the number of concurrent copies to the load of the destination device.
+     *
+     * @param pool the thread pool used for copying.
+     * @param maxThreads the maximal number of concurrent copies.
+     */
+    void adaptConcurrency(QThreadPool* pool, int maxThreads);
+    /**
+     * Load the journal of a previously cancelled transfer.
+     */
+    void loadJournal();
+    /**
+     * Record a started or completed file in the journal.
+     *
+     * @param entry the journal entry for the file.
+     */
+    void recordJournal(const QString& entry);
+    /**
+     * Return the key used for a file in the journal.
+     *
+     * @param file the file copied.
+     * @return the key as string.
+     */
+    [[nodiscard]] static QString journalKey(const xMobileSyncTransferFile& file);
+
+    std::filesystem::path transferBase;
+    xPlayerDeviceMonitor* transferMonitor;
+    quint64 transferMonitorSamples;
+    std::vector<xMobileSyncTransferFile> transferFiles;
+    std::uintmax_t transferTotalBytes;
+    std::atomic<std::uintmax_t> transferCopiedBytes;
+    std::atomic<bool> transferCancelled;
+    std::atomic<int> transferErrors;
+    QSet<QString> transferJournal;
+    QMutex transferJournalMutex;
+    QFile transferJournalFile;
+};
+
+#endif
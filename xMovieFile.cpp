@@ -13,52 +13,275 @@
  */
 
 #include "xMovieFile.h"
-#include <QRegularExpression>
+#include "xPlayerDatabase.h"
+
+#include <QMutexLocker>
+#include <QBuffer>
+#include <QImage>
 #include <QDebug>
 
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
 #include <filesystem>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Number of frames in the thumbnail strip.
+constexpr auto xMovieFile_ThumbnailFrames = 5;
+// Size of each frame in the thumbnail strip.
+constexpr auto xMovieFile_ThumbnailWidth = 160;
+constexpr auto xMovieFile_ThumbnailHeight = 90;
+// Maximal number of packets read to decode a single frame.
+constexpr auto xMovieFile_ThumbnailMaxPackets = 500;
+// Number of bytes at the start of a movie file read ahead by prefetch.
+constexpr off_t xMovieFile_PrefetchSize = 64*1024*1024;
+
+QMutex xMovieFile::movieFileInfoMutex;
+QHash<QString,xMovieFileInfo> xMovieFile::movieFileInfo;
+
+/**
+ * Return the languages of all streams of the given type.
+ */
+static QStringList xMovieFile_streamLanguages(AVFormatContext* formatContext, AVMediaType type) {
+    QStringList languages;
+    for (unsigned int i = 0; i < formatContext->nb_streams; ++i) {
+        auto stream = formatContext->streams[i];
+        if (stream->codecpar->codec_type != type) {
+            continue;
+        }
+        auto language = av_dict_get(stream->metadata, "language", nullptr, 0);
+        languages.push_back((language) ? QString::fromUtf8(language->value) : QString("Unknown"));
+    }
+    return languages;
+}
+
+/**
+ * Read the key frame positions of the main video stream from the container index.
+ *
+ * @return true if the index was read or no video stream exists, false if the video stream has no index.
+ */
+static bool xMovieFile_keyFrames(AVFormatContext* formatContext, QVector<qint64>& keyFrames) {
+    keyFrames.clear();
+    auto streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (streamIndex < 0) {
+        return true;
+    }
+    // Some demuxers (e.g. Matroska) only read the index on the first seek.
+    if (avformat_seek_file(formatContext, -1, INT64_MIN, 0, 0, 0) < 0) {
+        qWarning() << "xMovieFile: unable to seek to the start of the movie";
+    }
+    auto stream = formatContext->streams[streamIndex];
+    auto startTime = (stream->start_time != AV_NOPTS_VALUE) ? stream->start_time : 0;
+    auto entries = avformat_index_get_entries_count(stream);
+    keyFrames.reserve(entries);
+    for (auto i = 0; i < entries; ++i) {
+        auto entry = avformat_index_get_entry(stream, i);
+        if ((entry) && (entry->flags & AVINDEX_KEYFRAME)) {
+            keyFrames.push_back(static_cast<qint64>(av_rescale_q(entry->timestamp-startTime, stream->time_base, AVRational{ 1, 1000 })));
+        }
+    }
+    // The index is sorted by timestamp. Remove duplicates just in case.
+    keyFrames.erase(std::unique(keyFrames.begin(), keyFrames.end()), keyFrames.end());
+    return !keyFrames.isEmpty();
+}
 
-xMovieFile::xMovieFile(QObject* parent):QObject(parent) {
+/**
+ * Decode frames equally distributed over the movie and store them as JPEG strip.
+ */
+static QByteArray xMovieFile_thumbnails(AVFormatContext* formatContext) {
+    if ((formatContext->duration == AV_NOPTS_VALUE) || (formatContext->duration <= 0)) {
+        return {};
+    }
+    const AVCodec* codec = nullptr;
+    auto streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+    if ((streamIndex < 0) || (!codec)) {
+        return {};
+    }
+    auto codecContext = avcodec_alloc_context3(codec);
+    if ((avcodec_parameters_to_context(codecContext, formatContext->streams[streamIndex]->codecpar) < 0) ||
+        (avcodec_open2(codecContext, codec, nullptr) < 0)) {
+        avcodec_free_context(&codecContext);
+        return {};
+    }
+    auto packet = av_packet_alloc();
+    auto frame = av_frame_alloc();
+    SwsContext* scaleContext = nullptr;
+    QImage strip(xMovieFile_ThumbnailWidth*xMovieFile_ThumbnailFrames, xMovieFile_ThumbnailHeight, QImage::Format_RGB32);
+    strip.fill(Qt::black);
+    auto decodedFrames = 0;
+    for (auto i = 0; i < xMovieFile_ThumbnailFrames; ++i) {
+        // Use the middle of each of the equally sized parts of the movie.
+        auto timeStamp = formatContext->duration*(2*i+1)/(2*xMovieFile_ThumbnailFrames);
+        if (formatContext->start_time != AV_NOPTS_VALUE) {
+            timeStamp += formatContext->start_time;
+        }
+        if (av_seek_frame(formatContext, -1, timeStamp, AVSEEK_FLAG_BACKWARD) < 0) {
+            break;
+        }
+        avcodec_flush_buffers(codecContext);
+        auto decoded = false;
+        for (auto packets = 0; (!decoded) && (packets < xMovieFile_ThumbnailMaxPackets) &&
+                               (av_read_frame(formatContext, packet) >= 0); ++packets) {
+            if ((packet->stream_index == streamIndex) && (avcodec_send_packet(codecContext, packet) >= 0)) {
+                decoded = (avcodec_receive_frame(codecContext, frame) == 0);
+            }
+            av_packet_unref(packet);
+        }
+        if (!decoded) {
+            continue;
+        }
+        scaleContext = sws_getCachedContext(scaleContext, frame->width, frame->height,
+                                            static_cast<AVPixelFormat>(frame->format),
+                                            xMovieFile_ThumbnailWidth, xMovieFile_ThumbnailHeight,
+                                            AV_PIX_FMT_RGB32, SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!scaleContext) {
+            break;
+        }
+        // Scale directly into the strip. AV_PIX_FMT_RGB32 matches QImage::Format_RGB32.
+        uint8_t* stripData[4] = { strip.bits()+i*xMovieFile_ThumbnailWidth*4, nullptr, nullptr, nullptr };
+        int stripLineSize[4] = { static_cast<int>(strip.bytesPerLine()), 0, 0, 0 };
+        sws_scale(scaleContext, frame->data, frame->linesize, 0, frame->height, stripData, stripLineSize);
+        ++decodedFrames;
+    }
+    sws_freeContext(scaleContext);
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    avcodec_free_context(&codecContext);
+    QByteArray thumbnails;
+    if (decodedFrames > 0) {
+        QBuffer thumbnailsBuffer(&thumbnails);
+        thumbnailsBuffer.open(QIODevice::WriteOnly);
+        strip.save(&thumbnailsBuffer, "JPG", 80);
+    }
+    return thumbnails;
+}
+
+
+xMovieFile::xMovieFile(QObject* parent):
+        QObject(parent),
+        movieLength(-1) {
 }
 
 void xMovieFile::analyze(const QString& file) {
     // Check if we really have a file.
-    if (!std::filesystem::is_regular_file(file.toStdString())) {
+    std::error_code errorCode;
+    std::filesystem::path path(file.toStdString());
+    if (!std::filesystem::is_regular_file(path, errorCode)) {
         qCritical() << "xMovieFile::analyze: illegal file name: " << file;
         return;
     }
     movieFile = file;
-    // Start ffprobe in order to analyze the movie file.
-    process = new QProcess();
-    process->setProcessChannelMode(QProcess::MergedChannels);
-    process->start("/usr/bin/ffprobe", { {"-v"}, {"quiet"}, {"-print_format"}, {"json"},
-                                        {"-show_streams"}, {"-show_chapters"}, {"-show_format"}, movieFile });
-    process->waitForFinished(-1);
-    // Process standard output (includes stderr) and interpret json.
-    std::stringstream processOutput;
-    processOutput << process->readAllStandardOutput().toStdString();
-    // Delete process.
-    delete process;
-    boost::property_tree::ptree movieFileInfo;
-    try {
-        boost::property_tree::read_json(processOutput, movieFileInfo);
-    } catch (boost::property_tree::json_parser_error& e) {
-        qCritical() << "xMovieFile::analyze: unable to read movie file info.";
+    useInfo(xMovieFileInfo());
+    xMovieFileInfo info;
+    if (cachedInfo(file, info)) {
+        useInfo(info);
+    }
+}
+
+void xMovieFile::prefetch(const QString& file) {
+    auto fd = ::open(file.toStdString().c_str(), O_RDONLY|O_CLOEXEC);
+    if (fd < 0) {
+        qWarning() << "xMovieFile::prefetch: unable to open file: " << file;
         return;
     }
-    movieChapterLength.clear();
-    movieChapterBegin.clear();
-    auto childChapters = movieFileInfo.get_child("chapters");
-    for (boost::property_tree::ptree::value_type& childChapter : childChapters) {
-        // Retrieve start and end time for each track (chapter)
-        auto chapterBegin = childChapter.second.get<double>("start_time", 0.0);
-        auto chapterEnd = childChapter.second.get<double>("end_time", 0.0);
+    // Asynchronous read-ahead. The reading of the metadata is not delayed.
+    ::posix_fadvise(fd, 0, xMovieFile_PrefetchSize, POSIX_FADV_WILLNEED);
+    ::close(fd);
+    xMovieFileInfo info;
+    cachedInfo(file, info);
+}
+
+bool xMovieFile::cachedInfo(const QString& file, xMovieFileInfo& info) {
+    // Use the cached info if the file has not been modified.
+    if (!readFileStatus(file, info)) {
+        return false;
+    }
+    {
+        QMutexLocker lock(&movieFileInfoMutex);
+        auto cached = movieFileInfo.find(file);
+        if ((cached != movieFileInfo.end()) && (cached->size == info.size) && (cached->modified == info.modified)) {
+            info = cached.value();
+            return true;
+        }
+    }
+    // Use the movie catalog entry if it is still valid. Read the container otherwise.
+    auto catalogInfo = xPlayerDatabase::database()->getMovieCatalogEntry(file);
+    if ((catalogInfo.size == info.size) && (catalogInfo.modified == info.modified) && (catalogInfo.keyFramesValid)) {
+        info = catalogInfo;
+    } else if (!readInfo(file, info, false)) {
+        return false;
+    }
+    // The thumbnails are not required for playback.
+    info.thumbnails.clear();
+    // Read the container again next time if the key frame index is missing.
+    if (!info.keyFramesValid) {
+        return true;
+    }
+    QMutexLocker lock(&movieFileInfoMutex);
+    movieFileInfo.insert(file, info);
+    return true;
+}
+
+bool xMovieFile::readFileStatus(const QString& file, xMovieFileInfo& info) {
+    std::error_code errorCode;
+    std::filesystem::path path(file.toStdString());
+    auto size = std::filesystem::file_size(path, errorCode);
+    if (errorCode) {
+        return false;
+    }
+    auto modified = std::filesystem::last_write_time(path, errorCode);
+    if (errorCode) {
+        return false;
+    }
+    info.size = size;
+    info.modified = static_cast<qint64>(modified.time_since_epoch().count());
+    return true;
+}
+
+bool xMovieFile::readInfo(const QString& file, xMovieFileInfo& info, bool thumbnails) {
+    // Open the input. The chapters and stream languages are part of the container header.
+    AVFormatContext* formatContext = nullptr;
+    if (avformat_open_input(&formatContext, file.toStdString().c_str(), nullptr, nullptr) != 0) {
+        qCritical() << "xMovieFile::readInfo: unable to read movie file info: " << file;
+        return false;
+    }
+    // The streams only need to be probed for decoding (avformat_find_stream_info).
+    if ((thumbnails) && (avformat_find_stream_info(formatContext, nullptr) < 0)) {
+        qCritical() << "xMovieFile::readInfo: unable to read stream info: " << file;
+        thumbnails = false;
+    }
+    info.length = (formatContext->duration != AV_NOPTS_VALUE) ?
+            static_cast<qint64>(av_rescale(formatContext->duration, 1000, AV_TIME_BASE)) : -1;
+    info.chapterBegin.clear();
+    info.chapterLength.clear();
+    for (unsigned int i = 0; i < formatContext->nb_chapters; ++i) {
+        auto chapter = formatContext->chapters[i];
         // Convert to ms
-        movieChapterBegin.push_back(static_cast<qint64>(chapterBegin*1000));
-        movieChapterLength.push_back(static_cast<qint64>((chapterEnd-chapterBegin)*1000));
+        auto chapterBegin = av_rescale_q(chapter->start, chapter->time_base, AVRational{ 1, 1000 });
+        auto chapterEnd = av_rescale_q(chapter->end, chapter->time_base, AVRational{ 1, 1000 });
+        info.chapterBegin.push_back(static_cast<qint64>(chapterBegin));
+        info.chapterLength.push_back(static_cast<qint64>(chapterEnd-chapterBegin));
     }
+    info.audioLanguages = xMovieFile_streamLanguages(formatContext, AVMEDIA_TYPE_AUDIO);
+    info.subtitleLanguages = xMovieFile_streamLanguages(formatContext, AVMEDIA_TYPE_SUBTITLE);
+    // Read the index before decoding. Seeking may extend the index.
+    info.keyFramesValid = xMovieFile_keyFrames(formatContext, info.keyFrames);
+    info.thumbnails = (thumbnails) ? xMovieFile_thumbnails(formatContext) : QByteArray();
+    avformat_close_input(&formatContext);
+    return true;
+}
+
+void xMovieFile::useInfo(const xMovieFileInfo& info) {
+    movieLength = info.length;
+    movieChapterBegin = info.chapterBegin;
+    movieChapterLength = info.chapterLength;
+    movieAudioLanguages = info.audioLanguages;
+    movieSubtitleLanguages = info.subtitleLanguages;
+    movieKeyFrames = info.keyFrames;
 }
 
 QVector<qint64> xMovieFile::getChapterLength() const {
@@ -67,4 +290,20 @@ QVector<qint64> xMovieFile::getChapterLength() const {
 
 QVector<qint64> xMovieFile::getChapterBegin() const {
   return movieChapterBegin;
-}
\ No newline at end of file
+}
+
+qint64 xMovieFile::getLength() const {
+    return movieLength;
+}
+
+QStringList xMovieFile::getAudioLanguages() const {
+    return movieAudioLanguages;
+}
+
+QStringList xMovieFile::getSubtitleLanguages() const {
+    return movieSubtitleLanguages;
+}
+
+QVector<qint64> xMovieFile::getKeyFrames() const {
+    return movieKeyFrames;
+}
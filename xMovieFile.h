@@ -12,8 +12,11 @@
  * GNU General Public License for more details.
  */
 
-#include <QThread>
-#include <QProcess>
+#include "xPlayerTypes.h"
+
+#include <QObject>
+#include <QMutex>
+#include <QHash>
 #include <QVector>
 
 #ifndef __XMOVIEFILE_H__
@@ -28,6 +31,10 @@ public:
     /**
      * Analyze the given file.
      *
+     * The chapters are read in-process using libavformat. Only the container
+     * header is read. The results are cached per path, size and modification time.
+     * Valid entries of the movie catalog in the database are used if available.
+     *
      * @param file path to the movie file as string.
      */
     void analyze(const QString& file);
@@ -49,13 +56,87 @@ public:
      * @return a vector of chapter beginning in milliseconds.
      */
     [[nodiscard]] QVector<qint64> getChapterBegin() const;
+    /**
+     * Return the length of the movie file.
+     *
+     * @return the length in milliseconds, -1 if unknown.
+     */
+    [[nodiscard]] qint64 getLength() const;
+    /**
+     * Return the languages of the audio streams in the movie file.
+     *
+     * @return a list of languages, "Unknown" for streams without language.
+     */
+    [[nodiscard]] QStringList getAudioLanguages() const;
+    /**
+     * Return the languages of the subtitle streams in the movie file.
+     *
+     * @return a list of languages, "Unknown" for streams without language.
+     */
+    [[nodiscard]] QStringList getSubtitleLanguages() const;
+    /**
+     * Return the key frame positions of the main video stream.
+     *
+     * @return a sorted vector of key frame positions in milliseconds, empty if no index exists.
+     */
+    [[nodiscard]] QVector<qint64> getKeyFrames() const;
+    /**
+     * Read size and modification time of the given file.
+     *
+     * @param file path to the movie file as string.
+     * @param info the info object updated with size and modification time.
+     * @return true if the file is accessible, false otherwise.
+     */
+    static bool readFileStatus(const QString& file, xMovieFileInfo& info);
+    /**
+     * Read the metadata of the given file.
+     *
+     * Length, chapters, stream languages and the key frame index are read from
+     * the container. The thumbnail strip requires decoding and is therefore only
+     * created on request.
+     *
+     * @param file path to the movie file as string.
+     * @param info the info object updated. Size and modification time are not changed.
+     * @param thumbnails create the thumbnail strip if true.
+     * @return true if the container could be read, false otherwise.
+     */
+    static bool readInfo(const QString& file, xMovieFileInfo& info, bool thumbnails);
+    /**
+     * Prefetch the given file in order to start its playback without delay.
+     *
+     * The kernel is advised to read the start of the file into the page cache
+     * and the metadata is analyzed and cached. Blocks until the metadata is read.
+     *
+     * @param file path to the movie file as string.
+     */
+    static void prefetch(const QString& file);
 
 private:
+    /**
+     * Determine the info for the given file using the cache, the movie catalog or the container.
+     *
+     * @param file path to the movie file as string.
+     * @param info the info object updated.
+     * @return true if the info could be determined, false otherwise.
+     */
+    static bool cachedInfo(const QString& file, xMovieFileInfo& info);
+    /**
+     * Use the given info for the current movie file.
+     *
+     * @param info the info object for the current movie file.
+     */
+    void useInfo(const xMovieFileInfo& info);
+
     QString movieFile;
     QString movieFilePath;
+    qint64 movieLength;
     QVector<qint64> movieChapterLength;
     QVector<qint64> movieChapterBegin;
-    QProcess* process;
+    QStringList movieAudioLanguages;
+    QStringList movieSubtitleLanguages;
+    QVector<qint64> movieKeyFrames;
+    static QMutex movieFileInfoMutex;
+    static QHash<QString,xMovieFileInfo> movieFileInfo;
 };
 
 #endif
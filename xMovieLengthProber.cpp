@@ -0,0 +1,116 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xMovieLengthProber.h"
+
+#include <vlc/vlc.h>
+
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QDeadlineTimer>
+#include <QDebug>
+
+// Timeout for parsing a movie file in ms.
+constexpr auto xMovieLengthProber_ParseTimeout = 10000;
+// Additional time in ms to wait for the parsed event after the timeout.
+constexpr auto xMovieLengthProber_EventTimeout = 1000;
+
+/**
+ * State of a single probe. Updated by the libvlc event callback.
+ */
+struct xMovieLengthProbe {
+    QMutex mutex;
+    QWaitCondition parsed;
+    bool done = false;
+};
+
+static void xMovieLengthProber_parsedChanged(const libvlc_event_t* event, void* data) {
+    Q_UNUSED(event)
+    auto probe = static_cast<xMovieLengthProbe*>(data);
+    QMutexLocker lock(&probe->mutex);
+    probe->done = true;
+    probe->parsed.wakeAll();
+}
+
+
+xMovieLengthProber::xMovieLengthProber():
+        proberMutex(),
+        proberMedia(),
+        proberRequester(0) {
+    // Use VLC without video output.
+    static const char* const vlcArgs[] = { "--vout=none", "--quiet" };
+    proberInstance = libvlc_new(sizeof(vlcArgs)/sizeof(vlcArgs[0]), vlcArgs);
+}
+
+xMovieLengthProber::~xMovieLengthProber() {
+    if (proberInstance) {
+        libvlc_release(proberInstance);
+    }
+}
+
+xMovieLengthProber* xMovieLengthProber::prober() {
+    // The prober is accessed from worker threads. Static initialization is thread-safe.
+    static auto movieLengthProber = new xMovieLengthProber();
+    return movieLengthProber;
+}
+
+int xMovieLengthProber::requester() {
+    return ++proberRequester;
+}
+
+qint64 xMovieLengthProber::probe(const std::filesystem::path& path, int requester) {
+    if (!proberInstance) {
+        return -1;
+    }
+    auto vlcMedia = libvlc_media_new_path(proberInstance, path.generic_string().c_str());
+    if (!vlcMedia) {
+        return -1;
+    }
+    xMovieLengthProbe probe;
+    auto vlcEvents = libvlc_media_event_manager(vlcMedia);
+    libvlc_event_attach(vlcEvents, libvlc_MediaParsedChanged, xMovieLengthProber_parsedChanged, &probe);
+    {
+        QMutexLocker lock(&proberMutex);
+        proberMedia.insert(requester, vlcMedia);
+    }
+    if (libvlc_media_parse_with_options(vlcMedia, libvlc_media_parse_network, xMovieLengthProber_ParseTimeout) == 0) {
+        QMutexLocker lock(&probe.mutex);
+        if (!probe.done) {
+            probe.parsed.wait(&probe.mutex, QDeadlineTimer(xMovieLengthProber_ParseTimeout+xMovieLengthProber_EventTimeout));
+        }
+    }
+    {
+        QMutexLocker lock(&proberMutex);
+        proberMedia.remove(requester, vlcMedia);
+    }
+    // Detaching waits for a running callback. The probe can be safely released afterwards.
+    libvlc_event_detach(vlcEvents, libvlc_MediaParsedChanged, xMovieLengthProber_parsedChanged, &probe);
+    qint64 length = -1;
+    if (libvlc_media_get_parsed_status(vlcMedia) == libvlc_media_parsed_status_done) {
+        length = static_cast<qint64>(libvlc_media_get_duration(vlcMedia));
+    } else {
+        qDebug() << "Unable to parse movie: " << QString::fromStdString(path.generic_string());
+    }
+    libvlc_media_release(vlcMedia);
+    return length;
+}
+
+void xMovieLengthProber::cancel(int requester) {
+    QMutexLocker lock(&proberMutex);
+    // Stopping the parsing triggers the parsed event with a timeout status.
+    for (auto vlcMedia = proberMedia.constFind(requester);
+         (vlcMedia != proberMedia.cend()) && (vlcMedia.key() == requester); ++vlcMedia) {
+        libvlc_media_parse_stop(vlcMedia.value());
+    }
+}
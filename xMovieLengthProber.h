@@ -0,0 +1,73 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XMOVIELENGTHPROBER_H__
+#define __XMOVIELENGTHPROBER_H__
+
+#include <QMutex>
+#include <QMultiHash>
+
+#include <atomic>
+#include <filesystem>
+
+struct libvlc_instance_t;
+struct libvlc_media_t;
+
+/**
+ * Determine the length of movie files using a shared libvlc instance.
+ *
+ * The prober is thread-safe and is used concurrently from worker threads. The
+ * completion of the parsing is signaled by libvlc events, i.e. there is no polling.
+ * Probes are tagged with the requester, so that each requester only cancels its own.
+ */
+class xMovieLengthProber {
+public:
+    /**
+     * Return the movie length prober.
+     *
+     * @return pointer to the singleton object.
+     */
+    static xMovieLengthProber* prober();
+    /**
+     * Return a new requester id used to cancel probes.
+     *
+     * @return the requester id, never 0.
+     */
+    int requester();
+    /**
+     * Determine the length of the given movie file. Blocks until the parsing is done.
+     *
+     * @param path the path to the movie file.
+     * @param requester the id of the requester, 0 if the probe is not cancelled.
+     * @return the length in ms, -1 if the parsing failed or was cancelled.
+     */
+    qint64 probe(const std::filesystem::path& path, int requester=0);
+    /**
+     * Stop the running probes of the given requester. Each of them returns -1.
+     *
+     * @param requester the id of the requester.
+     */
+    void cancel(int requester);
+
+private:
+    xMovieLengthProber();
+    ~xMovieLengthProber();
+
+    libvlc_instance_t* proberInstance;
+    QMutex proberMutex;
+    QMultiHash<int,libvlc_media_t*> proberMedia;
+    std::atomic<int> proberRequester;
+};
+
+#endif
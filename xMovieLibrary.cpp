@@ -14,126 +14,324 @@
 
 #include "xMovieLibrary.h"
 #include "xPlayerConfiguration.h"
+#include "xPlayerDatabase.h"
+#include "xMovieFile.h"
 
+#include <QThreadPool>
+#include <QMutexLocker>
 #include <QDebug>
 
-xMovieLibraryScanning::xMovieLibraryScanning(xMovieFiles_t* movie, QObject* parent):
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <utility>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// Scanning is I/O bound, in particular on network shares. Use more threads than cores.
+constexpr auto xMovieLibraryScanning_Threads = 16;
+
+/**
+ * Determine the type of the directory entry. Only stat the entry if readdir does not provide the type.
+ */
+static unsigned char xMovieLibraryScanning_entryType(int directoryFd, const struct dirent* entry) {
+    // Symbolic links are followed like std::filesystem::is_directory does.
+    if ((entry->d_type != DT_UNKNOWN) && (entry->d_type != DT_LNK)) {
+        return entry->d_type;
+    }
+    struct stat entryStat{};
+    if (fstatat(directoryFd, entry->d_name, &entryStat, 0) != 0) {
+        return DT_UNKNOWN;
+    }
+    if (S_ISDIR(entryStat.st_mode)) {
+        return DT_DIR;
+    }
+    return (S_ISREG(entryStat.st_mode)) ? DT_REG : DT_UNKNOWN;
+}
+
+/**
+ * Determine if the file name has one of the given lower case extensions.
+ */
+static bool xMovieLibraryScanning_isMovieFile(const char* name, const std::unordered_set<std::string>& extensions) {
+    auto extension = std::strrchr(name, '.');
+    // Ignore names without extension and hidden files without extension.
+    if ((!extension) || (extension == name)) {
+        return false;
+    }
+    std::string lowerExtension(extension);
+    std::transform(lowerExtension.begin(), lowerExtension.end(), lowerExtension.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return (extensions.find(lowerExtension) != extensions.end());
+}
+
+
+xMovieLibraryScanning::xMovieLibraryScanning(QObject* parent):
         QThread(parent),
-        movieFiles(movie) {
+        movieScanDepth(xPlayerConfiguration::configuration()->getMovieLibraryScanDepth()) {
     connect(xPlayerConfiguration::configuration(), &xPlayerConfiguration::updatedMovieLibraryExtensions,
             this, &xMovieLibraryScanning::updateMovieExtensions);
+    connect(xPlayerConfiguration::configuration(), &xPlayerConfiguration::updatedMovieLibraryScanDepth,
+            this, &xMovieLibraryScanning::updateMovieScanDepth);
+    updateMovieExtensions();
 }
 
-void xMovieLibraryScanning::setBaseDirectories(const std::list<std::pair<QString, std::filesystem::path>>& base) {
+void xMovieLibraryScanning::setBaseDirectories(const std::list<std::pair<QString, std::filesystem::path>>& base,
+                                               const xMovieSnapshot_t& previous) {
     baseDirectories = base;
+    previousSnapshot = previous;
 }
 
 void xMovieLibraryScanning::updateMovieExtensions() {
-    movieExtensions = xPlayerConfiguration::configuration()->getMovieLibraryExtensionList();
+    std::unordered_set<std::string> extensions;
+    for (const auto& extension : xPlayerConfiguration::configuration()->getMovieLibraryExtensionList()) {
+        if (!extension.isEmpty()) {
+            extensions.insert(extension.toLower().toStdString());
+        }
+    }
+    QMutexLocker lock(&movieExtensionsMutex);
+    movieExtensions = extensions;
 }
 
-bool xMovieLibraryScanning::isMovieFile(const std::filesystem::path& file) {
-    if (std::filesystem::is_regular_file(file)) {
-        auto extension = QString::fromStdString(file.extension().string());
-        for (const auto& movieExtension : movieExtensions) {
-            if (extension.startsWith(movieExtension, Qt::CaseInsensitive)) {
-                return true;
-            }
+void xMovieLibraryScanning::updateMovieScanDepth() {
+    movieScanDepth.storeRelease(xPlayerConfiguration::configuration()->getMovieLibraryScanDepth());
+}
+
+bool xMovieLibraryScanning::readDirectory(const std::filesystem::path& path, const std::unordered_set<std::string>& extensions,
+                                          xMovieLibraryDirectory& content) {
+    auto directory = opendir(path.c_str());
+    if (!directory) {
+        return false;
+    }
+    auto directoryFd = dirfd(directory);
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != nullptr) {
+        if ((std::strcmp(entry->d_name, ".") == 0) || (std::strcmp(entry->d_name, "..") == 0)) {
+            continue;
+        }
+        switch (xMovieLibraryScanning_entryType(directoryFd, entry)) {
+            case DT_DIR: {
+                content.directories.emplace_back(entry->d_name);
+            } break;
+            case DT_REG: {
+                if (xMovieLibraryScanning_isMovieFile(entry->d_name, extensions)) {
+                    content.files.emplace_back(entry->d_name);
+                }
+            } break;
+            default: break;
+        }
+    }
+    closedir(directory);
+    return true;
+}
+
+void xMovieLibraryScanning::scanSubDirectory(xMovieLibrarySubDirectory& subDirectory, const std::filesystem::path& relative,
+                                             int depth, const std::unordered_set<std::string>& extensions) {
+    xMovieLibraryDirectory content;
+    auto path = (relative.empty()) ? subDirectory.path : subDirectory.path / relative;
+    if (!readDirectory(path, extensions, content)) {
+        qCritical() << "xMovieLibrary: unable to read directory: " << QString::fromStdString(path.generic_string());
+        return;
+    }
+    for (const auto& file : content.files) {
+        // Movies in nested directories are named by their relative path.
+        auto movieName = (relative.empty()) ? QString::fromStdString(file) :
+                QString::fromStdString((relative / file).generic_string());
+        subDirectory.movies.emplace_back(movieName, path / file);
+    }
+    if (depth > 0) {
+        for (const auto& directory : content.directories) {
+            scanSubDirectory(subDirectory, relative / directory, depth-1, extensions);
         }
     }
-    qDebug() << "xMovieLibrary: skipping: " << QString::fromStdString(file.generic_string());
-    return false;
 }
 
 void xMovieLibraryScanning::run() {
-    // Remove all movies.
-    movieFiles->clear();
-    // Loop over all base directories
-    // We assume that the subdirectories names are distinct over all base directories.
-    for (const auto& baseDirectory : baseDirectories) {
-        qDebug() << "xMovieLibrary: Directory: " << QString::fromStdString(baseDirectory.second.filename());
-        qDebug() << "xMovieLibrary: Tag: " << baseDirectory.first;
-        auto baseDirectoryTag = baseDirectory.first;
-        auto movieFilesTagPos = movieFiles->find(baseDirectoryTag);
-        if (movieFilesTagPos == movieFiles->end()) {
-            // Create missing TAG directory
-            (*movieFiles)[baseDirectoryTag] = std::map<QString, std::vector<xMovieLibraryEntry*>>();
-            // Create entry for "." directory
-            (*movieFiles)[baseDirectoryTag]["."] = std::vector<xMovieLibraryEntry*>();
-            movieFilesTagPos = movieFiles->find(baseDirectoryTag);
-        }
-        // Find "." directory for current TAG. Does exist.
-        auto movieFilesMainPos = movieFilesTagPos->second.find(".");
-        try {
-            for (const auto& entry : std::filesystem::directory_iterator(baseDirectory.second)) {
-                const auto& entryPath = entry.path();
-                if (std::filesystem::is_directory(entryPath)) {
-                    auto directoryName = QString::fromStdString(entryPath.filename());
-                    auto movieFilesDirectoryPos = movieFilesTagPos->second.find(directoryName);
-                    if (movieFilesDirectoryPos == movieFilesTagPos->second.end()) {
-                        // Create missing directory entry for the current TAG.
-                        movieFilesTagPos->second[directoryName] = std::vector<xMovieLibraryEntry*>();
-                        // Find the just directory name just created;
-                        movieFilesDirectoryPos = movieFilesTagPos->second.find(directoryName);
-                    }
-                    for (const auto& directoryEntry : std::filesystem::directory_iterator(entryPath)) {
-                        const auto& directoryEntryPath = directoryEntry.path();
-                        if (isMovieFile(directoryEntryPath)) {
-                            qDebug() << "xMovieLibrary: directory: " << QString::fromStdString(entryPath.filename())
-                                     << ", movie: " << QString::fromStdString(directoryEntryPath.filename());
-                            movieFilesDirectoryPos->second.emplace_back(
-                                    new xMovieLibraryEntry(baseDirectoryTag, directoryName,
-                                                           QString::fromStdString(directoryEntryPath.filename()), directoryEntryPath)
-                            );
-                        }
-                    }
-                } else if (isMovieFile(entryPath)) {
-                    movieFilesMainPos->second.emplace_back(
-                            new xMovieLibraryEntry(baseDirectoryTag, ".", QString::fromStdString(entryPath.filename()), entryPath)
-                    );
-                    qDebug() << "xMovieLibrary: movie: " << QString::fromStdString(entryPath.filename());
-                }
+    std::unordered_set<std::string> extensions;
+    {
+        QMutexLocker lock(&movieExtensionsMutex);
+        extensions = movieExtensions;
+    }
+    auto depth = movieScanDepth.loadAcquire();
+    std::vector<std::pair<QString,std::filesystem::path>> bases(baseDirectories.begin(), baseDirectories.end());
+    QThreadPool scanningPool;
+    scanningPool.setMaxThreadCount(xMovieLibraryScanning_Threads);
+    // Read all base directories in parallel.
+    std::vector<xMovieLibraryDirectory> baseContents(bases.size());
+    std::vector<int> baseRead(bases.size(), 0);
+    for (size_t i = 0; i < bases.size(); ++i) {
+        scanningPool.start(QRunnable::create([&bases, &baseContents, &baseRead, &extensions, i]() {
+            baseRead[i] = readDirectory(bases[i].second, extensions, baseContents[i]);
+        }));
+    }
+    scanningPool.waitForDone();
+    // Scan all subdirectories in parallel. Each task only updates its own subdirectory.
+    // The vector must not be modified while the tasks are running.
+    std::vector<xMovieLibrarySubDirectory> subDirectories;
+    if (depth > 1) {
+        for (size_t i = 0; i < bases.size(); ++i) {
+            for (const auto& directory : baseContents[i].directories) {
+                subDirectories.push_back({ bases[i].first, QString::fromStdString(directory), bases[i].second / directory, {} });
             }
-        } catch (...) {
-            qCritical() << "xMovieLibrary: directory not found: " << QString::fromStdString(baseDirectory.second.generic_string());
         }
+        for (auto& subDirectory : subDirectories) {
+            scanningPool.start(QRunnable::create([&subDirectory, &extensions, depth]() {
+                scanSubDirectory(subDirectory, std::filesystem::path(), depth-2, extensions);
+            }));
+        }
+        scanningPool.waitForDone();
     }
-    // Create list of tags. Some debugging output.
-    QStringList tagList;
-    for (auto& tag : (*movieFiles)) {
+    // Create the new snapshot. Reuse the entries of unchanged movies (including their scanned length).
+    auto snapshot = std::make_shared<xMovieLibrarySnapshot>();
+    auto addMovie = [this, &snapshot](const QString& tag, const QString& directory, const QString& movie,
+                                      const std::filesystem::path& path) {
+        xMovieLibraryKey key { tag, directory, movie };
+        // Ignore duplicates. The index owns the entries.
+        if (snapshot->index.contains(key)) {
+            return;
+        }
+        std::shared_ptr<xMovieLibraryEntry> entry;
+        if (previousSnapshot) {
+            auto previousEntry = previousSnapshot->index.find(key);
+            // Do not reuse the cached size and length of a movie file replaced at the same path.
+            if ((previousEntry != previousSnapshot->index.end()) && (previousEntry.value()->getPath() == path) &&
+                (previousEntry.value()->isUpToDate())) {
+                entry = previousEntry.value();
+            }
+        }
+        if (!entry) {
+            entry = std::make_shared<xMovieLibraryEntry>(tag, directory, movie, path);
+        }
+        snapshot->files[tag][directory].push_back(entry.get());
+        snapshot->index.insert(key, entry);
+    };
+    // We assume that the subdirectories names are distinct over all base directories.
+    for (size_t i = 0; i < bases.size(); ++i) {
+        const auto& [baseDirectoryTag, baseDirectoryPath] = bases[i];
+        qDebug() << "xMovieLibrary: Directory: " << QString::fromStdString(baseDirectoryPath.filename());
+        qDebug() << "xMovieLibrary: Tag: " << baseDirectoryTag;
+        // Create the TAG directory with the entry for the "." directory if missing.
+        snapshot->files[baseDirectoryTag]["."];
+        if (!baseRead[i]) {
+            qCritical() << "xMovieLibrary: directory not found: " << QString::fromStdString(baseDirectoryPath.generic_string());
+            continue;
+        }
+        for (const auto& file : baseContents[i].files) {
+            addMovie(baseDirectoryTag, ".", QString::fromStdString(file), baseDirectoryPath / file);
+        }
+    }
+    for (const auto& subDirectory : subDirectories) {
+        // Create the directory entry even if it does not contain any movies.
+        snapshot->files[subDirectory.tag][subDirectory.directory];
+        for (const auto& [movie, path] : subDirectory.movies) {
+            addMovie(subDirectory.tag, subDirectory.directory, movie, path);
+        }
+    }
+    // Sort the movies of each directory.
+    for (auto& tag : snapshot->files) {
         for (auto& dir : tag.second) {
-            std::sort(dir.second.begin(), dir.second.end(), [](xMovieLibraryEntry* a, xMovieLibraryEntry* b) { return (
-                    a->getMovieName() <
-                                                                                                                       b->getMovieName()); } );
+            std::sort(dir.second.begin(), dir.second.end(), [](xMovieLibraryEntry* a, xMovieLibraryEntry* b) {
+                return (a->getMovieName() < b->getMovieName());
+            });
         }
-        tagList.push_back(tag.first);
     }
-    // Update UI.
-    emit scannedTags(tagList);
+    qDebug() << "xMovieLibrary: scanned movies: " << snapshot->index.size();
+    // Do not hold the previous snapshot any longer than necessary.
+    previousSnapshot.reset();
+    emit scannedSnapshot(snapshot);
+}
+
+xMovieLibraryIndexing::xMovieLibraryIndexing(QObject* parent):
+        QThread(parent) {
+}
+
+void xMovieLibraryIndexing::setSnapshot(const xMovieSnapshot_t& snapshot) {
+    indexingSnapshot = snapshot;
+}
+
+void xMovieLibraryIndexing::run() {
+    auto indexed = 0;
+    for (auto movie = indexingSnapshot->index.cbegin(); movie != indexingSnapshot->index.cend(); ++movie) {
+        if (isInterruptionRequested()) {
+            qDebug() << "xMovieLibrary: indexing interrupted";
+            break;
+        }
+        const auto& [tag, directory, name] = movie.key();
+        auto file = QString::fromStdString(movie.value()->getPath().generic_string());
+        xMovieFileInfo info;
+        if (!xMovieFile::readFileStatus(file, info)) {
+            continue;
+        }
+        if (xPlayerDatabase::database()->isMovieCatalogEntryValid(file, info.size, info.modified)) {
+            continue;
+        }
+        // Reading the container may take a while for movies on a network share.
+        if (isInterruptionRequested()) {
+            qDebug() << "xMovieLibrary: indexing interrupted";
+            break;
+        }
+        if (!xMovieFile::readInfo(file, info, true)) {
+            continue;
+        }
+        xPlayerDatabase::database()->updateMovieCatalogEntry(file, info);
+        // Record the length. The movie list does not need to probe the movie.
+        if (info.length > 0) {
+            xPlayerDatabase::database()->updateMovieFileLength(tag, directory, name, static_cast<qint64>(info.size), info.length);
+        }
+        ++indexed;
+    }
+    qDebug() << "xMovieLibrary: indexed movies: " << indexed;
+    // Release the snapshot.
+    indexingSnapshot.reset();
+    emit indexedMovies(indexed);
 }
 
 
 xMovieLibrary::xMovieLibrary(QObject *parent):
-        QObject(parent) {
-    // Create movie file structure.
-    movieFiles = new xMovieFiles_t;
+        QObject(parent),
+        movieSnapshot(),
+        movieSnapshotShown(),
+        movieLibraryRescan(false),
+        movieLibraryReindex() {
     // Create scanning thread.
-    movieLibraryScanning = new xMovieLibraryScanning(movieFiles, this);
-    connect(movieLibraryScanning, &xMovieLibraryScanning::scannedTags, this, &xMovieLibrary::scannedTags);
+    movieLibraryScanning = new xMovieLibraryScanning(this);
+    connect(movieLibraryScanning, &xMovieLibraryScanning::scannedSnapshot, this, &xMovieLibrary::publishSnapshot,
+            Qt::QueuedConnection);
+    connect(movieLibraryScanning, &xMovieLibraryScanning::finished, this, &xMovieLibrary::scanningFinished);
+    // Create indexing thread. Started after each scan.
+    movieLibraryIndexing = new xMovieLibraryIndexing(this);
+    connect(movieLibraryIndexing, &xMovieLibraryIndexing::finished, this, &xMovieLibrary::indexingFinished);
 }
 
 xMovieLibrary::~xMovieLibrary() noexcept {
-    delete movieFiles;
+    stopIndexing();
+    movieLibraryIndexing->wait();
+    movieLibraryScanning->wait();
 }
 
 void xMovieLibrary::setBaseDirectories(const std::list<std::pair<QString,std::filesystem::path>>& base) {
-    movieLibraryScanning->setBaseDirectories(base);
+    // Do not modify a running scan. Rescan after the current scan is finished.
+    if (movieLibraryScanning->isRunning()) {
+        movieLibraryRescan = true;
+        movieLibraryRescanBase = base;
+        return;
+    }
+    // The indexing holds its own snapshot. Stop it anyway, the library is rescanned.
+    stopIndexing();
+    movieLibraryScanning->setBaseDirectories(base, snapshot());
     movieLibraryScanning->start(QThread::IdlePriority);
 }
 
+xMovieSnapshot_t xMovieLibrary::snapshot() const {
+    return std::atomic_load(&movieSnapshot);
+}
+
 void xMovieLibrary::scanForTag(const QString& tag) {
-    auto tagPos = movieFiles->find(tag);
-    if (tagPos != movieFiles->end()) {
+    auto currentSnapshot = snapshot();
+    if (!currentSnapshot) {
+        return;
+    }
+    auto tagPos = currentSnapshot->files.find(tag);
+    if (tagPos != currentSnapshot->files.end()) {
         QStringList dirList;
         for (const auto& dirEntry : tagPos->second) {
             // Ignore the entry for the "." directory.
@@ -147,53 +345,95 @@ void xMovieLibrary::scanForTag(const QString& tag) {
 }
 
 void xMovieLibrary::scanForTagAndDirectory(const QString& tag, const QString& dir) {
-    try {
-        emit scannedMovies((*movieFiles)[tag][dir]);
-    } catch (...) {
-        // Ignore any error. Do not update UI.
-        qCritical() << "Scanning Error for tag: " << tag << ", directory " << dir;
+    auto currentSnapshot = snapshot();
+    if (currentSnapshot) {
+        auto tagPos = currentSnapshot->files.find(tag);
+        if (tagPos != currentSnapshot->files.end()) {
+            auto dirPos = tagPos->second.find(dir);
+            if (dirPos != tagPos->second.end()) {
+                emit scannedMovies(dirPos->second);
+                // The UI replaced its movies. Keep the snapshot of the new movies alive.
+                movieSnapshotShown = currentSnapshot;
+                return;
+            }
+        }
+    }
+    // Ignore any error. Do not update UI.
+    qCritical() << "Scanning Error for tag: " << tag << ", directory " << dir;
+}
+
+std::shared_ptr<xMovieLibraryEntry> xMovieLibrary::findMovie(const QString& tag, const QString& directory, const QString& movie) const {
+    auto currentSnapshot = snapshot();
+    if (currentSnapshot) {
+        auto entry = currentSnapshot->index.find({ tag, directory, movie });
+        if (entry != currentSnapshot->index.end()) {
+            return entry.value();
+        }
+    }
+    return nullptr;
+}
+
+std::list<std::tuple<QString,QString,QString>> xMovieLibrary::findUnknownEntries(
+        const std::list<std::tuple<QString,QString,QString>>& entries) const {
+    std::list<std::tuple<QString,QString,QString>> unknownEntries;
+    auto currentSnapshot = snapshot();
+    for (const auto& [entryTag, entryDirectory, entryMovie] : entries) {
+        if ((!currentSnapshot) || (!currentSnapshot->index.contains({ entryTag, entryDirectory, entryMovie }))) {
+            unknownEntries.emplace_back(entryTag, entryDirectory, entryMovie);
+            qDebug() << "Unknown entry found: " << entryTag << "," << entryDirectory << "," << entryMovie;
+        }
     }
+    return unknownEntries;
 }
 
 void xMovieLibrary::scanForUnknownEntries(const std::list<std::tuple<QString, QString, QString>>& listEntries,
                                           const std::list<std::tuple<QString, QString, QString>>& listCachedEntries) {
-    std::list<std::tuple<QString, QString, QString>> unknownDatabaseEntries;
-    std::list<std::tuple<QString, QString, QString>> unknownCachedLengthEntries;
+    // Send the results.
+    emit scannedUnknownEntries(findUnknownEntries(listEntries), findUnknownEntries(listCachedEntries));
+}
 
-    scanListOfEntries(listEntries, unknownDatabaseEntries);
-    scanListOfEntries(listCachedEntries, unknownCachedLengthEntries);
+void xMovieLibrary::publishSnapshot(const xMovieSnapshot_t& scannedSnapshot) {
+    // Readers holding the previous snapshot continue to use it. It is released afterwards.
+    std::atomic_store(&movieSnapshot, scannedSnapshot);
+    QStringList tagList;
+    for (const auto& tag : scannedSnapshot->files) {
+        tagList.push_back(tag.first);
+    }
+    // Update UI.
+    emit scannedTags(tagList);
+    indexMovies(scannedSnapshot);
+}
 
-    // Send the results.
-    emit scannedUnknownEntries(unknownDatabaseEntries, unknownCachedLengthEntries);
-}
-
-void xMovieLibrary::scanListOfEntries(const std::list<std::tuple<QString, QString, QString>> &listEntries,
-                                      std::list<std::tuple<QString, QString, QString>> &listUnknownEntries) {
-    QString currentTag, currentDirectory;
-    std::vector<xMovieLibraryEntry*> currentMovies;
-    for (const auto& [entryTag, entryDirectory, movie] : listEntries) {
-        // We need to cache the entries if possible. List should be sorted by tag and directory.
-        if ((currentTag != entryTag) || (currentDirectory != entryDirectory)) {
-            currentTag = entryTag;
-            currentDirectory = entryDirectory;
-            try {
-                currentMovies = (*movieFiles)[currentTag][currentDirectory];
-            } catch (...) {
-                // Clear if not found.
-                currentMovies.clear();
-            }
-        }
-        // Make a copy. Capturing movie directly required C++20 support.
-        auto entryMovie = movie;
-        // We need to match the relative path generated by tag/directory/movie with the absolute paths stored.
-        auto currentMoviePos = std::find_if(currentMovies.begin(), currentMovies.end(),
-                                            [&entryMovie](xMovieLibraryEntry* elem) {
-                                                return (elem->getMovieName() == entryMovie);
-                                            });
-        // If we do not find the movie then we append the entry to the unknown list.
-        if (currentMoviePos == currentMovies.end()) {
-            listUnknownEntries.emplace_back(entryTag, entryDirectory, entryMovie);
-            qDebug() << "Unknown entry found: " << entryTag << "," << entryDirectory << "," << entryMovie;
-        }
+void xMovieLibrary::scanningFinished() {
+    // Perform the scan requested while scanning.
+    if (movieLibraryRescan) {
+        movieLibraryRescan = false;
+        setBaseDirectories(movieLibraryRescanBase);
+    }
+}
+
+void xMovieLibrary::indexMovies(const xMovieSnapshot_t& indexSnapshot) {
+    // Do not block the UI. Index the snapshot after the running indexing is stopped.
+    if (movieLibraryIndexing->isRunning()) {
+        movieLibraryReindex = indexSnapshot;
+        movieLibraryIndexing->requestInterruption();
+        return;
+    }
+    movieLibraryIndexing->setSnapshot(indexSnapshot);
+    movieLibraryIndexing->start(QThread::LowestPriority);
+}
+
+void xMovieLibrary::indexingFinished() {
+    if (movieLibraryReindex) {
+        // The finished signal is emitted right before the thread ends. Waiting does not block.
+        movieLibraryIndexing->wait();
+        indexMovies(std::exchange(movieLibraryReindex, nullptr));
+    }
+}
+
+void xMovieLibrary::stopIndexing() {
+    movieLibraryReindex.reset();
+    if (movieLibraryIndexing->isRunning()) {
+        movieLibraryIndexing->requestInterruption();
     }
-}
\ No newline at end of file
+}
@@ -21,10 +21,13 @@
 #include <QStringList>
 #include <QThread>
 #include <QMutex>
+#include <QHash>
 #include <filesystem>
+#include <memory>
+#include <unordered_set>
+#include <string>
 #include <map>
 #include <vector>
-#include "xMovieLibraryEntry.h"
 
 
 /**
@@ -32,20 +35,68 @@
  */
 typedef std::map<QString, std::map<QString, std::vector<xMovieLibraryEntry*>>> xMovieFiles_t;
 
+/**
+ * Key of the movie library index. Combination of tag, directory and movie.
+ */
+struct xMovieLibraryKey {
+    QString tag;
+    QString directory;
+    QString movie;
+
+    bool operator == (const xMovieLibraryKey& key) const {
+        return (tag == key.tag) && (directory == key.directory) && (movie == key.movie);
+    }
+};
+
+inline size_t qHash(const xMovieLibraryKey& key, size_t seed=0) {
+    return qHashMulti(seed, key.tag, key.directory, key.movie);
+}
+
+/**
+ * Typedef for the movie library index. Maps tag, directory and movie to the movie library entry.
+ */
+typedef QHash<xMovieLibraryKey, std::shared_ptr<xMovieLibraryEntry>> xMovieIndex_t;
+
+/**
+ * Immutable snapshot of the movie library.
+ *
+ * The index owns the movie library entries. Entries of unchanged movies are
+ * shared with the previous snapshot. A snapshot is released once the last
+ * reader holding it is done.
+ */
+struct xMovieLibrarySnapshot {
+    // maps directories and files to an assigned tag
+    // files[tag][directory] = files
+    xMovieFiles_t files;
+    xMovieIndex_t index;
+};
+
+/**
+ * Typedef for a shared snapshot of the movie library.
+ */
+typedef std::shared_ptr<const xMovieLibrarySnapshot> xMovieSnapshot_t;
+
 class xMovieLibraryScanning:public QThread {
     Q_OBJECT
 
 public:
-    explicit xMovieLibraryScanning(xMovieFiles_t* movie, QObject* parent=nullptr);
+    explicit xMovieLibraryScanning(QObject* parent=nullptr);
     ~xMovieLibraryScanning() override = default;
     /**
      * Set the base directories with tags for scanning.
      *
      * @param base a list of pairs of tags and filesystem paths.
+     * @param previous the current snapshot. Its entries are reused for unchanged movies.
      */
-    void setBaseDirectories(const std::list<std::pair<QString,std::filesystem::path>>& base);
+    void setBaseDirectories(const std::list<std::pair<QString,std::filesystem::path>>& base,
+                            const xMovieSnapshot_t& previous);
     /**
      * Scan the tag and filesystem paths for movie files.
+     *
+     * The base directories and their subdirectories are scanned in parallel
+     * up to the configured depth. The entry type is taken from the directory
+     * entry if available. Files are only stat'ed if the type is unknown.
+     * A new snapshot with index is created. The current snapshot is not modified.
      */
     void run() override;
 
@@ -53,28 +104,95 @@ signals:
     /**
      * Signal emitted after successful scanning of the movie library.
      *
-     * @param tags the list of tags.
+     * @param snapshot the new snapshot of the movie library.
      */
-    void scannedTags(const QStringList& tags);
+    void scannedSnapshot(const xMovieSnapshot_t& snapshot);
 
 private slots:
     /**
      * Update accepted movie file extensions.
      */
     void updateMovieExtensions();
+    /**
+     * Update the number of directory levels scanned.
+     */
+    void updateMovieScanDepth();
 
 private:
     /**
-     * Determine if the given file is a movie file.
+     * Movie files and subdirectories of a directory.
+     */
+    struct xMovieLibraryDirectory {
+        std::vector<std::string> files;
+        std::vector<std::string> directories;
+    };
+    /**
+     * Movies found in a subdirectory of a base directory.
+     */
+    struct xMovieLibrarySubDirectory {
+        QString tag;
+        QString directory;
+        std::filesystem::path path;
+        std::vector<std::pair<QString,std::filesystem::path>> movies;
+    };
+    /**
+     * Read the movie files and subdirectories of the given directory.
      *
-     * @param file the path to the file checked.
-     * @return true if the file has a movie extension, false otherwise.
+     * @param path the path to the directory.
+     * @param extensions the set of accepted lower case extensions.
+     * @param content the movie file and subdirectory names found.
+     * @return true if the directory could be read, false otherwise.
      */
-    bool isMovieFile(const std::filesystem::path& file);
+    static bool readDirectory(const std::filesystem::path& path, const std::unordered_set<std::string>& extensions,
+                              xMovieLibraryDirectory& content);
+    /**
+     * Scan the subdirectory and its nested directories for movie files.
+     *
+     * @param subDirectory the subdirectory updated with the movies found.
+     * @param relative the path of the nested directory relative to the subdirectory.
+     * @param depth the number of nested directory levels to scan.
+     * @param extensions the set of accepted lower case extensions.
+     */
+    static void scanSubDirectory(xMovieLibrarySubDirectory& subDirectory, const std::filesystem::path& relative,
+                                 int depth, const std::unordered_set<std::string>& extensions);
 
-    xMovieFiles_t* movieFiles;
-    QStringList movieExtensions;
+    QMutex movieExtensionsMutex;
+    std::unordered_set<std::string> movieExtensions;
+    QAtomicInt movieScanDepth;
     std::list<std::pair<QString,std::filesystem::path>> baseDirectories;
+    xMovieSnapshot_t previousSnapshot;
+};
+
+class xMovieLibraryIndexing:public QThread {
+    Q_OBJECT
+
+public:
+    explicit xMovieLibraryIndexing(QObject* parent=nullptr);
+    ~xMovieLibraryIndexing() override = default;
+    /**
+     * Set the movies to be indexed.
+     *
+     * @param snapshot the snapshot of the movie library. Held until the indexing is done.
+     */
+    void setSnapshot(const xMovieSnapshot_t& snapshot);
+    /**
+     * Update the movie catalog for all movies without valid entry.
+     *
+     * Length, chapters, stream languages and thumbnails are recorded. The
+     * indexing is stopped upon an interruption request.
+     */
+    void run() override;
+
+signals:
+    /**
+     * Signal emitted after indexing of the movie library.
+     *
+     * @param indexed the number of movies added to or updated in the catalog.
+     */
+    void indexedMovies(int indexed);
+
+private:
+    xMovieSnapshot_t indexingSnapshot;
 };
 
 class xMovieLibrary:public QObject {
@@ -88,11 +206,44 @@ public:
      *
      * A certain structure of the movie library is expected.
      * The movie library is scanned in a thread using the
-     * movie library scanning class.
+     * movie library scanning class. The movie catalog is
+     * updated in a background thread after the scan. A scan
+     * requested during a running scan is performed afterwards.
      *
      * @param base list of pairs of tag and filesystem path for movies.
      */
     void setBaseDirectories(const std::list<std::pair<QString,std::filesystem::path>>& base);
+    /**
+     * Return the current snapshot of the movie library.
+     *
+     * The snapshot is immutable and can be read from any thread. It remains
+     * valid as long as it is held, even if a new snapshot has been published.
+     *
+     * @return the shared snapshot, nullptr if the library has not been scanned.
+     */
+    [[nodiscard]] xMovieSnapshot_t snapshot() const;
+    /**
+     * Find the movie library entry for the given tag, directory and movie.
+     *
+     * The lookup does not modify the movie library. The entry is shared with
+     * the current snapshot and remains valid after a new snapshot is published.
+     *
+     * @param tag the tag of the movie.
+     * @param directory the directory of the movie.
+     * @param movie the movie name.
+     * @return shared pointer to the movie library entry, nullptr if not found.
+     */
+    [[nodiscard]] std::shared_ptr<xMovieLibraryEntry> findMovie(const QString& tag, const QString& directory, const QString& movie) const;
+    /**
+     * Determine the entries that are not in the movie library.
+     *
+     * Each entry is looked up in the movie library index. The entries do not need to be sorted.
+     *
+     * @param entries the list of tuples of tag, directory and movie to verify.
+     * @return the list of tuples of tag, directory and movie not found.
+     */
+    [[nodiscard]] std::list<std::tuple<QString,QString,QString>> findUnknownEntries(
+            const std::list<std::tuple<QString,QString,QString>>& entries) const;
 
 signals:
     /**
@@ -150,21 +301,44 @@ public slots:
 
 private:
     /**
-     * Check a list of tag/directory/movie entries and record unknown entries.
+     * Publish the new snapshot. Called after scanning in the library thread.
+     *
+     * @param snapshot the new snapshot of the movie library.
+     */
+    void publishSnapshot(const xMovieSnapshot_t& snapshot);
+    /**
+     * Start a scan requested during the last scan. Called after the scanning thread finished.
+     */
+    void scanningFinished();
+    /**
+     * Start the indexing of all movies in the given snapshot.
      *
-     * @param listEntries the list of entries to verify.
-     * @param listUnknownEntries add unknown entries to existing list (do not clear).
+     * @param snapshot the snapshot of the movie library.
      */
-    void scanListOfEntries(const std::list<std::tuple<QString, QString, QString>>& listEntries,
-                           std::list<std::tuple<QString, QString, QString>>& listUnknownEntries);
+    void indexMovies(const xMovieSnapshot_t& snapshot);
+    /**
+     * Start the indexing requested during the last indexing. Called after the indexing thread finished.
+     */
+    void indexingFinished();
+    /**
+     * Request the indexing to stop. Does not wait for the thread to finish.
+     */
+    void stopIndexing();
 
-    // maps directories and files to an assigned tag
-    // movieFiles[tag][directory] = files
-    xMovieFiles_t* movieFiles;
+    // Use std::atomic_load/std::atomic_store to access the current snapshot.
+    xMovieSnapshot_t movieSnapshot;
+    // The snapshot whose movies were sent last. The UI may still use its entries.
+    xMovieSnapshot_t movieSnapshotShown;
     xMovieLibraryScanning* movieLibraryScanning;
+    xMovieLibraryIndexing* movieLibraryIndexing;
+    bool movieLibraryRescan;
+    std::list<std::pair<QString,std::filesystem::path>> movieLibraryRescanBase;
+    // Snapshot to be indexed after the running indexing is stopped.
+    xMovieSnapshot_t movieLibraryReindex;
 };
 
 Q_DECLARE_METATYPE(xMovieLibraryEntry)
+Q_DECLARE_METATYPE(xMovieSnapshot_t)
 // Q_DECLARE_METATYPE(xMovieLibraryEntry*)
 
 #endif
@@ -13,11 +13,9 @@
  */
 
 #include "xMovieLibraryEntry.h"
+#include "xMovieLengthProber.h"
 #include "xPlayerDatabase.h"
 
-#include <vlc/vlc.h>
-
-#include <QThread>
 #include <QDebug>
 
 xMovieLibraryEntry::xMovieLibraryEntry():
@@ -27,7 +25,8 @@ xMovieLibraryEntry::xMovieLibraryEntry():
         entryMovie(),
         entryPath(),
         entryLength(0),
-        entrySize(0) {
+        entrySize(0),
+        entryModified(0) {
 }
 
 xMovieLibraryEntry::xMovieLibraryEntry(const QString& tag, const QString& directory,
@@ -38,7 +37,8 @@ xMovieLibraryEntry::xMovieLibraryEntry(const QString& tag, const QString& direct
         entryMovie(movie),
         entryPath(moviePath),
         entryLength(-1),
-        entrySize(-1) {
+        entrySize(-1),
+        entryModified(0) {
 }
 
 xMovieLibraryEntry::xMovieLibraryEntry(const xMovieLibraryEntry& entry):
@@ -47,8 +47,9 @@ xMovieLibraryEntry::xMovieLibraryEntry(const xMovieLibraryEntry& entry):
         entryDirectory(entry.entryDirectory),
         entryMovie(entry.entryMovie),
         entryPath(entry.entryPath),
-        entryLength(entry.entryLength),
-        entrySize(entry.entrySize) {
+        entryLength(entry.entryLength.load()),
+        entrySize(entry.entrySize.load()),
+        entryModified(entry.entryModified.load()) {
 }
 
 const QString& xMovieLibraryEntry::getTagName() const {
@@ -73,63 +74,66 @@ qint64 xMovieLibraryEntry::getLength() const {
     return entryLength;
 }
 
+qint64 xMovieLibraryEntry::getLength(int requester) const {
+    scan(requester);
+    return entryLength;
+}
+
 const std::filesystem::path& xMovieLibraryEntry::getPath() const {
     return entryPath;
 }
 
-void xMovieLibraryEntry::scan() const {
+void xMovieLibraryEntry::scan(int requester) const {
     if ((entrySize > 0) && (entryLength > 0)) {
         return;
     }
-    // Determine file size.
-    try {
-        entrySize = std::filesystem::file_size(entryPath);
-    } catch (const std::filesystem::filesystem_error& error) {
-        qCritical() << "Unable to access track: "
-                    << QString::fromStdString(entryPath.generic_string()) << ", error: " << error.what();
+    // Determine file size. Concurrent scans compute the same values.
+    std::uintmax_t size;
+    qint64 modified;
+    if (!fileStatus(size, modified)) {
         entrySize = static_cast<std::uintmax_t>(-1);
         entryLength = -1;
         return;
     }
-
+    entryModified = modified;
+    entrySize = size;
     auto [movieSize, movieLength] = xPlayerDatabase::database()->getMovieFileLength(entryTag, entryDirectory, entryMovie);
-    if ((entrySize == static_cast<std::uintmax_t>(movieSize)) && (movieLength > 0)) {
+    if ((size == static_cast<std::uintmax_t>(movieSize)) && (movieLength > 0)) {
         entryLength = movieLength;
         return;
     }
-    // Determine movie length. Use VLC without video output.
-    // Only instantiate VLC once for movie file entries.
-    static const char* const vlcArgs[] = { "--vout=none", "--quiet" };
-    static auto vlcInstance = libvlc_new(sizeof(vlcArgs)/sizeof(vlcArgs[0]), vlcArgs);
-    auto vlcMedia = libvlc_media_new_path(vlcInstance, entryPath.generic_string().c_str());
-    libvlc_media_parse_with_options(vlcMedia, libvlc_media_parse_network, 1000);
-    auto vlcStatus = libvlc_media_get_parsed_status(vlcMedia);
-    // Wait until parsing complete. Wait for 10 seconds maximum.
-    for (auto vlcStatusLoop = 0; (vlcStatus != libvlc_media_parsed_status_done) &&
-                                 (vlcStatus != libvlc_media_parsed_status_failed) &&
-                                 (vlcStatusLoop < 50); ++vlcStatusLoop) {
-        // Break out of loop if requested.
-        if (QThread::currentThread()->isInterruptionRequested()) {
-            // Release media and vlc instance.
-            libvlc_media_release(vlcMedia);
-            // Reset entrySize to allow scan.
-            entrySize = -1;
-            return;
-        }
-        // Wait for 200ms.
-        QThread::msleep(200);
-        vlcStatus = libvlc_media_get_parsed_status(vlcMedia);
-    }
-    entryLength = static_cast<qint64>(libvlc_media_get_duration(vlcMedia));
-    // Release media and vlc instance.
-    libvlc_media_release(vlcMedia);
-    qDebug() << "Scan: length: " << entryLength << ", size: " << entrySize;
-    if (entryLength > 0) {
+    // Determine movie length. The prober uses a shared VLC instance.
+    auto length = xMovieLengthProber::prober()->probe(entryPath, requester);
+    entryLength = length;
+    qDebug() << "Scan: length: " << length << ", size: " << size;
+    if (length > 0) {
         // We only record non-zero length.
-        xPlayerDatabase::database()->updateMovieFileLength(entryTag, entryDirectory, entryMovie, static_cast<qint64>(entrySize), entryLength);
+        xPlayerDatabase::database()->updateMovieFileLength(entryTag, entryDirectory, entryMovie, static_cast<qint64>(size), length);
     }
 }
 
 bool xMovieLibraryEntry::isScanned() const {
     return (entryLength > 0);
+}
+
+bool xMovieLibraryEntry::isUpToDate() const {
+    // Nothing is cached if the file status has not been determined.
+    if (entryModified == 0) {
+        return true;
+    }
+    std::uintmax_t size;
+    qint64 modified;
+    return (fileStatus(size, modified)) && (size == entrySize) && (modified == entryModified);
+}
+
+bool xMovieLibraryEntry::fileStatus(std::uintmax_t& size, qint64& modified) const {
+    try {
+        size = std::filesystem::file_size(entryPath);
+        modified = static_cast<qint64>(std::filesystem::last_write_time(entryPath).time_since_epoch().count());
+        return true;
+    } catch (const std::filesystem::filesystem_error& error) {
+        qCritical() << "Unable to access movie: "
+                    << QString::fromStdString(entryPath.generic_string()) << ", error: " << error.what();
+    }
+    return false;
 }
\ No newline at end of file
@@ -16,11 +16,20 @@
 #define __XMOVIELIBRARYENTRY_H__
 
 #include <QObject>
+#include <atomic>
 #include <filesystem>
+#include <memory>
 #include <vector>
 
 
-class xMovieLibraryEntry:public QObject {
+/**
+ * Movie file of the movie library.
+ *
+ * Entries are owned by the movie library snapshots through shared pointers and are
+ * shared between snapshots. The scanned size and length are cached and may be
+ * updated concurrently from worker threads.
+ */
+class xMovieLibraryEntry:public QObject, public std::enable_shared_from_this<xMovieLibraryEntry> {
 public:
     xMovieLibraryEntry();
     xMovieLibraryEntry(const QString& tag, const QString& directory,
@@ -61,6 +70,15 @@ public:
      * @return the length in ms as integer.
      */
     [[nodiscard]] qint64 getLength() const;
+    /**
+     * Retrieve the length of the movie file on behalf of a requester.
+     *
+     * A running length probe is stopped if the requester cancels its probes.
+     *
+     * @param requester the requester id of the movie length prober.
+     * @return the length in ms as integer.
+     */
+    [[nodiscard]] qint64 getLength(int requester) const;
     /**
      * Get the path for the movie file.
      *
@@ -73,16 +91,32 @@ public:
      * @return true if the movie has been scanned, false otherwise.
      */
     [[nodiscard]] bool isScanned() const;
+    /**
+     * Verify if the cached size and length are still valid for the movie file.
+     *
+     * @return true if the movie has not been scanned or its size and modification time are unchanged.
+     */
+    [[nodiscard]] bool isUpToDate() const;
 
 protected:
-    void scan() const;
+    void scan(int requester=0) const;
+    /**
+     * Determine the size and modification time of the movie file.
+     *
+     * @param size the file size in bytes.
+     * @param modified the modification time.
+     * @return true if the file is accessible, false otherwise.
+     */
+    bool fileStatus(std::uintmax_t& size, qint64& modified) const;
 
     QString entryTag;
     QString entryDirectory;
     QString entryMovie;
     std::filesystem::path entryPath;
-    mutable qint64 entryLength;
-    mutable std::uintmax_t entrySize;
+    // Updated by the workers computing the length.
+    mutable std::atomic<qint64> entryLength;
+    mutable std::atomic<std::uintmax_t> entrySize;
+    mutable std::atomic<qint64> entryModified;
 };
 
 
@@ -16,6 +16,7 @@
 #include "xPlayerUI.h"
 #include "xPlayerConfiguration.h"
 #include "xPlayerDatabase.h"
+#include "xMovieResumePositions.h"
 
 #include <QAudioOutput>
 #include <QAudioDevice>
@@ -25,11 +26,16 @@
 #include <QMouseEvent>
 #include <QCheckBox>
 #include <QTimer>
+#include <QThreadPool>
 #include <QDebug>
+#include <algorithm>
 #include <cmath>
 
 #include <vlc/vlc.h>
 
+// Remaining time of the current movie in ms at which the next movie is prefetched.
+constexpr qint64 xMoviePlayer_PrefetchTime = 180000;
+
 std::list<std::pair<QString,xMoviePlayer::AspectRatio>> xMoviePlayer::supportedAspectRatio() {
     return {
         {"Keep", xMoviePlayer::RatioKeep},
@@ -45,7 +51,9 @@ xMoviePlayer::xMoviePlayer(QWidget *parent):
         movieMediaChapter(0),
         movieMediaFullWindow(false),
         movieTickConnected(false),
+        movieFastSeek(false),
         movieCurrentPosition(0),
+        movieResumePosition(0),
         movieCurrentPlayed(0),
         moviePlayed(-1),
         movieCurrentSkip(false),
@@ -64,7 +72,10 @@ xMoviePlayer::xMoviePlayer(QWidget *parent):
     moviePlayer->setAudioOutput(audioOutput);
 
     // Setup the media player.
-    connect(moviePlayer, &QMediaPlayer::positionChanged, this, &xMoviePlayer::updatedPosition);
+    // Coalesce the position updates. QMediaPlayer may report a new position for each frame.
+    moviePositionTracker = new xPlayerPositionTracker(this);
+    connect(moviePlayer, &QMediaPlayer::positionChanged, moviePositionTracker, &xPlayerPositionTracker::tick);
+    connect(moviePositionTracker, &xPlayerPositionTracker::position, this, &xMoviePlayer::updatedPosition);
     connect(moviePlayer, &QMediaPlayer::durationChanged, [=](qint64 totalTime) {
         movieMediaLength = totalTime;
         qDebug() << "xMoviePlayer: totalTime: " << totalTime;
@@ -133,7 +144,8 @@ void xMoviePlayer::playPause() {
 void xMoviePlayer::playChapter(int chapter) {
     if ((chapter >= 0) && (chapter < movieMediaChapterBegin.count())) {
         qDebug() << "xMoviePlayer: playChapter:: " << chapter;
-        seek(movieMediaChapterBegin[chapter]);
+        // Chapters are not snapped to key frames.
+        moviePlayer->setPosition(movieMediaChapterBegin[chapter]);
         moviePlayer->play();
         movieCurrentSkip = true;
         emit currentState(moviePlayerState = State::PlayingState);
@@ -169,7 +181,7 @@ void xMoviePlayer::nextChapter() {
 
 void xMoviePlayer::seek(qint64 position) {
     movieCurrentSkip = true;
-    moviePlayer->setPosition(position);
+    moviePlayer->setPosition(seekPosition(position, 0));
     updateCurrentChapter();
 }
 
@@ -180,7 +192,7 @@ void xMoviePlayer::jump(qint64 delta) {
     qint64 currentLength = moviePlayer->duration() - 100;
     movieCurrentSkip = true;
     moviePlayer->play();
-    moviePlayer->setPosition(std::clamp(currentPosition, static_cast<qint64>(0), currentLength));
+    moviePlayer->setPosition(std::clamp(seekPosition(currentPosition, delta), static_cast<qint64>(0), currentLength));
     emit currentState(moviePlayerState = State::PlayingState);
     updateCurrentChapter();
 }
@@ -191,6 +203,9 @@ void xMoviePlayer::stop() {
     moviePlayer->stop();
     // Reset the current position.
     movieCurrentPosition = 0;
+    movieResumePosition = 0;
+    moviePositionTracker->reset();
+    xMovieResumePositions::positions()->flush();
     // Update states.
     emit currentState(moviePlayerState = State::StopState);
     emit currentMoviePlayed(0);
@@ -208,9 +223,14 @@ void xMoviePlayer::setMovie(const std::filesystem::path& path, const QString& na
     movieCurrent = std::make_pair(path, name);
     movieCurrentTag = tag;
     movieCurrentDirectory = directory;
-    // Analyze movie file.
+    moviePrefetched.clear();
+    moviePositionTracker->reset();
+    // Analyze movie file. Uses the cached info if the movie was prefetched.
     movieFile->analyze(filePath);
     movieMediaChapterBegin = movieFile->getChapterBegin();
+    movieMediaKeyFrames = movieFile->getKeyFrames();
+    // Resume partially watched movies once the media is loaded.
+    movieResumePosition = xMovieResumePositions::positions()->getPosition(filePath);
     // Set current movie.
     moviePlayer->setSource(QUrl::fromLocalFile(filePath));
     moviePlayer->play();
@@ -232,6 +252,14 @@ void xMoviePlayer::setAspectRatio(xMoviePlayer::AspectRatio aspectRatio) {
     setAspectRatioMode(static_cast<Qt::AspectRatioMode>(aspectRatio));
 }
 
+void xMoviePlayer::setFastSeek(bool enabled) {
+    movieFastSeek = enabled;
+}
+
+bool xMoviePlayer::getFastSeek() const {
+    return movieFastSeek;
+}
+
 void xMoviePlayer::availableAudioChannels() {
     QStringList audioChannels;
     // Process audio channels
@@ -318,6 +346,10 @@ void xMoviePlayer::updatedPosition(qint64 movieMediaPos) {
     if (std::abs(movieMediaPos - movieCurrentPosition) < xPlayer::MovieTickDeltaIgnore) {
         return;
     }
+    prefetchNextMovie(movieMediaPos);
+    // Record the resume position in memory. The database is updated in batches.
+    xMovieResumePositions::positions()->updatePosition(QString::fromStdString(movieCurrent.first.string()), movieCurrentTag,
+                                                       movieCurrentDirectory, movieCurrent.second, movieMediaPos, movieMediaLength);
     qDebug() << "xMovie: updatedPosition:: " << movieMediaPos << ", currentPlayed: " << movieCurrentPlayed << ", currentPos: " << movieCurrentPosition;
 
     // Update played time and current position.
@@ -340,18 +372,23 @@ void xMoviePlayer::updatedPosition(qint64 movieMediaPos) {
                 update = (movieCurrentPlayed >= moviePlayed);
             }
             if (update) {
-                // Update database.
+                // Update database on the worker thread. Reset the recorded state on failure.
                 auto name = movieCurrent.second;
-                auto result = xPlayerDatabase::database()->updateMovieFile(movieCurrentTag, movieCurrentDirectory, name);
-
-                qDebug() << "xMovie: updatedPosition: db: " << movieCurrentTag << "," << movieCurrentDirectory << "," << name;
-                qDebug() << "xMovie: updatedPosition: db: " << result;
-                if (result.second > 0) {
-                    // Update database overlay.
-                    emit updatePlayedMovie(movieCurrentTag, movieCurrentDirectory,
-                                           name, result.first, result.second);
-                    moviePlayedRecorded = true;
-                }
+                auto tag = movieCurrentTag;
+                auto directory = movieCurrentDirectory;
+                moviePlayedRecorded = true;
+                qDebug() << "xMovie: updatedPosition: db: " << tag << "," << directory << "," << name;
+                moviePositionTracker->record([tag, directory, name]() {
+                    return xPlayerDatabase::database()->updateMovieFile(tag, directory, name);
+                }, [this, tag, directory, name](const std::pair<int,qint64>& result) {
+                    qDebug() << "xMovie: updatedPosition: db: " << result;
+                    if (result.second > 0) {
+                        // Update database overlay.
+                        emit updatePlayedMovie(tag, directory, name, result.first, result.second);
+                    } else if ((movieCurrentTag == tag) && (movieCurrentDirectory == directory) && (movieCurrent.second == name)) {
+                        moviePlayedRecorded = false;
+                    }
+                });
             }
         } else {
             qCritical() << "xMoviePlayer::updatedPosition: illegal movie positions: "
@@ -376,7 +413,17 @@ void xMoviePlayer::aboutToFinish() {
 
 void xMoviePlayer::updatedMediaStatus(QMediaPlayer::MediaStatus status) {
     qDebug() << "xMoviePlayer: media status: " << status;
+    if ((status == QMediaPlayer::LoadedMedia) && (movieResumePosition > 0)) {
+        // Start at the previous key frame. No decoding up to the exact resume position is required.
+        qDebug() << "xMoviePlayer: resume: " << movieResumePosition;
+        movieCurrentSkip = true;
+        moviePlayer->setPosition(keyFramePosition(movieResumePosition, -1));
+        movieResumePosition = 0;
+        updateCurrentChapter();
+    }
     if (status == QMediaPlayer::EndOfMedia) {
+        // The movie was watched completely.
+        xMovieResumePositions::positions()->removePosition(QString::fromStdString(movieCurrent.first.string()));
         if (movieQueue.isEmpty()) {
             emit currentState(moviePlayerState = xMoviePlayer::StoppingState);
             stop();
@@ -411,13 +458,9 @@ void xMoviePlayer::updatedAudioDeviceId() {
 void xMoviePlayer::updateCurrentChapter() {
     if (movieMediaChapterBegin.count() > 0) {
         qint64 currentPosition = moviePlayer->position();
-        int chapter = static_cast<int>(movieMediaChapterBegin.count())-1;
-        while (chapter >= 0) {
-            if (movieMediaChapterBegin[chapter] < currentPosition) {
-                break;
-            }
-            --chapter;
-        }
+        // The current chapter is the last one beginning before the current position.
+        auto next = std::lower_bound(movieMediaChapterBegin.begin(), movieMediaChapterBegin.end(), currentPosition);
+        auto chapter = static_cast<int>(std::distance(movieMediaChapterBegin.begin(), next))-1;
         if (movieMediaChapter != chapter) {
             // Update current chapter.
             movieMediaChapter = chapter;
@@ -427,6 +470,52 @@ void xMoviePlayer::updateCurrentChapter() {
     }
 }
 
+qint64 xMoviePlayer::seekPosition(qint64 position, qint64 direction) const {
+    return (movieFastSeek) ? keyFramePosition(position, direction) : position;
+}
+
+qint64 xMoviePlayer::keyFramePosition(qint64 position, qint64 direction) const {
+    if (movieMediaKeyFrames.isEmpty()) {
+        return position;
+    }
+    // First key frame at or after the position.
+    auto next = std::lower_bound(movieMediaKeyFrames.begin(), movieMediaKeyFrames.end(), position);
+    if ((next != movieMediaKeyFrames.end()) && (*next == position)) {
+        return position;
+    }
+    auto previous = (next != movieMediaKeyFrames.begin()) ? std::prev(next) : movieMediaKeyFrames.end();
+    if (direction < 0) {
+        return (previous != movieMediaKeyFrames.end()) ? *previous : position;
+    }
+    if (direction > 0) {
+        return (next != movieMediaKeyFrames.end()) ? *next : position;
+    }
+    if (next == movieMediaKeyFrames.end()) {
+        return *previous;
+    }
+    if (previous == movieMediaKeyFrames.end()) {
+        return *next;
+    }
+    return ((position - *previous) <= (*next - position)) ? *previous : *next;
+}
+
+void xMoviePlayer::prefetchNextMovie(qint64 position) {
+    if ((movieQueue.isEmpty()) || (movieMediaLength <= 0) || (movieMediaLength - position > xMoviePlayer_PrefetchTime)) {
+        return;
+    }
+    // The queue may be modified after the prefetch. Compare with the current next movie.
+    const auto& nextMovie = movieQueue.first().first;
+    if (nextMovie == moviePrefetched) {
+        return;
+    }
+    moviePrefetched = nextMovie;
+    auto nextMovieFile = QString::fromStdString(nextMovie.string());
+    qDebug() << "xMoviePlayer: prefetch: " << nextMovieFile;
+    QThreadPool::globalInstance()->start(QRunnable::create([nextMovieFile]() {
+        xMovieFile::prefetch(nextMovieFile);
+    }));
+}
+
 void xMoviePlayer::keyPressEvent(QKeyEvent *keyEvent) {
     switch (keyEvent->key()) {
         case Qt::Key_Escape: {
@@ -17,6 +17,7 @@
 
 #include "xPlayerPulseAudioControls.h"
 #include "xMovieFile.h"
+#include "xPlayerPositionTracker.h"
 
 #include <QMediaPlayer>
 #include <QVideoWidget>
@@ -76,6 +77,12 @@ public:
      * @return a list of pairs (label, mode) of aspect ratio.
      */
     [[nodiscard]] static std::list<std::pair<QString,xMoviePlayer::AspectRatio>> supportedAspectRatio();
+    /**
+     * Return the state of the fast seek mode.
+     *
+     * @return true if seek and jump positions are snapped to key frames, false otherwise.
+     */
+    [[nodiscard]] bool getFastSeek() const;
 
 signals:
     /**
@@ -259,6 +266,15 @@ public slots:
      * @param index the index of the subtitle.
      */
     void selectSubtitle(int index);
+    /**
+     * Set the fast seek mode.
+     *
+     * Seek and jump positions are snapped to the key frames of the current movie
+     * if enabled. The playback can then start without decoding up to the exact position.
+     *
+     * @param enabled enable fast seek if true, disable otherwise.
+     */
+    void setFastSeek(bool enabled);
 
 private slots:
     /**
@@ -286,7 +302,7 @@ private slots:
      */
     void aboutToFinish();
     /**
-     * Called if tick has been changed.
+     * Called with the coalesced position updates of the movie player.
      */
     void updatedPosition(qint64 position);
     /**
@@ -333,22 +349,49 @@ private:
      * Update the current chapter index.
      */
     void updateCurrentChapter();
+    /**
+     * Determine the position used for seeking within the current movie.
+     *
+     * @param position the requested position in ms.
+     * @param direction snap to the previous key frame if negative, to the next if positive, nearest otherwise.
+     * @return the key frame position if fast seek is enabled, the requested position otherwise.
+     */
+    [[nodiscard]] qint64 seekPosition(qint64 position, qint64 direction) const;
+    /**
+     * Determine the key frame position for the given position within the current movie.
+     *
+     * @param position the requested position in ms.
+     * @param direction snap to the previous key frame if negative, to the next if positive, nearest otherwise.
+     * @return the key frame position, the requested position if no key frames are known.
+     */
+    [[nodiscard]] qint64 keyFramePosition(qint64 position, qint64 direction) const;
+    /**
+     * Prefetch the next movie in the queue if the current movie is about to end.
+     *
+     * @param position the current position in the movie in ms.
+     */
+    void prefetchNextMovie(qint64 position);
 
     xPlayerPulseAudioControls* pulseAudioControls;
     xMovieFile* movieFile;
     QMediaPlayer* moviePlayer;
+    xPlayerPositionTracker* moviePositionTracker;
     QAudioOutput* audioOutput;
     xMoviePlayer::State moviePlayerState;
     QList<QMediaMetaData> subtitlesMetaData;
     QList<QMediaMetaData> audioChannelsMetaData;
     QList<std::pair<std::filesystem::path,QString>> movieQueue;
+    std::filesystem::path moviePrefetched;
     qint64 movieMediaLength;
     QVector<qint64> movieMediaChapterBegin;
+    QVector<qint64> movieMediaKeyFrames;
     int movieMediaChapter;
     QString movieMediaCropAspectRatio;
     bool movieMediaFullWindow;
     bool movieTickConnected;
+    bool movieFastSeek;
     qint64 movieCurrentPosition;
+    qint64 movieResumePosition;
     qint64 movieCurrentPlayed;
     qint64 moviePlayed;
     bool movieCurrentSkip;
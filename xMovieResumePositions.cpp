@@ -0,0 +1,131 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xMovieResumePositions.h"
+#include "xPlayerDatabase.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+
+#include <algorithm>
+
+// Delay in ms after the first update until the positions are written to the database.
+constexpr auto xMovieResumePositions_FlushDelay = 30000;
+// Positions within the first minute are ignored.
+constexpr qint64 xMovieResumePositions_MinPosition = 60000;
+// Positions within the last two minutes or 5% are considered as watched.
+constexpr qint64 xMovieResumePositions_EndDelta = 120000;
+constexpr qint64 xMovieResumePositions_EndRatio = 20;
+
+xMovieResumePositions* xMovieResumePositions::movieResumePositions = nullptr;
+
+xMovieResumePositions::xMovieResumePositions():
+        QObject(),
+        resumePositions(),
+        resumeUpdated() {
+    for (const auto& position : xPlayerDatabase::database()->getMovieResumePositions()) {
+        resumePositions.insert(position.path, position);
+    }
+    resumeFlushTimer = new QTimer(this);
+    resumeFlushTimer->setSingleShot(true);
+    resumeFlushTimer->setInterval(xMovieResumePositions_FlushDelay);
+    connect(resumeFlushTimer, &QTimer::timeout, this, &xMovieResumePositions::flush);
+    // Do not lose the latest updates.
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &xMovieResumePositions::flush);
+}
+
+xMovieResumePositions* xMovieResumePositions::positions() {
+    // Create and return singleton.
+    if (movieResumePositions == nullptr) {
+        movieResumePositions = new xMovieResumePositions();
+    }
+    return movieResumePositions;
+}
+
+qint64 xMovieResumePositions::getPosition(const QString& path) const {
+    auto position = resumePositions.find(path);
+    return (position != resumePositions.end()) ? position->position : 0;
+}
+
+void xMovieResumePositions::updatePosition(const QString& path, const QString& tag, const QString& directory,
+                                           const QString& movie, qint64 position, qint64 length) {
+    if (length <= 0) {
+        return;
+    }
+    // Ignore the beginning. Positions of 0 are reported on stop or while a movie is loaded.
+    if (position < xMovieResumePositions_MinPosition) {
+        return;
+    }
+    // Play movies from the start if almost all of it was watched.
+    if (position > length-std::max(xMovieResumePositions_EndDelta, length/xMovieResumePositions_EndRatio)) {
+        removePosition(path);
+        return;
+    }
+    auto& resumePosition = resumePositions[path];
+    resumePosition.path = path;
+    resumePosition.tag = tag;
+    resumePosition.directory = directory;
+    resumePosition.movie = movie;
+    resumePosition.position = position;
+    resumePosition.length = length;
+    resumePosition.timeStamp = QDateTime::currentMSecsSinceEpoch();
+    markUpdated(path);
+}
+
+void xMovieResumePositions::removePosition(const QString& path) {
+    if (resumePositions.remove(path) > 0) {
+        markUpdated(path);
+    }
+}
+
+QList<xMovieResumePosition> xMovieResumePositions::continueWatching(int limit) const {
+    QList<xMovieResumePosition> watching(resumePositions.begin(), resumePositions.end());
+    std::sort(watching.begin(), watching.end(), [](const xMovieResumePosition& a, const xMovieResumePosition& b) {
+        return a.timeStamp > b.timeStamp;
+    });
+    if ((limit >= 0) && (watching.size() > limit)) {
+        watching.erase(watching.begin()+limit, watching.end());
+    }
+    return watching;
+}
+
+void xMovieResumePositions::flush() {
+    resumeFlushTimer->stop();
+    if (resumeUpdated.isEmpty()) {
+        return;
+    }
+    QList<xMovieResumePosition> positions;
+    for (const auto& path : resumeUpdated) {
+        auto position = resumePositions.find(path);
+        if (position != resumePositions.end()) {
+            positions.push_back(position.value());
+        } else {
+            // Removed positions are written with position 0.
+            xMovieResumePosition removed;
+            removed.path = path;
+            positions.push_back(removed);
+        }
+    }
+    resumeUpdated.clear();
+    qDebug() << "xMovieResumePositions: flush: " << positions.size();
+    xPlayerDatabase::database()->updateMovieResumePositions(positions);
+}
+
+void xMovieResumePositions::markUpdated(const QString& path) {
+    resumeUpdated.insert(path);
+    if (!resumeFlushTimer->isActive()) {
+        resumeFlushTimer->start();
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XMOVIERESUMEPOSITIONS_H__
+#define __XMOVIERESUMEPOSITIONS_H__
+
+#include "xPlayerTypes.h"
+
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+#include <QSet>
+
+/**
+ * Store the resume positions of partially watched movies.
+ *
+ * All positions are kept in memory for instant lookup. Updates are collected
+ * and written to the database in batches, at the latest when the application quits.
+ * The store is only accessed from the GUI thread.
+ */
+class xMovieResumePositions:public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * Return the movie resume positions.
+     *
+     * @return pointer to a singleton of the resume positions.
+     */
+    [[nodiscard]] static xMovieResumePositions* positions();
+    /**
+     * Return the resume position for the given movie file.
+     *
+     * @param path the path to the movie file.
+     * @return the resume position in ms, 0 if the movie should be played from the start.
+     */
+    [[nodiscard]] qint64 getPosition(const QString& path) const;
+    /**
+     * Update the resume position for the given movie file.
+     *
+     * Positions close to the start of the movie are ignored. Positions close to
+     * the end remove the resume position.
+     *
+     * @param path the path to the movie file.
+     * @param tag the tag for the movie file.
+     * @param directory the directory for the movie file.
+     * @param movie the name of the movie file.
+     * @param position the current position in ms.
+     * @param length the length of the movie in ms.
+     */
+    void updatePosition(const QString& path, const QString& tag, const QString& directory, const QString& movie,
+                        qint64 position, qint64 length);
+    /**
+     * Remove the resume position for the given movie file.
+     *
+     * @param path the path to the movie file.
+     */
+    void removePosition(const QString& path);
+    /**
+     * Return the partially watched movies of all tags.
+     *
+     * @param limit the maximal number of movies returned, all if negative.
+     * @return a list of resume positions sorted by time stamp, most recent first.
+     */
+    [[nodiscard]] QList<xMovieResumePosition> continueWatching(int limit=-1) const;
+
+public slots:
+    /**
+     * Write all updated resume positions to the database.
+     */
+    void flush();
+
+private:
+    xMovieResumePositions();
+    ~xMovieResumePositions() override = default;
+    /**
+     * Mark the resume position as updated and schedule the database write.
+     *
+     * @param path the path to the movie file.
+     */
+    void markUpdated(const QString& path);
+
+    QHash<QString,xMovieResumePosition> resumePositions;
+    QSet<QString> resumeUpdated;
+    QTimer* resumeFlushTimer;
+    static xMovieResumePositions* movieResumePositions;
+};
+
+#endif
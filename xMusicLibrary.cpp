@@ -23,8 +23,58 @@
 #include <QDebug>
 
 #include <filesystem>
+#include <algorithm>
 #include <unistd.h>
 
+// Number of differences reported together by compare.
+constexpr size_t xMusicLibrary_CompareBatchSize = 1000;
+
+/**
+ * Compare two entry names. Names equal except for case are ordered case-sensitive.
+ */
+static int xMusicLibrary_compareNames(const QString& a, const QString& b) {
+    auto result = a.compare(b, Qt::CaseInsensitive);
+    return (result != 0) ? result : a.compare(b, Qt::CaseSensitive);
+}
+
+/**
+ * Walk two vectors of entries as merged streams sorted by name.
+ *
+ * The entries of the libraries are sorted case-insensitive. The vectors are
+ * only sorted again if names equal except for case are not in order. The
+ * names of the first vector may be mapped by a separate name function.
+ */
+template<typename Entry, typename FirstName, typename SecondName, typename OnlyFirst, typename OnlySecond, typename Both>
+static void xMusicLibrary_merge(std::vector<Entry*> first, std::vector<Entry*> second, FirstName firstName,
+                                SecondName secondName, OnlyFirst onlyFirst, OnlySecond onlySecond, Both both) {
+    auto firstLessThan = [&firstName](Entry* a, Entry* b) {
+        return xMusicLibrary_compareNames(firstName(a), firstName(b)) < 0;
+    };
+    auto secondLessThan = [&secondName](Entry* a, Entry* b) {
+        return xMusicLibrary_compareNames(secondName(a), secondName(b)) < 0;
+    };
+    if (!std::is_sorted(first.begin(), first.end(), firstLessThan)) {
+        std::sort(first.begin(), first.end(), firstLessThan);
+    }
+    if (!std::is_sorted(second.begin(), second.end(), secondLessThan)) {
+        std::sort(second.begin(), second.end(), secondLessThan);
+    }
+    auto firstEntry = first.begin();
+    auto secondEntry = second.begin();
+    while ((firstEntry != first.end()) && (secondEntry != second.end())) {
+        auto result = xMusicLibrary_compareNames(firstName(*firstEntry), secondName(*secondEntry));
+        if (result < 0) {
+            onlyFirst(*firstEntry++);
+        } else if (result > 0) {
+            onlySecond(*secondEntry++);
+        } else {
+            both(*firstEntry++, *secondEntry++);
+        }
+    }
+    std::for_each(firstEntry, first.end(), onlyFirst);
+    std::for_each(secondEntry, second.end(), onlySecond);
+}
+
 
 xMusicLibrary::xMusicLibrary(QObject* parent):
         xMusicLibraryEntry(parent),
@@ -368,10 +418,22 @@ bool xMusicLibrary::isLocal() const {
 void xMusicLibrary::scanThread() {
     musicLibraryScanLock.lock();
     std::vector<xDirectoryEntry> artistEntries;
+    std::map<QString,std::vector<xRemoteLibraryAlbum>> remoteAlbums;
     if (isLocal()) {
         artistEntries = scanDirectory();
     } else {
-        artistEntries = xPlayerBluOSControls::controls()->getArtists();
+        // Crawl the complete remote library or load it from the remote library cache.
+        auto remoteArtists = xPlayerBluOSControls::controls()->getLibrary([this]() {
+            return musicLibraryScanning->isInterruptionRequested();
+        });
+        for (auto& remoteArtist : remoteArtists) {
+            artistEntries.push_back(remoteArtist.artist);
+            remoteAlbums[std::get<2>(remoteArtist.artist)] = std::move(remoteArtist.albums);
+        }
+        if (musicLibraryScanning->isInterruptionRequested()) {
+            musicLibraryScanLock.unlock();
+            return;
+        }
     }
     size_t totalNoAlbums = 0;
     std::sort(artistEntries.begin(), artistEntries.end());
@@ -396,7 +458,24 @@ void xMusicLibrary::scanThread() {
         }
         auto artist = new xMusicLibraryArtistEntry(artistName, artistUrl, this);
         // Scan albums for the current artist.
-        artist->scan();
+        if (isLocal()) {
+            artist->scan();
+        } else {
+            // Use the crawled albums and tracks.
+            const auto& artistAlbums = remoteAlbums[artistName];
+            std::vector<xDirectoryEntry> albumEntries;
+            albumEntries.reserve(artistAlbums.size());
+            for (const auto& remoteAlbum : artistAlbums) {
+                albumEntries.push_back(remoteAlbum.album);
+            }
+            artist->scan(std::move(albumEntries));
+            for (const auto& remoteAlbum : artistAlbums) {
+                auto album = artist->getAlbum(std::get<2>(remoteAlbum.album));
+                if ((album) && (!remoteAlbum.tracks.empty())) {
+                    album->scan(remoteAlbum.tracks);
+                }
+            }
+        }
         // Only add the artist is we have albums.
         if (artist->getNoOfAlbums() > 0) {
             musicLibraryArtists.emplace_back(artist);
@@ -444,101 +523,65 @@ void xMusicLibrary::scanThread() {
     musicLibraryScanLock.unlock();
 }
 
-void xMusicLibrary::compare(const xMusicLibrary* library, QStringList& missingArtists, QStringList& additionalArtists,
-                            std::map<QString, QStringList>& missingAlbums, std::map<QString, QStringList>& additionalAlbums,
-                            std::list<xMusicLibraryTrackEntry*>& missingTracks, std::list<xMusicLibraryTrackEntry*>& additionalTracks,
-                            std::pair<std::list<xMusicLibraryTrackEntry*>, std::list<xMusicLibraryTrackEntry*>>& differentTracks) const {
-    musicLibraryLock.lock();
-    // Compare the artists.
-    QStringList equalArtists;
-    for (auto artist : musicLibraryArtists) {
-        auto artistName = artist->getArtistName();
-        if (library->musicLibraryArtistsMap.find(artistName) != library->musicLibraryArtistsMap.end()) {
-            equalArtists.push_back(artistName);
-        } else {
-            missingArtists.push_back(artistName);
-        }
-    }
-    for (auto artist : library->musicLibraryArtists) {
-        auto artistName = artist->getArtistName();
-        if (musicLibraryArtistsMap.find(artistName) == musicLibraryArtistsMap.end()) {
-            additionalArtists.push_back(artistName);
-        }
-    }
-    // Compare the albums for equal artists.
-    std::map<QString, QStringList> equalAlbums;
-    for (const auto& equalArtist : equalArtists) {
-        try {
-            QStringList missing, additional, equal;
-
-            auto artist = musicLibraryArtistsMap.at(equalArtist);
-            auto libraryArtist = library->musicLibraryArtistsMap.at(equalArtist);
-
-            for (auto album : artist->getAlbums()) {
-                auto albumName = album->getAlbumName();
-                if (libraryArtist->getAlbum(albumName)) {
-                    equal.push_back(albumName);
-                } else {
-                    missing.push_back(albumName);
-                }
-            }
-            for (auto libraryAlbum : libraryArtist->getAlbums()) {
-                auto libraryAlbumName = libraryAlbum->getAlbumName();
-                // It's additional if we cannot find it in our library.
-                if (!artist->getAlbum(libraryAlbumName)) {
-                    additional.push_back(libraryAlbumName);
-                }
-            }
-
-            if (!missing.empty()) {
-                missingAlbums[equalArtist] = missing;
-            }
-            if (!additional.empty()) {
-                additionalAlbums[equalArtist] = additional;
-            }
-            if (!equal.empty()) {
-                equalAlbums[equalArtist] = equal;
-            }
-        }
-        catch (const std::out_of_range& e) {
-            qCritical() << "Unable to access artist in music library files: " << e.what();
-            missingArtists.clear();
-            additionalArtists.clear();
-            missingAlbums.clear();
-            additionalAlbums.clear();
-            missingTracks.clear();
-            additionalTracks.clear();
-            differentTracks.first.clear();
-            differentTracks.second.clear();
-            musicLibraryLock.unlock();
-            return;
-        }
+void xMusicLibrary::compare(const xMusicLibrary* library,
+                            const std::function<void(const xMusicLibraryDifference& missing,
+                                                     const xMusicLibraryDifference& additional)>& differences,
+                            const std::function<QString(const QString&)>& trackNameMap) const {
+    // Lock both libraries in a consistent order.
+    auto firstLock = (this < library) ? &musicLibraryLock : &library->musicLibraryLock;
+    auto secondLock = (this < library) ? &library->musicLibraryLock : &musicLibraryLock;
+    firstLock->lock();
+    if (firstLock != secondLock) {
+        secondLock->lock();
     }
-    // Compare the tracks for the equal artist and albums.
-    for (const auto& artist : equalAlbums) {
-        std::map<QString, std::list<xMusicLibraryTrackEntry*>> missingArtistTracks, additionalArtistTracks, differentArtistTracks;
-        for (const auto& album : artist.second) {
-            try {
-                listDifference(musicLibraryArtistsMap.at(artist.first)->getAlbum(album)->getTracks(),
-                               library->musicLibraryArtistsMap.at(artist.first)->getAlbum(album)->getTracks(),
-                               missingTracks, additionalTracks, differentTracks);
-            }
-            catch (const std::out_of_range& e) {
-                qCritical() << "Unable to access artist or album in music library files: " << e.what();
-                missingArtists.clear();
-                additionalArtists.clear();
-                missingAlbums.clear();
-                additionalAlbums.clear();
-                missingTracks.clear();
-                additionalTracks.clear();
-                differentTracks.first.clear();
-                differentTracks.second.clear();
-                musicLibraryLock.unlock();
-                return;
+    xMusicLibraryDifference missing, additional;
+    auto report = [&](bool force) {
+        if ((force) || (missing.size()+additional.size() >= xMusicLibrary_CompareBatchSize)) {
+            if ((missing.size() > 0) || (additional.size() > 0)) {
+                differences(missing, additional);
             }
+            missing.clear();
+            additional.clear();
         }
+    };
+    auto artistName = [](xMusicLibraryArtistEntry* artist) -> const QString& { return artist->getArtistName(); };
+    auto albumName = [](xMusicLibraryAlbumEntry* album) -> const QString& { return album->getAlbumName(); };
+    auto trackName = [](xMusicLibraryTrackEntry* track) -> const QString& { return track->getTrackName(); };
+    auto mappedTrackName = [&trackNameMap](xMusicLibraryTrackEntry* track) {
+        return (trackNameMap) ? trackNameMap(track->getTrackName()) : track->getTrackName();
+    };
+    xMusicLibrary_merge(musicLibraryArtists, library->musicLibraryArtists, artistName, artistName,
+        [&](xMusicLibraryArtistEntry* artist) {
+            missing.artists.push_back(artist);
+            report(false);
+        },
+        [&](xMusicLibraryArtistEntry* libraryArtist) {
+            additional.artists.push_back(libraryArtist);
+            report(false);
+        },
+        [&](xMusicLibraryArtistEntry* artist, xMusicLibraryArtistEntry* libraryArtist) {
+            xMusicLibrary_merge(artist->getAlbums(), libraryArtist->getAlbums(), albumName, albumName,
+                [&](xMusicLibraryAlbumEntry* album) { missing.albums.push_back(album); },
+                [&](xMusicLibraryAlbumEntry* libraryAlbum) { additional.albums.push_back(libraryAlbum); },
+                [&](xMusicLibraryAlbumEntry* album, xMusicLibraryAlbumEntry* libraryAlbum) {
+                    xMusicLibrary_merge(album->getTracks(), libraryAlbum->getTracks(), mappedTrackName, trackName,
+                        [&](xMusicLibraryTrackEntry* track) { missing.tracks.push_back(track); },
+                        [&](xMusicLibraryTrackEntry* libraryTrack) { additional.tracks.push_back(libraryTrack); },
+                        [&](xMusicLibraryTrackEntry* track, xMusicLibraryTrackEntry* libraryTrack) {
+                            // The size of tracks with mapped names, e.g. transcoded tracks, cannot be compared.
+                            if ((track->getTrackName() == libraryTrack->getTrackName()) && (!track->equal(libraryTrack))) {
+                                missing.differentTracks.push_back(track);
+                                additional.differentTracks.push_back(libraryTrack);
+                            }
+                        });
+                });
+            report(false);
+        });
+    report(true);
+    if (firstLock != secondLock) {
+        secondLock->unlock();
     }
-    musicLibraryLock.unlock();
+    firstLock->unlock();
 }
 
 void xMusicLibrary::compare(const xMusicLibrary* library,
@@ -578,40 +621,6 @@ void xMusicLibrary::compare(const xMusicLibrary* library,
     musicLibraryLock.unlock();
 }
 
-void xMusicLibrary::listDifference(const std::vector<xMusicLibraryTrackEntry*>& a, const std::vector<xMusicLibraryTrackEntry*>& b,
-                                   std::list<xMusicLibraryTrackEntry*>& missing, std::list<xMusicLibraryTrackEntry*>& additional,
-                                   std::pair<std::list<xMusicLibraryTrackEntry*>, std::list<xMusicLibraryTrackEntry*>>& different) {
-
-    for (auto aEntry : a) {
-        bool found = false;
-        for (auto bEntry : b) {
-            if (aEntry->equal(bEntry, false)) {
-                if (!aEntry->equal(bEntry)) {
-                    different.first.push_back(aEntry);
-                    different.second.push_back(bEntry);
-                }
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            missing.push_back(aEntry);
-        }
-    }
-    for (const auto& bEntry : b) {
-        bool found = false;
-        for (const auto& aEntry : b) {
-            if (bEntry->equal(aEntry, false)) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            additional.push_back(bEntry);
-        }
-    }
-}
-
 bool xMusicLibrary::isDirectoryEntryValid(const QUrl& dirEntry) {
     if (dirEntry.isLocalFile()) {
         QFileInfo dirPath(dirEntry.toLocalFile());
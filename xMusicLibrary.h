@@ -21,6 +21,34 @@
 #include <QThread>
 #include <QMutex>
 
+#include <functional>
+
+/**
+ * Differences of a music library compared to another one.
+ *
+ * The entries are referenced, not copied. They remain valid as long as the
+ * music library is not scanned again.
+ */
+struct xMusicLibraryDifference {
+    // Artists only present in this library.
+    std::vector<xMusicLibraryArtistEntry*> artists;
+    // Albums of common artists only present in this library.
+    std::vector<xMusicLibraryAlbumEntry*> albums;
+    // Tracks of common albums only present in this library.
+    std::vector<xMusicLibraryTrackEntry*> tracks;
+    // Tracks present in both libraries, but with different file sizes.
+    std::vector<xMusicLibraryTrackEntry*> differentTracks;
+
+    [[nodiscard]] size_t size() const {
+        return artists.size()+albums.size()+tracks.size()+differentTracks.size();
+    }
+    void clear() {
+        artists.clear();
+        albums.clear();
+        tracks.clear();
+        differentTracks.clear();
+    }
+};
 
 class xMusicLibrary: public xMusicLibraryEntry {
     Q_OBJECT
@@ -214,22 +242,22 @@ public slots:
     /**
      * Compare the current music library files to a given one.
      *
-     * We compare the libraries based on the difference in artists,
-     * albums and tracks.
+     * We compare the libraries based on the difference in artists, albums
+     * and tracks. Both libraries are walked as merged sorted streams. The
+     * differences are reported in batches while comparing. Both libraries
+     * are locked during the comparison. The track names of this library can
+     * be mapped to the names used in the given library, e.g. if tracks are
+     * transcoded. Tracks matched by a mapped name are not compared by size.
      *
-     * @param libraryFiles the music library that is compared to.
-     * @param missingArtists list of artists that are not present in given library.
-     * @param additionalArtists list of artists that are only present in the given library.
-     * @param missingAlbums list of albums for present artists that are not present in given library.
-     * @param additionalAlbums list of albums for present artists that are only present in given library.
-     * @param missingTracks list of tracks for present artists and albums that are not present in given library.
-     * @param additionalTracks list of tracks for present artists and albums that are only present in the given library.
-     * @param differentTracks pair of list of tracks present in both, but file sizes are different.
-     */
-    void compare(const xMusicLibrary* library, QStringList& missingArtists, QStringList& additionalArtists,
-                 std::map<QString, QStringList>& missingAlbums, std::map<QString, QStringList>& additionalAlbums,
-                 std::list<xMusicLibraryTrackEntry*>& missingTracks, std::list<xMusicLibraryTrackEntry*>& additionalTracks,
-                 std::pair<std::list<xMusicLibraryTrackEntry*>, std::list<xMusicLibraryTrackEntry*>>& differentTracks) const;
+     * @param library the music library that is compared to.
+     * @param differences function called for each batch with the missing (only in this library)
+     *        and additional (only in the given library) entries.
+     * @param trackNameMap function mapping a track name of this library to the name in the given library, may be empty.
+     */
+    void compare(const xMusicLibrary* library,
+                 const std::function<void(const xMusicLibraryDifference& missing,
+                                          const xMusicLibraryDifference& additional)>& differences,
+                 const std::function<QString(const QString&)>& trackNameMap={}) const;
     /**
      * Compare the current music library files to a given one.
      *
@@ -293,12 +321,6 @@ private:
      */
     static std::vector<xMusicLibraryTrackEntry*> filterTracks(xMusicLibraryAlbumEntry* album,
                                                               const xMusicLibraryFilter& filter);
-    /**
-     * Implement a list difference for track entries
-     */
-    static void listDifference(const std::vector<xMusicLibraryTrackEntry*>& a, const std::vector<xMusicLibraryTrackEntry*>& b,
-                               std::list<xMusicLibraryTrackEntry*>& missing, std::list<xMusicLibraryTrackEntry*>& additional,
-                               std::pair<std::list<xMusicLibraryTrackEntry*>, std::list<xMusicLibraryTrackEntry*>>& different);
 
     // Use mutex to protect the setting of the base library.
     mutable QMutex musicLibraryScanLock;
@@ -88,6 +88,10 @@ void xMusicLibraryAlbumEntry::scan() {
     } else {
         trackEntries = xPlayerBluOSControls::controls()->getTracks(getArtistName(), getAlbumName());
     }
+    scan(std::move(trackEntries));
+}
+
+void xMusicLibraryAlbumEntry::scan(std::vector<xDirectoryEntry> trackEntries) {
     // Sort the entries according to their name.
     std::sort(trackEntries.begin(), trackEntries.end());
     // Clear vector and map
@@ -31,6 +31,12 @@ public:
      * Scan for album entries for the given artist.
      */
     void scan() override;
+    /**
+     * Fill the album with the given track entries instead of scanning them.
+     *
+     * @param trackEntries vector of tuples of url, path, track name and length.
+     */
+    void scan(std::vector<xDirectoryEntry> trackEntries);
     /**
      * Verify if tracks for the albums have been scanned.
      *
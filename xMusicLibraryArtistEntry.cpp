@@ -72,6 +72,10 @@ void xMusicLibraryArtistEntry::scan() {
     } else {
         albumEntries = xPlayerBluOSControls::controls()->getAlbums(entryName);
     }
+    scan(std::move(albumEntries));
+}
+
+void xMusicLibraryArtistEntry::scan(std::vector<xDirectoryEntry> albumEntries) {
     std::sort(albumEntries.begin(), albumEntries.end());
     // Clear vector and map
     artistAlbums.clear();
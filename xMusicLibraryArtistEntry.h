@@ -32,6 +32,12 @@ public:
      * Scan for album entries for the given artist.
      */
     void scan() override;
+    /**
+     * Fill the artist with the given album entries instead of scanning them.
+     *
+     * @param albumEntries vector of tuples of url and album name.
+     */
+    void scan(std::vector<xDirectoryEntry> albumEntries);
     /**
      * Verify if entry has been scanned.
      *
@@ -16,7 +16,6 @@
 #include "xMusicLibraryAlbumEntry.h"
 #include "xMusicLibraryArtistEntry.h"
 #include "xPlayerConfiguration.h"
-#include "xPlayerBluOSControl.h"
 
 #include <QRegularExpression>
 #include <QProcess>
@@ -93,6 +92,16 @@ qint64 xMusicLibraryTrackEntry::getLength() const {
     return trackLength;
 }
 
+qint64 xMusicLibraryTrackEntry::scanLength(const QString& file) {
+    TagLib::FileRef track(file.toStdString().c_str(), true, TagLib::AudioProperties::Fast);
+    auto trackProperties = track.audioProperties();
+    if (trackProperties == nullptr) {
+        qCritical() << "Unable to get audio properties for: " << file;
+        return -1;
+    }
+    return trackProperties->lengthInMilliseconds();
+}
+
 int xMusicLibraryTrackEntry::getBitsPerSample() const {
     scanTags();
     return trackBitsPerSample;
@@ -108,6 +117,11 @@ int xMusicLibraryTrackEntry::getBitrate() const {
     return trackBitrate;
 }
 
+void xMusicLibraryTrackEntry::setTrackInfo(int sampleRate, int bitsPerSample) {
+    trackSampleRate = sampleRate;
+    trackBitsPerSample = bitsPerSample;
+}
+
 bool xMusicLibraryTrackEntry::isScanned() const {
     return (trackBitsPerSample > 0);
 }
@@ -188,10 +202,8 @@ void xMusicLibraryTrackEntry::scanTags() const {
         trackBitrate = currentTrackProperties->bitrate();
         trackSampleRate = currentTrackProperties->sampleRate();
         trackLength = currentTrackProperties->lengthInMilliseconds();
-    } else {
-        std::tie(trackSampleRate, trackBitsPerSample) = xPlayerBluOSControls::controls()->getTrackInfo(trackPath);
-        qDebug() << "scanTags() [remote]: " << trackPath << " : " << trackSampleRate  << "," << trackBitsPerSample;
     }
+    // The track info of remote tracks is set by the music player. See setTrackInfo.
 }
 
 bool xMusicLibraryTrackEntry::equal(xMusicLibraryTrackEntry* track, bool checkFileSize) const {
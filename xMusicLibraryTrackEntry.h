@@ -87,6 +87,15 @@ public:
      * @return the length in ms as integer.
      */
     [[nodiscard]] qint64 getLength() const;
+    /**
+     * Determine the length of a local music file without a track entry.
+     *
+     * Used by worker threads that must not access the track entries.
+     *
+     * @param file the path to the local music file.
+     * @return the length in ms as integer, -1 if the file cannot be scanned.
+     */
+    [[nodiscard]] static qint64 scanLength(const QString& file);
     /**
      * Retrieve the bits per sample for the music file.
      *
@@ -114,6 +123,16 @@ public:
      * @return the bitrate as integer.
      */
     [[nodiscard]] int getBitrate() const;
+    /**
+     * Set the sample rate and bits per sample for a remote track.
+     *
+     * Remote tracks are not scanned, since this requires network requests.
+     * The track info is requested asynchronously by the music player.
+     *
+     * @param sampleRate the sample rate as integer.
+     * @param bitsPerSample the bits per sample as integer.
+     */
+    void setTrackInfo(int sampleRate, int bitsPerSample);
     /**
      * Compare music files based on artist, album, track name and size.
      *
@@ -19,17 +19,28 @@
 #include "xPlayerDatabase.h"
 #include "xPlayerBluOSControl.h"
 
-#include <QRandomGenerator>
 #include <QAudioOutput>
+#include <QDateTime>
 #include <cmath>
 
 constexpr auto xMusicPlayer_MusicVisualizationSamples = 1024;
 constexpr auto xMusicPlayer_MusicVisualizationSamplesFactor = xMusicPlayer_MusicVisualizationSamples * 10;
+// Tracks played within this period (in ms) are less likely to be picked in shuffle mode.
+constexpr qint64 xMusicPlayer_ShuffleRecentlyPlayed = 30ll * 24 * 60 * 60 * 1000;
+// Minimal weight of a track in shuffle mode.
+constexpr auto xMusicPlayer_ShuffleMinWeight = 0.01;
+// Max number of consecutive tracks of the same artist if limited in shuffle mode.
+constexpr auto xMusicPlayer_ShuffleMaxArtistRun = 2;
 
 xMusicPlayer::xMusicPlayer(xMusicLibrary* library, QObject* parent):
         QObject(parent),
         musicLibrary(library),
-        musicPlaylistPermutation(),
+        musicPlaylistShuffle(),
+        musicShuffleMode(ShuffleMode::UniformShuffle),
+        musicShuffleLimitArtist(false),
+        musicShuffleStatistics(),
+        musicShuffleStatisticsLoaded(),
+        musicShuffleStatisticsThread(nullptr),
         musicVisualizationEnabled(false),
         musicVisualizationSampleRate(44100 / xMusicPlayer_MusicVisualizationSamplesFactor),
         musicPlayerState(State::StopState),
@@ -65,7 +76,10 @@ xMusicPlayer::xMusicPlayer(xMusicLibrary* library, QObject* parent):
     musicVisualization->setDataSize(xMusicPlayer_MusicVisualizationSamples);
     // Set up the playlist.
     // Connect QMediaPlayer signals to our music player signals.
-    connect(musicPlayer, &Phonon::MediaObject::tick, this, &xMusicPlayer::updatePlayed);
+    // Coalesce the tick updates.
+    musicPositionTracker = new xPlayerPositionTracker(this);
+    connect(musicPlayer, &Phonon::MediaObject::tick, musicPositionTracker, &xPlayerPositionTracker::tick);
+    connect(musicPositionTracker, &xPlayerPositionTracker::position, this, &xMusicPlayer::updatePlayed);
     connect(musicPlayer, &Phonon::MediaObject::currentSourceChanged, this, &xMusicPlayer::currentTrackSource);
     connect(musicPlayer, &Phonon::MediaObject::stateChanged, this, &xMusicPlayer::stateChanged);
     connect(musicPlayer, &Phonon::MediaObject::aboutToFinish, this, &xMusicPlayer::aboutToFinish);
@@ -74,6 +88,14 @@ xMusicPlayer::xMusicPlayer(xMusicLibrary* library, QObject* parent):
     connect(xPlayerConfiguration::configuration(), &xPlayerConfiguration::updatedDatabaseMusicPlayed, [=]() {
         musicPlayed = xPlayerConfiguration::configuration()->getDatabaseMusicPlayed();
     });
+    connect(xPlayerConfiguration::configuration(), &xPlayerConfiguration::updatedMusicShuffleMode, [=]() {
+        musicShuffleMode = static_cast<xMusicPlayer::ShuffleMode>(xPlayerConfiguration::configuration()->getMusicShuffleMode());
+        musicShuffleLimitArtist = xPlayerConfiguration::configuration()->getMusicShuffleLimitArtist();
+        // Refresh the database snapshot used for the weighted shuffle modes.
+        if (musicShuffleMode != ShuffleMode::UniformShuffle) {
+            loadShuffleStatistics();
+        }
+    });
     // Connect status update from BluOS player.
     connect(xPlayerBluOSControls::controls(), &xPlayerBluOSControls::playerStatus, this, &xMusicPlayer::playerStatus);
     connect(xPlayerBluOSControls::controls(), &xPlayerBluOSControls::playerStopped, this, &xMusicPlayer::stop);
@@ -88,6 +110,14 @@ xMusicPlayer::xMusicPlayer(xMusicLibrary* library, QObject* parent):
     connect(musicPlayerForTime, &QMediaPlayer::durationChanged, this, &xMusicPlayer::currentTrackDuration);
 }
 
+xMusicPlayer::~xMusicPlayer() {
+    // Wait for the database snapshot to be loaded.
+    if (musicShuffleStatisticsThread) {
+        musicShuffleStatisticsThread->wait();
+        delete musicShuffleStatisticsThread;
+    }
+}
+
 void xMusicPlayer::queueTracks(const QString& artist, const QString& album, const std::vector<xMusicLibraryTrackEntry*>& tracks) {
     if (musicLibrary->isLocal()) {
         // Add given tracks to the playlist and to the musicPlaylistEntries data structure.
@@ -123,31 +153,31 @@ void xMusicPlayer::finishedQueueTracks(bool autoPlay) {
         // Find the index of the current media source in the playlist.
         auto currentIndex = musicPlaylist.indexOf(musicPlayer->currentSource());
         if (useShuffleMode) {
+            updateShuffleWeights();
             if (currentIndex >= 0) {
-                currentIndex = musicPlaylistPermutation.indexOf(currentIndex);
+                currentIndex = musicPlaylistShuffle.position(currentIndex);
                 // Check if we are in the process of filling the queue in shuffle mode.
                 if ((currentIndex == 0) && (musicPlayer->state() == Phonon::StoppedState)) {
                     // Treat as empty queue;
                     currentIndex = -1;
                 }
             }
-            // The musicPlaylistPermutation still has the old size.
-            if ((currentIndex >= 0) && (currentIndex < musicPlaylistPermutation.count())) {
-                // A song was already playing.
-                musicPlaylistPermutation = extendPermutation(musicPlaylistPermutation.mid(0, currentIndex + 1),
-                                                             musicPlaylist.count(), currentIndex);
+            // The musicPlaylistShuffle still has the old size.
+            if ((currentIndex >= 0) && (currentIndex < musicPlaylistShuffle.count())) {
+                // A song was already playing. Extend the permutation in place.
+                musicPlaylistShuffle.extend(musicPlaylist.count(), currentIndex);
                 // Clear queue and enqueue the remaining entries.
                 musicPlayer->clearQueue();
-                for (auto i = currentIndex + 1; i < musicPlaylistPermutation.count(); ++i) {
-                    musicPlayer->enqueue(musicPlaylist[musicPlaylistPermutation[i]]);
+                for (auto i = currentIndex + 1; i < musicPlaylistShuffle.count(); ++i) {
+                    musicPlayer->enqueue(musicPlaylist[musicPlaylistShuffle.index(i)]);
                 }
             } else {
                 // No current song was playing. Queue possibly empty. No start index given.
-                musicPlaylistPermutation = computePermutation(musicPlaylist.count(), -1);
+                musicPlaylistShuffle.compute(musicPlaylist.count(), -1);
                 // Clear queue and enqueue all entries.
                 musicPlayer->clearQueue();
-                for (auto i = 0; i < musicPlaylistPermutation.count(); ++i) {
-                    musicPlayer->enqueue(musicPlaylist[musicPlaylistPermutation[i]]);
+                for (auto i = 0; i < musicPlaylistShuffle.count(); ++i) {
+                    musicPlayer->enqueue(musicPlaylist[musicPlaylistShuffle.index(i)]);
                 }
             }
         } else {
@@ -170,13 +200,10 @@ void xMusicPlayer::finishedQueueTracks(bool autoPlay) {
             }
         }
     } else {
-        auto queue = xPlayerBluOSControls::controls()->queue();
-        // Do we autoplay.
-        autoPlay = autoPlay && ((queue.empty()) && (musicPlayerState == State::StopState));
-        // Add tracks to queue.
-        for (auto i = queue.size(); i < musicPlaylistRemote.size(); ++i) {
-            xPlayerBluOSControls::controls()->addQueue(musicPlaylistRemote[i]);
-        }
+        // Do we autoplay. The queue is a local mirror of the player queue.
+        autoPlay = autoPlay && ((xPlayerBluOSControls::controls()->queue().empty()) && (musicPlayerState == State::StopState));
+        // Only send the differences to the player queue.
+        xPlayerBluOSControls::controls()->syncQueue(musicPlaylistRemote);
         // Play if autoplay is enabled.
         if (musicRemoteAutoNext) {
             emit currentState(musicPlayerState = xMusicPlayer::PlayingState);
@@ -201,6 +228,17 @@ void xMusicPlayer::moveQueueTracks(int fromIndex, int toIndex) {
         return;
     }
     qDebug() << "xMusicPlayer::moveQueueTracks: from " << fromIndex << " to " << toIndex;
+    if (!musicLibrary->isLocal()) {
+        // Move the elements in our list and only send the move to the player queue.
+        auto entry = musicPlaylistEntries[fromIndex];
+        musicPlaylistEntries.erase(musicPlaylistEntries.begin()+fromIndex);
+        // Adjust toIndex since element removed changes to toIndex position.
+        toIndex = (fromIndex < toIndex) ? toIndex-1 : toIndex;
+        musicPlaylistEntries.insert(musicPlaylistEntries.begin()+toIndex, entry);
+        musicPlaylistRemote.move(fromIndex, toIndex);
+        xPlayerBluOSControls::controls()->syncQueue(musicPlaylistRemote);
+        return;
+    }
     // Move the elements in our list.
     if (fromIndex < toIndex) {
         for (auto index = fromIndex+1; index < toIndex; ++index) {
@@ -242,6 +280,8 @@ void xMusicPlayer::dequeueTrack(int index) {
         // Remove the selected track from the playlist and entries.
         musicPlaylist.removeAt(index);
         musicPlaylistEntries.erase(musicPlaylistEntries.begin()+index);
+        // Keep a possible permutation consistent with the playlist.
+        musicPlaylistShuffle.remove(index);
         // Special handling if the current track is to be removed
         // This track is not in the music player playlist. It is its
         // current source. We therefore need to stop and clear everything.
@@ -272,7 +312,7 @@ void xMusicPlayer::dequeueTrack(int index) {
         // Remove the selected track from the remote playlist and entries.
         musicPlaylistRemote.removeAt(index);
         musicPlaylistEntries.erase(musicPlaylistEntries.begin()+index);
-        xPlayerBluOSControls::controls()->removeQueue(index);
+        xPlayerBluOSControls::controls()->syncQueue(musicPlaylistRemote);
     }
 }
 
@@ -293,6 +333,7 @@ void xMusicPlayer::clearQueue() {
     musicPlaylistEntries.clear();
     musicPlaylistRemote.clear();
     musicPlaylist.clear();
+    musicPlaylistShuffle.clear();
     musicCurrentRemote.clear();
     // Reset played.
     resetPlayed();
@@ -391,7 +432,9 @@ void xMusicPlayer::reInitialize() {
         emit currentVolume(xPlayerPulseAudioControls::controls()->getVolume());
     } else {
         emit allowShuffleMode(false);
-        emit currentVolume(xPlayerBluOSControls::controls()->getVolume());
+        xPlayerBluOSControls::controls()->getVolume([=](int vol) {
+            emit currentVolume(vol);
+        });
     }
 }
 
@@ -406,14 +449,15 @@ void xMusicPlayer::playPause() {
             musicPlayer->play();
         }
     } else {
-        auto state = xPlayerBluOSControls::controls()->state();
-        if (state == "play") {
-            emit currentState(musicPlayerState = State::PauseState);
-            xPlayerBluOSControls::controls()->pause();
-        } else {
-            emit currentState(musicPlayerState = State::PlayingState);
-            xPlayerBluOSControls::controls()->play();
-        }
+        xPlayerBluOSControls::controls()->state([=](const QString& state) {
+            if (state == "play") {
+                emit currentState(musicPlayerState = State::PauseState);
+                xPlayerBluOSControls::controls()->pause();
+            } else {
+                emit currentState(musicPlayerState = State::PlayingState);
+                xPlayerBluOSControls::controls()->play();
+            }
+        });
     }
 }
 
@@ -493,7 +537,7 @@ void xMusicPlayer::prev() {
         auto position = musicPlaylist.indexOf(musicPlayer->currentSource());
         // If we are in shuffle mode then we need to find the position in our permutation.
         if (useShuffleMode) {
-            position = musicPlaylistPermutation.indexOf(position);
+            position = musicPlaylistShuffle.position(position);
         }
         if (position > 0) {
             // Stop the player and clear its state.
@@ -502,7 +546,7 @@ void xMusicPlayer::prev() {
             // Queue all tracks starting with position - 1.
             if (useShuffleMode) {
                 for (auto i = position - 1; i < musicPlaylist.size(); ++i) {
-                    musicPlayer->enqueue(musicPlaylist[musicPlaylistPermutation[i]]);
+                    musicPlayer->enqueue(musicPlaylist[musicPlaylistShuffle.index(i)]);
                 }
             } else {
                 for (auto i = position - 1; i < musicPlaylist.size(); ++i) {
@@ -526,7 +570,7 @@ void xMusicPlayer::next() {
         auto position = musicPlaylist.indexOf(musicPlayer->currentSource());
         // If we are in shuffle mode then we need to find the position in our permutation.
         if (useShuffleMode) {
-            position = musicPlaylistPermutation.indexOf(position);
+            position = musicPlaylistShuffle.position(position);
         }
         if (position < musicPlaylist.size()-1) {
             // Stop the player and clear its state.
@@ -535,7 +579,7 @@ void xMusicPlayer::next() {
             // Queue all tracks starting with position + 1.
             if (useShuffleMode) {
                 for (auto i = position + 1; i < musicPlaylist.size(); ++i) {
-                    musicPlayer->enqueue(musicPlaylist[musicPlaylistPermutation[i]]);
+                    musicPlayer->enqueue(musicPlaylist[musicPlaylistShuffle.index(i)]);
                 }
             } else {
                 for (auto i = position + 1; i < musicPlaylist.size(); ++i) {
@@ -584,16 +628,17 @@ void xMusicPlayer::setShuffleMode(bool shuffle) {
         if (useShuffleMode) {
             auto currentIndex = musicPlaylist.indexOf(musicPlayer->currentSource());
             if ((currentIndex >= 0) && (currentIndex < musicPlaylist.count())) {
-                musicPlaylistPermutation = computePermutation(musicPlaylist.count(), currentIndex);
+                updateShuffleWeights();
+                musicPlaylistShuffle.compute(musicPlaylist.count(), currentIndex);
                 // Do not stop, just clear the queue
                 musicPlayer->clearQueue();
                 // Remaining tracks include the current
-                for (auto i = 1; i < musicPlaylistPermutation.count(); ++i) {
-                    musicPlayer->enqueue(musicPlaylist[musicPlaylistPermutation[i]]);
+                for (auto i = 1; i < musicPlaylistShuffle.count(); ++i) {
+                    musicPlayer->enqueue(musicPlaylist[musicPlaylistShuffle.index(i)]);
                 }
             }
         } else {
-            musicPlaylistPermutation.clear();
+            musicPlaylistShuffle.clear();
         }
     } else {
         xPlayerBluOSControls::controls()->setShuffle(useShuffleMode);
@@ -701,26 +746,36 @@ void xMusicPlayer::updatePlayed(qint64 pos) {
 void xMusicPlayer::updateDatabase(int index) {
     // Retrieve info for the currently played track and emit the information.
     if ((index >= 0) && (index < static_cast<int>(musicPlaylistEntries.size()))) {
-        auto [artist, album, entryObject] = musicPlaylistEntries[index];
+        // Copy the entry values. They are used on the worker thread.
+        auto artist = std::get<0>(musicPlaylistEntries[index]);
+        auto album = std::get<1>(musicPlaylistEntries[index]);
+        auto entryObject = std::get<2>(musicPlaylistEntries[index]);
         auto trackName = entryObject->getTrackName();
-        // Update database.
-        auto result = xPlayerDatabase::database()->updateMusicFile(artist, album, trackName,
-                                                                   entryObject->getSampleRate(),
-                                                                   entryObject->getBitsPerSample());
-        if (result.second > 0) {
-            // Update database overlay.
-            emit updatePlayedTrack(artist, album, trackName, result.first, result.second);
-        }
+        auto sampleRate = entryObject->getSampleRate();
+        auto bitsPerSample = entryObject->getBitsPerSample();
         // Update transitions
-        if (((!musicPlayedArtist.isEmpty()) && (!musicPlayedAlbum.isEmpty())) &&
-            ((musicPlayedArtist != artist) || (musicPlayedAlbum != album))) {
-            auto transition = xPlayerDatabase::database()->updateTransition(musicPlayedArtist, musicPlayedAlbum,
-                                                                            artist, album, useShuffleMode);
-            // Currently unused.
-            Q_UNUSED(transition)
-        }
+        auto transition = ((!musicPlayedArtist.isEmpty()) && (!musicPlayedAlbum.isEmpty())) &&
+                          ((musicPlayedArtist != artist) || (musicPlayedAlbum != album));
+        auto fromArtist = musicPlayedArtist;
+        auto fromAlbum = musicPlayedAlbum;
+        auto shuffleMode = useShuffleMode;
+        // Update database on the worker thread.
+        musicPositionTracker->record([=]() {
+            auto result = xPlayerDatabase::database()->updateMusicFile(artist, album, trackName, sampleRate, bitsPerSample);
+            if (transition) {
+                // Currently unused.
+                xPlayerDatabase::database()->updateTransition(fromArtist, fromAlbum, artist, album, shuffleMode);
+            }
+            return result;
+        }, [=](const std::pair<int,qint64>& result) {
+            if (result.second > 0) {
+                // Update database overlay.
+                emit updatePlayedTrack(artist, album, trackName, result.first, result.second);
+                // Keep the snapshot for the weighted shuffle modes up-to-date.
+                musicShuffleStatistics[artist+"/"+album+"/"+trackName] = result;
+            }
+        });
     }
-
 }
 
 void xMusicPlayer::currentTrackSource(const Phonon::MediaSource& current) {
@@ -831,6 +886,20 @@ void xMusicPlayer::playerStatus(const QString& path, int index, qint64 position,
                               entryObject->getSampleRate(), entryObject->getBitsPerSample(), quality);
             // Update current index.
             musicCurrentIndex = index;
+            if (!entryObject->isScanned()) {
+                // Do not wait for the track info. Update the track once the info is received.
+                xPlayerBluOSControls::controls()->getTrackInfo(path, [=](int sampleRate, int bitsPerSample) {
+                    // Ignore the info if the track is no longer played or the playlist was modified.
+                    if ((musicCurrentRemote != path) || (musicCurrentIndex != index) ||
+                        (musicPlaylistRemote.value(index) != path)) {
+                        return;
+                    }
+                    auto [currentArtist, currentAlbum, currentEntryObject] = musicPlaylistEntries[index];
+                    currentEntryObject->setTrackInfo(sampleRate, bitsPerSample);
+                    emit currentTrack(index, currentArtist, currentAlbum, currentEntryObject->getTrackName(),
+                                      currentEntryObject->getBitrate(), sampleRate, bitsPerSample, quality);
+                });
+            }
         }
         if (!musicPlayedRecorded) {
             // Update played.
@@ -841,6 +910,8 @@ void xMusicPlayer::playerStatus(const QString& path, int index, qint64 position,
 }
 
 void xMusicPlayer::resetPlayed() {
+    // Discard a pending position of the previous track.
+    musicPositionTracker->reset();
     musicCurrentPosition = 0;
     musicCurrentPlayed = 0;
     musicCurrentDuration = -1;
@@ -848,59 +919,59 @@ void xMusicPlayer::resetPlayed() {
     musicPlayedIndex = -1;
 }
 
-QVector<int> xMusicPlayer::computePermutation(int elements, int startIndex) {
-    QList<int> input;
-    QVector<int> permutation;
-    // Set up the input with all indices.
-    for (auto i = 0; i < elements; ++i) {
-        input.push_back(i);
-    }
-    // Remove the start index if we have a valid one.
-    if ((startIndex >= 0) && (startIndex < elements)) {
-        // Add startIndex to the permutation as first element.
-        permutation.push_back(startIndex);
-        input.removeOne(startIndex);
-        --elements;
-    }
-    // Choose the remaining elements at random.
-    for (auto i = 0; i < elements; ++i) {
-        auto index = QRandomGenerator::global()->bounded(input.count());
-        permutation.push_back(input[index]);
-        input.removeAt(index);
-    }
-    return permutation;
-}
-
-QVector<int> xMusicPlayer::extendPermutation(const QVector<int>& permutation, int elements, int extendIndex) {
-    // Return an empty permutation if we do not extend.
-    if (elements < permutation.count()) {
-        return QVector<int>{};
-    }
-    QList<int> input;
-    QVector<int> ePermutation;
-    // Set up the input with all indices.
-    for (auto i = 0; i < elements; ++i) {
-        input.push_back(i);
-    }
-    if ((extendIndex >= 0) && (extendIndex < elements)) {
-        for (auto i = 0; i < permutation.count(); ++i) {
-            // Remove the index from the input that are in the permutation.
-            input.removeOne(permutation[i]);
-            // Add the removed index to the extended permutation.
-            ePermutation.push_back(permutation[i]);
-            // We have one less element o choose.
-            --elements;
-            // End loop if we reached the extendIndex value.
-            if (permutation[i] == extendIndex) {
-                break;
-            }
+void xMusicPlayer::loadShuffleStatistics() {
+    if ((musicShuffleStatisticsThread) && (musicShuffleStatisticsThread->isRunning())) {
+        // Snapshot is currently loaded.
+        return;
+    }
+    delete musicShuffleStatisticsThread;
+    musicShuffleStatisticsThread = QThread::create([this]() {
+        musicShuffleStatisticsLoaded.clear();
+        for (const auto& [artist, album, track, playCount, timeStamp] : xPlayerDatabase::database()->getAllPlayedTracks()) {
+            musicShuffleStatisticsLoaded[artist+"/"+album+"/"+track] = std::make_pair(playCount, timeStamp);
         }
+    });
+    connect(musicShuffleStatisticsThread, &QThread::finished, this, [this]() {
+        // Hand over the snapshot in the GUI thread.
+        musicShuffleStatistics.swap(musicShuffleStatisticsLoaded);
+        musicShuffleStatisticsLoaded.clear();
+    });
+    musicShuffleStatisticsThread->start(QThread::IdlePriority);
+}
+
+void xMusicPlayer::updateShuffleWeights() {
+    if ((musicShuffleMode == ShuffleMode::UniformShuffle) && (!musicShuffleLimitArtist)) {
+        musicPlaylistShuffle.clearWeights();
+        return;
     }
-    // Choose the remaining elements at random.
-    for (auto i = 0; i < elements; ++i) {
-        auto index = QRandomGenerator::global()->bounded(input.count());
-        ePermutation.push_back(input[index]);
-        input.removeAt(index);
+    auto currentTimeStamp = QDateTime::currentMSecsSinceEpoch();
+    std::vector<double> weights;
+    std::vector<int> groups;
+    QHash<QString,int> artistGroups;
+    weights.reserve(musicPlaylistEntries.size());
+    groups.reserve(musicPlaylistEntries.size());
+    for (const auto& [artist, album, trackEntry] : musicPlaylistEntries) {
+        auto [playCount, timeStamp] = musicShuffleStatistics.value(artist+"/"+album+"/"+trackEntry->getTrackName(),
+                                                                   std::make_pair(0, static_cast<qint64>(0)));
+        auto weight = 1.0;
+        switch (musicShuffleMode) {
+            case ShuffleMode::RarelyPlayedShuffle: {
+                weight = 1.0 / (1.0 + playCount);
+            } break;
+            case ShuffleMode::NotRecentlyPlayedShuffle: {
+                if (timeStamp > 0) {
+                    weight = static_cast<double>(currentTimeStamp - timeStamp) / xMusicPlayer_ShuffleRecentlyPlayed;
+                }
+            } break;
+            default: break;
+        }
+        weights.push_back(std::clamp(weight, xMusicPlayer_ShuffleMinWeight, 1.0));
+        // Each artist is its own group.
+        auto artistGroup = artistGroups.find(artist);
+        if (artistGroup == artistGroups.end()) {
+            artistGroup = artistGroups.insert(artist, static_cast<int>(artistGroups.size()));
+        }
+        groups.push_back(artistGroup.value());
     }
-    return ePermutation;
+    musicPlaylistShuffle.setWeights(weights, groups, musicShuffleLimitArtist ? xMusicPlayer_ShuffleMaxArtistRun : 0);
 }
@@ -16,6 +16,8 @@
 
 #include "xMusicLibrary.h"
 #include "xPlayerPulseAudioControls.h"
+#include "xMusicPlayerShuffle.h"
+#include "xPlayerPositionTracker.h"
 
 #include <phonon/MediaObject>
 #include <phonon/MediaSource>
@@ -23,6 +25,8 @@
 #include <phonon/AudioDataOutput>
 
 #include <QMediaPlayer>
+#include <QThread>
+#include <QHash>
 
 class xMusicPlayer: public QObject {
     Q_OBJECT
@@ -34,9 +38,15 @@ public:
         PauseState,
         StopState
     };
+    // Music player shuffle modes.
+    enum ShuffleMode {
+        UniformShuffle,
+        RarelyPlayedShuffle,
+        NotRecentlyPlayedShuffle
+    };
 
     explicit xMusicPlayer(xMusicLibrary* library, QObject* parent = nullptr);
-    ~xMusicPlayer() override = default;
+    ~xMusicPlayer() override;
     /**
      * Return the volume for the music player
      *
@@ -341,30 +351,33 @@ private slots:
 private:
     void resetPlayed();
     /**
-     * Compute a permutation for 0...elements-1. Allow for a fixed starting index.
+     * Load a snapshot of the play count and time stamps from the database in a separate thread.
      *
-     * @param elements the number of elements for the permutation.
-     * @param startIndex the fixed starting index if >= 0.
-     * @return a vector containing a random permutation of 0...elements-1.
+     * The snapshot is used to compute the weights for the weighted shuffle modes.
+     * Picking tracks never queries the database.
      */
-    static QVector<int> computePermutation(int elements, int startIndex);
+    void loadShuffleStatistics();
     /**
-     * Extend a given permutation by keeping the initial permutation to extendIndex.
+     * Update the weights and groups (artists) of the shuffle engine for the current playlist.
      *
-     * @param permutation the current permutation used. Contains extendIndex.
-     * @param elements the new number of elements for the permutation.
-     * @param extendIndex the index up to the permutation is used in the extended permutation.
-     * @return a vector containing an extended random permutation of 0...elements-1.
+     * The weights are determined by the shuffle mode using the cached database snapshot.
      */
-    static QVector<int> extendPermutation(const QVector<int>& permutation, int elements, int extendIndex);
+    void updateShuffleWeights();
 
     xPlayerPulseAudioControls* pulseAudioControls;
     xMusicLibrary* musicLibrary;
     std::vector<std::tuple<QString,QString,xMusicLibraryTrackEntry*>> musicPlaylistEntries;
     QList<Phonon::MediaSource> musicPlaylist;
     QStringList musicPlaylistRemote;
-    QVector<int> musicPlaylistPermutation;
+    xMusicPlayerShuffle musicPlaylistShuffle;
+    xMusicPlayer::ShuffleMode musicShuffleMode;
+    bool musicShuffleLimitArtist;
+    // Snapshot of play count and time stamp for artist/album/track.
+    QHash<QString,std::pair<int,qint64>> musicShuffleStatistics;
+    QHash<QString,std::pair<int,qint64>> musicShuffleStatisticsLoaded;
+    QThread* musicShuffleStatisticsThread;
     Phonon::MediaObject* musicPlayer;
+    xPlayerPositionTracker* musicPositionTracker;
     Phonon::AudioOutput* musicOutput;
     Phonon::AudioDataOutput* musicVisualization;
     bool musicVisualizationSupported;
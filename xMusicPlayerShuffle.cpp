@@ -0,0 +1,275 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xMusicPlayerShuffle.h"
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+// Scale used to convert the weights into integers for an exact Fenwick tree.
+constexpr auto xMusicPlayerShuffle_WeightScale = 1000000.0;
+// Number of retries in order to avoid exceeding the group run limit.
+constexpr auto xMusicPlayerShuffle_GroupRunRetries = 8;
+
+/**
+ * Fenwick (binary indexed) tree over integer weights.
+ */
+class xMusicPlayerShuffleTree {
+public:
+    explicit xMusicPlayerShuffleTree(const std::vector<quint64>& weights):
+            tree(weights.size()+1, 0),
+            treeTotal(0) {
+        // Linear time construction.
+        for (size_t i = 1; i < tree.size(); ++i) {
+            tree[i] += weights[i-1];
+            treeTotal += weights[i-1];
+            auto parent = i + (i & (~i + 1));
+            if (parent < tree.size()) {
+                tree[parent] += tree[i];
+            }
+        }
+        treeMask = 1;
+        while ((treeMask << 1) < tree.size()) {
+            treeMask <<= 1;
+        }
+    }
+    /**
+     * Remove the weight for the given index.
+     */
+    void remove(size_t index, quint64 weight) {
+        treeTotal -= weight;
+        for (auto i = index+1; i < tree.size(); i += (i & (~i + 1))) {
+            tree[i] -= weight;
+        }
+    }
+    /**
+     * Find the index for the given value, i.e. the smallest index with prefix sum > value.
+     */
+    [[nodiscard]] size_t find(quint64 value) const {
+        size_t index = 0;
+        for (auto mask = treeMask; mask > 0; mask >>= 1) {
+            if ((index + mask < tree.size()) && (tree[index + mask] <= value)) {
+                index += mask;
+                value -= tree[index];
+            }
+        }
+        return index;
+    }
+    [[nodiscard]] quint64 total() const {
+        return treeTotal;
+    }
+
+private:
+    std::vector<quint64> tree;
+    quint64 treeTotal;
+    size_t treeMask;
+};
+
+
+xMusicPlayerShuffle::xMusicPlayerShuffle():
+        shufflePermutation(),
+        shufflePositions(),
+        shuffleWeights(),
+        shuffleGroups(),
+        shuffleMaxGroupRun(0),
+        shuffleGenerator(QRandomGenerator::global()->generate()) {
+}
+
+xMusicPlayerShuffle::xMusicPlayerShuffle(quint32 seed):
+        shufflePermutation(),
+        shufflePositions(),
+        shuffleWeights(),
+        shuffleGroups(),
+        shuffleMaxGroupRun(0),
+        shuffleGenerator(seed) {
+}
+
+void xMusicPlayerShuffle::setSeed(quint32 seed) {
+    shuffleGenerator.seed(seed);
+}
+
+void xMusicPlayerShuffle::setWeights(const std::vector<double>& weights, const std::vector<int>& groups, int maxGroupRun) {
+    shuffleWeights = weights;
+    shuffleGroups = groups;
+    shuffleMaxGroupRun = std::max(maxGroupRun, 0);
+    // Use no groups if they do not match the weights.
+    if (shuffleGroups.size() != shuffleWeights.size()) {
+        shuffleGroups.clear();
+    }
+}
+
+void xMusicPlayerShuffle::clearWeights() {
+    shuffleWeights.clear();
+    shuffleGroups.clear();
+    shuffleMaxGroupRun = 0;
+}
+
+bool xMusicPlayerShuffle::isWeighted() const {
+    return (!shuffleWeights.empty()) && (shuffleWeights.size() == shufflePermutation.size());
+}
+
+void xMusicPlayerShuffle::compute(int elements, int startIndex) {
+    elements = std::max(elements, 0);
+    shufflePermutation.resize(elements);
+    std::iota(shufflePermutation.begin(), shufflePermutation.end(), 0);
+    // Move the start index to the front if we have a valid one.
+    auto from = 0;
+    if ((startIndex >= 0) && (startIndex < elements)) {
+        std::swap(shufflePermutation[0], shufflePermutation[startIndex]);
+        from = 1;
+    }
+    shuffle(from);
+    shufflePositions.resize(elements);
+    updatePositions(0);
+}
+
+void xMusicPlayerShuffle::extend(int elements, int extendPosition) {
+    auto currentElements = count();
+    // Compute a new permutation if we do not extend.
+    if (elements < currentElements) {
+        compute(elements, -1);
+        return;
+    }
+    // Append the new indices at the end of the permutation.
+    shufflePermutation.resize(elements);
+    std::iota(shufflePermutation.begin()+currentElements, shufflePermutation.end(), currentElements);
+    shufflePositions.resize(elements);
+    // Keep everything up to and including the extend position.
+    auto from = std::clamp(extendPosition+1, 0, elements);
+    shuffle(from);
+    updatePositions(from);
+}
+
+void xMusicPlayerShuffle::remove(int index) {
+    auto removePosition = position(index);
+    if (removePosition < 0) {
+        return;
+    }
+    shufflePermutation.erase(shufflePermutation.begin()+removePosition);
+    shufflePositions.erase(shufflePositions.begin()+index);
+    // Keep the weights and groups consistent.
+    if (index < static_cast<int>(shuffleWeights.size())) {
+        shuffleWeights.erase(shuffleWeights.begin()+index);
+    }
+    if (index < static_cast<int>(shuffleGroups.size())) {
+        shuffleGroups.erase(shuffleGroups.begin()+index);
+    }
+    // Shift the indices behind the removed one.
+    for (auto& entry : shufflePermutation) {
+        if (entry > index) {
+            --entry;
+        }
+    }
+    // Shift the positions behind the removed one.
+    for (auto& entry : shufflePositions) {
+        if (entry > removePosition) {
+            --entry;
+        }
+    }
+}
+
+void xMusicPlayerShuffle::clear() {
+    shufflePermutation.clear();
+    shufflePositions.clear();
+}
+
+int xMusicPlayerShuffle::count() const {
+    return static_cast<int>(shufflePermutation.size());
+}
+
+bool xMusicPlayerShuffle::isEmpty() const {
+    return shufflePermutation.empty();
+}
+
+int xMusicPlayerShuffle::index(int position) const {
+    if ((position >= 0) && (position < count())) {
+        return shufflePermutation[position];
+    }
+    return -1;
+}
+
+int xMusicPlayerShuffle::position(int index) const {
+    if ((index >= 0) && (index < static_cast<int>(shufflePositions.size()))) {
+        return shufflePositions[index];
+    }
+    return -1;
+}
+
+const std::vector<int>& xMusicPlayerShuffle::permutation() const {
+    return shufflePermutation;
+}
+
+void xMusicPlayerShuffle::shuffle(int from) {
+    if (isWeighted()) {
+        shuffleWeighted(from);
+        return;
+    }
+    // Fisher-Yates shuffle of the positions from...count()-1.
+    for (auto i = count()-1; i > from; --i) {
+        auto j = from + static_cast<int>(shuffleGenerator.bounded(i - from + 1));
+        std::swap(shufflePermutation[i], shufflePermutation[j]);
+    }
+}
+
+void xMusicPlayerShuffle::shuffleWeighted(int from) {
+    auto elements = count() - from;
+    if (elements <= 1) {
+        return;
+    }
+    // Copy the remaining indices and convert their weights. Each index keeps a minimal
+    // weight in order to be picked eventually.
+    std::vector<int> remaining(shufflePermutation.begin()+from, shufflePermutation.end());
+    std::vector<quint64> weights(elements);
+    for (auto i = 0; i < elements; ++i) {
+        weights[i] = std::max(static_cast<quint64>(std::llround(std::max(shuffleWeights[remaining[i]], 0.0) *
+                                                                xMusicPlayerShuffle_WeightScale)), static_cast<quint64>(1));
+    }
+    xMusicPlayerShuffleTree tree(weights);
+    auto useGroups = (shuffleMaxGroupRun > 0) && (!shuffleGroups.empty());
+    // Determine the current group run before the first shuffled position.
+    auto lastGroup = -1;
+    auto groupRun = 0;
+    if ((useGroups) && (from > 0)) {
+        lastGroup = shuffleGroups[shufflePermutation[from-1]];
+        for (auto i = from-1; (i >= 0) && (shuffleGroups[shufflePermutation[i]] == lastGroup) &&
+                              (groupRun < shuffleMaxGroupRun); --i) {
+            ++groupRun;
+        }
+    }
+    for (auto position = from; position < count(); ++position) {
+        auto pick = tree.find(shuffleGenerator.bounded(tree.total()));
+        if ((useGroups) && (groupRun >= shuffleMaxGroupRun)) {
+            // Try to avoid another index of the same group. Give up if only the same group is left.
+            for (auto retry = 0; (retry < xMusicPlayerShuffle_GroupRunRetries) &&
+                                 (shuffleGroups[remaining[pick]] == lastGroup); ++retry) {
+                pick = tree.find(shuffleGenerator.bounded(tree.total()));
+            }
+        }
+        tree.remove(pick, weights[pick]);
+        weights[pick] = 0;
+        shufflePermutation[position] = remaining[pick];
+        if (useGroups) {
+            auto group = shuffleGroups[remaining[pick]];
+            groupRun = (group == lastGroup) ? groupRun+1 : 1;
+            lastGroup = group;
+        }
+    }
+}
+
+void xMusicPlayerShuffle::updatePositions(int from) {
+    for (auto i = from; i < count(); ++i) {
+        shufflePositions[shufflePermutation[i]] = i;
+    }
+}
@@ -0,0 +1,160 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XMUSICPLAYERSHUFFLE_H__
+#define __XMUSICPLAYERSHUFFLE_H__
+
+#include <QRandomGenerator>
+
+#include <vector>
+
+
+class xMusicPlayerShuffle {
+public:
+    /**
+     * Constructor. Use a randomly seeded generator.
+     */
+    xMusicPlayerShuffle();
+    /**
+     * Constructor. Use a deterministic seed for the generator (used for testing).
+     *
+     * @param seed the seed for the random generator.
+     */
+    explicit xMusicPlayerShuffle(quint32 seed);
+    ~xMusicPlayerShuffle() = default;
+    /**
+     * Reseed the random generator. The current permutation is not changed.
+     *
+     * @param seed the seed for the random generator.
+     */
+    void setSeed(quint32 seed);
+    /**
+     * Set the weights and groups used for a weighted shuffle.
+     *
+     * If weights for all elements are given then compute and extend sample the
+     * remaining indices proportional to their weight (without replacement) using
+     * a Fenwick tree, i.e. each pick is O(log elements). Consecutive indices of the
+     * same group (e.g. the artist) are limited to maxGroupRun if possible.
+     *
+     * @param weights the non-negative weight for each index.
+     * @param groups the group for each index.
+     * @param maxGroupRun the max number of consecutive indices of the same group, 0 for no limit.
+     */
+    void setWeights(const std::vector<double>& weights, const std::vector<int>& groups, int maxGroupRun);
+    /**
+     * Clear the weights and groups. Use a uniform shuffle.
+     */
+    void clearWeights();
+    /**
+     * Return if a weighted shuffle is used for the current permutation size.
+     *
+     * @return true if weights for all elements are available, false otherwise.
+     */
+    [[nodiscard]] bool isWeighted() const;
+    /**
+     * Compute a permutation for 0...elements-1. Allow for a fixed starting index.
+     *
+     * The permutation is computed in O(elements) using a Fisher-Yates shuffle,
+     * or in O(elements*log(elements)) if weights are used.
+     *
+     * @param elements the number of elements for the permutation.
+     * @param startIndex the fixed starting index if >= 0.
+     */
+    void compute(int elements, int startIndex);
+    /**
+     * Extend the current permutation to 0...elements-1.
+     *
+     * The permutation up to and including extendPosition is kept. The remaining
+     * entries and the newly added indices are shuffled in place. A new permutation
+     * is computed if the number of elements is smaller than the current one.
+     *
+     * @param elements the new number of elements for the permutation.
+     * @param extendPosition the position up to which the permutation is kept.
+     */
+    void extend(int elements, int extendPosition);
+    /**
+     * Remove an index from the permutation.
+     *
+     * All indices larger than the removed index are shifted down by one in
+     * order to mirror the removal of an entry from the playlist.
+     *
+     * @param index the index (not the position) to be removed.
+     */
+    void remove(int index);
+    /**
+     * Clear the permutation.
+     */
+    void clear();
+    /**
+     * Return the number of elements in the permutation.
+     *
+     * @return the number of elements.
+     */
+    [[nodiscard]] int count() const;
+    /**
+     * Return if the permutation is empty.
+     *
+     * @return true if the permutation has no elements, false otherwise.
+     */
+    [[nodiscard]] bool isEmpty() const;
+    /**
+     * Return the index at the given position of the permutation.
+     *
+     * @param position the position within the permutation.
+     * @return the index at the position, -1 if the position is invalid.
+     */
+    [[nodiscard]] int index(int position) const;
+    /**
+     * Return the position of the given index within the permutation in O(1).
+     *
+     * @param index the index to look up.
+     * @return the position of the index, -1 if the index is invalid.
+     */
+    [[nodiscard]] int position(int index) const;
+    /**
+     * Return the current permutation.
+     *
+     * @return a vector containing the permutation of 0...count()-1.
+     */
+    [[nodiscard]] const std::vector<int>& permutation() const;
+
+private:
+    /**
+     * Shuffle the permutation in place starting at the given position.
+     *
+     * @param from the first position that is shuffled.
+     */
+    void shuffle(int from);
+    /**
+     * Shuffle the permutation in place starting at the given position using the weights.
+     *
+     * @param from the first position that is shuffled.
+     */
+    void shuffleWeighted(int from);
+    /**
+     * Update the inverse permutation starting at the given position.
+     *
+     * @param from the first position that is updated.
+     */
+    void updatePositions(int from);
+
+    std::vector<int> shufflePermutation;
+    std::vector<int> shufflePositions;
+    std::vector<double> shuffleWeights;
+    std::vector<int> shuffleGroups;
+    int shuffleMaxGroupRun;
+    QRandomGenerator shuffleGenerator;
+};
+
+#endif
@@ -0,0 +1,219 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xPlayerBluOSClient.h"
+
+#include <QMutexLocker>
+#include <QPointer>
+#include <QDebug>
+
+#include <chrono>
+
+// Maximal number of concurrent connections to the BluOS player.
+constexpr auto xPlayerBluOSClient_MaxConnections = 4;
+// Maximal time in ms the client thread waits for network activity.
+constexpr auto xPlayerBluOSClient_PollTimeout = 1000;
+// Timeout in ms for a single request.
+constexpr auto xPlayerBluOSClient_RequestTimeout = 10000;
+
+// Callback that appends the received data to the response of a request.
+static size_t xPlayerBluOSClient_write(void* contents, size_t mSize, size_t nMembers, void* userPointer) {
+    auto request = static_cast<xPlayerBluOSClient::xPlayerBluOSRequest*>(userPointer);
+    auto realSize = mSize * nMembers;
+    if (request->response.isEmpty()) {
+        // Allocate the buffer for the whole response upfront if its length is known.
+        curl_off_t contentLength = -1;
+        if ((curl_easy_getinfo(request->handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength) == CURLE_OK) &&
+            (contentLength > 0)) {
+            request->response.reserve(static_cast<qsizetype>(contentLength));
+        }
+    }
+    request->response.append(static_cast<char*>(contents), static_cast<qsizetype>(realSize));
+    return realSize;
+}
+
+static qint64 xPlayerBluOSClient_now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+xPlayerBluOSClient::xPlayerBluOSClient():
+        clientStopped(false),
+        clientMutex(),
+        clientPending(),
+        clientOrdered(),
+        clientOrderedRunning(false),
+        clientRunning(),
+        clientHandles(),
+        clientLatency(0),
+        clientCompleted(0) {
+    clientMulti = curl_multi_init();
+    // Reuse the connections. Multiplexing is only used if supported by the player.
+    curl_multi_setopt(clientMulti, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(clientMulti, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(xPlayerBluOSClient_MaxConnections));
+    curl_multi_setopt(clientMulti, CURLMOPT_MAXCONNECTS, static_cast<long>(xPlayerBluOSClient_MaxConnections));
+    clientThread = QThread::create([this]() { run(); });
+    clientThread->start();
+}
+
+xPlayerBluOSClient::~xPlayerBluOSClient() {
+    clientStopped = true;
+    curl_multi_wakeup(clientMulti);
+    clientThread->wait();
+    delete clientThread;
+    // Complete all outstanding requests with an empty result.
+    for (auto& request : clientPending) {
+        request.completed({});
+    }
+    for (auto& request : clientOrdered) {
+        request.completed({});
+    }
+    for (auto& [handle, request] : clientRunning) {
+        curl_multi_remove_handle(clientMulti, handle);
+        curl_easy_cleanup(handle);
+        request.completed({});
+    }
+    for (auto handle : clientHandles) {
+        curl_easy_cleanup(handle);
+    }
+    curl_multi_cleanup(clientMulti);
+}
+
+std::future<QByteArray> xPlayerBluOSClient::request(const QUrl& url, bool ordered) {
+    auto result = std::make_shared<std::promise<QByteArray>>();
+    auto future = result->get_future();
+    enqueue({ url, ordered, 0, [result](QByteArray response) { result->set_value(std::move(response)); }, {}, 0, nullptr });
+    return future;
+}
+
+void xPlayerBluOSClient::request(const QUrl& url, QObject* context, const std::function<void(QByteArray)>& callback,
+                                 bool ordered, int timeout) {
+    QPointer<QObject> callbackContext(context);
+    enqueue({ url, ordered, timeout, [callbackContext, callback](QByteArray response) {
+        if (callbackContext) {
+            // Move the response along. The callback can parse the buffer in place without a copy.
+            QMetaObject::invokeMethod(callbackContext.data(), [callback, response=std::move(response)]() mutable {
+                callback(std::move(response));
+            }, Qt::QueuedConnection);
+        }
+    }, {}, 0, nullptr });
+}
+
+qint64 xPlayerBluOSClient::getAverageLatency() const {
+    auto completed = clientCompleted.load();
+    return (completed > 0) ? clientLatency.load() / completed : 0;
+}
+
+qint64 xPlayerBluOSClient::getCompletedRequests() const {
+    return clientCompleted.load();
+}
+
+void xPlayerBluOSClient::enqueue(xPlayerBluOSRequest&& request) {
+    qDebug() << "xPlayerBluOSClient::request: url: " << request.url.toEncoded();
+    request.started = xPlayerBluOSClient_now();
+    {
+        QMutexLocker lock(&clientMutex);
+        clientPending.emplace_back(std::move(request));
+    }
+    curl_multi_wakeup(clientMulti);
+}
+
+void xPlayerBluOSClient::run() {
+    while (!clientStopped) {
+        std::vector<xPlayerBluOSRequest> pending;
+        {
+            QMutexLocker lock(&clientMutex);
+            pending.swap(clientPending);
+        }
+        for (auto& request : pending) {
+            if (request.ordered) {
+                clientOrdered.emplace_back(std::move(request));
+            } else {
+                start(std::move(request));
+            }
+        }
+        // Only one ordered request is running at any time.
+        if ((!clientOrderedRunning) && (!clientOrdered.empty())) {
+            clientOrderedRunning = true;
+            start(std::move(clientOrdered.front()));
+            clientOrdered.pop_front();
+        }
+        int running = 0;
+        curl_multi_perform(clientMulti, &running);
+        // Start the next ordered request without waiting.
+        if ((complete()) && (!clientOrdered.empty())) {
+            continue;
+        }
+        curl_multi_poll(clientMulti, nullptr, 0, xPlayerBluOSClient_PollTimeout, nullptr);
+    }
+}
+
+void xPlayerBluOSClient::start(xPlayerBluOSRequest&& request) {
+    CURL* handle;
+    if (clientHandles.empty()) {
+        handle = curl_easy_init();
+    } else {
+        handle = clientHandles.back();
+        clientHandles.pop_back();
+    }
+    // The map node is not moved. The response can be used as write data.
+    auto& runningRequest = clientRunning[handle];
+    runningRequest = std::move(request);
+    runningRequest.handle = handle;
+    curl_easy_setopt(handle, CURLOPT_URL, runningRequest.url.toEncoded().constData());
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, xPlayerBluOSClient_write);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, static_cast<void*>(&runningRequest));
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, static_cast<long>((runningRequest.timeout > 0) ?
+                                                                   runningRequest.timeout : xPlayerBluOSClient_RequestTimeout));
+    curl_multi_add_handle(clientMulti, handle);
+}
+
+bool xPlayerBluOSClient::complete() {
+    auto orderedCompleted = false;
+    int messages = 0;
+    while (auto message = curl_multi_info_read(clientMulti, &messages)) {
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+        auto handle = message->easy_handle;
+        auto result = message->data.result;
+        long status = 0;
+        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+        curl_multi_remove_handle(clientMulti, handle);
+        auto runningRequest = clientRunning.find(handle);
+        auto request = std::move(runningRequest->second);
+        clientRunning.erase(runningRequest);
+        // Keep the handle. Its connection is kept in the connection cache of the multi handle.
+        clientHandles.push_back(handle);
+        clientLatency += xPlayerBluOSClient_now() - request.started;
+        ++clientCompleted;
+        if (request.ordered) {
+            clientOrderedRunning = false;
+            orderedCompleted = true;
+        }
+        if ((result == CURLE_OK) && (status >= 200) && (status < 300)) {
+            request.completed(std::move(request.response));
+        } else if (result == CURLE_OK) {
+            // The body of an error reply is not a valid response.
+            qWarning() << "xPlayerBluOSClient: request failed: " << request.url << ", HTTP status: " << status;
+            request.completed({});
+        } else {
+            qWarning() << "xPlayerBluOSClient: request failed: " << request.url << ", " << curl_easy_strerror(result);
+            request.completed({});
+        }
+    }
+    return orderedCompleted;
+}
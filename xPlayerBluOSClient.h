@@ -0,0 +1,132 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XPLAYERBLUOSCLIENT_H__
+#define __XPLAYERBLUOSCLIENT_H__
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QUrl>
+
+#include <curl/curl.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <vector>
+
+
+/**
+ * Asynchronous HTTP client for the BluOS player based on the curl multi interface.
+ *
+ * All requests are performed in a single client thread. The connections to the
+ * player are kept alive and reused. Unordered requests are performed concurrently
+ * on up to xPlayerBluOSClient_MaxConnections connections. Ordered requests are
+ * performed one after another in the order they were issued, e.g. modifications
+ * of the queue. The result is either delivered to a callback in the thread of a
+ * context object or through a future.
+ */
+class xPlayerBluOSClient {
+public:
+    xPlayerBluOSClient();
+    ~xPlayerBluOSClient();
+    /**
+     * Issue a request and deliver the result through a future.
+     *
+     * Waiting on the future must not be done within the GUI thread.
+     *
+     * @param url the request as URL.
+     * @param ordered perform the request after all previous ordered requests if true.
+     * @return the future for the raw request result, empty on error or on a non-2xx status.
+     */
+    std::future<QByteArray> request(const QUrl& url, bool ordered=false);
+    /**
+     * Issue a request and deliver the result to a callback.
+     *
+     * The callback is called within the thread of the context object. It is not
+     * called if the context object has been deleted in the meantime.
+     *
+     * @param url the request as URL.
+     * @param context the context object that determines the thread of the callback.
+     * @param callback the function called with the raw request result, empty on error or on a non-2xx status.
+     * @param ordered perform the request after all previous ordered requests if true.
+     * @param timeout the timeout for the request in ms, 0 for the default timeout.
+     */
+    void request(const QUrl& url, QObject* context, const std::function<void(QByteArray)>& callback,
+                 bool ordered=false, int timeout=0);
+    /**
+     * Return the average round-trip latency of the completed requests.
+     *
+     * @return the average latency in microseconds.
+     */
+    [[nodiscard]] qint64 getAverageLatency() const;
+    /**
+     * Return the number of completed requests.
+     *
+     * @return the number of requests.
+     */
+    [[nodiscard]] qint64 getCompletedRequests() const;
+    /**
+     * Request handled by the client thread. The response is received by the curl write callback.
+     */
+    struct xPlayerBluOSRequest {
+        QUrl url;
+        bool ordered;
+        int timeout;
+        std::function<void(QByteArray)> completed;
+        QByteArray response;
+        qint64 started;
+        CURL* handle;
+    };
+
+private:
+    /**
+     * Queue a request for the client thread and wake it up.
+     *
+     * @param request the request to be performed.
+     */
+    void enqueue(xPlayerBluOSRequest&& request);
+    /**
+     * Main loop of the client thread.
+     */
+    void run();
+    /**
+     * Add a request to the curl multi handle. Called in the client thread.
+     *
+     * @param request the request to be performed.
+     */
+    void start(xPlayerBluOSRequest&& request);
+    /**
+     * Handle the completed transfers. Called in the client thread.
+     *
+     * @return true if an ordered request has completed, false otherwise.
+     */
+    bool complete();
+
+    CURLM* clientMulti;
+    QThread* clientThread;
+    std::atomic<bool> clientStopped;
+    QMutex clientMutex;
+    std::vector<xPlayerBluOSRequest> clientPending;
+    std::deque<xPlayerBluOSRequest> clientOrdered;
+    bool clientOrderedRunning;
+    std::map<CURL*,xPlayerBluOSRequest> clientRunning;
+    std::vector<CURL*> clientHandles;
+    std::atomic<qint64> clientLatency;
+    std::atomic<qint64> clientCompleted;
+};
+
+#endif
@@ -13,30 +13,108 @@
  */
 
 #include "xPlayerBluOSControl.h"
+#include "xPlayerBluOSResponse.h"
+#include "xPlayerDatabase.h"
 
-#include <QThread>
-#include <QFileInfo>
 #include <QDebug>
 
+#include <algorithm>
+#include <deque>
 #include <iostream>
 #include <memory>
 
+// Maximal number of concurrent folder requests while crawling the library.
+constexpr size_t xPlayerBluOSControls_CrawlRequests = 8;
+// Number of times a failed folder request is retried while crawling the library.
+constexpr auto xPlayerBluOSControls_CrawlRetries = 3;
+
+/**
+ * Determine a longest increasing subsequence of the given permutation.
+ *
+ * @param order the permutation of the positions 0 to n-1.
+ * @return a vector that marks the positions that are part of the subsequence.
+ */
+static std::vector<bool> xPlayerBluOSControls_increasing(const std::vector<int>& order) {
+    // Index of the smallest last element of an increasing subsequence for each length.
+    std::vector<int> tails;
+    std::vector<int> previous(order.size(), -1);
+    for (auto index = 0; index < static_cast<int>(order.size()); ++index) {
+        auto tail = std::lower_bound(tails.begin(), tails.end(), order[index], [&order](int tailIndex, int position) {
+            return order[tailIndex] < position;
+        });
+        if (tail != tails.begin()) {
+            previous[index] = *(tail-1);
+        }
+        if (tail == tails.end()) {
+            tails.push_back(index);
+        } else {
+            *tail = index;
+        }
+    }
+    std::vector<bool> increasing(order.size(), false);
+    for (auto index = (tails.empty()) ? -1 : tails.back(); index >= 0; index = previous[index]) {
+        increasing[order[index]] = true;
+    }
+    return increasing;
+}
+
 
 xPlayerBluOSControls* xPlayerBluOSControls::bluOSControls = nullptr;
 
 xPlayerBluOSControls::xPlayerBluOSControls():
         QObject(),
         bluOSMutex(),
-        bluOSReIndexingInProgress(false) {
-    bluOSRequests = curl_easy_init();
-    bluOSStatus = new QTimer(this);
-    bluOSReIndexing = new QTimer(this);
-    QObject::connect(bluOSStatus, &QTimer::timeout, [=]() {
-        parsePlayerStatus(sendCommand(QUrl(bluOSUrl+"/Status")));
+        bluOSPlaylistIds(),
+        bluOSStatusPath(),
+        bluOSStatusIndex(-1),
+        bluOSStatusQuality(),
+        bluOSState(),
+        bluOSVolume(-1),
+        bluOSMuted(false),
+        bluOSShuffle(false),
+        bluOSQueue(),
+        bluOSQueuePending(0),
+        bluOSQueueRefresh(false) {
+    bluOSClient = new xPlayerBluOSClient();
+    bluOSStatusTracker = new xPlayerBluOSStatusTracker(bluOSClient, this);
+    QObject::connect(bluOSStatusTracker, &xPlayerBluOSStatusTracker::trackChanged,
+                     [=](const QString& path, int index, const QString& quality) {
+        bluOSStatusPath = path;
+        bluOSStatusIndex = index;
+        bluOSStatusQuality = quality;
     });
-    QObject::connect(bluOSReIndexing, &QTimer::timeout, [=]() {
-        parseIndexing(sendCommand(QUrl(bluOSUrl+"/Status")));
+    QObject::connect(bluOSStatusTracker, &xPlayerBluOSStatusTracker::positionChanged, [=](qint64 position) {
+        emit playerStatus(bluOSStatusPath, bluOSStatusIndex, position, bluOSStatusQuality);
+    });
+    QObject::connect(bluOSStatusTracker, &xPlayerBluOSStatusTracker::stateChanged, [=](const QString& state) {
+        bluOSState = state;
+    });
+    QObject::connect(bluOSStatusTracker, &xPlayerBluOSStatusTracker::volumeChanged, [=](int vol) {
+        bluOSVolume = vol;
+        emit volume(vol);
+    });
+    QObject::connect(bluOSStatusTracker, &xPlayerBluOSStatusTracker::muteChanged, [=](bool mute) {
+        bluOSMuted = mute;
+        emit muted(mute);
+    });
+    QObject::connect(bluOSStatusTracker, &xPlayerBluOSStatusTracker::shuffleChanged, [=](bool shuffle) {
+        bluOSShuffle = shuffle;
+    });
+    QObject::connect(bluOSStatusTracker, &xPlayerBluOSStatusTracker::queueLengthChanged, [=](int length) {
+        // Refresh the queue mirror if the queue was modified by other BluOS controllers.
+        if ((bluOSQueuePending == 0) && (!bluOSQueueRefresh) && (length != bluOSQueue.size())) {
+            refreshQueue();
+        }
+    });
+    QObject::connect(bluOSStatusTracker, &xPlayerBluOSStatusTracker::indexingChanged, [=](int noTracks) {
+        emit playerReIndexing(noTracks);
+        // The library of the player changes. Crawl it again on the next scan.
+        // The player may also be reindexed by other BluOS controllers.
+        if (noTracks > 0) {
+            invalidateLibrary();
+        }
     });
+    QObject::connect(bluOSStatusTracker, &xPlayerBluOSStatusTracker::stopped, this, &xPlayerBluOSControls::playerStopped);
     // The English language variant for parsing the track info.
     bluOSTrackInfoRegExpr.push_back(std::make_unique<QRegularExpression>("sample.*rate.*>(?<samplerate>\\d+).*\n.*sample.*size.*>(?<bitspersample>\\d+)"));
     // The German language variant for parsing the track info.
@@ -44,10 +122,8 @@ xPlayerBluOSControls::xPlayerBluOSControls():
 }
 
 xPlayerBluOSControls::~xPlayerBluOSControls() {
-    curl_easy_cleanup(bluOSRequests);
-    if (bluOSStatus) {
-        bluOSStatus->stop();
-    }
+    bluOSStatusTracker->stop();
+    delete bluOSClient;
 }
 
 xPlayerBluOSControls* xPlayerBluOSControls::controls() {
@@ -61,112 +137,201 @@ xPlayerBluOSControls* xPlayerBluOSControls::controls() {
 void xPlayerBluOSControls::reIndex() {
     // Stop the player.
     stop();
-    if (!bluOSReIndexing->isActive()) {
-        // Force the reindexing.
-        sendCommand(QUrl(bluOSUrl+"/Reindex"));
-        bluOSReIndexing->start(2000);
-        // Issue the first Status command immediately.
-        parseIndexing(sendCommand(QUrl(bluOSUrl+"/Status")));
-    }
+    // Force the reindexing. The progress is reported by the status tracker.
+    postCommand(QUrl(bluOSUrl+"/Reindex"));
+    invalidateLibrary();
 }
 
 void xPlayerBluOSControls::play() {
-    sendCommand(QUrl(bluOSUrl+"/Play"));
-    if (!bluOSStatus->isActive()) {
-        bluOSStatus->start(1000);
-    }
+    postCommand(QUrl(bluOSUrl+"/Play"));
+    bluOSState = "play";
 }
 
 void xPlayerBluOSControls::play(int index) {
-    sendCommand(QUrl(bluOSUrl+QString("/Play?id=%1").arg(index)));
-    if (!bluOSStatus->isActive()) {
-        bluOSStatus->start(1000);
-    }
+    postCommand(QUrl(bluOSUrl+QString("/Play?id=%1").arg(index)));
+    bluOSState = "play";
 }
 
 void xPlayerBluOSControls::pause() {
-    sendCommand(QUrl(bluOSUrl+"/Pause"));
-    bluOSStatus->stop();
+    postCommand(QUrl(bluOSUrl+"/Pause"));
+    bluOSState = "pause";
 }
 
 void xPlayerBluOSControls::stop() {
-    sendCommand(QUrl(bluOSUrl+"/Stop"));
-    bluOSStatus->stop();
+    postCommand(QUrl(bluOSUrl+"/Stop"));
+    bluOSState = "stop";
 }
 
 void xPlayerBluOSControls::seek(qint64 position) {
-    sendCommand(QUrl(bluOSUrl+QString("/Play?seek=%1").arg(position/1000)));
+    postCommand(QUrl(bluOSUrl+QString("/Play?seek=%1").arg(position/1000)));
     // Seek will start playing the current track.
-    if (!bluOSStatus->isActive()) {
-        bluOSStatus->start(1000);
-    }
+    bluOSState = "play";
 }
 
 void xPlayerBluOSControls::prev() {
-    sendCommand(QUrl(bluOSUrl+"/Back"));
-    if (!bluOSStatus->isActive()) {
-        bluOSStatus->start(1000);
-    }
+    postCommand(QUrl(bluOSUrl+"/Back"));
 }
 
 void xPlayerBluOSControls::next() {
-    sendCommand(QUrl(bluOSUrl+"/Skip"));
-    if (!bluOSStatus->isActive()) {
-        bluOSStatus->start(1000);
-    }
+    postCommand(QUrl(bluOSUrl+"/Skip"));
 }
 
-QString xPlayerBluOSControls::state() {
-    return parseState(sendCommand(QUrl(bluOSUrl+"/Status")));
+QString xPlayerBluOSControls::state() const {
+    return bluOSState;
+}
+
+void xPlayerBluOSControls::state(const std::function<void(const QString&)>& callback) {
+    sendCommand(QUrl(bluOSUrl+"/Status"), [=](QByteArray commandResult) {
+        bluOSState = parseState(std::move(commandResult));
+        callback(bluOSState);
+    });
 }
 
 void xPlayerBluOSControls::addQueue(const QString& path) {
-    sendCommand(QUrl(bluOSUrl+"/Add?file="+correctHtmlString(path)));
+    postQueueCommand(QUrl(bluOSUrl+"/Add?file="+correctHtmlString(path)));
+    bluOSQueue.push_back(path);
 }
 
 void xPlayerBluOSControls::removeQueue(int index) {
-    sendCommand(QUrl(bluOSUrl+QString("/Delete?id=%1").arg(index)));
+    if ((index < 0) || (index >= bluOSQueue.size())) {
+        return;
+    }
+    postQueueCommand(QUrl(bluOSUrl+QString("/Delete?id=%1").arg(index)));
+    bluOSQueue.removeAt(index);
 }
 
-QStringList xPlayerBluOSControls::queue() {
-    return parsePlaylist(sendCommand(QUrl(bluOSUrl+"/Playlist")));
+void xPlayerBluOSControls::moveQueue(int fromIndex, int toIndex) {
+    if ((fromIndex < 0) || (fromIndex >= bluOSQueue.size()) || (toIndex < 0) ||
+        (toIndex >= bluOSQueue.size()) || (fromIndex == toIndex)) {
+        return;
+    }
+    postQueueCommand(QUrl(bluOSUrl+QString("/Move?new=%1&old=%2").arg(toIndex).arg(fromIndex)));
+    bluOSQueue.move(fromIndex, toIndex);
+}
+
+void xPlayerBluOSControls::syncQueue(const QStringList& playlist) {
+    // Count the required occurrences of each track. A track may be queued multiple times.
+    QHash<QString,int> required;
+    for (const auto& path : playlist) {
+        ++required[path];
+    }
+    // Keep the first required occurrences and remove all others.
+    QHash<QString,int> kept;
+    std::vector<int> removals;
+    for (auto index = 0; index < bluOSQueue.size(); ++index) {
+        const auto& path = bluOSQueue[index];
+        if (kept.value(path) < required.value(path)) {
+            ++kept[path];
+        } else {
+            removals.push_back(index);
+        }
+    }
+    // Remove starting at the end of the queue. The remaining indices are not affected.
+    for (auto removal = removals.rbegin(); removal != removals.rend(); ++removal) {
+        removeQueue(*removal);
+    }
+    // Append the missing tracks.
+    for (const auto& path : playlist) {
+        if (kept.value(path) > 0) {
+            --kept[path];
+        } else {
+            addQueue(path);
+        }
+    }
+    // Reorder. Determine the position in the playlist for each track in the queue.
+    // Tracks queued multiple times keep their relative order.
+    QHash<QString,std::deque<int>> positions;
+    for (auto index = 0; index < playlist.size(); ++index) {
+        positions[playlist[index]].push_back(index);
+    }
+    std::vector<int> order;
+    order.reserve(bluOSQueue.size());
+    for (const auto& path : bluOSQueue) {
+        auto& pathPositions = positions[path];
+        order.push_back(pathPositions.front());
+        pathPositions.pop_front();
+    }
+    // The tracks of a longest increasing subsequence keep their place. Only the other
+    // tracks are moved, each right behind the track preceding it in the playlist.
+    auto unmoved = xPlayerBluOSControls_increasing(order);
+    for (auto position = 0; position < static_cast<int>(order.size()); ++position) {
+        if (unmoved[position]) {
+            continue;
+        }
+        auto fromIndex = static_cast<int>(std::find(order.begin(), order.end(), position)-order.begin());
+        auto toIndex = 0;
+        if (position > 0) {
+            auto previousIndex = static_cast<int>(std::find(order.begin(), order.end(), position-1)-order.begin());
+            toIndex = (fromIndex < previousIndex) ? previousIndex : previousIndex+1;
+        }
+        moveQueue(fromIndex, toIndex);
+        order.erase(order.begin()+fromIndex);
+        order.insert(order.begin()+toIndex, position);
+    }
+}
+
+QStringList xPlayerBluOSControls::queue() const {
+    return bluOSQueue;
 }
 
 void xPlayerBluOSControls::clearQueue() {
-    sendCommand(QUrl(bluOSUrl+"/Clear"));
+    postQueueCommand(QUrl(bluOSUrl+"/Clear"));
+    bluOSQueue.clear();
+}
+
+void xPlayerBluOSControls::refreshQueue() {
+    bluOSQueueRefresh = true;
+    sendCommand(QUrl(bluOSUrl+"/Playlist"), [=](QByteArray commandResult) {
+        bluOSQueueRefresh = false;
+        // Queue commands issued in the meantime are not part of the result.
+        if (bluOSQueuePending == 0) {
+            bluOSQueue = parsePlaylist(std::move(commandResult));
+        }
+    });
 }
 
 void xPlayerBluOSControls::setVolume(int vol) {
-    sendCommand(QUrl(bluOSUrl+QString("/Volume?level=%1").arg(vol)));
+    postCommand(QUrl(bluOSUrl+QString("/Volume?level=%1").arg(vol)));
+    bluOSVolume = vol;
     emit volume(vol);
 }
 
-int xPlayerBluOSControls::getVolume() {
-    return parseVolume(sendCommand(QUrl(bluOSUrl+"/Volume")));
+int xPlayerBluOSControls::getVolume() const {
+    return bluOSVolume;
+}
+
+void xPlayerBluOSControls::getVolume(const std::function<void(int)>& callback) {
+    sendCommand(QUrl(bluOSUrl+"/Volume"), [=](QByteArray commandResult) {
+        bluOSVolume = parseVolume(std::move(commandResult));
+        callback(bluOSVolume);
+    });
 }
 
 void xPlayerBluOSControls::setMuted(bool mute) {
-    sendCommand(QUrl(bluOSUrl+QString("/Volume?mute=%1").arg(static_cast<int>(mute))));
+    postCommand(QUrl(bluOSUrl+QString("/Volume?mute=%1").arg(static_cast<int>(mute))));
+    bluOSMuted = mute;
     emit muted(mute);
 }
 
-bool xPlayerBluOSControls::isMuted() {
-    return parseMute(sendCommand(QUrl(bluOSUrl+QString("/Status"))));
+bool xPlayerBluOSControls::isMuted() const {
+    return bluOSMuted;
 }
 
 void xPlayerBluOSControls::setShuffle(bool shuffle) {
-    sendCommand(QUrl(bluOSUrl+QString("/Shuffle?state=%1").arg(static_cast<int>(shuffle))));
+    postCommand(QUrl(bluOSUrl+QString("/Shuffle?state=%1").arg(static_cast<int>(shuffle))));
+    bluOSShuffle = shuffle;
 }
 
-bool xPlayerBluOSControls::isShuffle() {
-    return parseShuffle(sendCommand(QUrl(bluOSUrl+QString("/Status"))));
+bool xPlayerBluOSControls::isShuffle() const {
+    return bluOSShuffle;
 }
 
 std::vector<xDirectoryEntry> xPlayerBluOSControls::getArtists() {
     std::vector<xDirectoryEntry> artists;
-    auto artistsPath = bluOSUrl+"/Folders?&service=LocalMusic&path="+bluOSBasePath;
+    auto artistsPath = folderPath();
     qDebug() << "xPlayerBluOSControls::getArtists: " << artistsPath;
-    auto artistNames = parseFolders(sendCommand(artistsPath));
+    std::vector<QString> artistNames;
+    parseFolders(sendCommand(artistsPath), artistNames);
     artists.reserve(artistNames.size());
     for (const auto& artistName : artistNames) {
         artists.emplace_back(QUrl(artistsPath+"/"+artistName), QString(), artistName, -1);
@@ -176,9 +341,10 @@ std::vector<xDirectoryEntry> xPlayerBluOSControls::getArtists() {
 
 std::vector<xDirectoryEntry> xPlayerBluOSControls::getAlbums(const QString& artist) {
     std::vector<xDirectoryEntry> albums;
-    auto albumsPath = bluOSUrl+"/Folders?&service=LocalMusic&path="+bluOSBasePath+"/"+correctHtmlString(artist);
+    auto albumsPath = folderPath(artist);
     qDebug() << "xPlayerBluOSControls::getAlbums: " << albumsPath;
-    auto albumNames = parseFolders(sendCommand(albumsPath));
+    std::vector<QString> albumNames;
+    parseFolders(sendCommand(albumsPath), albumNames);
     albums.reserve(albumNames.size());
     for (const auto& albumName : albumNames) {
         albums.emplace_back(QUrl(albumsPath+"/"+albumName), QString(), albumName, -1);
@@ -188,9 +354,10 @@ std::vector<xDirectoryEntry> xPlayerBluOSControls::getAlbums(const QString& arti
 
 std::vector<xDirectoryEntry> xPlayerBluOSControls::getTracks(const QString& artist, const QString& album) {
     std::vector<xDirectoryEntry> tracks;
-    auto tracksPath = bluOSUrl+"/Folders?&service=LocalMusic&path="+bluOSBasePath+"/"+correctHtmlString(artist)+"/"+correctHtmlString(album);
+    auto tracksPath = folderPath(artist, album);
     qDebug() << "xPlayerBluOSControls::getTracks: " << tracksPath;
-    auto trackInfos = parseTracks(sendCommand(tracksPath));
+    std::vector<std::tuple<QString,QString,qint64>> trackInfos;
+    parseTracks(sendCommand(tracksPath), trackInfos);
     tracks.reserve(trackInfos.size());
     for (const auto& [trackPath, trackName, trackLength] : trackInfos) {
         tracks.emplace_back(QUrl(tracksPath+"/"+trackName), trackPath, trackName, trackLength);
@@ -198,176 +365,336 @@ std::vector<xDirectoryEntry> xPlayerBluOSControls::getTracks(const QString& arti
     return tracks;
 }
 
-std::tuple<int,int> xPlayerBluOSControls::getTrackInfo(const QString& path) {
-    auto trackId = parsePlaylistTrackId(sendCommand(QUrl(bluOSUrl+"/Playlist")), path);
-    auto trackInfoPath = bluOSUrl + QString("/Info?service=LocalMusic&category=technical&songid=%1&service=library").arg(trackId);
-    return parseTrackInfo(sendCommand(trackInfoPath));
-}
-
-// Helper function for sendCommand. Callback that stores the result into a string.
-static size_t CurlWriteMemoryCallback(void* contents, size_t mSize, size_t nMembers, void* userPointer) {
-  auto response = static_cast<QString*>(userPointer);
-  size_t realSize = mSize * nMembers;
-  response->append(QString::fromStdString(std::string(static_cast<char*>(contents), realSize)));
-  return realSize;
+void xPlayerBluOSControls::getTrackInfo(const QString& path, const std::function<void(int,int)>& callback) {
+    auto trackInfo = [=](int trackId) {
+        auto trackInfoPath = bluOSUrl + QString("/Info?service=LocalMusic&category=technical&songid=%1&service=library").arg(trackId);
+        sendCommand(QUrl(trackInfoPath), [=](QByteArray commandResult) {
+            auto [sampleRate, bitsPerSample] = parseTrackInfo(std::move(commandResult));
+            callback(sampleRate, bitsPerSample);
+        });
+    };
+    auto trackId = playlistTrackId(path);
+    if (trackId >= 0) {
+        trackInfo(trackId);
+        return;
+    }
+    // Cache the song ids of the current playlist. Subsequent tracks only require a single request.
+    sendCommand(QUrl(bluOSUrl+"/Playlist"), [=](QByteArray commandResult) {
+        auto playlistIds = parsePlaylistTrackIds(std::move(commandResult));
+        auto playlistTrackId = playlistIds.value(path, -1);
+        // Queue commands issued in the meantime are not part of the result.
+        if (bluOSQueuePending == 0) {
+            QMutexLocker locker(&bluOSMutex);
+            bluOSPlaylistIds = playlistIds;
+        }
+        if (playlistTrackId < 0) {
+            qWarning() << "xPlayerBluOSControls::getTrackInfo: track not in playlist: " << path;
+            callback(-1, -1);
+            return;
+        }
+        trackInfo(playlistTrackId);
+    });
 }
 
-QString xPlayerBluOSControls::sendCommand(const QUrl& url) {
+std::vector<xRemoteLibraryArtist> xPlayerBluOSControls::getLibrary(const std::function<bool()>& interrupted) {
     if (bluOSUrl.isEmpty()) {
-        qWarning() << "xPlayerBluOSControls::sendCommand: not connected, ignoring command: " << url;
         return {};
     }
-    QMutexLocker locker(&bluOSMutex);
-    QString curlResponse;
-    qDebug() << "xPlayerBluOSControls::sendCommand: url: " << url.toEncoded();
-    if (bluOSRequests) {
-        curl_easy_setopt(bluOSRequests, CURLOPT_URL, url.toEncoded().toStdString().c_str());
-        /* send all data to this function  */
-        curl_easy_setopt(bluOSRequests, CURLOPT_WRITEFUNCTION, CurlWriteMemoryCallback);
-        /* we pass a string to the callback function */
-        curl_easy_setopt(bluOSRequests, CURLOPT_WRITEDATA, (void *)&curlResponse);
-        if (curl_easy_perform(bluOSRequests) != CURLE_OK) {
+    auto cachedTracks = xPlayerDatabase::database()->getRemoteLibrary(bluOSUrl);
+    if (!cachedTracks.isEmpty()) {
+        qDebug() << "xPlayerBluOSControls::getLibrary: cached tracks: " << cachedTracks.size();
+        return cachedLibrary(cachedTracks);
+    }
+    auto library = crawlLibrary(interrupted);
+    if (library.empty()) {
+        // Interrupted or incomplete crawls are not stored in the cache.
+        return {};
+    }
+    // Store the crawled library in the cache. Artists without albums and albums without
+    // tracks are stored as entries with an empty album or track name.
+    QList<xRemoteLibraryTrack> tracks;
+    for (const auto& artist : library) {
+        const auto& artistName = std::get<2>(artist.artist);
+        if (artist.albums.empty()) {
+            tracks.push_back({ artistName, QString(), QString(), QString(), -1 });
+        }
+        for (const auto& album : artist.albums) {
+            if (album.tracks.empty()) {
+                tracks.push_back({ artistName, std::get<2>(album.album), QString(), QString(), -1 });
+            }
+            for (const auto& [trackUrl, trackPath, trackName, trackLength] : album.tracks) {
+                tracks.push_back({ artistName, std::get<2>(album.album), trackPath, trackName, trackLength });
+            }
+        }
+    }
+    xPlayerDatabase::database()->updateRemoteLibrary(bluOSUrl, tracks);
+    qDebug() << "xPlayerBluOSControls::getLibrary: crawled tracks: " << tracks.size();
+    return library;
+}
+
+std::vector<xRemoteLibraryArtist> xPlayerBluOSControls::crawlLibrary(const std::function<bool()>& interrupted) {
+    // A folder request for the albums of an artist (empty album) or the tracks of an album.
+    struct xCrawlRequest {
+        size_t artist;
+        size_t album;
+        int attempts;
+        std::future<QByteArray> result;
+    };
+    const auto noAlbum = static_cast<size_t>(-1);
+    auto artistsPath = folderPath();
+    std::vector<QString> artistNames;
+    for (auto attempts = 0; !parseFolders(sendCommand(QUrl(artistsPath)), artistNames); ++attempts) {
+        if ((attempts >= xPlayerBluOSControls_CrawlRetries) || (interrupted())) {
+            qCritical() << "xPlayerBluOSControls::crawlLibrary: artists request failed, aborting crawl.";
+            return {};
+        }
+    }
+    std::vector<xRemoteLibraryArtist> library;
+    library.reserve(artistNames.size());
+    for (const auto& artistName : artistNames) {
+        library.push_back({ xDirectoryEntry(QUrl(artistsPath+"/"+artistName), QString(), artistName, -1), {} });
+    }
+    std::deque<std::tuple<size_t,size_t,int>> pending;
+    for (size_t artistIndex = 0; artistIndex < library.size(); ++artistIndex) {
+        pending.emplace_back(artistIndex, noAlbum, 0);
+    }
+    // Keep a bounded number of requests in flight. The client spreads them over its connections.
+    std::deque<xCrawlRequest> inFlight;
+    while ((!pending.empty()) || (!inFlight.empty())) {
+        if (interrupted()) {
+            // Outstanding requests complete in the client. Their results are dropped.
+            return {};
+        }
+        while ((!pending.empty()) && (inFlight.size() < xPlayerBluOSControls_CrawlRequests)) {
+            auto [artistIndex, albumIndex, attempts] = pending.front();
+            pending.pop_front();
+            const auto& artistName = std::get<2>(library[artistIndex].artist);
+            auto path = (albumIndex == noAlbum) ? folderPath(artistName) :
+                        folderPath(artistName, std::get<2>(library[artistIndex].albums[albumIndex].album));
+            inFlight.push_back({ artistIndex, albumIndex, attempts, bluOSClient->request(QUrl(path)) });
+        }
+        auto request = std::move(inFlight.front());
+        inFlight.pop_front();
+        // The client reports failed, timed out and non-2xx requests with an empty result.
+        // An empty result cannot be parsed.
+        auto commandResult = request.result.get();
+        auto& artist = library[request.artist];
+        const auto& artistName = std::get<2>(artist.artist);
+        auto parsed = false;
+        if (request.album == noAlbum) {
+            std::vector<QString> albumNames;
+            parsed = parseFolders(std::move(commandResult), albumNames);
+            if (parsed) {
+                auto albumsPath = folderPath(artistName);
+                for (const auto& albumName : albumNames) {
+                    artist.albums.push_back({ xDirectoryEntry(QUrl(albumsPath+"/"+albumName), QString(), albumName, -1), {} });
+                    pending.emplace_back(request.artist, artist.albums.size()-1, 0);
+                }
+            }
+        } else {
+            std::vector<std::tuple<QString,QString,qint64>> trackInfos;
+            parsed = parseTracks(std::move(commandResult), trackInfos);
+            if (parsed) {
+                auto& album = artist.albums[request.album];
+                auto tracksPath = folderPath(artistName, std::get<2>(album.album));
+                for (const auto& [trackPath, trackName, trackLength] : trackInfos) {
+                    album.tracks.emplace_back(QUrl(tracksPath+"/"+trackName), trackPath, trackName, trackLength);
+                }
+            }
+        }
+        if (!parsed) {
+            if (request.attempts < xPlayerBluOSControls_CrawlRetries) {
+                pending.emplace_front(request.artist, request.album, request.attempts+1);
+                continue;
+            }
+            // Do not return a partial library. It would be stored in the cache.
+            qCritical() << "xPlayerBluOSControls::crawlLibrary: folder request failed, aborting crawl.";
             return {};
         }
     }
-    qDebug() << "xPlayerBluOSControls::sendCommand: " << curlResponse;
-    return curlResponse;
+    return library;
 }
 
-QString xPlayerBluOSControls::parseBasePath(const QString& commandResult) {
-    pugi::xml_parse_result result = bluOSResponse.load_string(commandResult.toStdString().c_str());
-    if (result) {
-        return QString::fromStdString(bluOSResponse.child("folders").child("subfolders").child("folder").child_value());
-    } else {
-        qCritical() << "Unable to parse result for base path: " << result.description();
+std::vector<xRemoteLibraryArtist> xPlayerBluOSControls::cachedLibrary(const QList<xRemoteLibraryTrack>& tracks) {
+    std::vector<xRemoteLibraryArtist> library;
+    auto artistsPath = folderPath();
+    // The tracks are sorted by artist and album.
+    for (const auto& track : tracks) {
+        if ((library.empty()) || (std::get<2>(library.back().artist) != track.artist)) {
+            library.push_back({ xDirectoryEntry(QUrl(artistsPath+"/"+track.artist), QString(), track.artist, -1), {} });
+        }
+        // Entry of an artist without albums.
+        if (track.album.isEmpty()) {
+            continue;
+        }
+        auto& albums = library.back().albums;
+        if ((albums.empty()) || (std::get<2>(albums.back().album) != track.album)) {
+            albums.push_back({ xDirectoryEntry(QUrl(folderPath(track.artist)+"/"+track.album), QString(), track.album, -1), {} });
+        }
+        // Entry of an album without tracks.
+        if (track.name.isEmpty()) {
+            continue;
+        }
+        albums.back().tracks.emplace_back(QUrl(folderPath(track.artist, track.album)+"/"+track.name),
+                                          track.path, track.name, track.length);
     }
-    return {};
+    return library;
 }
 
-QString xPlayerBluOSControls::parseState(const QString& commandResult) {
-    pugi::xml_parse_result result = bluOSResponse.load_string(commandResult.toStdString().c_str());
-    if (result) {
-        return QString::fromStdString(bluOSResponse.child("status").child("state").child_value());
-    } else {
-        qCritical() << "Unable to parse result for state: " << result.description();
+void xPlayerBluOSControls::invalidateLibrary() {
+    if (!bluOSUrl.isEmpty()) {
+        xPlayerDatabase::database()->removeRemoteLibrary(bluOSUrl);
     }
-    return {};
 }
 
-int xPlayerBluOSControls::parseVolume(const QString &commandResult) {
-    pugi::xml_parse_result result = bluOSResponse.load_string(commandResult.toStdString().c_str());
-    if (result) {
-        return QString::fromStdString(bluOSResponse.child("volume").child_value()).toInt();
-    } else {
-        qCritical() << "Unable to parse result for volume: " << result.description();
+QString xPlayerBluOSControls::folderPath(const QString& artist, const QString& album) const {
+    auto path = bluOSUrl+"/Folders?&service=LocalMusic&path="+bluOSBasePath;
+    if (!artist.isEmpty()) {
+        path += "/"+correctHtmlString(artist);
+        if (!album.isEmpty()) {
+            path += "/"+correctHtmlString(album);
+        }
     }
-    return -1;
+    return path;
 }
 
-bool xPlayerBluOSControls::parseMute(const QString& commandResult) {
-    pugi::xml_parse_result result = bluOSResponse.load_string(commandResult.toStdString().c_str());
-    if (result) {
-        return static_cast<bool>(QString::fromStdString(bluOSResponse.child("status").child("mute").child_value()).toInt());
+QByteArray xPlayerBluOSControls::sendCommand(const QUrl& url) {
+    if (bluOSUrl.isEmpty()) {
+        qWarning() << "xPlayerBluOSControls::sendCommand: not connected, ignoring command: " << url;
+        return {};
+    }
+    return bluOSClient->request(url).get();
+}
+
+void xPlayerBluOSControls::sendCommand(const QUrl& url, const std::function<void(QByteArray)>& callback) {
+    if (bluOSUrl.isEmpty()) {
+        qWarning() << "xPlayerBluOSControls::sendCommand: not connected, ignoring command: " << url;
+        return;
+    }
+    bluOSClient->request(url, this, callback, true);
+}
+
+void xPlayerBluOSControls::postQueueCommand(const QUrl& url) {
+    if (bluOSUrl.isEmpty()) {
+        qWarning() << "xPlayerBluOSControls::postQueueCommand: not connected, ignoring command: " << url;
+        return;
+    }
+    ++bluOSQueuePending;
+    sendCommand(url, [=](const QByteArray&) {
+        --bluOSQueuePending;
+    });
+    clearPlaylistIds();
+}
+
+void xPlayerBluOSControls::postCommand(const QUrl& url) {
+    if (bluOSUrl.isEmpty()) {
+        qWarning() << "xPlayerBluOSControls::postCommand: not connected, ignoring command: " << url;
+        return;
+    }
+    bluOSClient->request(url, this, [](const QByteArray&) { }, true);
+}
+
+int xPlayerBluOSControls::playlistTrackId(const QString& path) {
+    QMutexLocker locker(&bluOSMutex);
+    return bluOSPlaylistIds.value(path, -1);
+}
+
+void xPlayerBluOSControls::clearPlaylistIds() {
+    QMutexLocker locker(&bluOSMutex);
+    bluOSPlaylistIds.clear();
+}
+
+QString xPlayerBluOSControls::parseBasePath(QByteArray commandResult) {
+    xPlayerBluOSResponse response(std::move(commandResult));
+    if (response.isValid()) {
+        return QString::fromUtf8(response.child("folders").child("subfolders").child("folder").child_value());
     } else {
-        qCritical() << "Unable to parse result for state(mute): " << result.description();
+        qCritical() << "Unable to parse result for base path: " << response.description();
     }
-    return false;
+    return {};
 }
 
-bool xPlayerBluOSControls::parseShuffle(const QString& commandResult) {
-    pugi::xml_parse_result result = bluOSResponse.load_string(commandResult.toStdString().c_str());
-    if (result) {
-        return static_cast<bool>(QString::fromStdString(bluOSResponse.child("status").child("shuffle").child_value()).toInt());
+QString xPlayerBluOSControls::parseState(QByteArray commandResult) {
+    xPlayerBluOSResponse response(std::move(commandResult));
+    if (response.isValid()) {
+        return QString::fromUtf8(response.child("status").child("state").child_value());
     } else {
-        qCritical() << "Unable to parse result for state(shuffle): " << result.description();
+        qCritical() << "Unable to parse result for state: " << response.description();
     }
-    return false;
+    return {};
 }
 
-int xPlayerBluOSControls::parsePlaylistTrackId(const QString &commandResult, const QString& path) {
-    pugi::xml_parse_result result = bluOSResponse.load_string(commandResult.toStdString().c_str());
-    if (result) {
-        // Parse through all elements. Find the track ID.
-        for (auto song : bluOSResponse.child("playlist").children()) {
-            if (path == song.child("fn").child_value()) {
-                return QString(song.attribute("songid").value()).toInt();
-            }
-        }
+int xPlayerBluOSControls::parseVolume(QByteArray commandResult) {
+    xPlayerBluOSResponse response(std::move(commandResult));
+    if (response.isValid()) {
+        return response.child("volume").text().as_int(-1);
     } else {
-        qCritical() << "Unable to parse result for playlist: " << result.description();
+        qCritical() << "Unable to parse result for volume: " << response.description();
     }
     return -1;
 }
 
-int xPlayerBluOSControls::parseIndexing(const QString &commandResult) {
-    pugi::xml_parse_result result = bluOSResponse.load_string(commandResult.toStdString().c_str());
-    if (result) {
-        auto noTracks = QString::fromStdString(bluOSResponse.child("status").child("indexing").child_value()).toInt();
-        emit playerReIndexing(noTracks);
-        if ((bluOSReIndexingInProgress) && (noTracks == 0)) {
-            bluOSReIndexing->stop();
-            bluOSReIndexingInProgress = false;
+QHash<QString,int> xPlayerBluOSControls::parsePlaylistTrackIds(QByteArray commandResult) {
+    QHash<QString,int> trackIds;
+    xPlayerBluOSResponse response(std::move(commandResult));
+    if (response.isValid()) {
+        // Parse through all elements. Map each path to its track ID.
+        for (auto song : response.child("playlist").children()) {
+            trackIds.insert(QString::fromUtf8(song.child("fn").child_value()), song.attribute("songid").as_int());
         }
-        bluOSReIndexingInProgress = true;
     } else {
-        qCritical() << "Unable to parse result for state(shuffle): " << result.description();
-    }
-    return 0;
-}
-
-void xPlayerBluOSControls::parsePlayerStatus(const QString &commandResult) {
-    pugi::xml_parse_result result = bluOSStatusResponse.load_string(commandResult.toStdString().c_str());
-    if (result) {
-        auto status = bluOSStatusResponse.child("status");
-        emit playerStatus(status.child("fn").child_value(),
-                          QString::fromStdString(status.child("song").child_value()).toInt(),
-                          QString::fromStdString(status.child("secs").child_value()).toInt()*1000,
-                          status.child("quality").child_value());
-        // Try to detect stop at the end of the queue.
-        if (status.child("quality").empty() && status.child("canSeek").empty()) {
-            emit playerStopped();
-        }
-    } else {
-        qCritical() << "Unable to parse result for state: " << result.description();
+        qCritical() << "Unable to parse result for playlist: " << response.description();
     }
+    return trackIds;
 }
 
-std::vector<QString> xPlayerBluOSControls::parseFolders(const QString& commandResult) {
-    std::vector<QString> folders;
-    pugi::xml_parse_result result = bluOSResponse.load_string(commandResult.toStdString().c_str());
-    if (result) {
-        // Parse through all subfolders.
-        for (auto subfolder : bluOSResponse.child("folders").child("subfolders").children()) {
-            folders.emplace_back(subfolder.child_value());
-        }
-    } else {
-        qCritical() << "Unable to parse result for folders: " << result.description();
+bool xPlayerBluOSControls::parseFolders(QByteArray commandResult, std::vector<QString>& folders) {
+    folders.clear();
+    xPlayerBluOSResponse response(std::move(commandResult));
+    if (!response.isValid()) {
+        qCritical() << "Unable to parse result for folders: " << response.description();
+        return false;
     }
-    return folders;
+    auto foldersNode = response.child("folders");
+    if (foldersNode.empty()) {
+        qCritical() << "Unable to parse result for folders: no folders element";
+        return false;
+    }
+    // Parse through all subfolders.
+    for (auto subfolder : foldersNode.child("subfolders").children()) {
+        folders.emplace_back(QString::fromUtf8(subfolder.child_value()));
+    }
+    return true;
 }
 
-std::vector<std::tuple<QString,QString,qint64>> xPlayerBluOSControls::parseTracks(const QString& commandResult) {
-    std::vector<std::tuple<QString,QString,qint64>> tracks;
-    pugi::xml_parse_result result = bluOSResponse.load_string(commandResult.toStdString().c_str());
-    if (result) {
-        // Parse through all subfolders.
-        for (auto song : bluOSResponse.child("folders").child("songs").children()) {
-            QString songTime(song.child("time").child_value());
-            QString songPath(song.child("fn").child_value());
-            QFileInfo songInfo(songPath);
-            tracks.emplace_back(songPath, songInfo.fileName(), songTime.toInt()*1000);
-        }
-    } else {
-        qCritical() << "Unable to parse result for tracks: " << result.description();
+bool xPlayerBluOSControls::parseTracks(QByteArray commandResult, std::vector<std::tuple<QString,QString,qint64>>& tracks) {
+    tracks.clear();
+    xPlayerBluOSResponse response(std::move(commandResult));
+    if (!response.isValid()) {
+        qCritical() << "Unable to parse result for tracks: " << response.description();
+        return false;
     }
-    return tracks;
+    auto foldersNode = response.child("folders");
+    if (foldersNode.empty()) {
+        qCritical() << "Unable to parse result for tracks: no folders element";
+        return false;
+    }
+    // Parse through all songs.
+    for (auto song : foldersNode.child("songs").children()) {
+        auto songPath = QString::fromUtf8(song.child("fn").child_value());
+        // The file name is the last component of the path.
+        auto songName = songPath.mid(songPath.lastIndexOf('/')+1);
+        tracks.emplace_back(songPath, songName, song.child("time").text().as_llong()*1000);
+    }
+    return true;
 }
 
-std::tuple<int,int> xPlayerBluOSControls::parseTrackInfo(const QString& commandResult) {
+std::tuple<int,int> xPlayerBluOSControls::parseTrackInfo(QByteArray commandResult) {
     // The result is a mini HTTP page. Use simple regular expression for parsing.
+    auto trackInfo = QString::fromUtf8(commandResult).toLower();
     QRegularExpressionMatch match;
     for (auto& infoRegExpr : bluOSTrackInfoRegExpr) {
-        match = infoRegExpr->match(commandResult.toLower());
+        match = infoRegExpr->match(trackInfo);
         if (match.hasMatch()) {
             return std::make_tuple(match.captured("samplerate").toInt(), match.captured("bitspersample").toInt());
         }
@@ -376,16 +703,16 @@ std::tuple<int,int> xPlayerBluOSControls::parseTrackInfo(const QString& commandR
     return std::make_tuple(-1, -1);
 }
 
-QStringList xPlayerBluOSControls::parsePlaylist(const QString& commandResult) {
+QStringList xPlayerBluOSControls::parsePlaylist(QByteArray commandResult) {
     QStringList queue;
-    pugi::xml_parse_result result = bluOSResponse.load_string(commandResult.toStdString().c_str());
-    if (result) {
+    xPlayerBluOSResponse response(std::move(commandResult));
+    if (response.isValid()) {
         // Parse through all subfolders.
-        for (auto song : bluOSResponse.child("playlist").children()) {
-            queue.push_back(song.child("fn").child_value());
+        for (auto song : response.child("playlist").children()) {
+            queue.push_back(QString::fromUtf8(song.child("fn").child_value()));
         }
     } else {
-        qCritical() << "Unable to parse result for tracks: " << result.description();
+        qCritical() << "Unable to parse result for tracks: " << response.description();
     }
     return queue;
 }
@@ -408,12 +735,17 @@ void xPlayerBluOSControls::connect(const QUrl& url) {
     bluOSBasePath = parseBasePath(sendCommand(QUrl(bluOSUrl+"/Folders?&service=LocalMusic")));
     qDebug() << "xPlayerBluOSControls::connect: " << bluOSUrl << "," << bluOSBasePath;
     // Disable repeat of the queue.
-    sendCommand(QUrl(bluOSUrl+"/Repeat?&state=2"));
+    postCommand(QUrl(bluOSUrl+"/Repeat?&state=2"));
+    // Initialize the mirror of the queue.
+    refreshQueue();
+    // Track the state, volume, mute and shuffle mode and the current track.
+    bluOSStatusTracker->start(bluOSUrl);
 }
 
 void xPlayerBluOSControls::disconnect() {
     // Clear queue also stops the player.
     clearQueue();
+    bluOSStatusTracker->stop();
     bluOSUrl.clear();
     bluOSBasePath.clear();
 }
@@ -14,21 +14,28 @@
 #ifndef __XPLAYERBLUOSCONTROL_H__
 #define __XPLAYERBLUOSCONTROL_H__
 
+#include "xPlayerBluOSClient.h"
+#include "xPlayerBluOSStatusTracker.h"
 #include "xPlayerTypes.h"
 
 #include <QTimer>
 #include <QMutex>
+#include <QHash>
 #include <QUrl>
 #include <QRegularExpression>
 
+#include <functional>
 #include <memory>
-#include <pugixml.hpp>
-#include <curl/curl.h>
 
 
+// Allow test class to access everything.
+class test_xPlayerBluOSClient;
+
 class xPlayerBluOSControls:public QObject {
     Q_OBJECT
 
+    friend class test_xPlayerBluOSClient;
+
 public:
     /**
      * Return the BluOS controls.
@@ -75,11 +82,22 @@ public:
      */
     void seek(qint64 position);
     /**
-     * Get the current play state of the BlueOS player.
+     * Get the last known play state of the BlueOS player.
+     *
+     * The state is updated by the player status and by the player commands.
+     * The network is not accessed.
      *
      * @return the state as string.
      */
-    QString state();
+    [[nodiscard]] QString state() const;
+    /**
+     * Query the current play state of the BluOS player.
+     *
+     * The query is performed after all previously issued commands.
+     *
+     * @param callback function called with the state as string.
+     */
+    void state(const std::function<void(const QString&)>& callback);
     /**
      * Jump to the previous track in the playlist.
      */
@@ -101,11 +119,33 @@ public:
      */
     void removeQueue(int index);
     /**
-     * Get the current queue of the BluOS player.
+     * Move song within the BluOS player queue.
+     *
+     * @param fromIndex the current position of the track on the BluOS player.
+     * @param toIndex the new position of the track on the BluOS player.
+     */
+    void moveQueue(int fromIndex, int toIndex);
+    /**
+     * Synchronize the BluOS player queue with the given playlist.
+     *
+     * The playlist is compared to the mirror of the player queue. Only the
+     * required delete, add and move commands are sent to the player. The
+     * tracks of a longest increasing subsequence of the queue order are not
+     * moved, which minimizes the number of move commands. The commands are
+     * issued without waiting for the player.
+     *
+     * @param playlist the list of track paths on the BluOS player.
+     */
+    void syncQueue(const QStringList& playlist);
+    /**
+     * Return the mirror of the BluOS player queue. The network is not accessed.
+     *
+     * The mirror contains the result of all issued queue commands. It is
+     * refreshed if the queue is modified by other BluOS controllers.
      *
      * @return a list of strings of track paths.
      */
-    QStringList queue();
+    [[nodiscard]] QStringList queue() const;
     /**
      * Clear the BluOS player queue.
      */
@@ -117,11 +157,17 @@ public:
      */
     void setVolume(int vol);
     /**
-     * Return the volume for the BluOS player
+     * Return the last known volume for the BluOS player. The network is not accessed.
+     *
+     * @return integer value in between 0 and 100, -1 if unknown.
+     */
+    [[nodiscard]] int getVolume() const;
+    /**
+     * Query the current volume of the BluOS player.
      *
-     * @return integer value in between 0 and 100.
+     * @param callback function called with the volume in between 0 and 100.
      */
-    [[nodiscard]] int getVolume();
+    void getVolume(const std::function<void(int)>& callback);
     /**
      * Set the mute mode.
      *
@@ -129,11 +175,11 @@ public:
      */
     void setMuted(bool mute);
     /**
-     * Return the mute mode for the BluOS player
+     * Return the last known mute mode for the BluOS player. The network is not accessed.
      *
      * @return true if BluOS player is muted, false otherwise.
      */
-    [[nodiscard]] bool isMuted();
+    [[nodiscard]] bool isMuted() const;
     /**
      * Set the mute mode.
      *
@@ -141,11 +187,11 @@ public:
      */
     void setShuffle(bool shuffle);
     /**
-     * Return the shuffle mode for the BluOS player
+     * Return the last known shuffle mode for the BluOS player. The network is not accessed.
      *
      * @return true if BluOS player is muted, false otherwise.
      */
-    [[nodiscard]] bool isShuffle();
+    [[nodiscard]] bool isShuffle() const;
     /**
      * Return the artists for the BluOS player.
      *
@@ -168,12 +214,27 @@ public:
      */
     std::vector<xDirectoryEntry> getTracks(const QString& artist, const QString& album);
     /**
-     * Return the info for the given track ID.
+     * Query the info for the given track without waiting.
+     *
+     * The song id of the track is taken from the cached playlist. The playlist
+     * is only requested if the song id is not cached.
      *
      * @param path the path to the track on the BluOS player as string.
-     * @return a tuple of sample rate and bits per sample.
+     * @param callback function called with sample rate and bits per sample, -1 if unknown.
      */
-    std::tuple<int, int> getTrackInfo(const QString& path);
+    void getTrackInfo(const QString& path, const std::function<void(int,int)>& callback);
+    /**
+     * Return the complete library of the BluOS player.
+     *
+     * The library is loaded from the persistent remote library cache if available.
+     * Otherwise, the albums and tracks of all artists are crawled with a bounded
+     * number of concurrent requests and the cache is updated. The cache is
+     * invalidated if the BluOS player reindexes its library.
+     *
+     * @param interrupted function that returns true if the crawl is to be stopped.
+     * @return vector of artists with their albums and tracks, empty if interrupted.
+     */
+    std::vector<xRemoteLibraryArtist> getLibrary(const std::function<bool()>& interrupted);
 
 signals:
     /**
@@ -218,100 +279,140 @@ private:
      */
     ~xPlayerBluOSControls() override;
     /**
-     * Send http requests to the BluOS Player.
+     * Send http requests to the BluOS Player and wait for the result.
+     *
+     * Must not be called from the GUI thread.
      *
      * @param url the request as URL.
-     * @return the request result as string.
+     * @return the raw request result.
      */
-    QString sendCommand(const QUrl& url);
+    QByteArray sendCommand(const QUrl& url);
     /**
-     * Parse the result of the initial query to determine the base path for LocalMusic.
+     * Send http requests to the BluOS Player without waiting.
      *
-     * @param commandResult the result of the query as string.
-     * @return the base path for LocalMusic as string.
+     * The request is performed after all previously issued commands.
+     *
+     * @param url the request as URL.
+     * @param callback function called with the request result within the thread of the controls.
      */
-    QString parseBasePath(const QString& commandResult);
+    void sendCommand(const QUrl& url, const std::function<void(QByteArray)>& callback);
     /**
-     * Parse the result of the player state query.
+     * Send http requests to the BluOS Player and ignore the result.
      *
-     * @param commandResult the result of the query as string.
-     * @return the play state as string.
+     * The request is performed after all previously issued commands.
+     *
+     * @param url the request as URL.
      */
-    QString parseState(const QString& commandResult);
+    void postCommand(const QUrl& url);
     /**
-     * Parse the result of the volume query.
+     * Send a queue modifying http request to the BluOS player and ignore the result.
      *
-     * @param commandResult the result of the query as string.
-     * @return the volume level as integer.
+     * @param url the request as URL.
+     */
+    void postQueueCommand(const QUrl& url);
+    /**
+     * Refresh the mirror of the BluOS player queue.
      */
-    int parseVolume(const QString& commandResult);
+    void refreshQueue();
     /**
-     * Parse the result for mute of the status query.
+     * Crawl the albums and tracks of all artists concurrently.
      *
-     * @param commandResult the result of the query as string.
-     * @return true if mute is enabled, false otherwise.
+     * Failed requests are retried. The crawl is aborted if a request fails repeatedly.
+     *
+     * @param interrupted function that returns true if the crawl is to be stopped.
+     * @return vector of artists with their albums and tracks, empty if interrupted or aborted.
      */
-    bool parseMute(const QString& commandResult);
+    std::vector<xRemoteLibraryArtist> crawlLibrary(const std::function<bool()>& interrupted);
     /**
-     * Parse the result for shuffle of the status query.
+     * Convert the cached tracks into the remote library structure.
      *
-     * @param commandResult the result of the query as string.
-     * @return true if shuffle is enabled, false otherwise.
+     * @param tracks list of cached tracks sorted by artist and album.
+     * @return vector of artists with their albums and tracks.
      */
-    bool parseShuffle(const QString& commandResult);
+    std::vector<xRemoteLibraryArtist> cachedLibrary(const QList<xRemoteLibraryTrack>& tracks);
     /**
-     * Parse the result for the playlist query.
+     * Invalidate the persistent remote library cache of the BluOS player.
+     */
+    void invalidateLibrary();
+    /**
+     * Return the folder query for the artists, albums or tracks.
      *
-     * @param commandResult the result of the query as string.
-     * @param path the path of the track to be found.
-     * @return the song id as integer.
+     * @param artist the artist name, empty for the artists query.
+     * @param album the album name, empty for the albums query.
+     * @return the folder query as string.
      */
-    int parsePlaylistTrackId(const QString& commandResult, const QString& path);
+    [[nodiscard]] QString folderPath(const QString& artist=QString(), const QString& album=QString()) const;
     /**
-     * Parse the result for indexing of the status query.
+     * Return the cached song id for the given track path.
      *
-     * @param commandResult the result of the query as string.
-     * @return number of tracks indexed.
+     * @param path the path to the track on the BluOS player as string.
+     * @return the song id as integer, -1 if not cached.
      */
-    int parseIndexing(const QString& commandResult);
+    int playlistTrackId(const QString& path);
+    /**
+     * Clear the cached song ids. Called if the playlist is modified.
+     */
+    void clearPlaylistIds();
+    /**
+     * Parse the result of the initial query to determine the base path for LocalMusic.
+     *
+     * @param commandResult the raw result of the query, parsed in place.
+     * @return the base path for LocalMusic as string.
+     */
+    QString parseBasePath(QByteArray commandResult);
+    /**
+     * Parse the result of the player state query.
+     *
+     * @param commandResult the raw result of the query, parsed in place.
+     * @return the play state as string.
+     */
+    QString parseState(QByteArray commandResult);
+    /**
+     * Parse the result of the volume query.
+     *
+     * @param commandResult the raw result of the query, parsed in place.
+     * @return the volume level as integer.
+     */
+    int parseVolume(QByteArray commandResult);
+    /**
+     * Parse the result for the playlist query.
+     *
+     * @param commandResult the raw result of the query, parsed in place.
+     * @return a map of track paths to song ids.
+     */
+    QHash<QString,int> parsePlaylistTrackIds(QByteArray commandResult);
     /**
      * Parse the result of a folder query.
      *
-     * @param commandResult the result of the query as string.
-     * @return a vector of folder names.
+     * @param commandResult the raw result of the query, parsed in place.
+     * @param folders the vector of folder names, empty if the folder has no subfolders.
+     * @return true if the result could be parsed, false otherwise.
      */
-    std::vector<QString> parseFolders(const QString& commandResult);
+    bool parseFolders(QByteArray commandResult, std::vector<QString>& folders);
     /**
      * Parse the result of a track query.
      *
-     * @param commandResult the result of the query as string.
-     * @return a vector of tuples of path, track name and length.
+     * @param commandResult the raw result of the query, parsed in place.
+     * @param tracks the vector of tuples of path, track name and length, empty if the folder has no tracks.
+     * @return true if the result could be parsed, false otherwise.
      */
-    std::vector<std::tuple<QString,QString,qint64>> parseTracks(const QString& commandResult);
+    bool parseTracks(QByteArray commandResult, std::vector<std::tuple<QString,QString,qint64>>& tracks);
     /**
      * Parse the result of the track info query.
      *
      * Note: the result is HTTP rather than XML.
      *
-     * @param commandResult the result of the query as string.
+     * @param commandResult the raw result of the query.
      * @return a tuple of bitrate and bits per sample.
      */
-    std::tuple<int,int> parseTrackInfo(const QString& commandResult);
+    std::tuple<int,int> parseTrackInfo(QByteArray commandResult);
     /**
      * Parse the result of a playlist query.
      *
-     * @param commandResult the result of the query as string.
+     * @param commandResult the raw result of the query, parsed in place.
      * @return a vector of paths in the playlist.
      */
-    QStringList parsePlaylist(const QString& commandResult);
-    /**
-     * Parse the result of the status query.
-     *
-     * Emit playerStatus signal each time the Status is queried.
-     *
-     * @param commandResult the result of the query as string.
-     */
-    void parsePlayerStatus(const QString& commandResult);
+    QStringList parsePlaylist(QByteArray commandResult);
     /**
      * Correct problematic characters in HTML request.
      *
@@ -322,15 +423,22 @@ private:
 
     QString bluOSUrl;
     QString bluOSBasePath;
-    CURL* bluOSRequests;
-    pugi::xml_document bluOSResponse;
+    xPlayerBluOSClient* bluOSClient;
     std::vector<std::unique_ptr<QRegularExpression>> bluOSTrackInfoRegExpr;
     static xPlayerBluOSControls* bluOSControls;
     QMutex bluOSMutex;
-    QTimer* bluOSStatus;
-    QTimer* bluOSReIndexing;
-    bool bluOSReIndexingInProgress;
-    pugi::xml_document bluOSStatusResponse;
+    QHash<QString,int> bluOSPlaylistIds;
+    xPlayerBluOSStatusTracker* bluOSStatusTracker;
+    QString bluOSStatusPath;
+    int bluOSStatusIndex;
+    QString bluOSStatusQuality;
+    QString bluOSState;
+    int bluOSVolume;
+    bool bluOSMuted;
+    bool bluOSShuffle;
+    QStringList bluOSQueue;
+    int bluOSQueuePending;
+    bool bluOSQueueRefresh;
 };
 
 
@@ -0,0 +1,39 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xPlayerBluOSResponse.h"
+
+// The responses do not require EOL normalization, declarations, comments or processing instructions.
+constexpr auto xPlayerBluOSResponse_ParseOptions = pugi::parse_minimal | pugi::parse_escapes;
+
+
+xPlayerBluOSResponse::xPlayerBluOSResponse(QByteArray response):
+        responseBuffer(std::move(response)),
+        responseDocument() {
+    // Detaches only if the buffer is shared. The document references the buffer.
+    responseResult = responseDocument.load_buffer_inplace(responseBuffer.data(), responseBuffer.size(),
+                                                          xPlayerBluOSResponse_ParseOptions, pugi::encoding_utf8);
+}
+
+bool xPlayerBluOSResponse::isValid() const {
+    return static_cast<bool>(responseResult);
+}
+
+const char* xPlayerBluOSResponse::description() const {
+    return responseResult.description();
+}
+
+pugi::xml_node xPlayerBluOSResponse::child(const char* name) const {
+    return responseDocument.child(name);
+}
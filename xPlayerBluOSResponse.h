@@ -0,0 +1,69 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XPLAYERBLUOSRESPONSE_H__
+#define __XPLAYERBLUOSRESPONSE_H__
+
+#include <QByteArray>
+
+#include <pugixml.hpp>
+
+
+/**
+ * XML response of the BluOS player parsed in place.
+ *
+ * The response takes over the received buffer and pugixml parses it without
+ * copying. The strings of the resulting nodes point into the buffer and are
+ * valid as long as the response exists. Only the parsing steps required by
+ * the player responses are enabled (minimal parsing plus escapes).
+ */
+class xPlayerBluOSResponse {
+public:
+    /**
+     * Parse the received response.
+     *
+     * The buffer is modified during parsing. It should not be shared in order
+     * to avoid a copy.
+     *
+     * @param response the raw bytes received from the player.
+     */
+    explicit xPlayerBluOSResponse(QByteArray response);
+    ~xPlayerBluOSResponse() = default;
+    /**
+     * Return the result of the parsing.
+     *
+     * @return true if the response was parsed successfully, false otherwise.
+     */
+    [[nodiscard]] bool isValid() const;
+    /**
+     * Return the description of the parsing error.
+     *
+     * @return the error description.
+     */
+    [[nodiscard]] const char* description() const;
+    /**
+     * Return the top-level element of the response.
+     *
+     * @param name the name of the element.
+     * @return the node for the element, an empty node if it does not exist.
+     */
+    [[nodiscard]] pugi::xml_node child(const char* name) const;
+
+private:
+    QByteArray responseBuffer;
+    pugi::xml_document responseDocument;
+    pugi::xml_parse_result responseResult;
+};
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xPlayerBluOSStatusTracker.h"
+#include "xPlayerBluOSResponse.h"
+
+#include <QDebug>
+
+// Time in seconds the player holds a status request if nothing changes.
+constexpr auto xPlayerBluOSStatusTracker_PollTimeout = 60;
+// Additional time in ms before the client aborts a status request.
+constexpr auto xPlayerBluOSStatusTracker_PollGrace = 10000;
+// Time in ms before a failed status request is repeated.
+constexpr auto xPlayerBluOSStatusTracker_RetryInterval = 2000;
+// Interval in ms for the extrapolated position updates.
+constexpr auto xPlayerBluOSStatusTracker_PositionInterval = 1000;
+
+
+xPlayerBluOSStatusTracker::xPlayerBluOSStatusTracker(xPlayerBluOSClient* client, QObject* parent):
+        QObject(parent),
+        trackerClient(client),
+        trackerGeneration(0),
+        trackerRunning(false),
+        trackerInitial(true),
+        trackerIndex(-1),
+        trackerVolume(-1),
+        trackerMute(false),
+        trackerShuffle(false),
+        trackerQueueLength(-1),
+        trackerIndexing(0),
+        trackerStopped(true),
+        trackerPosition(0) {
+    trackerPositionTimer = new QTimer(this);
+    connect(trackerPositionTimer, &QTimer::timeout, [=]() {
+        emit positionChanged(trackerPosition+trackerPositionTime.elapsed());
+    });
+}
+
+void xPlayerBluOSStatusTracker::start(const QString& url) {
+    stop();
+    trackerUrl = url;
+    trackerEtag.clear();
+    trackerRunning = true;
+    trackerInitial = true;
+    trackerStopped = true;
+    trackerPath.clear();
+    trackerIndex = -1;
+    trackerQuality.clear();
+    trackerQueueLength = -1;
+    trackerIndexing = 0;
+    poll();
+}
+
+void xPlayerBluOSStatusTracker::stop() {
+    // Replies to outstanding requests belong to an older generation.
+    ++trackerGeneration;
+    trackerRunning = false;
+    trackerPositionTimer->stop();
+}
+
+void xPlayerBluOSStatusTracker::poll() {
+    auto generation = trackerGeneration;
+    auto statusPath = trackerUrl+"/Status";
+    if (!trackerEtag.isEmpty()) {
+        statusPath += QString("?timeout=%1&etag=%2").arg(xPlayerBluOSStatusTracker_PollTimeout).arg(trackerEtag);
+    }
+    trackerClient->request(QUrl(statusPath), this, [=](QByteArray commandResult) {
+        reply(std::move(commandResult), generation);
+    }, false, xPlayerBluOSStatusTracker_PollTimeout*1000+xPlayerBluOSStatusTracker_PollGrace);
+}
+
+void xPlayerBluOSStatusTracker::reply(QByteArray commandResult, int generation) {
+    if ((!trackerRunning) || (generation != trackerGeneration)) {
+        return;
+    }
+    xPlayerBluOSResponse response(std::move(commandResult));
+    if (!response.isValid()) {
+        qWarning() << "xPlayerBluOSStatusTracker: status request failed, retrying.";
+        // Do not query the player in a tight loop if it is not reachable.
+        QTimer::singleShot(xPlayerBluOSStatusTracker_RetryInterval, this, [=]() {
+            if ((trackerRunning) && (generation == trackerGeneration)) {
+                poll();
+            }
+        });
+        return;
+    }
+    auto status = response.child("status");
+    QString etag = status.attribute("etag").value();
+    // The timeout expired without any change if the etag is unchanged.
+    if ((etag.isEmpty()) || (etag != trackerEtag)) {
+        trackerEtag = etag;
+        update(status);
+    }
+    poll();
+}
+
+void xPlayerBluOSStatusTracker::update(const pugi::xml_node& status) {
+    QString state = status.child("state").child_value();
+    if ((trackerInitial) || (state != trackerState)) {
+        trackerState = state;
+        emit stateChanged(trackerState);
+    }
+    if (!status.child("volume").empty()) {
+        auto vol = QString(status.child("volume").child_value()).toInt();
+        if ((trackerInitial) || (vol != trackerVolume)) {
+            trackerVolume = vol;
+            emit volumeChanged(trackerVolume);
+        }
+    }
+    auto mute = static_cast<bool>(QString(status.child("mute").child_value()).toInt());
+    if ((trackerInitial) || (mute != trackerMute)) {
+        trackerMute = mute;
+        emit muteChanged(trackerMute);
+    }
+    auto shuffle = static_cast<bool>(QString(status.child("shuffle").child_value()).toInt());
+    if ((trackerInitial) || (shuffle != trackerShuffle)) {
+        trackerShuffle = shuffle;
+        emit shuffleChanged(trackerShuffle);
+    }
+    if (!status.child("plen").empty()) {
+        auto queueLength = QString(status.child("plen").child_value()).toInt();
+        if (queueLength != trackerQueueLength) {
+            trackerQueueLength = queueLength;
+            emit queueLengthChanged(trackerQueueLength);
+        }
+    }
+    auto indexing = QString(status.child("indexing").child_value()).toInt();
+    if (indexing != trackerIndexing) {
+        trackerIndexing = indexing;
+        emit indexingChanged(trackerIndexing);
+    }
+    QString path = status.child("fn").child_value();
+    auto index = QString(status.child("song").child_value()).toInt();
+    QString quality = status.child("quality").child_value();
+    // Resynchronize the extrapolated position.
+    trackerPosition = QString(status.child("secs").child_value()).toLongLong()*1000;
+    trackerPositionTime.restart();
+    if ((path != trackerPath) || (index != trackerIndex) || (quality != trackerQuality)) {
+        trackerPath = path;
+        trackerIndex = index;
+        trackerQuality = quality;
+        if (!trackerPath.isEmpty()) {
+            emit trackChanged(trackerPath, trackerIndex, trackerQuality);
+        }
+    }
+    if (!trackerPath.isEmpty()) {
+        emit positionChanged(trackerPosition);
+    }
+    // Only extrapolate the position while playing.
+    if ((trackerState == "play") || (trackerState == "stream")) {
+        if (!trackerPositionTimer->isActive()) {
+            trackerPositionTimer->start(xPlayerBluOSStatusTracker_PositionInterval);
+        }
+    } else {
+        trackerPositionTimer->stop();
+    }
+    // Try to detect stop at the end of the queue. Report the transition only.
+    auto isStopped = (status.child("quality").empty() && status.child("canSeek").empty());
+    if ((isStopped) && (!trackerStopped)) {
+        emit stopped();
+    }
+    trackerStopped = isStopped;
+    trackerInitial = false;
+}
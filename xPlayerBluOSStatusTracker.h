@@ -0,0 +1,159 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XPLAYERBLUOSSTATUSTRACKER_H__
+#define __XPLAYERBLUOSSTATUSTRACKER_H__
+
+#include "xPlayerBluOSClient.h"
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QString>
+
+#include <pugixml.hpp>
+
+
+/**
+ * Track the status of the BluOS player using long-polling.
+ *
+ * The status request includes the etag of the previous reply. The player only
+ * replies if its status changed or the timeout expired. Only the fields that
+ * changed are reported. The position within the current track is extrapolated
+ * locally while playing, i.e. the player is not polled for position updates.
+ */
+class xPlayerBluOSStatusTracker:public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param client pointer to the client used for the status requests.
+     * @param parent pointer to the parent object.
+     */
+    explicit xPlayerBluOSStatusTracker(xPlayerBluOSClient* client, QObject* parent=nullptr);
+    ~xPlayerBluOSStatusTracker() override = default;
+    /**
+     * Start tracking the status of the given BluOS player.
+     *
+     * The first reply reports all fields.
+     *
+     * @param url the url of the BluOS player as string.
+     */
+    void start(const QString& url);
+    /**
+     * Stop tracking the status. Replies of outstanding requests are ignored.
+     */
+    void stop();
+
+signals:
+    /**
+     * Signal emitted if the current track changed.
+     *
+     * @param path path of the currently played track.
+     * @param index the index in the playlist.
+     * @param quality the track quality as string.
+     */
+    void trackChanged(const QString& path, int index, const QString& quality);
+    /**
+     * Signal emitted for the position within the current track.
+     *
+     * Emitted once per second while playing and if the player reports a position.
+     *
+     * @param position the position in ms within the track.
+     */
+    void positionChanged(qint64 position);
+    /**
+     * Signal emitted if the play state changed.
+     *
+     * @param state the play state as string.
+     */
+    void stateChanged(const QString& state);
+    /**
+     * Signal emitted if the volume changed.
+     *
+     * @param vol the volume in between 0 and 100.
+     */
+    void volumeChanged(int vol);
+    /**
+     * Signal emitted if the mute mode changed.
+     *
+     * @param mute true if muted, false otherwise.
+     */
+    void muteChanged(bool mute);
+    /**
+     * Signal emitted if the shuffle mode changed.
+     *
+     * @param shuffle true if shuffle is enabled, false otherwise.
+     */
+    void shuffleChanged(bool shuffle);
+    /**
+     * Signal emitted if the length of the player queue changed.
+     *
+     * @param length the number of tracks in the queue.
+     */
+    void queueLengthChanged(int length);
+    /**
+     * Signal emitted if the number of indexed tracks changed.
+     *
+     * @param noTracks number of tracks currently scanned, 0 if not indexing.
+     */
+    void indexingChanged(int noTracks);
+    /**
+     * Signal emitted if the player stopped at the end of the queue.
+     */
+    void stopped();
+
+private:
+    /**
+     * Issue the next long-polling status request.
+     */
+    void poll();
+    /**
+     * Handle the reply of a status request.
+     *
+     * @param commandResult the raw result of the status request, parsed in place.
+     * @param generation the generation of the request used to ignore stopped requests.
+     */
+    void reply(QByteArray commandResult, int generation);
+    /**
+     * Compare the status fields to the previous ones and report the changes.
+     *
+     * @param status the status element of the reply.
+     */
+    void update(const pugi::xml_node& status);
+
+    xPlayerBluOSClient* trackerClient;
+    QString trackerUrl;
+    QString trackerEtag;
+    int trackerGeneration;
+    bool trackerRunning;
+    bool trackerInitial;
+    QString trackerPath;
+    int trackerIndex;
+    QString trackerQuality;
+    QString trackerState;
+    int trackerVolume;
+    bool trackerMute;
+    bool trackerShuffle;
+    int trackerQueueLength;
+    int trackerIndexing;
+    bool trackerStopped;
+    qint64 trackerPosition;
+    QElapsedTimer trackerPositionTime;
+    QTimer* trackerPositionTimer;
+};
+
+#endif
@@ -21,6 +21,8 @@
 #include <QRegularExpression>
 #include <QDebug>
 
+#include <algorithm>
+
 // Configuration strings.
 const QString xPlayerConfiguration_MusicLibraryDirectory { "xPlay/MusicLibraryDirectory" }; // NOLINT
 const QString xPlayerConfiguration_MusicLibraryBluOS { "xPlay/MusicLibraryBluOS" }; // NOLINT
@@ -34,15 +36,23 @@ const QString xPlayerConfiguration_MusicViewSelectors { "xPlay/MusicViewSelector
 const QString xPlayerConfiguration_MusicViewFilters { "xPlay/MusicViewFilters" }; // NOLINT
 const QString xPlayerConfiguration_MusicViewVisualization { "xPlay/MusicViewVisualization" }; // NOLINT
 const QString xPlayerConfiguration_MusicViewVisualizationMode { "xPlay/MusicViewVisualizationMode" }; // NOLINT
+const QString xPlayerConfiguration_MusicShuffleMode { "xPlay/MusicShuffleMode" }; // NOLINT
+const QString xPlayerConfiguration_MusicShuffleLimitArtist { "xPlay/MusicShuffleLimitArtist" }; // NOLINT
 const QString xPlayerConfiguration_RotelWidget { "xPlay/RotelWidget" }; // NOLINT
 const QString xPlayerConfiguration_RotelNetworkAddress { "xPlay/RotelNetworkAddress" }; // NOLINT
 const QString xPlayerConfiguration_RotelNetworkPort { "xPlay/RotelNetworkPort" }; // NOLINT
 const QString xPlayerConfiguration_MovieLibraryDirectory { "xPlay/MovieLibraryDirectory" }; // NOLINT
 const QString xPlayerConfiguration_MovieLibraryExtensions { "xPlay/MovieLibraryExtensions" }; // NOLINT
+const QString xPlayerConfiguration_MovieLibraryScanDepth { "xPlay/MovieLibraryScanDepth" }; // NOLINT
 const QString xPlayerConfiguration_MovieDefaultAudioLanguage { "xPlay/MovieDefaultAudioLanguage" }; // NOLINT
 const QString xPlayerConfiguration_MovieDefaultSubtitleLanguage { "xPlay/MovieSubtitleAudioLanguage" }; // NOLINT
 const QString xPlayerConfiguration_MovieAudioDeviceId { "xPlay/MovieAudioDeviceId" }; // NOLINT
 const QString xPlayerConfiguration_MovieViewFilters { "xPlay/MovieViewFilters" }; // NOLINT
+const QString xPlayerConfiguration_PlayerPositionInterval { "xPlay/PlayerPositionInterval" }; // NOLINT
+const QString xPlayerConfiguration_MobileSyncTranscodeFormat { "xPlay/MobileSyncTranscodeFormat" }; // NOLINT
+const QString xPlayerConfiguration_MobileSyncTranscodeBitrate { "xPlay/MobileSyncTranscodeBitrate" }; // NOLINT
+const QString xPlayerConfiguration_MobileSyncEncoder { "xPlay/MobileSyncEncoder" }; // NOLINT
+const QString xPlayerConfiguration_DeviceMonitorInterval { "xPlay/DeviceMonitorInterval" }; // NOLINT
 const QString xPlayerConfiguration_StreamingSites { "xPlay/StreamingSites" }; // NOLINT
 const QString xPlayerConfiguration_StreamingSitesDefault { "xPlay/StreamingSitesDefault" }; // NOLINT
 const QString xPlayerConfiguration_StreamingViewSidebar { "xPlay/StreamingViewSidebar" }; // NOLINT
@@ -70,9 +80,17 @@ const bool xPlayerConfiguration_MusicViewSelectors_Default = true; // NOLINT
 const bool xPlayerConfiguration_MusicViewFilters_Default = false; // NOLINT
 const bool xPlayerConfiguration_MusicViewVisualization_Default = false; // NOLINT
 const int xPlayerConfiguration_MusicViewVisualizationMode_Default = 0; // NOLINT
+const int xPlayerConfiguration_MusicShuffleMode_Default = 0; // NOLINT
+const bool xPlayerConfiguration_MusicShuffleLimitArtist_Default = false; // NOLINT
 const QString xPlayerConfiguration_MovieLibraryExtensions_Default { ".mkv .mp4 .avi .mov .wmv" }; // NOLINT
+const int xPlayerConfiguration_MovieLibraryScanDepth_Default = 2; // NOLINT
 const QString xPlayerConfiguration_MovieAudioDeviceId_Default { "pulse" }; // NOLINT
 const bool xPlayerConfiguration_MovieViewFilters_Default = true; // NOLINT
+const int xPlayerConfiguration_PlayerPositionInterval_Default = 500; // NOLINT
+const int xPlayerConfiguration_MobileSyncTranscodeBitrate_Default = 160; // NOLINT
+const QString xPlayerConfiguration_MobileSyncEncoder_Default { "/usr/bin/ffmpeg" }; // NOLINT
+const int xPlayerConfiguration_DeviceMonitorInterval_Default = 1000; // NOLINT
+const int xPlayerConfiguration_DeviceMonitorInterval_Minimum = 100; // NOLINT
 const bool xPlayerConfiguration_DatabaseUsePlayedLevels_Default = false; // NOLINT
 const std::tuple<int,int,int> xPlayerConfiguration_DatabasePlayedLevels_Default { 5, 10, 15 }; // NOLINT
 const QList<std::pair<QString,QUrl>> xPlayerConfiguration_StreamingDefaultSites = { // NOLINT
@@ -217,6 +235,22 @@ void xPlayerConfiguration::setMusicViewVisualizationMode(int mode) {
     }
 }
 
+void xPlayerConfiguration::setMusicShuffleMode(int mode) {
+    if (mode != getMusicShuffleMode()) {
+        settings->setValue(xPlayerConfiguration_MusicShuffleMode, mode);
+        settings->sync();
+        emit updatedMusicShuffleMode();
+    }
+}
+
+void xPlayerConfiguration::setMusicShuffleLimitArtist(bool enabled) {
+    if (enabled != getMusicShuffleLimitArtist()) {
+        settings->setValue(xPlayerConfiguration_MusicShuffleLimitArtist, enabled);
+        settings->sync();
+        emit updatedMusicShuffleMode();
+    }
+}
+
 void xPlayerConfiguration::setRotelWidget(bool enable) {
     if (enable != rotelWidget()) {
         settings->setValue(xPlayerConfiguration_RotelWidget, enable);
@@ -255,6 +289,14 @@ void xPlayerConfiguration::setMovieLibraryExtensions(const QString& extensions)
     }
 }
 
+void xPlayerConfiguration::setMovieLibraryScanDepth(int depth) {
+    if (depth != getMovieLibraryScanDepth()) {
+        settings->setValue(xPlayerConfiguration_MovieLibraryScanDepth, depth);
+        settings->sync();
+        emit updatedMovieLibraryScanDepth();
+    }
+}
+
 void xPlayerConfiguration::setMovieDefaultAudioLanguage(const QString& language) {
     if (language != getMovieDefaultAudioLanguage()) {
         settings->setValue(xPlayerConfiguration_MovieDefaultAudioLanguage, language);
@@ -287,6 +329,46 @@ void xPlayerConfiguration::setMovieViewFilters(bool visible) {
     }
 }
 
+void xPlayerConfiguration::setPlayerPositionInterval(int interval) {
+    if (interval != getPlayerPositionInterval()) {
+        settings->setValue(xPlayerConfiguration_PlayerPositionInterval, interval);
+        settings->sync();
+        emit updatedPlayerPositionInterval();
+    }
+}
+
+void xPlayerConfiguration::setMobileSyncTranscodeFormat(const QString& format) {
+    if (format != getMobileSyncTranscodeFormat()) {
+        settings->setValue(xPlayerConfiguration_MobileSyncTranscodeFormat, format);
+        settings->sync();
+        emit updatedMobileSyncTranscode();
+    }
+}
+
+void xPlayerConfiguration::setMobileSyncTranscodeBitrate(int bitrate) {
+    if (bitrate != getMobileSyncTranscodeBitrate()) {
+        settings->setValue(xPlayerConfiguration_MobileSyncTranscodeBitrate, bitrate);
+        settings->sync();
+        emit updatedMobileSyncTranscode();
+    }
+}
+
+void xPlayerConfiguration::setMobileSyncEncoder(const QString& encoder) {
+    if (encoder != getMobileSyncEncoder()) {
+        settings->setValue(xPlayerConfiguration_MobileSyncEncoder, encoder);
+        settings->sync();
+        emit updatedMobileSyncTranscode();
+    }
+}
+
+void xPlayerConfiguration::setDeviceMonitorInterval(int interval) {
+    if (interval != getDeviceMonitorInterval()) {
+        settings->setValue(xPlayerConfiguration_DeviceMonitorInterval, interval);
+        settings->sync();
+        emit updatedDeviceMonitorInterval();
+    }
+}
+
 void xPlayerConfiguration::setStreamingSites(const QList<std::pair<QString,QUrl>>& sites) {
     if ((sites != getStreamingSites()) || (sites == xPlayerConfiguration_StreamingDefaultSites)) {
         QString nameUrlString;
@@ -522,6 +604,14 @@ int xPlayerConfiguration::getMusicViewVisualizationMode() {
     return settings->value(xPlayerConfiguration_MusicViewVisualizationMode, xPlayerConfiguration_MusicViewVisualizationMode_Default).toInt();
 }
 
+int xPlayerConfiguration::getMusicShuffleMode() {
+    return settings->value(xPlayerConfiguration_MusicShuffleMode, xPlayerConfiguration_MusicShuffleMode_Default).toInt();
+}
+
+bool xPlayerConfiguration::getMusicShuffleLimitArtist() {
+    return settings->value(xPlayerConfiguration_MusicShuffleLimitArtist, xPlayerConfiguration_MusicShuffleLimitArtist_Default).toBool();
+}
+
 bool xPlayerConfiguration::rotelWidget() {
     return settings->value(xPlayerConfiguration_RotelWidget, true).toBool();
 }
@@ -545,6 +635,30 @@ bool xPlayerConfiguration::getMovieViewFilters() {
     return settings->value(xPlayerConfiguration_MovieViewFilters, xPlayerConfiguration_MovieViewFilters_Default).toBool();
 }
 
+int xPlayerConfiguration::getPlayerPositionInterval() {
+    return std::max(settings->value(xPlayerConfiguration_PlayerPositionInterval,
+                                    xPlayerConfiguration_PlayerPositionInterval_Default).toInt(), 0);
+}
+
+QString xPlayerConfiguration::getMobileSyncTranscodeFormat() {
+    return settings->value(xPlayerConfiguration_MobileSyncTranscodeFormat, "").toString();
+}
+
+int xPlayerConfiguration::getMobileSyncTranscodeBitrate() {
+    return std::max(settings->value(xPlayerConfiguration_MobileSyncTranscodeBitrate,
+                                    xPlayerConfiguration_MobileSyncTranscodeBitrate_Default).toInt(), 32);
+}
+
+QString xPlayerConfiguration::getMobileSyncEncoder() {
+    return settings->value(xPlayerConfiguration_MobileSyncEncoder, xPlayerConfiguration_MobileSyncEncoder_Default).toString();
+}
+
+int xPlayerConfiguration::getDeviceMonitorInterval() {
+    return std::max(settings->value(xPlayerConfiguration_DeviceMonitorInterval,
+                                    xPlayerConfiguration_DeviceMonitorInterval_Default).toInt(),
+                    xPlayerConfiguration_DeviceMonitorInterval_Minimum);
+}
+
 QList<std::pair<QString,QUrl>> xPlayerConfiguration::getStreamingSites() {
     auto streamingSites = settings->value(xPlayerConfiguration_StreamingSites, "").toString();
     QList<std::pair<QString,QUrl>> streamingList;
@@ -669,6 +783,11 @@ QStringList xPlayerConfiguration::getMovieLibraryExtensionList() {
     }
 }
 
+int xPlayerConfiguration::getMovieLibraryScanDepth() {
+    return std::max(settings->value(xPlayerConfiguration_MovieLibraryScanDepth,
+                                    xPlayerConfiguration_MovieLibraryScanDepth_Default).toInt(), 1);
+}
+
 QString xPlayerConfiguration::getMovieDefaultAudioLanguage() {
     return settings->value(xPlayerConfiguration_MovieDefaultAudioLanguage, "").toString();
 }
@@ -742,6 +861,7 @@ void xPlayerConfiguration::updatedConfiguration() {
     emit updatedMusicViewFilters();
     emit updatedMusicViewVisualization();
     emit updatedMusicViewVisualizationMode();
+    emit updatedMusicShuffleMode();
     emit updatedRotelNetworkAddress();
     emit updatedMovieLibraryTagsAndDirectories();
     emit updatedMovieLibraryExtensions();
@@ -749,6 +869,9 @@ void xPlayerConfiguration::updatedConfiguration() {
     emit updatedMovieDefaultSubtitleLanguage();
     emit updatedMovieAudioDeviceId();
     emit updatedMovieViewFilters();
+    emit updatedPlayerPositionInterval();
+    emit updatedMobileSyncTranscode();
+    emit updatedDeviceMonitorInterval();
     emit updatedStreamingSites();
     emit updatedStreamingSitesDefault();
     emit updatedStreamingViewSidebar();
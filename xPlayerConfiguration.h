@@ -110,6 +110,21 @@ public:
      * @param mode the music visualization mode as integer.
      */
     void setMusicViewVisualizationMode(int mode);
+    /**
+     * Set the shuffle mode for the music player.
+     * - 0: uniform
+     * - 1: favor rarely played tracks
+     * - 2: avoid recently played tracks
+     *
+     * @param mode the shuffle mode as integer.
+     */
+    void setMusicShuffleMode(int mode);
+    /**
+     * Enable or disable limiting consecutive tracks of the same artist in shuffle mode.
+     *
+     * @param enabled limit same artist runs if true, do not limit otherwise.
+     */
+    void setMusicShuffleLimitArtist(bool enabled);
     /**
      * Set availability of the Rotel amp widget.
      *
@@ -135,6 +150,12 @@ public:
      * @param extensions a space separated list of extensions.
      */
     void setMovieLibraryExtensions(const QString& extensions);
+    /**
+     * Set the number of directory levels scanned for movie files.
+     *
+     * @param depth the depth, 1 for the base directories only.
+     */
+    void setMovieLibraryScanDepth(int depth);
     /**
      * Set the default language for movie audio channels.
      *
@@ -159,6 +180,36 @@ public:
      * @param visible show movie filters if true, hide otherwise.
      */
     void setMovieViewFilters(bool visible);
+    /**
+     * Set the interval for position updates of the music and movie player.
+     *
+     * @param interval the minimal interval in between two position updates in ms.
+     */
+    void setPlayerPositionInterval(int interval);
+    /**
+     * Set the format files are transcoded to during the mobile sync.
+     *
+     * @param format the target format, e.g. "opus". Empty if files are copied without transcoding.
+     */
+    void setMobileSyncTranscodeFormat(const QString& format);
+    /**
+     * Set the bitrate of files transcoded during the mobile sync.
+     *
+     * @param bitrate the target bitrate in kbit/s.
+     */
+    void setMobileSyncTranscodeBitrate(int bitrate);
+    /**
+     * Set the path to the encoder binary (ffmpeg) used for transcoding.
+     *
+     * @param encoder the path to the encoder binary.
+     */
+    void setMobileSyncEncoder(const QString& encoder);
+    /**
+     * Set the sample interval of the block device monitor.
+     *
+     * @param interval the interval in between two samples in ms.
+     */
+    void setDeviceMonitorInterval(int interval);
     /**
      * Set the list of sites available in the streaming view.
      *
@@ -356,6 +407,18 @@ public:
      * @return 0, if we use a small window, 1 if the central window is used.
      */
     int getMusicViewVisualizationMode();
+    /**
+     * Get the shuffle mode for the music player.
+     *
+     * @return 0 for uniform, 1 for favor rarely played, 2 for avoid recently played.
+     */
+    [[nodiscard]] int getMusicShuffleMode();
+    /**
+     * Get the limit mode for consecutive tracks of the same artist in shuffle mode.
+     *
+     * @return true if same artist runs are limited, false otherwise.
+     */
+    [[nodiscard]] bool getMusicShuffleLimitArtist();
     /**
      * Return the availability of the Rotel amp widget.
      *
@@ -392,6 +455,15 @@ public:
      * @return the list of extensions.
      */
     [[nodiscard]] QStringList getMovieLibraryExtensionList();
+    /**
+     * Get the number of directory levels scanned for movie files.
+     *
+     * Movies in nested directories are added to the directory of the
+     * second level with their relative path as name.
+     *
+     * @return the depth, 2 for the base directories and their subdirectories.
+     */
+    [[nodiscard]] int getMovieLibraryScanDepth();
     /**
      * Get the default language for movie audio channels.
      *
@@ -422,6 +494,36 @@ public:
      * @return true if the movie filters are visible, false otherwise.
      */
     [[nodiscard]] bool getMovieViewFilters();
+    /**
+     * Get the interval for position updates of the music and movie player.
+     *
+     * @return the minimal interval in between two position updates in ms.
+     */
+    [[nodiscard]] int getPlayerPositionInterval();
+    /**
+     * Get the format files are transcoded to during the mobile sync.
+     *
+     * @return the target format, empty if files are copied without transcoding.
+     */
+    [[nodiscard]] QString getMobileSyncTranscodeFormat();
+    /**
+     * Get the bitrate of files transcoded during the mobile sync.
+     *
+     * @return the target bitrate in kbit/s.
+     */
+    [[nodiscard]] int getMobileSyncTranscodeBitrate();
+    /**
+     * Get the path to the encoder binary (ffmpeg) used for transcoding.
+     *
+     * @return the path to the encoder binary.
+     */
+    [[nodiscard]] QString getMobileSyncEncoder();
+    /**
+     * Get the sample interval of the block device monitor.
+     *
+     * @return the interval in between two samples in ms.
+     */
+    [[nodiscard]] int getDeviceMonitorInterval();
     /**
      * Get the list of streaming sites.
      *
@@ -599,6 +701,10 @@ signals:
      * Signal an update of the visualization mode.
      */
     void updatedMusicViewVisualizationMode();
+    /**
+     * Signal an update of the shuffle mode or artist limit.
+     */
+    void updatedMusicShuffleMode();
     /**
      * Signal an update of the movie library directory.
      */
@@ -607,6 +713,10 @@ signals:
      * Signal an update of the accepted movie file extensions.
      */
     void updatedMovieLibraryExtensions();
+    /**
+     * Signal an update of the movie library scan depth.
+     */
+    void updatedMovieLibraryScanDepth();
     /**
      * Signal an update of the default movie audio channel language.
      */
@@ -623,6 +733,18 @@ signals:
      * Signal an update of the movie filters visibility.
      */
     void updatedMovieViewFilters();
+    /**
+     * Signal an update of the player position update interval.
+     */
+    void updatedPlayerPositionInterval();
+    /**
+     * Signal an update of the mobile sync transcoding configuration.
+     */
+    void updatedMobileSyncTranscode();
+    /**
+     * Signal an update of the block device monitor interval.
+     */
+    void updatedDeviceMonitorInterval();
     /**
      * Signal an update of the visibility of the Rotel amp widget.
      */
@@ -136,6 +136,9 @@ void xPlayerConfigurationDialog::createMovieConfigurationTab(QWidget* movieLibra
     movieLibraryListWidget->setSortingEnabled(true);
     auto movieLibraryExtensionsLabel = new QLabel(tr("Extensions"), movieLibraryTab);
     movieLibraryExtensionsWidget = new QLineEdit(movieLibraryTab);
+    auto movieLibraryScanDepthLabel = new QLabel(tr("Scan Depth"), movieLibraryTab);
+    movieLibraryScanDepthWidget = new QSpinBox(movieLibraryTab);
+    movieLibraryScanDepthWidget->setRange(1, 10);
     auto movieDefaultAudioLanguageLabel = new QLabel(tr("Default Audio Channel Language"), movieLibraryTab);
     movieDefaultAudioLanguageWidget = new QComboBox(movieLibraryTab);
     movieDefaultAudioLanguageWidget->addItem(tr("movie default"));
@@ -160,8 +163,10 @@ void xPlayerConfigurationDialog::createMovieConfigurationTab(QWidget* movieLibra
     movieLibraryLayout->addWidget(movieLibraryDirectoryOpenButton, 3, 4);
     movieLibraryLayout->addWidget(movieLibraryListWidget, 4, 0, 3, 5);
     movieLibraryLayout->addWidget(movieLibraryButtons, 7, 0, 1, 5);
-    movieLibraryLayout->addWidget(movieLibraryExtensionsLabel, 8, 0, 1, 5);
-    movieLibraryLayout->addWidget(movieLibraryExtensionsWidget, 9, 0, 1, 5);
+    movieLibraryLayout->addWidget(movieLibraryExtensionsLabel, 8, 0, 1, 4);
+    movieLibraryLayout->addWidget(movieLibraryExtensionsWidget, 9, 0, 1, 4);
+    movieLibraryLayout->addWidget(movieLibraryScanDepthLabel, 8, 4);
+    movieLibraryLayout->addWidget(movieLibraryScanDepthWidget, 9, 4);
     movieLibraryLayout->addRowSpacer(10, xPlayerLayout::LargeSpace);
     movieLibraryLayout->addWidget(movieDefaultAudioLanguageLabel, 11, 0, 1, 2);
     movieLibraryLayout->addWidget(movieDefaultAudioLanguageWidget, 12, 0, 1, 2);
@@ -352,6 +357,7 @@ void xPlayerConfigurationDialog::loadSettings() {
     auto [rotelNetworkAddress, rotelNetworkPort] = xPlayerConfiguration::configuration()->getRotelNetworkAddress();
     auto movieLibraryTagAndDirectory = xPlayerConfiguration::configuration()->getMovieLibraryTagAndDirectory();
     auto movieLibraryExtensions = xPlayerConfiguration::configuration()->getMovieLibraryExtensions();
+    auto movieLibraryScanDepth = xPlayerConfiguration::configuration()->getMovieLibraryScanDepth();
     auto movieDefaultAudioLanguage = xPlayerConfiguration::configuration()->getMovieDefaultAudioLanguage();
     auto movieDefaultSubtitleLanguage = xPlayerConfiguration::configuration()->getMovieDefaultSubtitleLanguage();
     auto movieAudioDeviceId = xPlayerConfiguration::configuration()->getMovieAudioDeviceId();
@@ -403,6 +409,7 @@ void xPlayerConfigurationDialog::loadSettings() {
     }
     databaseIgnoreUpdateErrorsCheck->setChecked(xPlayerConfiguration::configuration()->getDatabaseIgnoreUpdateErrors());
     movieLibraryExtensionsWidget->setText(movieLibraryExtensions);
+    movieLibraryScanDepthWidget->setValue(movieLibraryScanDepth);
     movieLibraryListWidget->clear();
     if (movieLibraryTagAndDirectory.count() > 0) {
         for (const auto& entry : movieLibraryTagAndDirectory) {
@@ -444,6 +451,7 @@ void xPlayerConfigurationDialog::saveSettings() {
     auto rotelNetworkAddress = rotelNetworkAddressWidget->text();
     auto rotelNetworkPort = rotelNetworkPortWidget->value();
     auto movieLibraryExtensions = movieLibraryExtensionsWidget->text();
+    auto movieLibraryScanDepth = movieLibraryScanDepthWidget->value();
     auto movieDefaultAudioLanguage =
             movieDefaultAudioLanguageWidget->currentIndex() ? movieDefaultAudioLanguageWidget->currentText() : "";
     auto movieDefaultSubtitleLanguage =
@@ -492,6 +500,7 @@ void xPlayerConfigurationDialog::saveSettings() {
     qDebug() << "xPlayerConfigurationDialog: save: rotelNetworkPort: " << rotelNetworkPort;
     qDebug() << "xPlayerConfigurationDialog: save: movieLibraryDirectory: " << movieLibraryTagAndDirectory;
     qDebug() << "xPlayerConfigurationDialog: save: movieLibraryExtensions: " << movieLibraryExtensions;
+    qDebug() << "xPlayerConfigurationDialog: save: movieLibraryScanDepth: " << movieLibraryScanDepth;
     qDebug() << "xPlayerConfigurationDialog: save: movieDefaultAudioLanguage: " << movieDefaultAudioLanguage;
     qDebug() << "xPlayerConfigurationDialog: save: movieDefaultSubtitleLanguage: " << movieDefaultSubtitleLanguage;
     qDebug() << "xPlayerConfigurationDialog: save: movieAudioDevice: " << movieAudioDeviceId;
@@ -521,6 +530,7 @@ void xPlayerConfigurationDialog::saveSettings() {
     xPlayerConfiguration::configuration()->setRotelNetworkAddress(rotelNetworkAddress, rotelNetworkPort);
     xPlayerConfiguration::configuration()->setMovieLibraryTagAndDirectory(movieLibraryTagAndDirectory);
     xPlayerConfiguration::configuration()->setMovieLibraryExtensions(movieLibraryExtensions);
+    xPlayerConfiguration::configuration()->setMovieLibraryScanDepth(movieLibraryScanDepth);
     xPlayerConfiguration::configuration()->setMovieDefaultAudioLanguage(movieDefaultAudioLanguage);
     xPlayerConfiguration::configuration()->setMovieDefaultSubtitleLanguage(movieDefaultSubtitleLanguage);
     xPlayerConfiguration::configuration()->setMovieAudioDeviceId(movieAudioDeviceId);
@@ -156,6 +156,7 @@ private:
     QLineEdit* movieLibraryTagWidget;
     QLineEdit* movieLibraryDirectoryWidget;
     QLineEdit* movieLibraryExtensionsWidget;
+    QSpinBox* movieLibraryScanDepthWidget;
     QComboBox* movieDefaultAudioLanguageWidget;
     QComboBox* movieDefaultSubtitleLanguageWidget;
     QComboBox* movieAudioDeviceWidget;
@@ -16,8 +16,43 @@
 #include "xPlayerConfiguration.h"
 #include <QCryptographicHash>
 #include <QDateTime>
+#include <QMutexLocker>
 #include <QDebug>
 
+/**
+ * Convert a vector of times into a comma separated string stored in the database.
+ */
+static std::string xPlayerDatabase_fromTimes(const QVector<qint64>& times) {
+    QStringList timesList;
+    for (auto time : times) {
+        timesList.push_back(QString::number(time));
+    }
+    return timesList.join(",").toStdString();
+}
+
+/**
+ * Convert a comma separated string stored in the database into a vector of times.
+ */
+static QVector<qint64> xPlayerDatabase_toTimes(const unsigned char* text) {
+    QVector<qint64> times;
+    if (text) {
+        for (const auto& time : QString::fromUtf8(reinterpret_cast<const char*>(text)).split(",", Qt::SkipEmptyParts)) {
+            times.push_back(time.toLongLong());
+        }
+    }
+    return times;
+}
+
+/**
+ * Convert a comma separated string stored in the database into a list of strings.
+ */
+static QStringList xPlayerDatabase_toList(const unsigned char* text) {
+    if (text) {
+        return QString::fromUtf8(reinterpret_cast<const char*>(text)).split(",", Qt::SkipEmptyParts);
+    }
+    return {};
+}
+
 // singleton object.
 xPlayerDatabase* xPlayerDatabase::playerDatabase = nullptr;
 
@@ -36,6 +71,7 @@ xPlayerDatabase::~xPlayerDatabase() noexcept {
 }
 
 void xPlayerDatabase::updatedDatabaseDirectory() {
+    QMutexLocker lock(&sqlMutex);
     // Close database.
     sqlite3_close(sqlDatabase);
     loadDatabase();
@@ -72,6 +108,21 @@ void xPlayerDatabase::loadDatabase() {
     // Create movie table.
     sqlite3_exec(sqlDatabase, "CREATE TABLE movie (hash VARCHAR PRIMARY KEY, playCount INT, timeStamp BIGINT, "
                    "tag VARCHAR, directory VARCHAR, movie VARCHAR)", nullptr, nullptr, nullptr);
+    // Create movie catalog table.
+    sqlite3_exec(sqlDatabase, "CREATE TABLE movieCatalog (path VARCHAR PRIMARY KEY, size BIGINT, modified BIGINT, "
+                   "length BIGINT, chapterBegin VARCHAR, chapterLength VARCHAR, audio VARCHAR, subtitles VARCHAR, "
+                   "thumbnails BLOB)", nullptr, nullptr, nullptr);
+    // Add key frame index to existing movie catalog tables. Entries without index are re-indexed.
+    sqlite3_exec(sqlDatabase, "ALTER TABLE movieCatalog ADD COLUMN keyFrames VARCHAR", nullptr, nullptr, nullptr);
+    // Create movie resume position table.
+    sqlite3_exec(sqlDatabase, "CREATE TABLE movieResume (path VARCHAR PRIMARY KEY, position BIGINT, length BIGINT, "
+                   "timeStamp BIGINT, tag VARCHAR, directory VARCHAR, movie VARCHAR)", nullptr, nullptr, nullptr);
+    // Create file fingerprint table.
+    sqlite3_exec(sqlDatabase, "CREATE TABLE fileFingerprint (path VARCHAR PRIMARY KEY, size BIGINT, modified BIGINT, "
+                   "fingerprint VARCHAR)", nullptr, nullptr, nullptr);
+    // Create remote library cache table.
+    sqlite3_exec(sqlDatabase, "CREATE TABLE remoteLibrary (player VARCHAR, artist VARCHAR, album VARCHAR, "
+                   "path VARCHAR, name VARCHAR, length BIGINT)", nullptr, nullptr, nullptr);
 }
 
 void xPlayerDatabase::dbCheck(int result, int expected) {
@@ -89,6 +140,7 @@ xPlayerDatabase* xPlayerDatabase::database() {
 }
 
 int xPlayerDatabase::getPlayCount(int bitsPerSample, int sampleRate, qint64 after) {
+    QMutexLocker lock(&sqlMutex);
     sqlite3_stmt* sqlStatement = nullptr;
     try {
         if (bitsPerSample > 0) {
@@ -133,6 +185,7 @@ int xPlayerDatabase::getPlayCount(int bitsPerSample, int sampleRate, qint64 afte
 }
 
 int xPlayerDatabase::getPlayCount(const QString& artist, const QString& album, qint64 after) {
+    QMutexLocker lock(&sqlMutex);
     auto artistStd = artist.toStdString();
     auto albumStd = album.toStdString();
     sqlite3_stmt* sqlStatement = nullptr;
@@ -179,6 +232,7 @@ int xPlayerDatabase::getPlayCount(const QString& artist, const QString& album, q
 }
 
 int xPlayerDatabase::getMaxPlayCount(const QString& artist, const QString& album, const QString& track, qint64 after) {
+    QMutexLocker lock(&sqlMutex);
     auto artistStd = artist.toStdString();
     auto albumStd = album.toStdString();
     auto trackStd = track.toStdString();
@@ -221,6 +275,7 @@ int xPlayerDatabase::getMaxPlayCount(const QString& artist, const QString& album
 }
 
 QList<std::pair<QString,int>> xPlayerDatabase::getPlayedArtists(qint64 after) {
+    QMutexLocker lock(&sqlMutex);
     QList<std::pair<QString,int>> artists;
     sqlite3_stmt* sqlStatement = nullptr;
     try {
@@ -247,6 +302,7 @@ QList<std::pair<QString,int>> xPlayerDatabase::getPlayedArtists(qint64 after) {
 }
 
 QList<std::pair<QString,int>> xPlayerDatabase::getPlayedAlbums(const QString& artist, qint64 after) {
+    QMutexLocker lock(&sqlMutex);
     QList<std::pair<QString,int>> albums;
     auto artistStd = artist.toStdString();
     sqlite3_stmt* sqlStatement = nullptr;
@@ -275,6 +331,7 @@ QList<std::pair<QString,int>> xPlayerDatabase::getPlayedAlbums(const QString& ar
 }
 
 QList<std::tuple<QString,int,qint64>> xPlayerDatabase::getPlayedTracks(const QString& artist, const QString& album, qint64 after) {
+    QMutexLocker lock(&sqlMutex);
     QList<std::tuple<QString,int,qint64>> tracks;
     auto artistStd = artist.toStdString();
     auto albumStd = album.toStdString();
@@ -304,6 +361,7 @@ QList<std::tuple<QString,int,qint64>> xPlayerDatabase::getPlayedTracks(const QSt
 }
 
 int xPlayerDatabase::getMaxViewCount(const QString& tag, const QString& directory, const QString& movie, qint64 after) {
+    QMutexLocker lock(&sqlMutex);
     auto tagStd = tag.toStdString();
     auto directoryStd = directory.toStdString();
     auto movieStd = movie.toStdString();
@@ -346,6 +404,7 @@ int xPlayerDatabase::getMaxViewCount(const QString& tag, const QString& director
 }
 
 QList<std::pair<QString,int>> xPlayerDatabase::getPlayedTags(qint64 after) {
+    QMutexLocker lock(&sqlMutex);
     QList<std::pair<QString,int>> tags;
     sqlite3_stmt* sqlStatement = nullptr;
     try {
@@ -372,6 +431,7 @@ QList<std::pair<QString,int>> xPlayerDatabase::getPlayedTags(qint64 after) {
 }
 
 QList<std::pair<QString,int>> xPlayerDatabase::getPlayedDirectories(const QString& tag, qint64 after) {
+    QMutexLocker lock(&sqlMutex);
     QList<std::pair<QString,int>> directories;
     auto tagStd = tag.toStdString();
     sqlite3_stmt* sqlStatement = nullptr;
@@ -400,6 +460,7 @@ QList<std::pair<QString,int>> xPlayerDatabase::getPlayedDirectories(const QStrin
 }
 
 QList<std::tuple<QString,int,qint64>> xPlayerDatabase::getPlayedMovies(const QString& tag, const QString& directory, qint64 after) {
+    QMutexLocker lock(&sqlMutex);
     QList<std::tuple<QString,int,qint64>> movies;
     auto tagStd = tag.toStdString();
     auto directoryStd = directory.toStdString();
@@ -457,6 +518,7 @@ void xPlayerDatabase::updateMovieLengthCacheEntry(const QString& tag, const QStr
 
 std::pair<qint64,qint64> xPlayerDatabase::getMovieFileLength(const QString& tag, const QString& directory,
                                                              const QString& movie) {
+    QMutexLocker lock(&sqlMutex);
     QList<std::tuple<QString,int,qint64>> movies;
     auto tagStd = tag.toStdString();
     auto directoryStd = directory.toStdString();
@@ -487,7 +549,143 @@ std::pair<qint64,qint64> xPlayerDatabase::getMovieFileLength(const QString& tag,
     return getMovieLengthCacheEntry(tag, directory, movie);
 }
 
+xMovieFileInfo xPlayerDatabase::getMovieCatalogEntry(const QString& path) {
+    QMutexLocker lock(&sqlMutex);
+    xMovieFileInfo info;
+    auto pathStd = path.toStdString();
+    sqlite3_stmt* sqlStatement = nullptr;
+    try {
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "SELECT size, modified, length, chapterBegin, chapterLength, audio, "
+                                                "subtitles, thumbnails, keyFrames FROM movieCatalog WHERE path = ?",
+                                   -1, &sqlStatement, nullptr));
+        dbCheck(sqlite3_bind_text(sqlStatement, 1, pathStd.c_str(), static_cast<int>(pathStd.size()), nullptr));
+        if (sqlite3_step(sqlStatement) == SQLITE_ROW) {
+            info.size = static_cast<std::uintmax_t>(sqlite3_column_int64(sqlStatement, 0));
+            info.modified = sqlite3_column_int64(sqlStatement, 1);
+            info.length = sqlite3_column_int64(sqlStatement, 2);
+            info.chapterBegin = xPlayerDatabase_toTimes(sqlite3_column_text(sqlStatement, 3));
+            info.chapterLength = xPlayerDatabase_toTimes(sqlite3_column_text(sqlStatement, 4));
+            info.audioLanguages = xPlayerDatabase_toList(sqlite3_column_text(sqlStatement, 5));
+            info.subtitleLanguages = xPlayerDatabase_toList(sqlite3_column_text(sqlStatement, 6));
+            auto thumbnails = sqlite3_column_blob(sqlStatement, 7);
+            if (thumbnails) {
+                info.thumbnails = QByteArray(static_cast<const char*>(thumbnails), sqlite3_column_bytes(sqlStatement, 7));
+            }
+            info.keyFrames = xPlayerDatabase_toTimes(sqlite3_column_text(sqlStatement, 8));
+            info.keyFramesValid = (sqlite3_column_type(sqlStatement, 8) != SQLITE_NULL);
+        }
+        dbCheck(sqlite3_finalize(sqlStatement));
+    } catch (const std::runtime_error& e) {
+        qCritical() << "Unable to query database for movie catalog entry, error: " << e.what();
+        sqlite3_finalize(sqlStatement);
+        info = xMovieFileInfo();
+    }
+    return info;
+}
+
+QList<xMovieResumePosition> xPlayerDatabase::getMovieResumePositions() {
+    QMutexLocker lock(&sqlMutex);
+    QList<xMovieResumePosition> positions;
+    sqlite3_stmt* sqlStatement = nullptr;
+    try {
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "SELECT path, position, length, timeStamp, tag, directory, movie FROM movieResume",
+                                   -1, &sqlStatement, nullptr));
+        while (sqlite3_step(sqlStatement) == SQLITE_ROW) {
+            xMovieResumePosition position;
+            position.path = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(sqlStatement, 0)));
+            position.position = sqlite3_column_int64(sqlStatement, 1);
+            position.length = sqlite3_column_int64(sqlStatement, 2);
+            position.timeStamp = sqlite3_column_int64(sqlStatement, 3);
+            position.tag = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(sqlStatement, 4)));
+            position.directory = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(sqlStatement, 5)));
+            position.movie = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(sqlStatement, 6)));
+            positions.push_back(position);
+        }
+        dbCheck(sqlite3_finalize(sqlStatement));
+    } catch (const std::runtime_error& e) {
+        qCritical() << "Unable to query database for movie resume positions, error: " << e.what();
+        sqlite3_finalize(sqlStatement);
+        positions.clear();
+    }
+    return positions;
+}
+
+QList<xFileFingerprint> xPlayerDatabase::getFileFingerprints() {
+    QMutexLocker lock(&sqlMutex);
+    QList<xFileFingerprint> fingerprints;
+    sqlite3_stmt* sqlStatement = nullptr;
+    try {
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "SELECT path, size, modified, fingerprint FROM fileFingerprint",
+                                   -1, &sqlStatement, nullptr));
+        while (sqlite3_step(sqlStatement) == SQLITE_ROW) {
+            xFileFingerprint fingerprint;
+            fingerprint.path = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(sqlStatement, 0)));
+            fingerprint.size = static_cast<std::uintmax_t>(sqlite3_column_int64(sqlStatement, 1));
+            fingerprint.modified = sqlite3_column_int64(sqlStatement, 2);
+            fingerprint.fingerprint = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(sqlStatement, 3)));
+            fingerprints.push_back(fingerprint);
+        }
+        dbCheck(sqlite3_finalize(sqlStatement));
+    } catch (const std::runtime_error& e) {
+        qCritical() << "Unable to query database for file fingerprints, error: " << e.what();
+        sqlite3_finalize(sqlStatement);
+        fingerprints.clear();
+    }
+    return fingerprints;
+}
+
+QList<xRemoteLibraryTrack> xPlayerDatabase::getRemoteLibrary(const QString& player) {
+    QMutexLocker lock(&sqlMutex);
+    QList<xRemoteLibraryTrack> tracks;
+    auto playerStd = player.toStdString();
+    sqlite3_stmt* sqlStatement = nullptr;
+    try {
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "SELECT artist, album, path, name, length FROM remoteLibrary "
+                                                "WHERE player=? ORDER BY artist, album", -1, &sqlStatement, nullptr));
+        dbCheck(sqlite3_bind_text(sqlStatement, 1, playerStd.c_str(), static_cast<int>(playerStd.size()), SQLITE_TRANSIENT));
+        while (sqlite3_step(sqlStatement) == SQLITE_ROW) {
+            xRemoteLibraryTrack track;
+            track.artist = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(sqlStatement, 0)));
+            track.album = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(sqlStatement, 1)));
+            track.path = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(sqlStatement, 2)));
+            track.name = QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(sqlStatement, 3)));
+            track.length = sqlite3_column_int64(sqlStatement, 4);
+            tracks.push_back(track);
+        }
+        dbCheck(sqlite3_finalize(sqlStatement));
+    } catch (const std::runtime_error& e) {
+        qCritical() << "Unable to query database for remote library, error: " << e.what();
+        sqlite3_finalize(sqlStatement);
+        tracks.clear();
+    }
+    return tracks;
+}
+
+bool xPlayerDatabase::isMovieCatalogEntryValid(const QString& path, std::uintmax_t size, qint64 modified) {
+    QMutexLocker lock(&sqlMutex);
+    auto pathStd = path.toStdString();
+    auto valid = false;
+    sqlite3_stmt* sqlStatement = nullptr;
+    try {
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "SELECT COUNT(*) FROM movieCatalog WHERE path = ? AND size = ? AND modified = ? "
+                                                "AND keyFrames IS NOT NULL",
+                                   -1, &sqlStatement, nullptr));
+        dbCheck(sqlite3_bind_text(sqlStatement, 1, pathStd.c_str(), static_cast<int>(pathStd.size()), nullptr));
+        dbCheck(sqlite3_bind_int64(sqlStatement, 2, static_cast<sqlite3_int64>(size)));
+        dbCheck(sqlite3_bind_int64(sqlStatement, 3, modified));
+        if (sqlite3_step(sqlStatement) == SQLITE_ROW) {
+            valid = (sqlite3_column_int(sqlStatement, 0) > 0);
+        }
+        dbCheck(sqlite3_finalize(sqlStatement));
+    } catch (const std::runtime_error& e) {
+        qCritical() << "Unable to query database for movie catalog entry, error: " << e.what();
+        sqlite3_finalize(sqlStatement);
+    }
+    return valid;
+}
+
 std::pair<int,qint64> xPlayerDatabase::updateMusicFile(const QString& artist, const QString& album, const QString& track, int sampleRate, int bitsPerSample) {
+    QMutexLocker lock(&sqlMutex);
     auto hash = QCryptographicHash::hash((artist+"/"+album+"/"+track).toUtf8(), QCryptographicHash::Sha256).toBase64().toStdString();
     auto timeStamp = QDateTime::currentMSecsSinceEpoch();
     sqlite3_stmt* sqlStatement = nullptr;
@@ -548,6 +746,7 @@ std::pair<int,qint64> xPlayerDatabase::updateMusicFile(const QString& artist, co
 }
 
 void xPlayerDatabase::renameMusicFile(const QString& artist, const QString& album, const QString& track, const QString& newTrack) {
+    QMutexLocker lock(&sqlMutex);
     auto hash = QCryptographicHash::hash((artist+"/"+album+"/"+track).toUtf8(), QCryptographicHash::Sha256).toBase64().toStdString();
     auto newHash = QCryptographicHash::hash((artist+"/"+album+"/"+newTrack).toUtf8(), QCryptographicHash::Sha256).toBase64().toStdString();
     sqlite3_stmt* sqlStatement = nullptr;
@@ -593,6 +792,7 @@ void xPlayerDatabase::renameMusicFile(const QString& artist, const QString& albu
 }
 
 void xPlayerDatabase::renameMusicFiles(const QString& artist, const QString& album, const QString& newAlbum) {
+    QMutexLocker lock(&sqlMutex);
     std::vector<std::tuple<std::string, int, int64_t, std::string, int, int>> renameEntries;
     auto artistStd = artist.toStdString();
     auto albumStd = album.toStdString();
@@ -653,6 +853,7 @@ void xPlayerDatabase::renameMusicFiles(const QString& artist, const QString& alb
 }
 
 void xPlayerDatabase::renameMusicFiles(const QString& artist, const QString& newArtist) {
+    QMutexLocker lock(&sqlMutex);
     std::vector<std::tuple<std::string, int, int64_t, std::string, std::string, int, int>> renameEntries;
     auto artistStd = artist.toStdString();
     auto newArtistStd = newArtist.toStdString();
@@ -713,6 +914,7 @@ void xPlayerDatabase::renameMusicFiles(const QString& artist, const QString& new
 }
 
 std::pair<int,qint64> xPlayerDatabase::updateMovieFile(const QString& tag, const QString& directory, const QString& movie) {
+    QMutexLocker lock(&sqlMutex);
     auto hash = QCryptographicHash::hash((tag+"/"+directory+"/"+movie).toUtf8(), QCryptographicHash::Sha256).toBase64().toStdString();
     auto timeStamp = QDateTime::currentMSecsSinceEpoch();
     sqlite3_stmt* sqlStatement = nullptr;
@@ -760,6 +962,9 @@ std::pair<int,qint64> xPlayerDatabase::updateMovieFile(const QString& tag, const
 
 void xPlayerDatabase::updateMovieFileLength(const QString &tag, const QString &directory, const QString &movie,
                                             qint64 movieSize, qint64 movieLength) {
+    QMutexLocker lock(&sqlMutex);
+    // Keep the cache consistent with the database.
+    updateMovieLengthCacheEntry(tag, directory, movie, movieSize, movieLength);
     auto tagStd = tag.toStdString();
     auto directoryStd = directory.toStdString();
     auto movieStd = movie.toStdString();
@@ -799,7 +1004,176 @@ void xPlayerDatabase::updateMovieFileLength(const QString &tag, const QString &d
     }
 }
 
+void xPlayerDatabase::updateMovieCatalogEntry(const QString& path, const xMovieFileInfo& info) {
+    QMutexLocker lock(&sqlMutex);
+    auto pathStd = path.toStdString();
+    auto chapterBeginStd = xPlayerDatabase_fromTimes(info.chapterBegin);
+    auto chapterLengthStd = xPlayerDatabase_fromTimes(info.chapterLength);
+    auto audioStd = info.audioLanguages.join(",").toStdString();
+    auto subtitlesStd = info.subtitleLanguages.join(",").toStdString();
+    auto keyFramesStd = xPlayerDatabase_fromTimes(info.keyFrames);
+    sqlite3_stmt* sqlStatement = nullptr;
+    try {
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "INSERT OR REPLACE INTO movieCatalog (path,size,modified,length,chapterBegin,"
+                                                "chapterLength,audio,subtitles,thumbnails,keyFrames) VALUES (?,?,?,?,?,?,?,?,?,?)",
+                                   -1, &sqlStatement, nullptr));
+        dbCheck(sqlite3_bind_text(sqlStatement, 1, pathStd.c_str(), static_cast<int>(pathStd.size()), nullptr));
+        dbCheck(sqlite3_bind_int64(sqlStatement, 2, static_cast<sqlite3_int64>(info.size)));
+        dbCheck(sqlite3_bind_int64(sqlStatement, 3, info.modified));
+        dbCheck(sqlite3_bind_int64(sqlStatement, 4, info.length));
+        dbCheck(sqlite3_bind_text(sqlStatement, 5, chapterBeginStd.c_str(), static_cast<int>(chapterBeginStd.size()), nullptr));
+        dbCheck(sqlite3_bind_text(sqlStatement, 6, chapterLengthStd.c_str(), static_cast<int>(chapterLengthStd.size()), nullptr));
+        dbCheck(sqlite3_bind_text(sqlStatement, 7, audioStd.c_str(), static_cast<int>(audioStd.size()), nullptr));
+        dbCheck(sqlite3_bind_text(sqlStatement, 8, subtitlesStd.c_str(), static_cast<int>(subtitlesStd.size()), nullptr));
+        dbCheck(sqlite3_bind_blob(sqlStatement, 9, info.thumbnails.constData(), static_cast<int>(info.thumbnails.size()), nullptr));
+        // A missing key frame index is stored as NULL. The entry is then not valid.
+        if (info.keyFramesValid) {
+            dbCheck(sqlite3_bind_text(sqlStatement, 10, keyFramesStd.c_str(), static_cast<int>(keyFramesStd.size()), nullptr));
+        } else {
+            dbCheck(sqlite3_bind_null(sqlStatement, 10));
+        }
+        dbCheck(sqlite3_step(sqlStatement), SQLITE_DONE);
+        dbCheck(sqlite3_finalize(sqlStatement));
+    } catch (const std::runtime_error& e) {
+        qCritical() << "xPlayerDatabase::updateMovieCatalogEntry: error: " << e.what();
+        sqlite3_finalize(sqlStatement);
+    }
+}
+
+void xPlayerDatabase::updateMovieResumePositions(const QList<xMovieResumePosition>& positions) {
+    QMutexLocker lock(&sqlMutex);
+    if (positions.isEmpty()) {
+        return;
+    }
+    sqlite3_stmt* sqlUpdateStatement = nullptr;
+    sqlite3_stmt* sqlRemoveStatement = nullptr;
+    try {
+        // Use a single transaction for the batch. Other threads wait for the lock
+        // and their statements are not part of the transaction.
+        dbCheck(sqlite3_exec(sqlDatabase, "BEGIN TRANSACTION", nullptr, nullptr, nullptr));
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "INSERT OR REPLACE INTO movieResume (path,position,length,timeStamp,"
+                                                "tag,directory,movie) VALUES (?,?,?,?,?,?,?)",
+                                   -1, &sqlUpdateStatement, nullptr));
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "DELETE FROM movieResume WHERE path = ?",
+                                   -1, &sqlRemoveStatement, nullptr));
+        for (const auto& position : positions) {
+            auto pathStd = position.path.toStdString();
+            if (position.position <= 0) {
+                dbCheck(sqlite3_bind_text(sqlRemoveStatement, 1, pathStd.c_str(), static_cast<int>(pathStd.size()), SQLITE_TRANSIENT));
+                dbCheck(sqlite3_step(sqlRemoveStatement), SQLITE_DONE);
+                dbCheck(sqlite3_reset(sqlRemoveStatement));
+                continue;
+            }
+            auto tagStd = position.tag.toStdString();
+            auto directoryStd = position.directory.toStdString();
+            auto movieStd = position.movie.toStdString();
+            dbCheck(sqlite3_bind_text(sqlUpdateStatement, 1, pathStd.c_str(), static_cast<int>(pathStd.size()), SQLITE_TRANSIENT));
+            dbCheck(sqlite3_bind_int64(sqlUpdateStatement, 2, position.position));
+            dbCheck(sqlite3_bind_int64(sqlUpdateStatement, 3, position.length));
+            dbCheck(sqlite3_bind_int64(sqlUpdateStatement, 4, position.timeStamp));
+            dbCheck(sqlite3_bind_text(sqlUpdateStatement, 5, tagStd.c_str(), static_cast<int>(tagStd.size()), SQLITE_TRANSIENT));
+            dbCheck(sqlite3_bind_text(sqlUpdateStatement, 6, directoryStd.c_str(), static_cast<int>(directoryStd.size()), SQLITE_TRANSIENT));
+            dbCheck(sqlite3_bind_text(sqlUpdateStatement, 7, movieStd.c_str(), static_cast<int>(movieStd.size()), SQLITE_TRANSIENT));
+            dbCheck(sqlite3_step(sqlUpdateStatement), SQLITE_DONE);
+            dbCheck(sqlite3_reset(sqlUpdateStatement));
+        }
+        dbCheck(sqlite3_finalize(sqlUpdateStatement));
+        dbCheck(sqlite3_finalize(sqlRemoveStatement));
+        dbCheck(sqlite3_exec(sqlDatabase, "COMMIT", nullptr, nullptr, nullptr));
+    } catch (const std::runtime_error& e) {
+        qCritical() << "xPlayerDatabase::updateMovieResumePositions: error: " << e.what();
+        sqlite3_finalize(sqlUpdateStatement);
+        sqlite3_finalize(sqlRemoveStatement);
+        sqlite3_exec(sqlDatabase, "ROLLBACK", nullptr, nullptr, nullptr);
+    }
+}
+
+void xPlayerDatabase::updateFileFingerprints(const QList<xFileFingerprint>& fingerprints) {
+    QMutexLocker lock(&sqlMutex);
+    if (fingerprints.isEmpty()) {
+        return;
+    }
+    sqlite3_stmt* sqlStatement = nullptr;
+    try {
+        // Store all fingerprints of a sync at once.
+        dbCheck(sqlite3_exec(sqlDatabase, "BEGIN TRANSACTION", nullptr, nullptr, nullptr));
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "INSERT OR REPLACE INTO fileFingerprint (path,size,modified,fingerprint) "
+                                                "VALUES (?,?,?,?)", -1, &sqlStatement, nullptr));
+        for (const auto& fingerprint : fingerprints) {
+            auto pathStd = fingerprint.path.toStdString();
+            auto fingerprintStd = fingerprint.fingerprint.toStdString();
+            dbCheck(sqlite3_bind_text(sqlStatement, 1, pathStd.c_str(), static_cast<int>(pathStd.size()), SQLITE_TRANSIENT));
+            dbCheck(sqlite3_bind_int64(sqlStatement, 2, static_cast<sqlite3_int64>(fingerprint.size)));
+            dbCheck(sqlite3_bind_int64(sqlStatement, 3, fingerprint.modified));
+            dbCheck(sqlite3_bind_text(sqlStatement, 4, fingerprintStd.c_str(), static_cast<int>(fingerprintStd.size()), SQLITE_TRANSIENT));
+            dbCheck(sqlite3_step(sqlStatement), SQLITE_DONE);
+            dbCheck(sqlite3_reset(sqlStatement));
+        }
+        dbCheck(sqlite3_finalize(sqlStatement));
+        dbCheck(sqlite3_exec(sqlDatabase, "COMMIT", nullptr, nullptr, nullptr));
+    } catch (const std::runtime_error& e) {
+        qCritical() << "xPlayerDatabase::updateFileFingerprints: error: " << e.what();
+        sqlite3_finalize(sqlStatement);
+        sqlite3_exec(sqlDatabase, "ROLLBACK", nullptr, nullptr, nullptr);
+    }
+}
+
+void xPlayerDatabase::updateRemoteLibrary(const QString& player, const QList<xRemoteLibraryTrack>& tracks) {
+    QMutexLocker lock(&sqlMutex);
+    auto playerStd = player.toStdString();
+    sqlite3_stmt* sqlRemoveStatement = nullptr;
+    sqlite3_stmt* sqlStatement = nullptr;
+    try {
+        // Replace the cached library within a single transaction.
+        dbCheck(sqlite3_exec(sqlDatabase, "BEGIN TRANSACTION", nullptr, nullptr, nullptr));
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "DELETE FROM remoteLibrary WHERE player=?", -1, &sqlRemoveStatement, nullptr));
+        dbCheck(sqlite3_bind_text(sqlRemoveStatement, 1, playerStd.c_str(), static_cast<int>(playerStd.size()), SQLITE_TRANSIENT));
+        dbCheck(sqlite3_step(sqlRemoveStatement), SQLITE_DONE);
+        dbCheck(sqlite3_finalize(sqlRemoveStatement));
+        sqlRemoveStatement = nullptr;
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "INSERT INTO remoteLibrary (player,artist,album,path,name,length) "
+                                                "VALUES (?,?,?,?,?,?)", -1, &sqlStatement, nullptr));
+        for (const auto& track : tracks) {
+            auto artistStd = track.artist.toStdString();
+            auto albumStd = track.album.toStdString();
+            auto pathStd = track.path.toStdString();
+            auto nameStd = track.name.toStdString();
+            dbCheck(sqlite3_bind_text(sqlStatement, 1, playerStd.c_str(), static_cast<int>(playerStd.size()), SQLITE_TRANSIENT));
+            dbCheck(sqlite3_bind_text(sqlStatement, 2, artistStd.c_str(), static_cast<int>(artistStd.size()), SQLITE_TRANSIENT));
+            dbCheck(sqlite3_bind_text(sqlStatement, 3, albumStd.c_str(), static_cast<int>(albumStd.size()), SQLITE_TRANSIENT));
+            dbCheck(sqlite3_bind_text(sqlStatement, 4, pathStd.c_str(), static_cast<int>(pathStd.size()), SQLITE_TRANSIENT));
+            dbCheck(sqlite3_bind_text(sqlStatement, 5, nameStd.c_str(), static_cast<int>(nameStd.size()), SQLITE_TRANSIENT));
+            dbCheck(sqlite3_bind_int64(sqlStatement, 6, track.length));
+            dbCheck(sqlite3_step(sqlStatement), SQLITE_DONE);
+            dbCheck(sqlite3_reset(sqlStatement));
+        }
+        dbCheck(sqlite3_finalize(sqlStatement));
+        dbCheck(sqlite3_exec(sqlDatabase, "COMMIT", nullptr, nullptr, nullptr));
+    } catch (const std::runtime_error& e) {
+        qCritical() << "xPlayerDatabase::updateRemoteLibrary: error: " << e.what();
+        sqlite3_finalize(sqlRemoveStatement);
+        sqlite3_finalize(sqlStatement);
+        sqlite3_exec(sqlDatabase, "ROLLBACK", nullptr, nullptr, nullptr);
+    }
+}
+
+void xPlayerDatabase::removeRemoteLibrary(const QString& player) {
+    QMutexLocker lock(&sqlMutex);
+    auto playerStd = player.toStdString();
+    sqlite3_stmt* sqlStatement = nullptr;
+    try {
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "DELETE FROM remoteLibrary WHERE player=?", -1, &sqlStatement, nullptr));
+        dbCheck(sqlite3_bind_text(sqlStatement, 1, playerStd.c_str(), static_cast<int>(playerStd.size()), SQLITE_TRANSIENT));
+        dbCheck(sqlite3_step(sqlStatement), SQLITE_DONE);
+        dbCheck(sqlite3_finalize(sqlStatement));
+    } catch (const std::runtime_error& e) {
+        qCritical() << "xPlayerDatabase::removeRemoteLibrary: error: " << e.what();
+        sqlite3_finalize(sqlStatement);
+    }
+}
+
 void xPlayerDatabase::removeMovieFileLength(const QString &tag, const QString &directory, const QString &movie) {
+    QMutexLocker lock(&sqlMutex);
     auto tagStd = tag.toStdString();
     auto directoryStd = directory.toStdString();
     auto movieStd = movie.toStdString();
@@ -831,6 +1205,7 @@ void xPlayerDatabase::removeMovieFileLength(const QString &tag, const QString &d
 }
 
 void xPlayerDatabase::clearMovieFileLength() {
+    QMutexLocker lock(&sqlMutex);
     sqlite3_stmt* sqlStatement = nullptr;
     try {
         dbCheck(sqlite3_prepare_v2(sqlDatabase, "DELETE FROM movieLength", -1, &sqlStatement, nullptr));
@@ -844,6 +1219,7 @@ void xPlayerDatabase::clearMovieFileLength() {
 }
 
 bool xPlayerDatabase::removeMusicPlaylist(const QString& name) {
+    QMutexLocker lock(&sqlMutex);
     auto nameStd = name.toStdString();
     sqlite3_stmt* sqlStatement = nullptr;
     try {
@@ -874,6 +1250,7 @@ bool xPlayerDatabase::removeMusicPlaylist(const QString& name) {
 }
 
 QStringList xPlayerDatabase::getMusicPlaylists() {
+    QMutexLocker lock(&sqlMutex);
     QStringList names;
     sqlite3_stmt* sqlStatement = nullptr;
     try {
@@ -895,6 +1272,7 @@ QStringList xPlayerDatabase::getMusicPlaylists() {
 }
 
 std::vector<std::tuple<QString,QString,QString>> xPlayerDatabase::getMusicPlaylist(const QString& name) {
+    QMutexLocker lock(&sqlMutex);
     std::vector<std::tuple<QString,QString,QString>> entries;
     auto nameStd = name.toStdString();
     sqlite3_stmt* sqlStatement = nullptr;
@@ -929,6 +1307,7 @@ std::vector<std::tuple<QString,QString,QString>> xPlayerDatabase::getMusicPlayli
 }
 
 bool xPlayerDatabase::updateMusicPlaylist(const QString& name, const std::vector<std::tuple<QString,QString,QString>>& entries) {
+    QMutexLocker lock(&sqlMutex);
     sqlite3_stmt* sqlStatement = nullptr;
     auto nameStd = name.toStdString();
     auto playlistId = 0;
@@ -1026,6 +1405,7 @@ bool xPlayerDatabase::updateMusicPlaylist(const QString& name, const std::vector
 }
 
 std::list<std::tuple<QString,QString,QString>> xPlayerDatabase::getAllTracks() {
+    QMutexLocker lock(&sqlMutex);
     std::list<std::tuple<QString,QString,QString>> tracks;
     sqlite3_stmt* sqlStatement = nullptr;
     try {
@@ -1049,7 +1429,36 @@ std::list<std::tuple<QString,QString,QString>> xPlayerDatabase::getAllTracks() {
     return tracks;
 }
 
+std::list<std::tuple<QString,QString,QString,int,qint64>> xPlayerDatabase::getAllPlayedTracks(qint64 after) {
+    QMutexLocker lock(&sqlMutex);
+    std::list<std::tuple<QString,QString,QString,int,qint64>> tracks;
+    sqlite3_stmt* sqlStatement = nullptr;
+    try {
+        dbCheck(sqlite3_prepare_v2(sqlDatabase, "SELECT artist, album, track, playCount, timeStamp FROM music "
+                                                "WHERE timeStamp >= ?",
+                                   -1, &sqlStatement, nullptr));
+        dbCheck(sqlite3_bind_int64(sqlStatement, 1, after));
+        while (sqlite3_step(sqlStatement) != SQLITE_DONE) {
+            auto artist = QString::fromUtf8(reinterpret_cast<const char *>(sqlite3_column_text(sqlStatement, 0)));
+            auto album = QString::fromUtf8(reinterpret_cast<const char *>(sqlite3_column_text(sqlStatement, 1)));
+            auto track = QString::fromUtf8(reinterpret_cast<const char *>(sqlite3_column_text(sqlStatement, 2)));
+            auto playCount = sqlite3_column_int(sqlStatement, 3);
+            auto timeStamp = sqlite3_column_int64(sqlStatement, 4);
+            if ((!artist.isEmpty()) && (!album.isEmpty()) && (!track.isEmpty())) {
+                tracks.emplace_back(artist, album, track, playCount, timeStamp);
+            }
+        }
+        dbCheck(sqlite3_finalize(sqlStatement));
+    } catch (const std::runtime_error& e) {
+        qCritical() << "Unable to get all played tracks, error: " << sqlite3_errmsg(sqlDatabase);
+        sqlite3_finalize(sqlStatement);
+        tracks.clear();
+    }
+    return tracks;
+}
+
 std::list<std::tuple<QString,QString,QString>> xPlayerDatabase::getAllMovies() {
+    QMutexLocker lock(&sqlMutex);
     std::list<std::tuple<QString,QString,QString>> movies;
     sqlite3_stmt* sqlStatement = nullptr;
     try {
@@ -1074,6 +1483,7 @@ std::list<std::tuple<QString,QString,QString>> xPlayerDatabase::getAllMovies() {
 }
 
 std::list<std::tuple<QString,QString,QString>> xPlayerDatabase::getAllMovieLengths() {
+    QMutexLocker lock(&sqlMutex);
     std::list<std::tuple<QString,QString,QString>> movies;
     sqlite3_stmt* sqlStatement = nullptr;
     try {
@@ -1126,6 +1536,7 @@ void xPlayerDatabase::removeMovies(const std::list<std::tuple<QString, QString,
 }
 
 void xPlayerDatabase::removeMovieLengths(const std::list<std::tuple<QString, QString, QString>>& entries) {
+    QMutexLocker lock(&sqlMutex);
     // We only need to remove the movies from the movie table.
     try {
         sqlite3_stmt* sqlStatement = nullptr;
@@ -1174,6 +1585,7 @@ std::list<std::string> xPlayerDatabase::convertEntriesToWhereArguments(const std
 }
 
 QString xPlayerDatabase::getArtistURL(const QString& artist) {
+    QMutexLocker lock(&sqlMutex);
     sqlite3_stmt* sqlStatement = nullptr;
     auto artistStd = artist.toStdString();
 
@@ -1190,6 +1602,7 @@ QString xPlayerDatabase::getArtistURL(const QString& artist) {
 }
 
 void xPlayerDatabase::updateArtistURL(const QString& artist, const QString& url) {
+    QMutexLocker lock(&sqlMutex);
     auto artistStd = artist.toStdString();
     auto urlStd = url.toStdString();
     sqlite3_stmt* sqlStatement = nullptr;
@@ -1222,6 +1635,7 @@ void xPlayerDatabase::updateArtistURL(const QString& artist, const QString& url)
 }
 
 void xPlayerDatabase::removeArtistURL(const QString& artist) {
+    QMutexLocker lock(&sqlMutex);
     auto artistStd = artist.toStdString();
     sqlite3_stmt* sqlStatement = nullptr;
     try {
@@ -1240,6 +1654,7 @@ void xPlayerDatabase::removeArtistURL(const QString& artist) {
 std::pair<int,qint64> xPlayerDatabase::updateTransition(const QString& fromArtist, const QString& fromAlbum,
                                                          const QString& toArtist, const QString& toAlbum,
                                                          bool shuffleMode) {
+    QMutexLocker lock(&sqlMutex);
     auto timeStamp = QDateTime::currentMSecsSinceEpoch();
     auto fromArtistStd = fromArtist.toStdString();
     auto fromAlbumStd = fromAlbum.toStdString();
@@ -1308,6 +1723,7 @@ std::pair<int,qint64> xPlayerDatabase::updateTransition(const QString& fromArtis
 }
 
 std::vector<std::pair<QString,int>> xPlayerDatabase::getArtistTransitions(const QString& artist) {
+    QMutexLocker lock(&sqlMutex);
     std::vector<std::pair<QString,int>> artistTransitions;
     auto artistStd = artist.toStdString();
     sqlite3_stmt* sqlStatement = nullptr;
@@ -1339,6 +1755,7 @@ std::vector<std::pair<QString,int>> xPlayerDatabase::getArtistTransitions(const
 }
 
 void xPlayerDatabase::addTag(const QString& artist, const QString& album, const QString& track, const QString& tag) {
+    QMutexLocker lock(&sqlMutex);
     auto hash = QCryptographicHash::hash((artist + "/" + album + "/" + track).toUtf8(),
                                          QCryptographicHash::Sha256).toBase64().toStdString();
     auto tagStd = tag.toStdString();
@@ -1358,6 +1775,7 @@ void xPlayerDatabase::addTag(const QString& artist, const QString& album, const
 }
 
 void xPlayerDatabase::removeTag(const QString& artist, const QString& album, const QString& track, const QString& tag) {
+    QMutexLocker lock(&sqlMutex);
     auto hash = QCryptographicHash::hash((artist+"/"+album+"/"+track).toUtf8(),
                                          QCryptographicHash::Sha256).toBase64().toStdString();
     auto tagStd = tag.toStdString();
@@ -1377,6 +1795,7 @@ void xPlayerDatabase::removeTag(const QString& artist, const QString& album, con
 }
 
 void xPlayerDatabase::removeAllTags(const QString& artist, const QString& album, const QString& track) {
+    QMutexLocker lock(&sqlMutex);
     auto hash = QCryptographicHash::hash((artist + "/" + album + "/" + track).toUtf8(),
                                          QCryptographicHash::Sha256).toBase64().toStdString();
     sqlite3_stmt* sqlStatement = nullptr;
@@ -1395,6 +1814,7 @@ void xPlayerDatabase::removeAllTags(const QString& artist, const QString& album,
 
 void xPlayerDatabase::updateTags(const QString& artist, const QString& album, const QString& track,
                                  const QStringList& tags) {
+    QMutexLocker lock(&sqlMutex);
     auto hash = QCryptographicHash::hash((artist + "/" + album + "/" + track).toUtf8(),
                                          QCryptographicHash::Sha256).toBase64().toStdString();
     try {
@@ -1416,6 +1836,7 @@ void xPlayerDatabase::updateTags(const QString& artist, const QString& album, co
 }
 
 QStringList xPlayerDatabase::getTags(const QString& artist, const QString& album, const QString& track) {
+    QMutexLocker lock(&sqlMutex);
     auto hash = QCryptographicHash::hash((artist + "/" + album + "/" + track).toUtf8(),
                                          QCryptographicHash::Sha256).toBase64().toStdString();
     QStringList tags;
@@ -1440,6 +1861,7 @@ QStringList xPlayerDatabase::getTags(const QString& artist, const QString& album
 }
 
 std::vector<std::tuple<QString, QString, QString>> xPlayerDatabase::getAllForTag(const QString& tag) {
+    QMutexLocker lock(&sqlMutex);
     std::vector<std::tuple<QString,QString,QString>> entries;
     auto tagStd = tag.toStdString();
     sqlite3_stmt* sqlStatement = nullptr;
@@ -1466,6 +1888,7 @@ std::vector<std::tuple<QString, QString, QString>> xPlayerDatabase::getAllForTag
 }
 
 std::map<QString,std::set<QString>> xPlayerDatabase::getAllAlbums(qint64 after) {
+    QMutexLocker lock(&sqlMutex);
     std::map<QString,std::set<QString>> mapArtistAlbum;
     sqlite3_stmt* sqlStatement = nullptr;
     try {
@@ -1492,6 +1915,7 @@ std::map<QString,std::set<QString>> xPlayerDatabase::getAllAlbums(qint64 after)
 }
 
 void xPlayerDatabase::removeFromTable(const std::string& tableName, const std::string& whereArgument) {
+    QMutexLocker lock(&sqlMutex);
     // Remove entries from given table.
     auto sqlRemove = "DELETE FROM " + tableName + whereArgument;
     if (sqlite3_exec(sqlDatabase, sqlRemove.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) {
@@ -15,8 +15,11 @@
 #ifndef __XPLAYERDATABASE_H__
 #define __XPLAYERDATABASE_H__
 
+#include "xPlayerTypes.h"
+
 #include <QObject>
 #include <QStringList>
+#include <QRecursiveMutex>
 #include <sqlite3.h>
 #include <set>
 
@@ -125,6 +128,43 @@ public:
      * @return a pair of byte size and length in ms.
      */
     std::pair<qint64,qint64> getMovieFileLength(const QString& tag, const QString& directory, const QString& movie);
+    /**
+     * Return the movie catalog entry for a movie file.
+     *
+     * The caller needs to validate the entry with the size and modification time of the file.
+     *
+     * @param path the path to the movie file.
+     * @return the movie file info, size and modification time are 0 if no entry exists.
+     */
+    xMovieFileInfo getMovieCatalogEntry(const QString& path);
+    /**
+     * Return all stored movie resume positions.
+     *
+     * @return a list of resume positions.
+     */
+    QList<xMovieResumePosition> getMovieResumePositions();
+    /**
+     * Return all stored file fingerprints.
+     *
+     * @return a list of file fingerprints.
+     */
+    QList<xFileFingerprint> getFileFingerprints();
+    /**
+     * Return the cached library of a remote player.
+     *
+     * @param player the url of the remote player as string.
+     * @return a list of tracks sorted by artist and album, empty if not cached.
+     */
+    QList<xRemoteLibraryTrack> getRemoteLibrary(const QString& player);
+    /**
+     * Verify if a valid movie catalog entry exists for a movie file.
+     *
+     * @param path the path to the movie file.
+     * @param size the current byte size of the movie file.
+     * @param modified the current modification time of the movie file.
+     * @return true if an entry with matching size and modification time exists, false otherwise.
+     */
+    bool isMovieCatalogEntryValid(const QString& path, std::uintmax_t size, qint64 modified);
     /**
      * Record the playing music file in the music table of the database.
      *
@@ -201,6 +241,44 @@ public:
      */
     void updateMovieFileLength(const QString& tag, const QString& directory, const QString& movie,
                                qint64 movieSize, qint64 movieLength);
+    /**
+     * Record the metadata of a movie file in the movie catalog.
+     *
+     * An existing entry for the movie file is replaced.
+     *
+     * @param path the path to the movie file.
+     * @param info the movie file info including size and modification time.
+     */
+    void updateMovieCatalogEntry(const QString& path, const xMovieFileInfo& info);
+    /**
+     * Record the resume positions for a batch of movie files within one transaction.
+     *
+     * Existing entries are replaced. Entries with a position of 0 are removed.
+     *
+     * @param positions the list of resume positions.
+     */
+    void updateMovieResumePositions(const QList<xMovieResumePosition>& positions);
+    /**
+     * Record a batch of file fingerprints within one transaction.
+     *
+     * Existing entries for the same path are replaced.
+     *
+     * @param fingerprints the list of file fingerprints.
+     */
+    void updateFileFingerprints(const QList<xFileFingerprint>& fingerprints);
+    /**
+     * Replace the cached library of a remote player within one transaction.
+     *
+     * @param player the url of the remote player as string.
+     * @param tracks the list of tracks of the remote library.
+     */
+    void updateRemoteLibrary(const QString& player, const QList<xRemoteLibraryTrack>& tracks);
+    /**
+     * Remove the cached library of a remote player.
+     *
+     * @param player the url of the remote player as string.
+     */
+    void removeRemoteLibrary(const QString& player);
     /**
      * Remove the recorded movie length.
      *
@@ -259,6 +337,15 @@ public:
      * @return a list of tuples of artist, album and track as strings.
      */
     std::list<std::tuple<QString,QString,QString>> getAllTracks();
+    /**
+     * Return the play count and time stamp for all tracks stored in the music table of the database.
+     *
+     * The output is used as snapshot for the weighted shuffle modes of the music player.
+     *
+     * @param after the time stamp after which played files are considered.
+     * @return a list of tuples of artist, album, track, play count and time stamp.
+     */
+    std::list<std::tuple<QString,QString,QString,int,qint64>> getAllPlayedTracks(qint64 after=0);
     /**
      * Return all movies stored in the movie table of the database.
      *
@@ -467,6 +554,11 @@ private:
     static xPlayerDatabase* playerDatabase;
     sqlite3* sqlDatabase;
     std::map<QString, std::map<QString, std::pair<qint64, qint64>>> movieLengthCache;
+    // The connection is shared by the GUI and worker threads, e.g. the movie indexer, the
+    // duration workers and the position tracker. Every access to the connection holds the
+    // lock. Transactions thereby never include statements of other threads. Recursive
+    // since accesses call each other.
+    QRecursiveMutex sqlMutex;
 };
 
 #endif
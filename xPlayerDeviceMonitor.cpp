@@ -0,0 +1,235 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xPlayerDeviceMonitor.h"
+#include "xPlayerConfiguration.h"
+
+#include <QFile>
+#include <QDebug>
+
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+const QString xPlayerDeviceMonitor_DeviceStat { "/sys/dev/block/%1:%2/stat" }; // NOLINT
+const QString xPlayerDeviceMonitor_DeviceQueueDepth { "/sys/dev/block/%1:%2/queue/nr_requests" }; // NOLINT
+const QString xPlayerDeviceMonitor_PartitionQueueDepth { "/sys/dev/block/%1:%2/../queue/nr_requests" }; // NOLINT
+// The stat file counts sectors of 512 bytes independent of the sector size of the device.
+constexpr auto xPlayerDeviceMonitor_SectorSize = 512ull;
+// Time window of the moving average in ms.
+constexpr auto xPlayerDeviceMonitor_AverageWindow = 5000;
+// Index of the sectors read, sectors written and in-flight fields in the stat file.
+constexpr auto xPlayerDeviceMonitor_SectorsRead = 2;
+constexpr auto xPlayerDeviceMonitor_SectorsWritten = 6;
+constexpr auto xPlayerDeviceMonitor_InFlight = 8;
+constexpr auto xPlayerDeviceMonitor_Fields = 9;
+
+/**
+ * Read the first line of the given file as integer.
+ */
+static int xPlayerDeviceMonitor_readInt(const QString& fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly|QIODevice::Text)) {
+        return 0;
+    }
+    return file.readLine().trimmed().toInt();
+}
+
+/**
+ * Arm the timer with the given interval in ms.
+ */
+static void xPlayerDeviceMonitor_setTimer(int timerFd, int interval) {
+    struct itimerspec timerSpec{};
+    timerSpec.it_interval.tv_sec = interval / 1000;
+    timerSpec.it_interval.tv_nsec = (interval % 1000) * 1000000L;
+    timerSpec.it_value = timerSpec.it_interval;
+    ::timerfd_settime(timerFd, 0, &timerSpec, nullptr);
+}
+
+
+xPlayerDeviceMonitor::xPlayerDeviceMonitor(QObject* parent):
+        QObject(parent),
+        monitorThread(nullptr),
+        monitorMutex(),
+        monitorStatistics(),
+        monitorInterval(xPlayerConfiguration::configuration()->getDeviceMonitorInterval()),
+        monitorStatFd(-1),
+        monitorTimerFd(-1),
+        monitorStopFd(-1) {
+    connect(xPlayerConfiguration::configuration(), &xPlayerConfiguration::updatedDeviceMonitorInterval,
+            this, &xPlayerDeviceMonitor::updateInterval);
+}
+
+xPlayerDeviceMonitor::~xPlayerDeviceMonitor() {
+    stop();
+}
+
+bool xPlayerDeviceMonitor::start(const std::filesystem::path& path) {
+    stop();
+    struct stat pathStat{};
+    if (stat(path.c_str(), &pathStat) < 0) {
+        qCritical() << "xPlayerDeviceMonitor: unable to call stat for path: " << QString::fromStdString(path.string());
+        return false;
+    }
+    auto deviceMajor = major(pathStat.st_dev);
+    auto deviceMinor = minor(pathStat.st_dev);
+    auto deviceStat = xPlayerDeviceMonitor_DeviceStat.arg(deviceMajor).arg(deviceMinor);
+    monitorStatFd = ::open(deviceStat.toStdString().c_str(), O_RDONLY|O_CLOEXEC);
+    if (monitorStatFd < 0) {
+        qCritical() << "xPlayerDeviceMonitor: unable to open device stat file: " << deviceStat;
+        return false;
+    }
+    // Partitions do not have a queue. Use the queue of the parent device.
+    auto queueDepth = xPlayerDeviceMonitor_readInt(xPlayerDeviceMonitor_DeviceQueueDepth.arg(deviceMajor).arg(deviceMinor));
+    if (queueDepth <= 0) {
+        queueDepth = xPlayerDeviceMonitor_readInt(xPlayerDeviceMonitor_PartitionQueueDepth.arg(deviceMajor).arg(deviceMinor));
+    }
+    monitorInterval = xPlayerConfiguration::configuration()->getDeviceMonitorInterval();
+    monitorTimerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    monitorStopFd = ::eventfd(0, EFD_CLOEXEC);
+    if ((monitorTimerFd < 0) || (monitorStopFd < 0)) {
+        qCritical() << "xPlayerDeviceMonitor: unable to create timer or event: " << strerror(errno);
+        stop();
+        return false;
+    }
+    xPlayerDeviceMonitor_setTimer(monitorTimerFd, monitorInterval);
+    {
+        QMutexLocker lock(&monitorMutex);
+        monitorStatistics = xPlayerDeviceStatistics{};
+        monitorStatistics.queueDepth = queueDepth;
+    }
+    monitorThread = QThread::create([this]() { monitor(); });
+    monitorThread->start();
+    return true;
+}
+
+void xPlayerDeviceMonitor::stop() {
+    if (monitorThread) {
+        // Wake up the monitor thread.
+        uint64_t stopEvent = 1;
+        if (::write(monitorStopFd, &stopEvent, sizeof(stopEvent)) < 0) {
+            qWarning() << "xPlayerDeviceMonitor: unable to stop monitor: " << strerror(errno);
+        }
+        monitorThread->wait();
+        delete monitorThread;
+        monitorThread = nullptr;
+    }
+    for (auto fd : { &monitorStatFd, &monitorTimerFd, &monitorStopFd }) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void xPlayerDeviceMonitor::updateInterval() {
+    monitorInterval = xPlayerConfiguration::configuration()->getDeviceMonitorInterval();
+    // Restart the timer of a running monitor. The monitor thread uses the new interval with the next sample.
+    if (monitorTimerFd >= 0) {
+        xPlayerDeviceMonitor_setTimer(monitorTimerFd, monitorInterval);
+    }
+}
+
+xPlayerDeviceStatistics xPlayerDeviceMonitor::getStatistics() {
+    QMutexLocker lock(&monitorMutex);
+    return monitorStatistics;
+}
+
+void xPlayerDeviceMonitor::monitor() {
+    unsigned long long fields[xPlayerDeviceMonitor_Fields] = {};
+    if (!readStat(fields)) {
+        return;
+    }
+    auto previousSectorsRead = fields[xPlayerDeviceMonitor_SectorsRead];
+    auto previousSectorsWritten = fields[xPlayerDeviceMonitor_SectorsWritten];
+    auto previousSample = std::chrono::steady_clock::now();
+    struct pollfd pollFds[2] = { { monitorTimerFd, POLLIN, 0 }, { monitorStopFd, POLLIN, 0 } };
+    while (true) {
+        if (::poll(pollFds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (pollFds[1].revents & POLLIN) {
+            break;
+        }
+        if (!(pollFds[0].revents & POLLIN)) {
+            continue;
+        }
+        uint64_t expirations = 0;
+        if ((::read(monitorTimerFd, &expirations, sizeof(expirations)) < 0) || (!readStat(fields))) {
+            continue;
+        }
+        auto currentSample = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration<double>(currentSample - previousSample).count();
+        if (elapsed <= 0) {
+            continue;
+        }
+        auto readBytes = static_cast<double>((fields[xPlayerDeviceMonitor_SectorsRead] - previousSectorsRead) *
+                                             xPlayerDeviceMonitor_SectorSize) / elapsed;
+        auto writeBytes = static_cast<double>((fields[xPlayerDeviceMonitor_SectorsWritten] - previousSectorsWritten) *
+                                              xPlayerDeviceMonitor_SectorSize) / elapsed;
+        auto inFlight = static_cast<double>(fields[xPlayerDeviceMonitor_InFlight]);
+        previousSectorsRead = fields[xPlayerDeviceMonitor_SectorsRead];
+        previousSectorsWritten = fields[xPlayerDeviceMonitor_SectorsWritten];
+        previousSample = currentSample;
+        // Smoothing factor of an exponential moving average over the time window.
+        auto alpha = 2.0 / (std::max(xPlayerDeviceMonitor_AverageWindow / monitorInterval.load(), 1) + 1.0);
+        xPlayerDeviceStatistics statistics;
+        {
+            QMutexLocker lock(&monitorMutex);
+            if (monitorStatistics.samples == 0) {
+                monitorStatistics.readBytes = readBytes;
+                monitorStatistics.writeBytes = writeBytes;
+                monitorStatistics.inFlight = inFlight;
+            } else {
+                monitorStatistics.readBytes += alpha * (readBytes - monitorStatistics.readBytes);
+                monitorStatistics.writeBytes += alpha * (writeBytes - monitorStatistics.writeBytes);
+                monitorStatistics.inFlight += alpha * (inFlight - monitorStatistics.inFlight);
+            }
+            ++monitorStatistics.samples;
+            statistics = monitorStatistics;
+        }
+        emit throughput(static_cast<quint64>(statistics.readBytes), static_cast<quint64>(statistics.writeBytes));
+    }
+}
+
+bool xPlayerDeviceMonitor::readStat(unsigned long long fields[]) {
+    char statBuffer[256];
+    auto bytes = ::pread(monitorStatFd, statBuffer, sizeof(statBuffer)-1, 0);
+    if (bytes <= 0) {
+        return false;
+    }
+    statBuffer[bytes] = 0;
+    // The fields are separated by spaces.
+    auto statField = statBuffer;
+    for (auto i = 0; i < xPlayerDeviceMonitor_Fields; ++i) {
+        char* statFieldEnd = nullptr;
+        fields[i] = std::strtoull(statField, &statFieldEnd, 10);
+        if (statFieldEnd == statField) {
+            return false;
+        }
+        statField = statFieldEnd;
+    }
+    return true;
+}
@@ -0,0 +1,110 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XPLAYERDEVICEMONITOR_H__
+#define __XPLAYERDEVICEMONITOR_H__
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+
+#include <filesystem>
+#include <atomic>
+
+/**
+ * Statistics of a block device averaged over the last few seconds.
+ */
+struct xPlayerDeviceStatistics {
+    // Throughput in bytes per second.
+    double readBytes = 0;
+    double writeBytes = 0;
+    // Number of requests issued to the device but not yet completed.
+    double inFlight = 0;
+    // Maximal number of requests queued for the device.
+    int queueDepth = 0;
+    // Number of samples taken. Increased with each sample.
+    quint64 samples = 0;
+};
+
+/**
+ * Monitor the throughput of the block device of a given path.
+ *
+ * The device statistics are sampled at the configured rate by a dedicated
+ * thread. A change of the configured rate is applied to a running monitor. The thread sleeps in poll on a timerfd and is stopped immediately
+ * through an eventfd. The statistics are read with a single pread and are
+ * smoothed by an exponential moving average over a fixed time window.
+ */
+class xPlayerDeviceMonitor:public QObject {
+    Q_OBJECT
+
+public:
+    explicit xPlayerDeviceMonitor(QObject* parent=nullptr);
+    ~xPlayerDeviceMonitor() override;
+    /**
+     * Start monitoring the device of the given path. A running monitor is stopped.
+     *
+     * @param path a path located on the device.
+     * @return true if the monitor was started, false otherwise.
+     */
+    bool start(const std::filesystem::path& path);
+    /**
+     * Stop monitoring. Blocks until the monitor thread is finished.
+     */
+    void stop();
+    /**
+     * Return the latest statistics. Thread-safe.
+     *
+     * @return the averaged statistics of the device.
+     */
+    [[nodiscard]] xPlayerDeviceStatistics getStatistics();
+
+signals:
+    /**
+     * Signal the averaged throughput of the device. Emitted by the monitor thread.
+     *
+     * @param readBytes the number of bytes read per second.
+     * @param writeBytes the number of bytes written per second.
+     */
+    void throughput(quint64 readBytes, quint64 writeBytes);
+
+private slots:
+    /**
+     * Apply the configured sample interval.
+     */
+    void updateInterval();
+
+private:
+    /**
+     * Sample the device statistics until the monitor is stopped. Runs in the monitor thread.
+     */
+    void monitor();
+    /**
+     * Read the fields of the device stat file.
+     *
+     * @param fields array for the read, write and in-flight fields.
+     * @return true if the fields were read, false otherwise.
+     */
+    bool readStat(unsigned long long fields[]);
+
+    QThread* monitorThread;
+    QMutex monitorMutex;
+    xPlayerDeviceStatistics monitorStatistics;
+    // Sample interval in ms. Read by the monitor thread.
+    std::atomic<int> monitorInterval;
+    int monitorStatFd;
+    int monitorTimerFd;
+    int monitorStopFd;
+};
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xPlayerDurationService.h"
+#include "xMovieLengthProber.h"
+#include "xMusicLibraryTrackEntry.h"
+#include "xMovieLibraryEntry.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+// Number of lengths computed and reported together.
+constexpr size_t xPlayerDurationService_BatchSize = 32;
+
+QMutex xPlayerDurationService::serviceCacheMutex;
+QHash<QString,qint64> xPlayerDurationService::serviceCache;
+
+
+xPlayerDurationService::xPlayerDurationService(QObject* parent):
+        QObject(parent),
+        serviceContext(std::make_shared<xPlayerDurationContext>()),
+        serviceRequests(),
+        serviceRequestId(0),
+        serviceMovies(false) {
+    serviceContext->service = this;
+    serviceContext->requester = xMovieLengthProber::prober()->requester();
+}
+
+xPlayerDurationService::~xPlayerDurationService() {
+    cancel();
+    // Workers still running do not report to this service any more.
+    QMutexLocker lock(&serviceContext->mutex);
+    serviceContext->service = nullptr;
+}
+
+void xPlayerDurationService::request(const std::vector<xPlayerListWidgetItem*>& items, int priority) {
+    QList<std::pair<xPlayerListWidgetItem*,qint64>> cachedLengths;
+    std::vector<xPlayerDurationRequest> requests;
+    auto generation = serviceContext->generation.loadAcquire();
+    auto context = serviceContext;
+    for (auto item : items) {
+        auto key = cacheKey(item);
+        if (key.isEmpty()) {
+            continue;
+        }
+        {
+            QMutexLocker lock(&serviceCacheMutex);
+            auto cached = serviceCache.find(key);
+            if (cached != serviceCache.end()) {
+                cachedLengths.push_back(std::make_pair(item, cached.value()));
+                continue;
+            }
+        }
+        QUrl track;
+        std::shared_ptr<xMovieLibraryEntry> movie;
+        if (item->trackEntry()) {
+            track = item->trackEntry()->getUrl();
+            // Remote tracks include their length.
+            if (!track.isLocalFile()) {
+                cachedLengths.push_back(std::make_pair(item, item->trackEntry()->getLength()));
+                continue;
+            }
+        } else if (item->movieEntry()) {
+            // Hold the movie entry. It may be released with its library snapshot in the meantime.
+            movie = item->movieEntry()->weak_from_this().lock();
+            serviceMovies = true;
+        }
+        serviceRequests.insert(item, ++serviceRequestId);
+        requests.push_back({ item, serviceRequestId, track, movie, key });
+        if (requests.size() >= xPlayerDurationService_BatchSize) {
+            pool()->start(QRunnable::create([context, requests, generation]() { compute(context, requests, generation); }), priority);
+            requests.clear();
+        }
+    }
+    if (!requests.empty()) {
+        pool()->start(QRunnable::create([context, requests, generation]() { compute(context, requests, generation); }), priority);
+    }
+    if (!cachedLengths.isEmpty()) {
+        emit lengths(cachedLengths);
+    }
+}
+
+void xPlayerDurationService::remove(xPlayerListWidgetItem* item) {
+    // A new item at the same address gets a new request id.
+    serviceRequests.remove(item);
+}
+
+void xPlayerDurationService::cancel() {
+    // The pool is shared. Queued requests of this service return without computing.
+    serviceContext->generation.fetchAndAddOrdered(1);
+    serviceRequests.clear();
+    // Stop the movie probes of this service that are currently running.
+    if (serviceMovies) {
+        xMovieLengthProber::prober()->cancel(serviceContext->requester);
+        serviceMovies = false;
+    }
+}
+
+void xPlayerDurationService::invalidateCache() {
+    QMutexLocker lock(&serviceCacheMutex);
+    serviceCache.clear();
+}
+
+QThreadPool* xPlayerDurationService::pool() {
+    // Static initialization is thread-safe.
+    static auto durationPool = []() {
+        auto threadPool = new QThreadPool();
+        threadPool->setMaxThreadCount(QThread::idealThreadCount());
+        return threadPool;
+    }();
+    return durationPool;
+}
+
+void xPlayerDurationService::compute(const std::shared_ptr<xPlayerDurationContext>& context,
+                                     const std::vector<xPlayerDurationRequest>& requests, int generation) {
+    std::vector<xPlayerDurationResult> results;
+    for (const auto& request : requests) {
+        // Stop if the requests were cancelled.
+        if (context->generation.loadAcquire() != generation) {
+            return;
+        }
+        qint64 length = -1;
+        if (!request.track.isEmpty()) {
+            length = xMusicLibraryTrackEntry::scanLength(request.track.toLocalFile());
+        } else if (request.movie) {
+            length = request.movie->getLength(context->requester);
+        }
+        // Do not cache invalid lengths. The file may not be accessible yet.
+        if (length > 0) {
+            QMutexLocker lock(&serviceCacheMutex);
+            serviceCache.insert(request.key, length);
+        }
+        results.push_back({ request.item, request.id, length });
+    }
+    QMutexLocker lock(&context->mutex);
+    // The service is not deleted while the lock is held.
+    if ((context->service) && (context->generation.loadAcquire() == generation)) {
+        auto service = context->service;
+        QMetaObject::invokeMethod(service, [service, results, generation]() {
+            service->report(results, generation);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void xPlayerDurationService::report(const std::vector<xPlayerDurationResult>& results, int generation) {
+    // Check in the service thread. A cancel after the computation is thereby handled.
+    if (serviceContext->generation.loadAcquire() != generation) {
+        return;
+    }
+    QList<std::pair<xPlayerListWidgetItem*,qint64>> computedLengths;
+    for (const auto& result : results) {
+        // Ignore items removed in the meantime, even if their address has been reused.
+        auto pending = serviceRequests.find(result.item);
+        if ((pending != serviceRequests.end()) && (pending.value() == result.id)) {
+            serviceRequests.erase(pending);
+            computedLengths.push_back(std::make_pair(result.item, result.length));
+        }
+    }
+    if (!computedLengths.isEmpty()) {
+        emit lengths(computedLengths);
+    }
+}
+
+QString xPlayerDurationService::cacheKey(xPlayerListWidgetItem* item) {
+    if (item->trackEntry()) {
+        return item->trackEntry()->getUrl().toString();
+    }
+    if (item->movieEntry()) {
+        return QString::fromStdString(item->movieEntry()->getPath().generic_string());
+    }
+    return {};
+}
@@ -0,0 +1,143 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XPLAYERDURATIONSERVICE_H__
+#define __XPLAYERDURATIONSERVICE_H__
+
+#include "xPlayerListWidgetItem.h"
+
+#include <QObject>
+#include <QThreadPool>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QUrl>
+
+#include <memory>
+#include <vector>
+
+
+/**
+ * Compute the lengths of track and movie list items on a thread pool.
+ *
+ * The worker threads never access the list items. They only use the URL of the
+ * track or a shared pointer to the movie entry. The pool and the results are
+ * shared between all services. Results are delivered in batches to the thread
+ * the service lives in and only for items that have not been removed.
+ */
+class xPlayerDurationService:public QObject {
+    Q_OBJECT
+
+public:
+    explicit xPlayerDurationService(QObject* parent=nullptr);
+    ~xPlayerDurationService() override;
+    /**
+     * Request the lengths for the given items.
+     *
+     * Cached lengths are reported immediately. All other lengths are computed
+     * on the thread pool and reported in batches. Requests with a higher priority
+     * are computed first.
+     *
+     * @param items vector of pointers to the list items.
+     * @param priority the priority of the request.
+     */
+    void request(const std::vector<xPlayerListWidgetItem*>& items, int priority=0);
+    /**
+     * Remove an item before it is deleted. Its length is not reported.
+     *
+     * @param item pointer to the list item.
+     */
+    void remove(xPlayerListWidgetItem* item);
+    /**
+     * Cancel all outstanding requests. Results of these requests are not reported.
+     *
+     * Running movie probes are stopped.
+     */
+    void cancel();
+    /**
+     * Clear the lengths cached by all services, e.g. after a library rescan.
+     */
+    static void invalidateCache();
+
+signals:
+    /**
+     * Signal emitted for a batch of computed lengths.
+     *
+     * @param lengths list of pairs of list item pointer and length in ms.
+     */
+    void lengths(const QList<std::pair<xPlayerListWidgetItem*,qint64>>& lengths);
+
+private:
+    struct xPlayerDurationRequest {
+        xPlayerListWidgetItem* item;
+        quint64 id;
+        QUrl track;
+        std::shared_ptr<xMovieLibraryEntry> movie;
+        QString key;
+    };
+    struct xPlayerDurationResult {
+        xPlayerListWidgetItem* item;
+        quint64 id;
+        qint64 length;
+    };
+    /**
+     * State shared between the service and its workers. Outlives the service.
+     */
+    struct xPlayerDurationContext {
+        QAtomicInt generation;
+        QMutex mutex;
+        xPlayerDurationService* service;
+        // Requester id for the movie length probes of the service.
+        int requester;
+    };
+    /**
+     * Return the thread pool shared by all services.
+     *
+     * @return pointer to the thread pool.
+     */
+    static QThreadPool* pool();
+    /**
+     * Compute the lengths for a batch of requests. Called in a worker thread.
+     *
+     * @param context the state shared with the service.
+     * @param requests the vector of requests.
+     * @param generation the generation of the requests used for cancellation.
+     */
+    static void compute(const std::shared_ptr<xPlayerDurationContext>& context,
+                        const std::vector<xPlayerDurationRequest>& requests, int generation);
+    /**
+     * Report the lengths if the requests were not cancelled. Called in the service thread.
+     *
+     * @param results the vector of computed lengths.
+     * @param generation the generation of the requests used for cancellation.
+     */
+    void report(const std::vector<xPlayerDurationResult>& results, int generation);
+    /**
+     * Return the key used for the cache.
+     *
+     * @param item pointer to the list item.
+     * @return the key as string, empty if the item has no track or movie entry.
+     */
+    static QString cacheKey(xPlayerListWidgetItem* item);
+
+    std::shared_ptr<xPlayerDurationContext> serviceContext;
+    // Maps the items with outstanding requests to the id of their latest request.
+    QHash<xPlayerListWidgetItem*,quint64> serviceRequests;
+    quint64 serviceRequestId;
+    bool serviceMovies;
+    static QMutex serviceCacheMutex;
+    static QHash<QString,qint64> serviceCache;
+};
+
+#endif
@@ -0,0 +1,249 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xPlayerListModel.h"
+
+#include <QBrush>
+
+#include <algorithm>
+
+
+xPlayerListModel::xPlayerListModel(int columns, const QFontMetrics& metrics, QObject* parent):
+        QAbstractItemModel(parent),
+        modelItems(),
+        modelColumns(columns),
+        modelTextColumnWidth(0),
+        modelFontMetrics(metrics),
+        modelIcons() {
+}
+
+xPlayerListModel::~xPlayerListModel() {
+    for (auto item : modelItems) {
+        delete item;
+    }
+}
+
+void xPlayerListModel::insertItem(int row, xPlayerListWidgetItem* item) {
+    if ((row < 0) || (row > count())) {
+        row = count();
+    }
+    beginInsertRows(QModelIndex(), row, row);
+    modelItems.insert(modelItems.begin()+row, item);
+    item->itemModel = this;
+    updateRows(row);
+    endInsertRows();
+}
+
+void xPlayerListModel::insertItems(int row, const std::vector<xPlayerListWidgetItem*>& items) {
+    if (items.empty()) {
+        return;
+    }
+    if ((row < 0) || (row > count())) {
+        row = count();
+    }
+    beginInsertRows(QModelIndex(), row, row+static_cast<int>(items.size())-1);
+    modelItems.insert(modelItems.begin()+row, items.begin(), items.end());
+    for (auto item : items) {
+        item->itemModel = this;
+    }
+    updateRows(row);
+    endInsertRows();
+}
+
+void xPlayerListModel::appendItems(const std::vector<xPlayerListWidgetItem*>& items) {
+    insertItems(count(), items);
+}
+
+xPlayerListWidgetItem* xPlayerListModel::takeItem(int row) {
+    if ((row < 0) || (row >= count())) {
+        return nullptr;
+    }
+    beginRemoveRows(QModelIndex(), row, row);
+    auto item = modelItems[row];
+    modelItems.erase(modelItems.begin()+row);
+    item->itemModel = nullptr;
+    item->itemRow = -1;
+    updateRows(row);
+    endRemoveRows();
+    return item;
+}
+
+std::vector<xPlayerListWidgetItem*> xPlayerListModel::takeItems() {
+    beginResetModel();
+    std::vector<xPlayerListWidgetItem*> items;
+    items.swap(modelItems);
+    for (auto item : items) {
+        item->itemModel = nullptr;
+        item->itemRow = -1;
+    }
+    endResetModel();
+    return items;
+}
+
+void xPlayerListModel::resetItems(const std::vector<xPlayerListWidgetItem*>& items) {
+    beginResetModel();
+    for (auto item : modelItems) {
+        delete item;
+    }
+    modelItems = items;
+    for (auto item : modelItems) {
+        item->itemModel = this;
+    }
+    updateRows(0);
+    endResetModel();
+}
+
+void xPlayerListModel::moveItem(int fromRow, int toRow) {
+    if ((fromRow < 0) || (fromRow >= count()) || (toRow < 0) || (toRow > count()) ||
+        (fromRow == toRow) || (fromRow+1 == toRow)) {
+        return;
+    }
+    beginMoveRows(QModelIndex(), fromRow, fromRow, QModelIndex(), toRow);
+    auto item = modelItems[fromRow];
+    modelItems.erase(modelItems.begin()+fromRow);
+    // The destination shifts if the item is moved down.
+    modelItems.insert(modelItems.begin()+((fromRow < toRow) ? toRow-1 : toRow), item);
+    updateRows(std::min(fromRow, toRow));
+    endMoveRows();
+}
+
+void xPlayerListModel::clearItems() {
+    beginResetModel();
+    for (auto item : modelItems) {
+        delete item;
+    }
+    modelItems.clear();
+    endResetModel();
+}
+
+xPlayerListWidgetItem* xPlayerListModel::item(int row) const {
+    if ((row >= 0) && (row < count())) {
+        return modelItems[row];
+    }
+    return nullptr;
+}
+
+xPlayerListWidgetItem* xPlayerListModel::item(const QModelIndex& index) const {
+    return (index.isValid()) ? item(index.row()) : nullptr;
+}
+
+int xPlayerListModel::row(xPlayerListWidgetItem* item) const {
+    return ((item) && (item->itemModel == this)) ? item->itemRow : -1;
+}
+
+int xPlayerListModel::count() const {
+    return static_cast<int>(modelItems.size());
+}
+
+void xPlayerListModel::itemChanged(xPlayerListWidgetItem* item) {
+    if ((item) && (item->itemModel == this) && (item->itemRow >= 0)) {
+        emit dataChanged(index(item->itemRow, 0), index(item->itemRow, modelColumns-1));
+    }
+}
+
+QIcon xPlayerListModel::icon(const QString& iconPath) {
+    auto icon = modelIcons.find(iconPath);
+    if (icon == modelIcons.end()) {
+        icon = modelIcons.insert(iconPath, QIcon(iconPath));
+    }
+    return icon.value();
+}
+
+void xPlayerListModel::setTextColumnWidth(int width) {
+    modelTextColumnWidth = width;
+}
+
+QModelIndex xPlayerListModel::index(int row, int column, const QModelIndex& parent) const {
+    if ((parent.isValid()) || (row < 0) || (row >= count()) || (column < 0) || (column >= modelColumns)) {
+        return {};
+    }
+    return createIndex(row, column);
+}
+
+QModelIndex xPlayerListModel::parent(const QModelIndex& index) const {
+    Q_UNUSED(index)
+    return {};
+}
+
+int xPlayerListModel::rowCount(const QModelIndex& parent) const {
+    return (parent.isValid()) ? 0 : count();
+}
+
+int xPlayerListModel::columnCount(const QModelIndex& parent) const {
+    return (parent.isValid()) ? 0 : modelColumns;
+}
+
+QVariant xPlayerListModel::data(const QModelIndex& index, int role) const {
+    auto listItem = item(index);
+    if (!listItem) {
+        return {};
+    }
+    switch (role) {
+        case Qt::DisplayRole: {
+            return (index.column() == 0) ? listItem->text() : listItem->timeText();
+        }
+        case Qt::DecorationRole: {
+            if ((index.column() == 0) && (!listItem->icon().isNull())) {
+                return listItem->icon();
+            }
+        } break;
+        case Qt::ToolTipRole: {
+            if (index.column() == 0) {
+                return toolTip(listItem);
+            }
+        } break;
+        case Qt::TextAlignmentRole: {
+            if (index.column() == 1) {
+                return static_cast<int>(Qt::AlignRight|Qt::AlignVCenter);
+            }
+        } break;
+        case Qt::BackgroundRole: {
+            if (listItem->hasErrorMark()) {
+                return QBrush(Qt::red, Qt::Dense6Pattern);
+            }
+        } break;
+        default: break;
+    }
+    return {};
+}
+
+Qt::ItemFlags xPlayerListModel::flags(const QModelIndex& index) const {
+    if (!index.isValid()) {
+        // Allow drops in between the items.
+        return Qt::ItemIsDropEnabled;
+    }
+    return Qt::ItemIsEnabled|Qt::ItemIsSelectable|Qt::ItemIsDragEnabled;
+}
+
+Qt::DropActions xPlayerListModel::supportedDropActions() const {
+    return Qt::MoveAction;
+}
+
+void xPlayerListModel::updateRows(int from) {
+    for (auto row = from; row < count(); ++row) {
+        modelItems[row]->itemRow = row;
+    }
+}
+
+QString xPlayerListModel::toolTip(xPlayerListWidgetItem* item) const {
+    // Only compute the text width if the tooltip is requested.
+    if (modelTextColumnWidth < modelFontMetrics.size(Qt::TextSingleLine, item->text()+"...").width()) {
+        if (item->toolTip().isEmpty()) {
+            return item->text();
+        } else {
+            return QString("%1\n%2").arg(item->text(), item->toolTip());
+        }
+    }
+    return item->toolTip();
+}
@@ -0,0 +1,174 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XPLAYERLISTMODEL_H__
+#define __XPLAYERLISTMODEL_H__
+
+#include "xPlayerListWidgetItem.h"
+
+#include <QAbstractItemModel>
+#include <QFontMetrics>
+#include <QIcon>
+#include <QHash>
+
+#include <vector>
+
+
+/**
+ * Flat model for the xPlayerListWidget.
+ *
+ * The model owns the list items. An item only stores its entry, text, time and
+ * flags. The display data (time string, tooltip, icon, error brush) is created on
+ * demand in data(), i.e. only for rows that are currently visible in the view.
+ */
+class xPlayerListModel:public QAbstractItemModel {
+    Q_OBJECT
+
+public:
+    explicit xPlayerListModel(int columns, const QFontMetrics& metrics, QObject* parent=nullptr);
+    ~xPlayerListModel() override;
+    /**
+     * Insert a single item into the model.
+     *
+     * @param row the row the item is inserted before, append if row is out of range.
+     * @param item pointer to the item. The model takes ownership.
+     */
+    void insertItem(int row, xPlayerListWidgetItem* item);
+    /**
+     * Insert a vector of items using a single row insertion.
+     *
+     * @param row the row the items are inserted before, append if row is out of range.
+     * @param items vector of pointers to the items. The model takes ownership.
+     */
+    void insertItems(int row, const std::vector<xPlayerListWidgetItem*>& items);
+    /**
+     * Append a vector of items using a single row insertion.
+     *
+     * @param items vector of pointers to the items. The model takes ownership.
+     */
+    void appendItems(const std::vector<xPlayerListWidgetItem*>& items);
+    /**
+     * Remove the item at the given row without deleting it.
+     *
+     * @param row the row of the item.
+     * @return a pointer to the item, nullptr if the row is invalid.
+     */
+    xPlayerListWidgetItem* takeItem(int row);
+    /**
+     * Remove all items without deleting them.
+     *
+     * @return a vector of pointers to the items in current order.
+     */
+    std::vector<xPlayerListWidgetItem*> takeItems();
+    /**
+     * Replace all items using a single model reset.
+     *
+     * @param items vector of pointers to the items. The model takes ownership.
+     */
+    void resetItems(const std::vector<xPlayerListWidgetItem*>& items);
+    /**
+     * Move the item at the given row.
+     *
+     * @param fromRow the current row of the item.
+     * @param toRow the row the item is inserted before.
+     */
+    void moveItem(int fromRow, int toRow);
+    /**
+     * Remove and delete all items.
+     */
+    void clearItems();
+    /**
+     * Return the item at the given row.
+     *
+     * @param row the row of the item.
+     * @return a pointer to the item, nullptr if the row is invalid.
+     */
+    [[nodiscard]] xPlayerListWidgetItem* item(int row) const;
+    /**
+     * Return the item for the given model index.
+     *
+     * @param index the model index.
+     * @return a pointer to the item, nullptr if the index is invalid.
+     */
+    [[nodiscard]] xPlayerListWidgetItem* item(const QModelIndex& index) const;
+    /**
+     * Return the row of the given item.
+     *
+     * @param item pointer to the item.
+     * @return the row of the item, -1 if the item is not part of the model.
+     */
+    [[nodiscard]] int row(xPlayerListWidgetItem* item) const;
+    /**
+     * Return the number of items.
+     *
+     * @return the number of items as integer.
+     */
+    [[nodiscard]] int count() const;
+    /**
+     * Notify the view that the displayed data of the item changed.
+     *
+     * @param item pointer to the changed item.
+     */
+    void itemChanged(xPlayerListWidgetItem* item);
+    /**
+     * Return a shared icon for the given file.
+     *
+     * Icons are cached in order to avoid loading the same pixmap for every row.
+     *
+     * @param iconPath path to the icon/pixmap file as string.
+     * @return the icon.
+     */
+    QIcon icon(const QString& iconPath);
+    /**
+     * Update the width of the text column. Used to decide if the tooltip shows the text.
+     *
+     * @param width the column width in pixel.
+     */
+    void setTextColumnWidth(int width);
+    /**
+     * Functions required for QAbstractItemModel.
+     */
+    [[nodiscard]] QModelIndex index(int row, int column, const QModelIndex& parent=QModelIndex()) const override;
+    [[nodiscard]] QModelIndex parent(const QModelIndex& index) const override;
+    [[nodiscard]] int rowCount(const QModelIndex& parent=QModelIndex()) const override;
+    [[nodiscard]] int columnCount(const QModelIndex& parent=QModelIndex()) const override;
+    [[nodiscard]] QVariant data(const QModelIndex& index, int role) const override;
+    [[nodiscard]] Qt::ItemFlags flags(const QModelIndex& index) const override;
+    [[nodiscard]] Qt::DropActions supportedDropActions() const override;
+
+private:
+    /**
+     * Update the row stored in the items starting at the given row.
+     *
+     * @param from the first row to be updated.
+     */
+    void updateRows(int from);
+    /**
+     * Return the tooltip for the item.
+     *
+     * The tooltip is added to a possibly shortened text separated by a newline.
+     *
+     * @param item pointer to the item.
+     * @return the tooltip as string.
+     */
+    [[nodiscard]] QString toolTip(xPlayerListWidgetItem* item) const;
+
+    std::vector<xPlayerListWidgetItem*> modelItems;
+    int modelColumns;
+    int modelTextColumnWidth;
+    QFontMetrics modelFontMetrics;
+    QHash<QString,QIcon> modelIcons;
+};
+
+#endif
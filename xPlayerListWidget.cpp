@@ -16,48 +16,87 @@
 #include "xPlayerConfiguration.h"
 #include "xPlayerUI.h"
 
-#include <QResizeEvent>
 #include <QHeaderView>
-#include <QTimer>
+#include <QDropEvent>
+#include <QItemSelectionModel>
 #include <QDebug>
-#include <QTreeWidget>
-#include <QCoreApplication>
+#include <algorithm>
+#include <iterator>
 #include <utility>
 
+// Priority used to request the lengths of visible rows.
+constexpr auto xPlayerListWidget_VisiblePriority = 1;
+
+/**
+ * Return the key used to sort the list items. Sorting is case-insensitive.
+ *
+ * @param text the text of the list item.
+ * @return the case folded text.
+ */
+static QString xPlayerListWidget_sortKey(const QString& text) {
+    return text.toCaseFolded();
+}
+
+/**
+ * Return the items together with their sort key. The key is computed only once per item.
+ *
+ * @param items vector of pointers to the list items.
+ * @return vector of pairs of sort key and pointer to the list item in the given order.
+ */
+static std::vector<std::pair<QString,xPlayerListWidgetItem*>> xPlayerListWidget_sortKeyItems(
+        const std::vector<xPlayerListWidgetItem*>& items) {
+    std::vector<std::pair<QString,xPlayerListWidgetItem*>> keyItems;
+    keyItems.reserve(items.size());
+    for (auto item : items) {
+        keyItems.emplace_back(xPlayerListWidget_sortKey(item->text()), item);
+    }
+    return keyItems;
+}
+
 
 xPlayerListWidget::xPlayerListWidget(QWidget* parent, bool displayTime):
-        QTreeWidget(parent),
+        QTreeView(parent),
+        listModel(nullptr),
         sortItems(false),
         dragDropItems(false),
-        updateItemsThread(nullptr),
+        durationService(nullptr),
+        durationPending(),
+        durationTotal(0),
         dragDropFromIndex(-1),
         dragDropToIndex(-1),
         currentMatch() {
+    listModel = new xPlayerListModel((displayTime) ? 2 : 1, fontMetrics(), this);
+    setModel(listModel);
+    // All rows have the same height. Required in order to only layout the visible rows.
+    setUniformRowHeights(true);
     header()->setStretchLastSection(false);
     header()->setSectionResizeMode(0, QHeaderView::Stretch);
     if (displayTime) {
-        setColumnCount(2);
         setColumnWidth(1, fontMetrics().size(Qt::TextSingleLine, "99:99:99").width());
-    } else {
-        setColumnCount(1);
     }
     header()->setVisible(false);
     setRootIsDecorated(false);
-    connect(this, &xPlayerListWidget::itemWidgetsIterate, this, &xPlayerListWidget::addItemWidgetsWorker);
-    connect(this, &QTreeWidget::currentItemChanged, [=](QTreeWidgetItem* current, QTreeWidgetItem*) {
-        if (current) {
-            emit currentListIndexChanged(indexOfTopLevelItem(current));
+    setItemsExpandable(false);
+    // The tooltips are created on demand by the model and depend on the width of the text column.
+    connect(header(), &QHeaderView::sectionResized, this, [=](int index, int, int width) {
+        if (index == 0) {
+            listModel->setTextColumnWidth(width);
         }
     });
-    connect(this, &QTreeWidget::itemDoubleClicked, [=](QTreeWidgetItem* item, int) {
-        emit listItemDoubleClicked(reinterpret_cast<xPlayerListWidgetItem*>(item));
+    connect(selectionModel(), &QItemSelectionModel::currentChanged, this, [=](const QModelIndex& current, const QModelIndex&) {
+        if (current.isValid()) {
+            emit currentListIndexChanged(current.row());
+        }
     });
-    connect(this, &QTreeWidget::itemClicked, [=](QTreeWidgetItem* item, int) {
-        emit listItemClicked(reinterpret_cast<xPlayerListWidgetItem*>(item));
+    connect(this, &QTreeView::doubleClicked, [=](const QModelIndex& index) {
+        emit listItemDoubleClicked(listModel->item(index));
     });
-    connect(this, &xPlayerListWidget::updateTime, [=](xPlayerListWidgetItem* item) {
-        item->updateTimeDisplay();
+    connect(this, &QTreeView::clicked, [=](const QModelIndex& index) {
+        emit listItemClicked(listModel->item(index));
     });
+    // Lengths are computed in a thread pool and reported in batches in the Qt main loop.
+    durationService = new xPlayerDurationService(this);
+    connect(durationService, &xPlayerDurationService::lengths, this, &xPlayerListWidget::updateItemsLengths);
     // Disable drag and drop for BluOS player libraries. Not supported.
     connect(xPlayerConfiguration::configuration(), &xPlayerConfiguration::updatedUseMusicLibraryBluOS, [=]() {
         enableDragAndDrop(!xPlayerConfiguration::configuration()->useMusicLibraryBluOS());
@@ -65,11 +104,7 @@ xPlayerListWidget::xPlayerListWidget(QWidget* parent, bool displayTime):
 }
 
 xPlayerListWidget::~xPlayerListWidget() {
-    if (updateItemsThread) {
-        qDebug() << "Waiting for timer thread to finish.";
-        updateItemsThread->requestInterruption();
-        updateItemsThread->wait();
-    }
+    durationService->cancel();
 }
 
 void xPlayerListWidget::enableSorting(bool sorted) {
@@ -85,12 +120,9 @@ void xPlayerListWidget::addListItem(const QString& text) {
 }
 
 void xPlayerListWidget::addListItem(const QString& text, const QString& tooltip) {
-    auto item = new xPlayerListWidgetItem(text, this);
+    auto item = new xPlayerListWidgetItem(text);
     item->addToolTip(tooltip);
     addListWidgetItem(item, text);
-    if (!currentMatch.isEmpty()) {
-        updateFilter(currentMatch);
-    }
 }
 
 void xPlayerListWidget::addListItem(xMusicLibraryArtistEntry* entry) {
@@ -110,105 +142,132 @@ void xPlayerListWidget::addListItem(xMovieLibraryEntry* entry) {
 }
 
 void xPlayerListWidget::addListItems(const QStringList& list) {
+    std::vector<xPlayerListWidgetItem*> items;
+    items.reserve(list.size());
     for (const auto& element : list) {
-        addListItem(element);
+        items.emplace_back(new xPlayerListWidgetItem(element));
+    }
+    addListWidgetItems(items);
+}
+
+void xPlayerListWidget::addListItems(const std::vector<xMusicLibraryArtistEntry*>& entries) {
+    std::vector<xPlayerListWidgetItem*> items;
+    items.reserve(entries.size());
+    for (auto entry : entries) {
+        items.emplace_back(new xPlayerListWidgetItem(entry));
+    }
+    addListWidgetItems(items);
+}
+
+void xPlayerListWidget::addListItems(const std::vector<xMusicLibraryAlbumEntry*>& entries) {
+    std::vector<xPlayerListWidgetItem*> items;
+    items.reserve(entries.size());
+    for (auto entry : entries) {
+        items.emplace_back(new xPlayerListWidgetItem(entry));
     }
+    addListWidgetItems(items);
+}
+
+void xPlayerListWidget::addListItems(const std::vector<xMusicLibraryTrackEntry*>& entries) {
+    addListItems(entries, QString());
+}
+
+void xPlayerListWidget::addListItems(const std::vector<xMovieLibraryEntry*>& entries) {
+    std::vector<xPlayerListWidgetItem*> items;
+    items.reserve(entries.size());
+    for (auto entry : entries) {
+        items.emplace_back(new xPlayerListWidgetItem(entry));
+    }
+    addListWidgetItems(items);
 }
 
 void xPlayerListWidget::addListItem(xMusicLibraryArtistEntry* entry, const QString& tooltip) {
-    auto item = new xPlayerListWidgetItem(entry, this);
+    auto item = new xPlayerListWidgetItem(entry);
     // Add tooltip.
     item->addToolTip(tooltip);
     addListWidgetItem(item, entry->getArtistName());
-    if (!currentMatch.isEmpty()) {
-        updateFilter(currentMatch);
-    }
 }
 
 void xPlayerListWidget::addListItem(xMusicLibraryAlbumEntry* entry, const QString& tooltip) {
-    auto item = new xPlayerListWidgetItem(entry, this);
+    auto item = new xPlayerListWidgetItem(entry);
     // Add tooltip.
     item->addToolTip(tooltip);
     addListWidgetItem(item, entry->getAlbumName());
-    if (!currentMatch.isEmpty()) {
-        updateFilter(currentMatch);
-    }
 }
 
 void xPlayerListWidget::addListItem(xMusicLibraryTrackEntry* entry, const QString& tooltip) {
-    auto item = new xPlayerListWidgetItem(entry, this);
+    auto item = new xPlayerListWidgetItem(entry);
     // Add tooltip.
     item->addToolTip(tooltip);
     addListWidgetItem(item, entry->getTrackName());
-    if (!currentMatch.isEmpty()) {
-        updateFilter(currentMatch);
-    }
 }
 
 void xPlayerListWidget::addListItem(xMovieLibraryEntry* entry, const QString& tooltip) {
-    auto item = new xPlayerListWidgetItem(entry, this);
+    auto item = new xPlayerListWidgetItem(entry);
     // Add tooltip.
     item->addToolTip(tooltip);
     addListWidgetItem(item, entry->getMovieName());
-    if (!currentMatch.isEmpty()) {
-        updateFilter(currentMatch);
-    }
 }
 
 void xPlayerListWidget::addListItems(const std::vector<xMusicLibraryTrackEntry*>& entries, const QString& tooltip) {
-    for (const auto& entry : entries) {
-        auto item = new xPlayerListWidgetItem(entry, this);
+    std::vector<xPlayerListWidgetItem*> items;
+    items.reserve(entries.size());
+    for (auto entry : entries) {
+        auto item = new xPlayerListWidgetItem(entry);
         // Add tooltip.
         item->addToolTip(tooltip);
-        addListWidgetItem(item, entry->getName());
-        // Update filter.
-        if (!currentMatch.isEmpty()) {
-            item->setHidden(!item->text().contains(currentMatch, Qt::CaseInsensitive));
-        }
+        items.emplace_back(item);
     }
+    addListWidgetItems(items);
 }
 
 void xPlayerListWidget::addListItems(const QList<std::pair<QString, std::vector<xMusicLibraryTrackEntry*>>>& entries) {
-    int maxFiles = 0;
+    std::vector<xPlayerListWidgetItem*> items;
     for (const auto& entry : entries) {
-        maxFiles += static_cast<int>(entry.second.size());
-    }
-    addItemWidgetsWorker(entries, entries.begin(), 0, maxFiles);
-}
-
-void xPlayerListWidget::addItemWidgetsWorker(const QList<std::pair<QString, std::vector<xMusicLibraryTrackEntry*>>>& entries,
-                                             QList<std::pair<QString, std::vector<xMusicLibraryTrackEntry*>>>::const_iterator entriesIterator,
-                                             int currentFiles, int maxFiles) {
-    addListItems(entriesIterator->second, entriesIterator->first);
-    currentFiles += static_cast<int>(entriesIterator->second.size());
-    emit itemWidgetsProgress(currentFiles, maxFiles);
-    if (entriesIterator != entries.end()) {
-        auto nextEntriesIterator = ++entriesIterator;
-        QTimer::singleShot(50, [=]() { emit itemWidgetsIterate(entries, nextEntriesIterator, currentFiles, maxFiles); });
+        for (const auto& trackEntry : entry.second) {
+            auto item = new xPlayerListWidgetItem(trackEntry);
+            item->addToolTip(entry.first);
+            items.emplace_back(item);
+        }
     }
+    addListWidgetItems(items);
 }
 
 xPlayerListWidgetItem* xPlayerListWidget::listItem(int index) {
-    return reinterpret_cast<xPlayerListWidgetItem*>(topLevelItem(index));
+    return listModel->item(index);
 }
 
 void xPlayerListWidget::takeListItem(int index) {
-    delete takeTopLevelItem(index);
-    updateItems();
+    auto item = listModel->takeItem(index);
+    if (item) {
+        // Update the total time without recomputing it.
+        if ((!durationPending.remove(item)) && (item->hasTime())) {
+            durationTotal -= std::max(item->time(), static_cast<qint64>(0));
+        }
+        // An outstanding length is not reported for the deleted item.
+        durationService->remove(item);
+        delete item;
+    }
+    if (durationPending.isEmpty()) {
+        emit totalTime(durationTotal);
+    }
 }
 
 xPlayerListWidgetItem* xPlayerListWidget::itemAt(const QPoint& point) {
-    return reinterpret_cast<xPlayerListWidgetItem*>(QTreeWidget::itemAt(point));
+    return listModel->item(indexAt(point));
 }
 
 xPlayerListWidgetItem* xPlayerListWidget::currentItem() {
-    return reinterpret_cast<xPlayerListWidgetItem*>(QTreeWidget::currentItem());
+    return listModel->item(currentIndex());
 }
 
 QList<xPlayerListWidgetItem*> xPlayerListWidget::findListItems(const QString& text) {
     QList<xPlayerListWidgetItem*> findWidgets;
-    for (auto item : QTreeWidget::findItems(text, Qt::MatchExactly)) {
-        findWidgets.push_back(reinterpret_cast<xPlayerListWidgetItem*>(item));
+    for (auto index = 0; index < listModel->count(); ++index) {
+        auto item = listModel->item(index);
+        if (item->text() == text) {
+            findWidgets.push_back(item);
+        }
     }
     return findWidgets;
 }
@@ -216,137 +275,240 @@ QList<xPlayerListWidgetItem*> xPlayerListWidget::findListItems(const QString& te
 bool xPlayerListWidget::setCurrentItem(const QString& text) {
     auto items = findListItems(text);
     for (auto item : items) {
-        QTreeWidget::setCurrentItem(item);
+        setCurrentListIndex(listModel->row(item));
     }
     return !items.isEmpty();
 }
 
 void xPlayerListWidget::clearItems() {
-    if ((updateItemsThread) && (updateItemsThread->isRunning())){
-        // We need to cleanly end the update thread.
-        updateItemsThread->requestInterruption();
-        updateItemsThread->wait();
-        // Delete and reset to nullptr.
-        delete updateItemsThread;
-        updateItemsThread = nullptr;
-    }
-    // Clear all posted events for this since time update may still be in the queue.
-    QCoreApplication::removePostedEvents(this);
-    // Clear the tree widget.
-    QTreeWidget::clear();
+    // Lengths of outstanding requests are not reported after the cancel.
+    durationService->cancel();
+    durationPending.clear();
+    durationTotal = 0;
+    // Clear the model.
+    listModel->clearItems();
     // Clear any total time displayed.
     emit totalTime(0);
 }
 
 void xPlayerListWidget::updateFilter(const QString &match) {
     currentMatch = match;
-    if (match.isEmpty()) {
-        for (int i = 0; i < topLevelItemCount(); ++i) {
-            topLevelItem(i)->setHidden(false);
-        }
-    } else {
-        for (int i = 0; i < topLevelItemCount(); ++i) {
-            auto item = topLevelItem(i);
-            item->setHidden(!item->text(0).contains(match, Qt::CaseInsensitive));
-        }
+    for (auto row = 0; row < listModel->count(); ++row) {
+        updateFilterItem(row);
     }
 }
 
 void xPlayerListWidget::setCurrentListIndex(int index) {
-    QTreeWidget::setCurrentItem(topLevelItem(index));
+    setCurrentIndex(listModel->index(index, 0));
 }
 
 int xPlayerListWidget::currentListIndex() {
-    auto item = QTreeWidget::currentItem();
-    return (item) ? indexOfTopLevelItem(item) : -1;
+    auto index = currentIndex();
+    return (index.isValid()) ? index.row() : -1;
 }
 
 int xPlayerListWidget::listIndex(xPlayerListWidgetItem* item) {
-    return indexOfTopLevelItem(item);
+    return listModel->row(item);
 }
 
 int xPlayerListWidget::count() {
-    return topLevelItemCount();
+    return listModel->count();
 }
 
 void xPlayerListWidget::scrollToIndex(int index) {
-    scrollToItem(listItem(index));
+    scrollTo(listModel->index(index, 0));
 }
 
 void xPlayerListWidget::refreshItems(std::function<bool (xPlayerListWidgetItem*, xPlayerListWidgetItem*)> lesserThan) {
-    std::vector<xPlayerListWidgetItem*> items(count());
     auto cItem = currentItem();
-    for (auto index = count()-1; index >= 0; --index) {
-        items[index] = reinterpret_cast<xPlayerListWidgetItem*>(QTreeWidget::takeTopLevelItem(index));
-    }
+    auto items = listModel->takeItems();
     // Only sort item if a function is provided.
     if (lesserThan != nullptr) {
         std::sort(items.begin(), items.end(), std::move(lesserThan));
     }
-    for (auto item : items) {
-        addListWidgetItem(item, item->text());
+    // Keep the sorted mode of the list.
+    if (sortItems) {
+        sortListWidgetItems(items);
     }
+    listModel->resetItems(items);
     // Set current item after rebuilding the list.
     if (cItem) {
-        QTreeWidget::setCurrentItem(cItem);
+        setCurrentListIndex(listModel->row(cItem));
     }
     // Update hidden items according to the current filter.
     updateFilter(currentMatch);
 }
 
 void xPlayerListWidget::updateItems() {
-    if ((updateItemsThread) && (updateItemsThread->isRunning())) {
-        updateItemsThread->requestInterruption();
-        updateItemsThread->wait();
-        delete updateItemsThread;
+    // Determine the visible rows. Their lengths are requested first.
+    auto firstVisible = indexAt(viewport()->rect().topLeft()).row();
+    auto lastVisible = indexAt(viewport()->rect().bottomLeft()).row();
+    if (firstVisible < 0) {
+        firstVisible = 0;
     }
-    updateItemsThread = QThread::create([this]() { updateItemsWorker(); });
-    connect(updateItemsThread, &QThread::finished, this, &xPlayerListWidget::updateItemsWorkerFinished);
-    updateItemsThread->start();
-}
-
-void xPlayerListWidget::updateItemsWorker() {
-    qint64 total = 0;
-    for (int index = 0; index < topLevelItemCount(); ++index) {
-        // Check if we want to end the thread.
-        if (QThread::currentThread()->isInterruptionRequested()) {
-            return;
+    if (lastVisible < 0) {
+        lastVisible = listModel->count()-1;
+    }
+    std::vector<xPlayerListWidgetItem*> visibleItems;
+    std::vector<xPlayerListWidgetItem*> items;
+    for (auto index = 0; index < listModel->count(); ++index) {
+        auto item = listModel->item(index);
+        if ((!item->hasTime()) && (!durationPending.contains(item))) {
+            durationPending.insert(item);
+            if ((index >= firstVisible) && (index <= lastVisible)) {
+                visibleItems.emplace_back(item);
+            } else {
+                items.emplace_back(item);
+            }
         }
-        auto item = listItem(index);
-        total += item->updateTime();
-        emit updateTime(item);
     }
-    emit totalTime(total);
+    if (!visibleItems.empty()) {
+        durationService->request(visibleItems, xPlayerListWidget_VisiblePriority);
+    }
+    if (!items.empty()) {
+        durationService->request(items);
+    }
+    if (durationPending.isEmpty()) {
+        emit totalTime(durationTotal);
+    }
 }
 
-void xPlayerListWidget::updateItemsWorkerFinished() {
+void xPlayerListWidget::updateItemsLengths(const QList<std::pair<xPlayerListWidgetItem*,qint64>>& lengths) {
+    for (const auto& [item, length] : lengths) {
+        // Ignore lengths for items that have been removed in the meantime.
+        if (durationPending.remove(item)) {
+            item->setTime(length);
+            item->updateTimeDisplay();
+            durationTotal += std::max(length, static_cast<qint64>(0));
+        }
+    }
+    if (durationPending.isEmpty()) {
+        emit totalTime(durationTotal);
+    }
 }
 
 void xPlayerListWidget::addListWidgetItem(xPlayerListWidgetItem* item, const QString& text) {
-    if ((sortItems) && (topLevelItemCount() > 0)) {
-        int insertPos = 0;
-        for (; insertPos < topLevelItemCount(); ++insertPos) {
-            // Sorting is case-insensitive.
-            if (text.compare(QTreeWidget::itemAt(insertPos, 0)->text(0), Qt::CaseInsensitive) < 0) {
-                break;
+    int insertPos = listModel->count();
+    if (sortItems) {
+        // Binary search for the first item that is greater. Use the same key as the bulk sort.
+        auto key = xPlayerListWidget_sortKey(text);
+        int lower = 0;
+        while (lower < insertPos) {
+            auto middle = lower + (insertPos - lower) / 2;
+            if (key < xPlayerListWidget_sortKey(listModel->item(middle)->text())) {
+                insertPos = middle;
+            } else {
+                lower = middle + 1;
             }
         }
-        QTreeWidget::insertTopLevelItem(insertPos, item);
+    }
+    listModel->insertItem(insertPos, item);
+    if (item->hasTime()) {
+        durationTotal += std::max(item->time(), static_cast<qint64>(0));
+    }
+    // Update filter.
+    if (!currentMatch.isEmpty()) {
+        updateFilterItem(insertPos);
+    }
+}
+
+void xPlayerListWidget::addListWidgetItems(const std::vector<xPlayerListWidgetItem*>& items) {
+    if (items.empty()) {
+        return;
+    }
+    if ((sortItems) && (items.size() == 1)) {
+        addListWidgetItem(items.front(), items.front()->text());
+        return;
+    }
+    for (auto item : items) {
+        if (item->hasTime()) {
+            durationTotal += std::max(item->time(), static_cast<qint64>(0));
+        }
+    }
+    auto firstRow = listModel->count();
+    if (sortItems) {
+        if (firstRow > 0) {
+            mergeListWidgetItems(items);
+            return;
+        }
+        auto sortedItems = items;
+        sortListWidgetItems(sortedItems);
+        listModel->appendItems(sortedItems);
     } else {
-        QTreeWidget::addTopLevelItem(item);
+        listModel->appendItems(items);
+    }
+    // Update filter.
+    if (!currentMatch.isEmpty()) {
+        for (auto row = firstRow; row < listModel->count(); ++row) {
+            updateFilterItem(row);
+        }
     }
 }
 
-void xPlayerListWidget::resizeEvent(QResizeEvent* event) {
-    if (event) {
-        if (event->oldSize().width() != event->size().width()) {
-            for (int i = 0; i < topLevelItemCount(); ++i) {
-                auto item = reinterpret_cast<xPlayerListWidgetItem*>(topLevelItem(i));
-                item->updateToolTip();
+void xPlayerListWidget::mergeListWidgetItems(const std::vector<xPlayerListWidgetItem*>& items) {
+    std::vector<xPlayerListWidgetItem*> existingItems;
+    existingItems.reserve(listModel->count());
+    for (auto row = 0; row < listModel->count(); ++row) {
+        existingItems.push_back(listModel->item(row));
+    }
+    auto existingKeyItems = xPlayerListWidget_sortKeyItems(existingItems);
+    auto sortedKeyItems = xPlayerListWidget_sortKeyItems(items);
+    std::stable_sort(sortedKeyItems.begin(), sortedKeyItems.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    // Existing items are placed before new items with the same text.
+    std::vector<std::pair<QString,xPlayerListWidgetItem*>> mergedKeyItems;
+    mergedKeyItems.reserve(existingKeyItems.size()+sortedKeyItems.size());
+    std::merge(existingKeyItems.begin(), existingKeyItems.end(), sortedKeyItems.begin(), sortedKeyItems.end(),
+               std::back_inserter(mergedKeyItems), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    // Group the new items into runs inserted before the same existing row.
+    std::vector<std::pair<int,std::vector<xPlayerListWidgetItem*>>> runs;
+    auto existingRow = 0;
+    for (const auto& keyItem : mergedKeyItems) {
+        if ((existingRow < static_cast<int>(existingItems.size())) && (keyItem.second == existingItems[existingRow])) {
+            ++existingRow;
+            continue;
+        }
+        if ((runs.empty()) || (runs.back().first != existingRow)) {
+            runs.emplace_back(existingRow, std::vector<xPlayerListWidgetItem*>());
+        }
+        runs.back().second.push_back(keyItem.second);
+    }
+    // Insert the last run first. The rows of the preceding runs are not shifted.
+    // The current item, the selection and the hidden rows are kept by the view.
+    for (auto run = runs.rbegin(); run != runs.rend(); ++run) {
+        listModel->insertItems(run->first, run->second);
+    }
+    // Update filter.
+    if (!currentMatch.isEmpty()) {
+        auto insertedRows = 0;
+        for (const auto& [runRow, runItems] : runs) {
+            for (auto index = 0; index < static_cast<int>(runItems.size()); ++index) {
+                updateFilterItem(runRow+insertedRows+index);
             }
+            insertedRows += static_cast<int>(runItems.size());
         }
     }
-    QTreeWidget::resizeEvent(event);
+}
+
+void xPlayerListWidget::sortListWidgetItems(std::vector<xPlayerListWidgetItem*>& items) {
+    // Compute the case folded key only once per item.
+    auto keyItems = xPlayerListWidget_sortKeyItems(items);
+    std::stable_sort(keyItems.begin(), keyItems.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    for (size_t i = 0; i < keyItems.size(); ++i) {
+        items[i] = keyItems[i].second;
+    }
+}
+
+void xPlayerListWidget::updateFilterItem(int row) {
+    auto hidden = (!currentMatch.isEmpty()) && (!listModel->item(row)->text().contains(currentMatch, Qt::CaseInsensitive));
+    if (isRowHidden(row, QModelIndex()) != hidden) {
+        setRowHidden(row, QModelIndex(), hidden);
+    }
 }
 
 void xPlayerListWidget::dragEnterEvent(QDragEnterEvent* event) {
@@ -355,7 +517,7 @@ void xPlayerListWidget::dragEnterEvent(QDragEnterEvent* event) {
             // currentListIndex is more accurate than using the event position.
             // converting the position sometimes leads to an incorrect listIndex.
             dragDropFromIndex = currentListIndex();
-            QTreeWidget::dragEnterEvent(event);
+            QTreeView::dragEnterEvent(event);
         }
     }
 }
@@ -363,25 +525,27 @@ void xPlayerListWidget::dragEnterEvent(QDragEnterEvent* event) {
 void xPlayerListWidget::dropEvent(QDropEvent* event) {
     if (dragDropItems) {
         if (event) {
-            auto dropPosition = event->posF();
-            auto dragDropToItem = itemAt(event->pos());
-            if (dragDropToItem) {
-                auto dropItemRect = visualItemRect(dragDropToItem);
-                dragDropToIndex = indexOfTopLevelItem(dragDropToItem);
+            auto dropPosition = event->position().toPoint();
+            auto dropIndex = indexAt(dropPosition);
+            if (dropIndex.isValid()) {
+                auto dropItemRect = visualRect(dropIndex);
+                dragDropToIndex = dropIndex.row();
                 // We insert before the current element if the position is in the upper half of the listItem widget.
                 if (dropPosition.y() > dropItemRect.y() + (dropItemRect.height() / 2.0)) {
-                    dropPosition.setY(dropItemRect.bottom());
                     ++dragDropToIndex;
-                } else {
-                    dropPosition.setY(dropItemRect.top());
                 }
             } else {
                 // No listItem at position means move to the end of the list.
-                dragDropToIndex = topLevelItemCount();
+                dragDropToIndex = listModel->count();
             }
-            auto adjustedEvent = new QDropEvent(dropPosition, event->possibleActions(), event->mimeData(),
-                                                event->mouseButtons(), event->keyboardModifiers(), event->type());
-            QTreeWidget::dropEvent(adjustedEvent);
+            // Move the item within the model. Ignore the drop action in order to prevent
+            // the view from removing the dragged item afterwards.
+            listModel->moveItem(dragDropFromIndex, dragDropToIndex);
+            event->setDropAction(Qt::IgnoreAction);
+            event->accept();
+            stopAutoScroll();
+            setState(NoState);
+            viewport()->update();
             emit dragDrop(dragDropFromIndex, dragDropToIndex);
         }
     }
@@ -16,17 +16,25 @@
 #define __XPLAYERLISTWIDGET_H__
 
 #include "xPlayerListWidgetItem.h"
+#include "xPlayerListModel.h"
+#include "xPlayerDurationService.h"
 #include "xPlayerUI.h"
 
-#include <QTreeWidget>
-#include <QThread>
+#include <QTreeView>
+#include <QSet>
 #include <QLabel>
 #include <QString>
 
 #include <map>
 
 
-class xPlayerListWidget:public QTreeWidget {
+/**
+ * Virtualized list based on a QTreeView and the xPlayerListModel.
+ *
+ * Only the visible rows are rendered, i.e. the memory and time used for
+ * the display does not depend on the number of items in the list.
+ */
+class xPlayerListWidget:public QTreeView {
     Q_OBJECT
 
 public:
@@ -59,6 +67,9 @@ public:
     void addListItem(const QString& text, const QString& tooltip);
     /**
      * Add list of items without time section to the list.
+     *
+     * All items are added in a single batch.
+     *
      * @param list a string list of items to be added.
      */
     void addListItems(const QStringList& list);
@@ -81,6 +92,18 @@ public:
     void addListItem(xMusicLibraryAlbumEntry* entry, const QString& tooltip);
     void addListItem(xMusicLibraryTrackEntry* entry, const QString& tooltip);
     void addListItem(xMovieLibraryEntry* entry, const QString& tooltip);
+    /**
+     * Add vector of items to the list.
+     *
+     * All items are added in a single batch. In sorted mode the items are sorted
+     * once and merged with the existing items.
+     *
+     * @param entries vector of pointer to the associated music or movie library entry objects.
+     */
+    void addListItems(const std::vector<xMusicLibraryArtistEntry*>& entries);
+    void addListItems(const std::vector<xMusicLibraryAlbumEntry*>& entries);
+    void addListItems(const std::vector<xMusicLibraryTrackEntry*>& entries);
+    void addListItems(const std::vector<xMovieLibraryEntry*>& entries);
     /**
      * Add vector of items with tooltip to the list.
      *
@@ -91,6 +114,8 @@ public:
     /**
      * Add list of pairs of tooltip and item vector.
      *
+     * All items are added using a single row insertion into the model.
+     *
      * @param files list of pairs of tooltip and vector of pointer to associated music file objects.
      */
     void addListItems(const QList<std::pair<QString, std::vector<xMusicLibraryTrackEntry*>>>& entries);
@@ -177,7 +202,8 @@ public:
     /**
      * Update all list items.
      *
-     * Run time consuming updates in a separate thread.
+     * The times of all items without a time are computed by the duration service.
+     * The total time is emitted once all times are available.
      */
     void updateItems();
     /**
@@ -218,15 +244,6 @@ signals:
      * @param total the total time in ms.
      */
     void totalTime(qint64 total);
-    /**
-     * Signal emitted if the time is updated in a list element.
-     *
-     * The update has to be done via signals in order to perform the
-     * UI update from the Qt main loop.
-     *
-     * @param item pointer to the item.
-     */
-    void updateTime(xPlayerListWidgetItem* item);
     /**
      * Signal emitted if an element was moved via drag and drop.
      *
@@ -234,32 +251,8 @@ signals:
      * @param toIndex the index the element is inserted before.
      */
     void dragDrop(int fromIndex, int toIndex);
-    /**
-     * Signal used to update larger list in stages.
-     *
-     * @param entries list of pairs of tooltip and vector of pointer to associated music library entries.
-     * @param entryIterator iterator to the list element to be added.
-     * @param currentFiles current number of files inserted.
-     * @param maxFiles maximal number of files inserted overall.
-     */
-    void itemWidgetsIterate(const QList<std::pair<QString, std::vector<xMusicLibraryTrackEntry*>>>& entries,
-                            QList<std::pair<QString, std::vector<xMusicLibraryTrackEntry*>>>::const_iterator entryIterator,
-                            int currentFiles, int maxFiles);
-    /**
-     * Signal emitted when inserted in stages.
-     *
-     * @param current the current number of items inserted.
-     * @param max the maximal number of items to be inserted.
-     */
-    void itemWidgetsProgress(int current, int max);
 
 protected:
-    /**
-     * Called upon resizing the tree widget.
-     *
-     * @param event a pointer to the resize event.
-     */
-    void resizeEvent(QResizeEvent* event) override;
     /**
      * Called upon the start of the drag-and-drop operation.
      *
@@ -280,37 +273,57 @@ private:
     /**
      * Add list item with the given text.
      *
-     * Add the list item or insert it in ascending order.
+     * Add the list item or insert it in ascending order using a binary search.
      *
      * @param item the pointer to the list item.
      * @param text the text to be inserted as string.
      */
     void addListWidgetItem(xPlayerListWidgetItem* item, const QString& text);
     /**
-     * Worker function for updateItems. Function is running in a separate thread.
+     * Add list items in a single batch.
+     *
+     * In sorted mode, the items are sorted once and merged with the existing items.
      *
-     * Requires fine grained reaction to interrupt cancellations.
+     * @param items vector of pointers to the list items.
      */
-    void updateItemsWorker();
+    void addListWidgetItems(const std::vector<xPlayerListWidgetItem*>& items);
     /**
-     * Called upon finishing the thread.
+     * Merge list items with the existing sorted items.
+     *
+     * The new items are sorted and merged using precomputed case folded keys.
+     * They are inserted in runs without resetting the model. Existing items are
+     * placed before new items with the same text.
+     *
+     * @param items vector of pointers to the list items.
      */
-    void updateItemsWorkerFinished();
+    void mergeListWidgetItems(const std::vector<xPlayerListWidgetItem*>& items);
     /**
-     * Worker used to add items in stages.
+     * Sort the items case-insensitive according to their text.
      *
-     * @param files list of pairs of tooltip and vector of pointer to associated music file objects.
-     * @param fileIterator iterator to the list element to be added.
-     * @param currentFiles current number of files inserted.
-     * @param maxFiles maximal number of files inserted overall.
+     * The sort is stable and uses a precomputed case folded key for each item.
+     *
+     * @param items vector of pointers to the list items sorted in place.
+     */
+    static void sortListWidgetItems(std::vector<xPlayerListWidgetItem*>& items);
+    /**
+     * Update the items with the lengths computed by the duration service.
+     *
+     * @param lengths list of pairs of list item pointer and length in ms.
+     */
+    void updateItemsLengths(const QList<std::pair<xPlayerListWidgetItem*,qint64>>& lengths);
+    /**
+     * Hide the item at the given row if it does not match the current filter.
+     *
+     * @param row the row of the item.
      */
-    void addItemWidgetsWorker(const QList<std::pair<QString, std::vector<xMusicLibraryTrackEntry*>>>& entries,
-                              QList<std::pair<QString, std::vector<xMusicLibraryTrackEntry*>>>::const_iterator entriesIterator,
-                              int currentFiles, int maxFiles);
+    void updateFilterItem(int row);
 
+    xPlayerListModel* listModel;
     bool sortItems;
     bool dragDropItems;
-    QThread* updateItemsThread;
+    xPlayerDurationService* durationService;
+    QSet<xPlayerListWidgetItem*> durationPending;
+    qint64 durationTotal;
     int dragDropFromIndex;
     int dragDropToIndex;
     QString currentMatch;
@@ -13,86 +13,53 @@
  */
 
 #include "xPlayerListWidgetItem.h"
+#include "xPlayerListModel.h"
 
-#include <QResizeEvent>
-#include <QHeaderView>
-#include <QTimer>
-#include <QDebug>
-#include <QTreeWidget>
-#include <QCoreApplication>
-#include <utility>
-
-xPlayerListWidgetItem::xPlayerListWidgetItem(const QString& text, QTreeWidget* parent):
-        QTreeWidgetItem(parent),
+xPlayerListWidgetItem::xPlayerListWidgetItem(const QString& text):
         itemTimeUpdated(true),
+        itemTimeDisplayed(false),
         itemTime(0),
         itemText(text),
         itemTooltip(),
-        itemGetText(),
-        itemGetLength(),
+        itemIcon(),
         itemTimeMode(xPlayerTimeMode::NoTime),
         itemArtistEntry(nullptr),
         itemAlbumEntry(nullptr),
         itemTrackEntry(nullptr),
         itemMovieEntry(nullptr),
-        itemErrorMark(false) {
-    Q_ASSERT(parent != nullptr);
-    setText(0, itemText);
-    itemTextWidth = parent->fontMetrics().size(Qt::TextSingleLine, itemText+"...").width();
-    itemBackgroundBrush = background(0);
-}
-
-xPlayerListWidgetItem::xPlayerListWidgetItem(std::function<QString ()> getText, std::function<qint64 ()> getLength,
-                                             xPlayerTimeMode timeMode, QTreeWidget* parent):
-        QTreeWidgetItem(parent),
-        itemTimeUpdated(timeMode == xPlayerTimeMode::NoTime),
-        itemTime(0),
-        itemTooltip(),
-        itemGetText(std::move(getText)),
-        itemGetLength(std::move(getLength)),
-        itemTimeMode(timeMode),
-        itemArtistEntry(nullptr),
-        itemAlbumEntry(nullptr),
-        itemTrackEntry(nullptr),
-        itemMovieEntry(nullptr),
-        itemErrorMark(false) {
-    Q_ASSERT(parent != nullptr);
-    itemText = itemGetText();
-    itemTextWidth = parent->fontMetrics().size(Qt::TextSingleLine, itemText+"...").width();
-    setText(0, itemText);
-    itemBackgroundBrush = background(0);
+        itemErrorMark(false),
+        itemModel(nullptr),
+        itemRow(-1) {
 }
 
-xPlayerListWidgetItem::xPlayerListWidgetItem(xMusicLibraryArtistEntry* entry, QTreeWidget* parent):
-        xPlayerListWidgetItem([entry] { return entry->getArtistName(); },
-                              [] { return -1; }, xPlayerTimeMode::NoTime, parent) {
+xPlayerListWidgetItem::xPlayerListWidgetItem(xMusicLibraryArtistEntry* entry):
+        xPlayerListWidgetItem(entry->getArtistName()) {
     itemArtistEntry = entry;
 }
 
-xPlayerListWidgetItem::xPlayerListWidgetItem(xMusicLibraryAlbumEntry* entry, QTreeWidget* parent):
-        xPlayerListWidgetItem([entry] { return entry->getAlbumName(); },
-                              [] { return -1; }, xPlayerTimeMode::NoTime, parent) {
+xPlayerListWidgetItem::xPlayerListWidgetItem(xMusicLibraryAlbumEntry* entry):
+        xPlayerListWidgetItem(entry->getAlbumName()) {
     itemAlbumEntry = entry;
 }
 
-xPlayerListWidgetItem::xPlayerListWidgetItem(xMusicLibraryTrackEntry* entry, QTreeWidget* parent):
-        xPlayerListWidgetItem([entry] { return entry->getTrackName(); },
-                              [entry] { return entry->getLength(); }, xPlayerTimeMode::MinuteTimeShortMode, parent) {
+xPlayerListWidgetItem::xPlayerListWidgetItem(xMusicLibraryTrackEntry* entry):
+        xPlayerListWidgetItem(entry->getTrackName()) {
     itemTrackEntry = entry;
+    itemTimeMode = xPlayerTimeMode::MinuteTimeShortMode;
+    itemTimeUpdated = false;
     // Only update the time in the constructor if it was already scanned. The update will force a scan if necessary.
-    setTextAlignment(1, Qt::AlignRight|Qt::AlignVCenter);
     if (itemTrackEntry->isScanned()) {
         updateTime();
         updateTimeDisplay();
     }
 }
 
-xPlayerListWidgetItem::xPlayerListWidgetItem(xMovieLibraryEntry* entry, QTreeWidget* parent):
-    xPlayerListWidgetItem([entry] { return entry->getMovieName(); },
-                          [entry] { return entry->getLength(); }, xPlayerTimeMode::HourTimeShortMode, parent) {
+xPlayerListWidgetItem::xPlayerListWidgetItem(xMovieLibraryEntry* entry):
+        xPlayerListWidgetItem(entry->getMovieName()) {
     itemMovieEntry = entry;
+    itemTimeMode = xPlayerTimeMode::HourTimeShortMode;
+    itemTimeUpdated = false;
     // Only update the time in the constructor if it was already scanned. The update will force a scan if necessary.
-    setTextAlignment(1, Qt::AlignRight|Qt::AlignVCenter);
     if (itemMovieEntry->isScanned()) {
         updateTime();
         updateTimeDisplay();
@@ -103,12 +70,21 @@ void xPlayerListWidgetItem::setIcon(const QString& fileName) {
     if (fileName.isEmpty()) {
         removeIcon();
     } else {
-        QTreeWidgetItem::setIcon(0, QIcon(fileName));
+        // Share the icon with other items of the model.
+        itemIcon = (itemModel) ? itemModel->icon(fileName) : QIcon(fileName);
+        changed();
     }
 }
 
 void xPlayerListWidgetItem::removeIcon() {
-    QTreeWidgetItem::setIcon(0, QIcon());
+    if (!itemIcon.isNull()) {
+        itemIcon = QIcon();
+        changed();
+    }
+}
+
+const QIcon& xPlayerListWidgetItem::icon() const {
+    return itemIcon;
 }
 
 void xPlayerListWidgetItem::addToolTip(const QString& text) {
@@ -117,15 +93,7 @@ void xPlayerListWidgetItem::addToolTip(const QString& text) {
 }
 
 void xPlayerListWidgetItem::updateToolTip() {
-    if (treeWidget()->columnWidth(0) < itemTextWidth) {
-        if (itemTooltip.isEmpty()) {
-            setToolTip(0, itemText);
-        } else {
-            setToolTip(0, QString("%1\n%2").arg(itemText, itemTooltip));
-        }
-    } else {
-        setToolTip(0, itemTooltip);
-    }
+    changed();
 }
 
 void xPlayerListWidgetItem::removeToolTip() {
@@ -133,18 +101,18 @@ void xPlayerListWidgetItem::removeToolTip() {
     updateToolTip();
 }
 
+const QString& xPlayerListWidgetItem::toolTip() const {
+    return itemTooltip;
+}
+
 void xPlayerListWidgetItem::addErrorMark() {
-    for (auto i = 0; i < columnCount(); ++i) {
-        setBackground(i, QBrush(Qt::red, Qt::Dense6Pattern));
-    }
     itemErrorMark = true;
+    changed();
 }
 
 void xPlayerListWidgetItem::removeErrorMark() {
-    for (auto i = 0; i < columnCount(); ++i) {
-        setBackground(i, itemBackgroundBrush);
-    }
     itemErrorMark = false;
+    changed();
 }
 
 bool xPlayerListWidgetItem::hasErrorMark() {
@@ -155,49 +123,67 @@ const QString& xPlayerListWidgetItem::text() const {
     return itemText;
 }
 
-int xPlayerListWidgetItem::textWidth() const {
-    return itemTextWidth;
+QString xPlayerListWidgetItem::timeText() const {
+    if (itemTimeDisplayed) {
+        switch (itemTimeMode) {
+            case xPlayerTimeMode::MinuteTimeShortMode: {
+                return QString("%1:%2").arg(itemTime/60000).arg((itemTime/1000)%60, 2, 10, QChar('0'));
+            }
+            case xPlayerTimeMode::HourTimeShortMode: {
+                return QString("%1:%2:%3").arg(itemTime/3600000).arg((itemTime/60000)%60, 2, 10, QChar('0')).arg((itemTime/1000)%60, 2, 10, QChar('0'));
+            }
+            default: break;
+        }
+    }
+    return {};
 }
 
 void xPlayerListWidgetItem::updateText() {
-    if (itemGetText != nullptr) {
-        itemText = itemGetText();
-        // Update with for new text.
-        itemTextWidth = treeWidget()->fontMetrics().size(Qt::TextSingleLine, itemText+"...").width();
+    if (itemArtistEntry) {
+        itemText = itemArtistEntry->getArtistName();
+    } else if (itemAlbumEntry) {
+        itemText = itemAlbumEntry->getAlbumName();
+    } else if (itemTrackEntry) {
+        itemText = itemTrackEntry->getTrackName();
+    } else if (itemMovieEntry) {
+        itemText = itemMovieEntry->getMovieName();
     }
-    setText(0, itemText);
-    updateToolTip();
+    changed();
 }
 
 qint64 xPlayerListWidgetItem::updateTime() {
     // Read time only once. Use cached value later on.
     // Note: the corresponding entry has to be scanned beforehand.
     if (!itemTimeUpdated) {
-        itemTime = itemGetLength();
+        if (itemTrackEntry) {
+            itemTime = itemTrackEntry->getLength();
+        } else if (itemMovieEntry) {
+            itemTime = itemMovieEntry->getLength();
+        }
         itemTimeUpdated = true;
     }
     return itemTime;
 }
 
+void xPlayerListWidgetItem::setTime(qint64 time) {
+    itemTime = time;
+    itemTimeUpdated = true;
+}
+
+qint64 xPlayerListWidgetItem::time() const {
+    return itemTime;
+}
+
+bool xPlayerListWidgetItem::hasTime() const {
+    return itemTimeUpdated;
+}
+
 void xPlayerListWidgetItem::updateTimeDisplay() {
-    if (itemTimeUpdated) {
-        switch (itemTimeMode) {
-            case xPlayerTimeMode::MinuteTimeShortMode: {
-                setText(1, QString("%1:%2").arg(itemTime/60000).arg((itemTime/1000)%60, 2, 10, QChar('0')));
-            } break;
-            case xPlayerTimeMode::HourTimeShortMode: {
-                setText(1, QString("%1:%2:%3").arg(itemTime/3600000).arg((itemTime/60000)%60, 2, 10, QChar('0')).arg((itemTime/1000)%60, 2, 10, QChar('0')));
-            } break;
-            default: break;
-        }
-        if (itemTime <= 0) {
-            addErrorMark();
-        } else {
-            // Only remove the error mark if it was marked.
-            if (hasErrorMark()) {
-                removeErrorMark();
-            }
-        }
+    if ((itemTimeUpdated) && (itemTimeMode != xPlayerTimeMode::NoTime)) {
+        itemTimeDisplayed = true;
+        // The error mark is shown for invalid times.
+        itemErrorMark = (itemTime <= 0);
+        changed();
     }
 }
 
@@ -217,3 +203,8 @@ xMovieLibraryEntry* xPlayerListWidgetItem::movieEntry() const {
     return itemMovieEntry;
 }
 
+void xPlayerListWidgetItem::changed() {
+    if (itemModel) {
+        itemModel->itemChanged(this);
+    }
+}
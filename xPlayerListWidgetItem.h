@@ -22,24 +22,27 @@
 #include "xMusicLibraryTrackEntry.h"
 #include "xMovieLibraryEntry.h"
 
-#include <QTreeWidgetItem>
+#include <QIcon>
 #include <QString>
 
-#include <functional>
+class xPlayerListModel;
 
 /**
+ * Lightweight row of the xPlayerListWidget.
+ *
+ * The item does not create any display data. The xPlayerListModel creates the
+ * displayed text, time, tooltip and error mark on demand for visible rows only.
+ *
  * @Note: Qt does not support templates with signals and slots mechanism.
  */
-class xPlayerListWidgetItem:public QTreeWidgetItem {
+class xPlayerListWidgetItem {
 public:
-    explicit xPlayerListWidgetItem(const QString& text, QTreeWidget* parent);
-    explicit xPlayerListWidgetItem(std::function<QString ()> getText, std::function<qint64 ()> getLength,
-                                   xPlayerTimeMode timeMode, QTreeWidget* parent);
-    explicit xPlayerListWidgetItem(xMusicLibraryArtistEntry* artist, QTreeWidget* parent);
-    explicit xPlayerListWidgetItem(xMusicLibraryAlbumEntry* album, QTreeWidget* parent);
-    explicit xPlayerListWidgetItem(xMusicLibraryTrackEntry* track, QTreeWidget* parent);
-    explicit xPlayerListWidgetItem(xMovieLibraryEntry* movie, QTreeWidget* parent);
-    ~xPlayerListWidgetItem() override = default;
+    explicit xPlayerListWidgetItem(const QString& text);
+    explicit xPlayerListWidgetItem(xMusicLibraryArtistEntry* artist);
+    explicit xPlayerListWidgetItem(xMusicLibraryAlbumEntry* album);
+    explicit xPlayerListWidgetItem(xMusicLibraryTrackEntry* track);
+    explicit xPlayerListWidgetItem(xMovieLibraryEntry* movie);
+    ~xPlayerListWidgetItem() = default;
     /**
      * Set an icon for the list item.
      *
@@ -50,6 +53,12 @@ public:
      * Remove the icon from the list item.
      */
     void removeIcon();
+    /**
+     * Return the icon of the list item.
+     *
+     * @return the icon, a null icon if none is set.
+     */
+    [[nodiscard]] const QIcon& icon() const;
     /**
      * Add a tooltip to the list item.
      *
@@ -62,8 +71,7 @@ public:
     /**
      * Update the tooltip to the list item.
      *
-     * The tooltip is added to a possibly shortened track name
-     * separated by a newline.
+     * The tooltip is created by the model once it is shown.
      */
     void updateToolTip();
     /**
@@ -73,6 +81,12 @@ public:
      * visible.
      */
     void removeToolTip();
+    /**
+     * Return the added tooltip.
+     *
+     * @return the tooltip as string.
+     */
+    [[nodiscard]] const QString& toolTip() const;
     /**
      * Add a red background pattern as error mark.
      */
@@ -94,11 +108,11 @@ public:
      */
     [[nodiscard]] const QString& text() const;
     /**
-     * Return the width of the list item text.
+     * Return the displayed time of the list item.
      *
-     * @return the width as int.
+     * @return the time as formatted string, empty if no time is displayed.
      */
-    [[nodiscard]] int textWidth() const;
+    [[nodiscard]] QString timeText() const;
     /**
      * Update the text of the list item.
      *
@@ -109,6 +123,24 @@ public:
      * Determine the time for the list item. No UI update.
      */
     qint64 updateTime();
+    /**
+     * Set the time for the list item. No UI update.
+     *
+     * @param time the time in ms.
+     */
+    void setTime(qint64 time);
+    /**
+     * Return the time for the list item.
+     *
+     * @return the time in ms, 0 if not yet determined.
+     */
+    [[nodiscard]] qint64 time() const;
+    /**
+     * Check if the time of the list item has been determined.
+     *
+     * @return true if the time is available, false otherwise.
+     */
+    [[nodiscard]] bool hasTime() const;
     /**
      * Update the displayed time in the list item.
      */
@@ -124,20 +156,28 @@ public:
     [[nodiscard]] xMovieLibraryEntry* movieEntry() const;
 
 protected:
+    /**
+     * Notify the model about a changed item.
+     */
+    void changed();
+
     bool itemTimeUpdated;
+    bool itemTimeDisplayed;
     qint64 itemTime;
     QString itemText;
-    int itemTextWidth;
     QString itemTooltip;
-    std::function<QString ()> itemGetText;
-    std::function<qint64 ()> itemGetLength;
+    QIcon itemIcon;
     xPlayerTimeMode itemTimeMode;
     xMusicLibraryArtistEntry* itemArtistEntry{};
     xMusicLibraryAlbumEntry* itemAlbumEntry{};
     xMusicLibraryTrackEntry* itemTrackEntry{};
     xMovieLibraryEntry* itemMovieEntry{};
-    QBrush itemBackgroundBrush;
     bool itemErrorMark;
+    // Set by the model.
+    xPlayerListModel* itemModel;
+    int itemRow;
+
+    friend class xPlayerListModel;
 };
 
 #endif
\ No newline at end of file
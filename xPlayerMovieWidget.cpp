@@ -17,6 +17,7 @@
 #include "xPlayerPulseAudioControls.h"
 #include "xPlayerUI.h"
 #include "xPlayerConfiguration.h"
+#include "xMovieResumePositions.h"
 
 #include <QGroupBox>
 #include <QComboBox>
@@ -26,6 +27,9 @@
 #include <QActionGroup>
 #include <QApplication>
 
+// Maximal number of movies shown in the continue watching menu.
+constexpr auto xPlayerMovieWidget_ContinueWatching = 10;
+
 xPlayerMovieWidget::xPlayerMovieWidget(xMoviePlayer* player, QWidget *parent, Qt::WindowFlags flags):
         QWidget(parent, flags),
         moviePlayer(player),
@@ -160,6 +164,26 @@ void xPlayerMovieWidget::createOptionsMenu() {
     optionsAutoplayNext->setCheckable(true);
     optionsAutoplayNext->setChecked(false);
     connect(optionsAutoplayNext, &QAction::triggered, this, &xPlayerMovieWidget::autoPlayNextMovie);
+    // Fast seek to key frames.
+    auto optionsFastSeek = new QAction(tr("Fast Seek"), optionsMenu);
+    optionsFastSeek->setCheckable(true);
+    optionsFastSeek->setChecked(moviePlayer->getFastSeek());
+    connect(optionsFastSeek, &QAction::triggered, moviePlayer, &xMoviePlayer::setFastSeek);
+    // Continue watching submenu. Updated whenever shown.
+    auto continueWatchingSubmenu = new QMenu(tr("Continue Watching"), optionsMenu);
+    connect(continueWatchingSubmenu, &QMenu::aboutToShow, [=]() {
+        continueWatchingSubmenu->clear();
+        for (const auto& watching : xMovieResumePositions::positions()->continueWatching(xPlayerMovieWidget_ContinueWatching)) {
+            auto watchingAction = continueWatchingSubmenu->addAction(QString("%1 - %2 (%3)").arg(
+                    watching.directory, watching.movie, xPlayer::millisecondsToTimeFormat(watching.position, true)));
+            connect(watchingAction, &QAction::triggered, [=](bool) {
+                moviePlayer->clearMovieQueue();
+                moviePlayer->setMovie(std::filesystem::path(watching.path.toStdString()),
+                                      watching.movie, watching.tag, watching.directory);
+            });
+        }
+        continueWatchingSubmenu->setEnabled(!continueWatchingSubmenu->isEmpty());
+    });
     // Aspect ration submenu.
     auto aspectRatioSubmenu = new QMenu(tr("Aspect Ratio"), optionsMenu);
     auto aspectRatioActions = new QActionGroup(aspectRatioSubmenu);
@@ -182,7 +206,9 @@ void xPlayerMovieWidget::createOptionsMenu() {
     }
     // Compose menu.
     optionsMenu->addAction(optionsAutoplayNext);
+    optionsMenu->addAction(optionsFastSeek);
     optionsMenu->addSeparator();
+    optionsMenu->addMenu(continueWatchingSubmenu);
     optionsMenu->addMenu(aspectRatioSubmenu);
     optionsMenuButton->setMenu(optionsMenu);
 }
@@ -302,39 +302,32 @@ xPlayerMusicLibraryWidgetItem* xPlayerMusicLibraryWidget::itemAt(const QPoint& p
     }
 }
 
-void xPlayerMusicLibraryWidget::markItems(const QStringList& missingArtists,
-                                          const std::map<QString, QStringList>& missingAlbums,
-                                          const std::list<xMusicLibraryTrackEntry*>& missingTracks,
-                                          const std::list<xMusicLibraryTrackEntry*>& differentTracks) {
-    // Remove any markings.
-    clearItems();
+void xPlayerMusicLibraryWidget::markItems(const xMusicLibraryDifference& missing) {
     // Mark the missing artists.
-    musicLibraryHiddenArtists = missingArtists;
-    for (const auto& artist : missingArtists) {
-        auto artistItem = mapArtists.find(artist);
+    for (auto artist : missing.artists) {
+        auto artistItem = mapArtists.find(artist->getArtistName());
         if (artistItem != mapArtists.end()) {
             artistItem->second->mark(QBrush(Qt::red, Qt::Dense4Pattern), true);
+            musicLibraryHiddenArtists.push_back(artist->getArtistName());
         }
     }
     // Update missing artist visibility.
     updateMissingArtists();
     // Mark the missing albums.
-    for (const auto& artist : missingAlbums) {
-        auto albumsForArtist = mapAlbums.find(artist.first);
+    for (auto album : missing.albums) {
+        auto albumsForArtist = mapAlbums.find(album->getArtistName());
         if (albumsForArtist != mapAlbums.end()) {
-            for (const auto& album : artist.second) {
-                auto albumItem = albumsForArtist->second.find(album);
-                if (albumItem != albumsForArtist->second.end()) {
-                    // Color the missing albums (recursivly) with a denser pattern.
-                    albumItem->second->mark(QBrush(Qt::red, Qt::Dense4Pattern), true);
-                    // The corresponding missingArtists are colored with lighter pattern.
-                    albumItem->second->artist()->mark(QBrush(Qt::red, Qt::Dense6Pattern));
-                }
+            auto albumItem = albumsForArtist->second.find(album->getAlbumName());
+            if (albumItem != albumsForArtist->second.end()) {
+                // Color the missing albums (recursivly) with a denser pattern.
+                albumItem->second->mark(QBrush(Qt::red, Qt::Dense4Pattern), true);
+                // The corresponding missingArtists are colored with lighter pattern.
+                albumItem->second->artist()->mark(QBrush(Qt::red, Qt::Dense6Pattern));
             }
         }
     }
     // Mark the missing tracks.
-    for (auto track : missingTracks) {
+    for (auto track : missing.tracks) {
         auto trackItem = mapTracks.find(track);
         if (trackItem != mapTracks.end()) {
             // Color the missing missingTracks with a denser pattern.
@@ -345,7 +338,7 @@ void xPlayerMusicLibraryWidget::markItems(const QStringList& missingArtists,
         }
     }
     // mark the different tracks.
-    for (const auto& track : differentTracks) {
+    for (auto track : missing.differentTracks) {
         auto trackItem = mapTracks.find(track);
         if (trackItem != mapTracks.end()) {
             // Color the missing missingTracks with a denser pattern.
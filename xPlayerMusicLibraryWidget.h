@@ -172,15 +172,12 @@ public:
     /**
      * Mark the items in the music library tree.
      *
-     * @param missingArtists the list of missing artists.
-     * @param missingAlbums the list of missing albums for existing artists.
-     * @param missingTracks the list of missing tracks for existing artists and albums.
-     * @param differentTracks the list of tracks that have the same relative path, but are different.
-     */
-    void markItems(const QStringList& missingArtists,
-                   const std::map<QString, QStringList>& missingAlbums,
-                   const std::list<xMusicLibraryTrackEntry*> &missingTracks,
-                   const std::list<xMusicLibraryTrackEntry*> &differentTracks);
+     * Existing markings are kept. The differences of a compare can thereby be
+     * marked in batches. Use clearItems to remove existing markings.
+     *
+     * @param missing the missing artists, albums and tracks and the tracks that are different.
+     */
+    void markItems(const xMusicLibraryDifference& missing);
     /**
      * Mark the existing items in the music library tree.
      *
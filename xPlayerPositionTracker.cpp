@@ -0,0 +1,93 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "xPlayerPositionTracker.h"
+#include "xPlayerConfiguration.h"
+
+#include <QDebug>
+
+
+xPlayerPositionTracker::xPlayerPositionTracker(QObject* parent):
+        QObject(parent),
+        trackerPosition(0),
+        trackerPending(false),
+        trackerTicksReceived(0),
+        trackerTicksProcessed(0) {
+    trackerTimer = new QTimer(this);
+    trackerTimer->setSingleShot(true);
+    // Database updates are run in order of their submission.
+    trackerPool = new QThreadPool(this);
+    trackerPool->setMaxThreadCount(1);
+    connect(trackerTimer, &QTimer::timeout, this, &xPlayerPositionTracker::timeout);
+    connect(xPlayerConfiguration::configuration(), &xPlayerConfiguration::updatedPlayerPositionInterval,
+            this, &xPlayerPositionTracker::updatedPositionInterval);
+    updatedPositionInterval();
+}
+
+xPlayerPositionTracker::~xPlayerPositionTracker() {
+    // Finish outstanding database updates. Their results are no longer reported.
+    trackerPool->waitForDone();
+}
+
+void xPlayerPositionTracker::record(const std::function<std::pair<int,qint64>()>& update,
+                                    const std::function<void(const std::pair<int,qint64>&)>& updated) {
+    trackerPool->start(QRunnable::create([this, update, updated]() {
+        auto result = update();
+        QMetaObject::invokeMethod(this, [updated, result]() { updated(result); }, Qt::QueuedConnection);
+    }));
+}
+
+qint64 xPlayerPositionTracker::getTicksReceived() const {
+    return trackerTicksReceived;
+}
+
+qint64 xPlayerPositionTracker::getTicksProcessed() const {
+    return trackerTicksProcessed;
+}
+
+void xPlayerPositionTracker::tick(qint64 position) {
+    ++trackerTicksReceived;
+    trackerPosition = position;
+    if (trackerTimer->isActive()) {
+        // Combine with the following ticks within the interval.
+        trackerPending = true;
+        return;
+    }
+    process();
+    trackerTimer->start();
+}
+
+void xPlayerPositionTracker::reset() {
+    qDebug() << "xPlayerPositionTracker: ticks received: " << trackerTicksReceived
+             << ", processed: " << trackerTicksProcessed;
+    trackerTimer->stop();
+    trackerPending = false;
+}
+
+void xPlayerPositionTracker::timeout() {
+    if (trackerPending) {
+        process();
+        trackerTimer->start();
+    }
+}
+
+void xPlayerPositionTracker::updatedPositionInterval() {
+    trackerTimer->setInterval(xPlayerConfiguration::configuration()->getPlayerPositionInterval());
+}
+
+void xPlayerPositionTracker::process() {
+    trackerPending = false;
+    ++trackerTicksProcessed;
+    emit position(trackerPosition);
+}
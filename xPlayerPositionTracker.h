@@ -0,0 +1,104 @@
+/*
+ * This file is part of xPlay.
+ *
+ * xPlay is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * xPlay is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __XPLAYERPOSITIONTRACKER_H__
+#define __XPLAYERPOSITIONTRACKER_H__
+
+#include <QObject>
+#include <QTimer>
+#include <QThreadPool>
+
+#include <functional>
+
+/**
+ * Coalesce the position updates of a player and run its database updates.
+ *
+ * The position ticks of the media backends are reduced to the configured
+ * interval. The first tick is processed immediately, following ticks within
+ * the interval are combined and the latest position is processed at the end
+ * of the interval. Database updates are run in order on a worker thread and
+ * their result is reported back in the thread the tracker lives in.
+ */
+class xPlayerPositionTracker:public QObject {
+    Q_OBJECT
+
+public:
+    explicit xPlayerPositionTracker(QObject* parent=nullptr);
+    ~xPlayerPositionTracker() override;
+    /**
+     * Run a database update on the worker thread.
+     *
+     * @param update the function updating the database, returns the pair of play count and time stamp.
+     * @param updated the function called with the result in the thread of the tracker.
+     */
+    void record(const std::function<std::pair<int,qint64>()>& update,
+                const std::function<void(const std::pair<int,qint64>&)>& updated);
+    /**
+     * Return the number of position ticks received.
+     *
+     * @return the number of ticks since construction.
+     */
+    [[nodiscard]] qint64 getTicksReceived() const;
+    /**
+     * Return the number of position ticks processed.
+     *
+     * @return the number of processed positions since construction.
+     */
+    [[nodiscard]] qint64 getTicksProcessed() const;
+
+signals:
+    /**
+     * Signal a coalesced position update.
+     *
+     * @param position the latest position in ms.
+     */
+    void position(qint64 position);
+
+public slots:
+    /**
+     * Receive a position tick of the media backend.
+     *
+     * @param position the current position in ms.
+     */
+    void tick(qint64 position);
+    /**
+     * Discard a pending position update, e.g. after the media was changed.
+     */
+    void reset();
+
+private slots:
+    /**
+     * Process the pending position at the end of the interval.
+     */
+    void timeout();
+    /**
+     * Called if the position update interval has been changed.
+     */
+    void updatedPositionInterval();
+
+private:
+    /**
+     * Emit the latest position.
+     */
+    void process();
+
+    QTimer* trackerTimer;
+    QThreadPool* trackerPool;
+    qint64 trackerPosition;
+    bool trackerPending;
+    qint64 trackerTicksReceived;
+    qint64 trackerTicksProcessed;
+};
+
+#endif
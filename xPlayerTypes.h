@@ -16,8 +16,14 @@
 #define __XPLAYERTYPES_H__
 
 #include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QVector>
 #include <QUrl>
 
+#include <cstdint>
+#include <vector>
+
 /**
  * Mode for displaying time.
  */
@@ -34,4 +40,75 @@ enum xPlayerTimeMode {
  */
 typedef std::tuple<QUrl,QString,QString,qint64> xDirectoryEntry;
 
+/**
+ * Album of a remote library with its track entries.
+ */
+struct xRemoteLibraryAlbum {
+    xDirectoryEntry album;
+    std::vector<xDirectoryEntry> tracks;
+};
+
+/**
+ * Artist of a remote library with its albums.
+ */
+struct xRemoteLibraryArtist {
+    xDirectoryEntry artist;
+    std::vector<xRemoteLibraryAlbum> albums;
+};
+
+/**
+ * Track of a remote library as stored in the persistent remote library cache.
+ */
+struct xRemoteLibraryTrack {
+    QString artist;
+    QString album;
+    QString path;
+    QString name;
+    qint64 length = -1;
+};
+
+/**
+ * Metadata of a movie file stored in the movie catalog.
+ *
+ * The entry is valid as long as size and modification time match the file.
+ * The key frames of the main video stream are stored as sorted positions in ms.
+ * The key frame index is invalid if the video stream has no index. Such entries are indexed again.
+ * The thumbnails are stored as JPEG encoded strip of equally sized frames.
+ */
+struct xMovieFileInfo {
+    std::uintmax_t size = 0;
+    qint64 modified = 0;
+    qint64 length = -1;
+    QVector<qint64> chapterBegin;
+    QVector<qint64> chapterLength;
+    QStringList audioLanguages;
+    QStringList subtitleLanguages;
+    QVector<qint64> keyFrames;
+    bool keyFramesValid = false;
+    QByteArray thumbnails;
+};
+
+/**
+ * Content fingerprint of a file. Valid as long as size and modification time match the file.
+ */
+struct xFileFingerprint {
+    QString path;
+    std::uintmax_t size = 0;
+    qint64 modified = 0;
+    QString fingerprint;
+};
+
+/**
+ * Resume position of a partially watched movie file.
+ */
+struct xMovieResumePosition {
+    QString path;
+    QString tag;
+    QString directory;
+    QString movie;
+    qint64 position = 0;
+    qint64 length = -1;
+    qint64 timeStamp = 0;
+};
+
 #endif